@@ -99,6 +99,7 @@ CGUIVisualisationControl::CGUIVisualisationControl(DWORD dwParentID, DWORD dwCon
 
 CGUIVisualisationControl::~CGUIVisualisationControl(void)
 {
+  ClearBuffers();
   fft_close(m_fftState);
 }
 
@@ -287,6 +288,8 @@ void CGUIVisualisationControl::Render()
       return;
     }
   }
+  ProcessAudio();
+
   CSingleLock lock (m_critSection);
   if (m_pVisualisation)
   {
@@ -363,45 +366,68 @@ void CGUIVisualisationControl::OnAudioData(const unsigned char* pAudioData, int
   if (iAudioDataLength<0)
     return;
   
-  // Save our audio data in the buffers
-  auto_ptr<CAudioBuffer> pBuffer ( new CAudioBuffer(2*AUDIO_BUFFER_SIZE) );
+  // only copy the data here, this is the audio thread.  the analysis and
+  // handing it to the vis happens in ProcessAudio() from Render()
+  CAudioBuffer* pBuffer;
+  if (m_freeBuffers.size())
+  {
+    pBuffer = m_freeBuffers.front();
+    m_freeBuffers.pop_front();
+  }
+  else
+    pBuffer = new CAudioBuffer(2*AUDIO_BUFFER_SIZE);
   pBuffer->Set(pAudioData, iAudioDataLength, m_iBitsPerSample);
-  m_vecBuffers.push_back( pBuffer.release() );
+  m_vecBuffers.push_back(pBuffer);
 
   if ( (int)m_vecBuffers.size() < m_iNumBuffers) return ;
 
-  auto_ptr<CAudioBuffer> ptrAudioBuffer ( m_vecBuffers.front() );
+  m_readyBuffers.push_back(m_vecBuffers.front());
   m_vecBuffers.pop_front();
-  // Fourier transform the data if the vis wants it...
-  if (m_bWantsFreq)
+
+  // don't pile them up if we're not being rendered
+  while (m_readyBuffers.size() > MAX_AUDIO_BUFFERS)
+  {
+    m_freeBuffers.push_back(m_readyBuffers.front());
+    m_readyBuffers.pop_front();
+  }
+  return ;
+}
+
+void CGUIVisualisationControl::ProcessAudio()
+{
+  std::list<CAudioBuffer*> buffers;
   {
-    const short* psAudioData = ptrAudioBuffer->Get();
+    CSingleLock lock (m_critSection);
+    buffers.swap(m_readyBuffers);
+  }
+
+  for (std::list<CAudioBuffer*>::iterator it = buffers.begin(); it != buffers.end(); ++it)
+  {
+    const short* psAudioData = (*it)->Get();
 
-    // FFT the data
-    fft_perform_stereo(psAudioData, m_fFreq, m_fftState);
+    // Fourier transform the data if the vis wants it...
+    if (m_bWantsFreq)
+      fft_perform_stereo(psAudioData, m_fFreq, m_fftState);
 
     // Transfer data to our visualisation
+    CSingleLock lock (m_critSection);
+    if (!m_pVisualisation || !m_bInitialized)
+      break;
     try
     {
-      m_pVisualisation->AudioData(ptrAudioBuffer->Get(), AUDIO_BUFFER_SIZE/2, m_fFreq, AUDIO_BUFFER_SIZE/2);
-    }
-    catch (...)
-    {
-      CLog::Log(LOGERROR, "Exception in Visualisation::AudioData()");
-    }
-  }
-  else
-  { // Transfer data to our visualisation
-    try
-    {
-      m_pVisualisation->AudioData(ptrAudioBuffer->Get(), AUDIO_BUFFER_SIZE/2, NULL, 0);
+      if (m_bWantsFreq)
+        m_pVisualisation->AudioData(psAudioData, AUDIO_BUFFER_SIZE/2, m_fFreq, AUDIO_BUFFER_SIZE/2);
+      else
+        m_pVisualisation->AudioData(psAudioData, AUDIO_BUFFER_SIZE/2, NULL, 0);
     }
     catch (...)
     {
       CLog::Log(LOGERROR, "Exception in Visualisation::AudioData()");
     }
   }
-  return ;
+
+  CSingleLock lock (m_critSection);
+  m_freeBuffers.splice(m_freeBuffers.end(), buffers);
 }
 
 bool CGUIVisualisationControl::OnAction(const CAction &action)
@@ -494,6 +520,16 @@ void CGUIVisualisationControl::ClearBuffers()
     delete pAudioBuffer;
     m_vecBuffers.pop_front();
   }
+  while (m_readyBuffers.size() > 0)
+  {
+    delete m_readyBuffers.front();
+    m_readyBuffers.pop_front();
+  }
+  while (m_freeBuffers.size() > 0)
+  {
+    delete m_freeBuffers.front();
+    m_freeBuffers.pop_front();
+  }
   for (int j = 0; j < AUDIO_BUFFER_SIZE*2; j++)
   {
     m_fFreq[j] = 0.0f;
@@ -68,13 +68,16 @@ private:
   void CreateBuffers();
   void ClearBuffers();
   bool UpdateAlbumArt();
+  void ProcessAudio();
   CStdString      m_currentVis;
   CVisualisation* m_pVisualisation;
 
   int m_iChannels;
   int m_iSamplesPerSec;
   int m_iBitsPerSample;
-  std::list<CAudioBuffer*> m_vecBuffers;
+  std::list<CAudioBuffer*> m_vecBuffers;    // held back for the vis' sync delay
+  std::list<CAudioBuffer*> m_readyBuffers;  // waiting for ProcessAudio()
+  std::list<CAudioBuffer*> m_freeBuffers;
   int m_iNumBuffers;        // Number of Audio buffers
   bool m_bWantsFreq;
   fft_state* m_fftState;
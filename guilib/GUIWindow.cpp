@@ -42,10 +42,26 @@
 #include "utils/PerformanceSample.h"
 #endif
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
 using namespace std;
 
 CStdString CGUIWindow::CacheFilename = "";
 
+// skin files of windows loaded on demand, as parsed, so that activating one
+// doesn't read and parse its xml again. includes are resolved on each load
+// as conditional includes depend on the state at the time, and the control
+// factory adds the defaults to the elements it is given.
+struct SCachedWindowXML
+{
+  time_t mtime;
+  __int64 size;
+  TiXmlDocument doc;
+};
+static map<CStdString, SCachedWindowXML> g_windowXMLCache;
+static CCriticalSection g_windowXMLCacheSection;
+
 CGUIWindow::CGUIWindow(DWORD dwID, const CStdString &xmlFile)
 {
   m_dwWindowId = dwID;
@@ -78,6 +94,8 @@ CGUIWindow::~CGUIWindow(void)
 void CGUIWindow::FlushReferenceCache()
 {
   CacheFilename.clear();
+  CSingleLock lock(g_windowXMLCacheSection);
+  g_windowXMLCache.clear();
 }
 
 bool CGUIWindow::LoadReferences()
@@ -167,7 +185,7 @@ bool CGUIWindow::Load(const CStdString& strFileName, bool bContainsPath)
     strPath = g_SkinInfo.GetSkinPath(strFileName, &resToUse);
   }
 
-  if ( !xmlDoc.LoadFile(strPath.c_str()) && !xmlDoc.LoadFile(strPath.ToLower().c_str()) && !xmlDoc.LoadFile(strLowerPath.c_str()))
+  if ( !LoadXMLFile(xmlDoc, strPath) && !LoadXMLFile(xmlDoc, strPath.ToLower()) && !LoadXMLFile(xmlDoc, strLowerPath))
   {
     CLog::Log(LOGERROR, "unable to load:%s, Line %d\n%s", strPath.c_str(), xmlDoc.ErrorRow(), xmlDoc.ErrorDesc());
 #ifdef PRE_SKIN_VERSION_2_1_COMPATIBILITY
@@ -202,6 +220,40 @@ bool CGUIWindow::Load(const CStdString& strFileName, bool bContainsPath)
   return ret;
 }
 
+bool CGUIWindow::LoadXMLFile(TiXmlDocument &xmlDoc, const CStdString &strPath)
+{
+  // windows that stay loaded only parse their file once anyway
+  if (!m_loadOnDemand)
+    return xmlDoc.LoadFile(strPath.c_str());
+
+  struct stat fileStat;
+  if (strPath.IsEmpty() || stat(strPath.c_str(), &fileStat) == -1)
+    return xmlDoc.LoadFile(strPath.c_str()); // for the error
+
+  CSingleLock lock(g_windowXMLCacheSection);
+  map<CStdString, SCachedWindowXML>::iterator it = g_windowXMLCache.find(strPath);
+  if (it != g_windowXMLCache.end())
+  {
+    if (it->second.mtime == fileStat.st_mtime && it->second.size == fileStat.st_size)
+    {
+      xmlDoc = it->second.doc;
+      return true;
+    }
+    g_windowXMLCache.erase(it);
+  }
+  lock.Leave();
+
+  if (!xmlDoc.LoadFile(strPath.c_str()))
+    return false;
+
+  lock.Enter();
+  SCachedWindowXML &cached = g_windowXMLCache[strPath];
+  cached.mtime = fileStat.st_mtime;
+  cached.size = fileStat.st_size;
+  cached.doc = xmlDoc;
+  return true;
+}
+
 bool CGUIWindow::Load(TiXmlElement* pRootElement)
 {
   // set the scaling resolution so that any control creation or initialisation can
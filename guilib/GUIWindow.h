@@ -193,6 +193,8 @@ protected:
 
   void LoadControl(TiXmlElement* pControl, CGUIControlGroup *pGroup);
 
+  bool LoadXMLFile(TiXmlDocument &xmlDoc, const CStdString &strPath);
+
 //#ifdef PRE_SKIN_VERSION_2_1_COMPATIBILITY
   bool LoadReferences();
   static CStdString CacheFilename;
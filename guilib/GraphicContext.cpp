@@ -61,6 +61,7 @@ static CSettingInt* g_guiSkinzoom = NULL;
 
 CGraphicContext::CGraphicContext(void)
 {
+  SetName("graphics context");
   m_iScreenWidth = 720;
   m_iScreenHeight = 576;
 #ifndef HAS_SDL
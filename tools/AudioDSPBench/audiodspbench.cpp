@@ -0,0 +1,111 @@
+#include "stdafx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* times each CAudioDSP kernel on a packet sized buffer, once built with its
+   sse2 loops and once with only the plain C ones, and prints the samples per
+   second of both. AudioDSP.cpp is compiled twice into this file, each time in
+   a namespace of its own, the scalar copy with __SSE2__ taken away.
+
+   build: g++ -O2 -msse2 -I. audiodspbench.cpp -o audiodspbench
+   usage: audiodspbench [samples per call] [ms per kernel] */
+
+namespace sse2
+{
+#include "../../xbmc/utils/AudioDSP.cpp"
+}
+
+#undef __AUDIO_DSP__H__
+#pragma push_macro("__SSE2__")
+#undef __SSE2__
+namespace scalar
+{
+#include "../../xbmc/utils/AudioDSP.cpp"
+}
+#pragma pop_macro("__SSE2__")
+
+static int g_samples;
+static double g_seconds;
+
+static double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+struct Buffers
+{
+  short*         int16;
+  unsigned char* int24;
+  int*           int32;
+  float*         floats;
+  short*         out16;
+};
+
+/* calls the kernel on the buffers until the time is up, returns samples/s */
+template <class DSP>
+static double Time(int kernel, Buffers& b)
+{
+  typename DSP::DitherState dither;
+  long calls = 0;
+  double start = now(), elapsed;
+  do
+  {
+    for (int i = 0; i < 64; i++)
+    {
+      switch (kernel)
+      {
+      case 0: DSP::Int16ToFloat(b.floats, b.int16, g_samples); break;
+      case 1: DSP::Int24ToFloat(b.floats, b.int24, g_samples); break;
+      case 2: DSP::Int32ToFloat(b.floats, b.int32, g_samples); break;
+      case 3: DSP::Gain(b.floats, g_samples, 1.0f, true); break;
+      case 4: DSP::FloatToInt16(b.out16, b.floats, g_samples, &dither); break;
+      case 5: DSP::FloatToInt16(b.out16, b.floats, g_samples, NULL); break;
+      }
+    }
+    calls += 64;
+    elapsed = now() - start;
+  } while (elapsed < g_seconds);
+  return (double)calls * g_samples / elapsed;
+}
+
+int main(int argc, char* argv[])
+{
+  g_samples = argc > 1 ? atoi(argv[1]) : 4096;
+  g_seconds = (argc > 2 ? atoi(argv[2]) : 500) / 1000.0;
+
+  Buffers b;
+  b.int16  = new short[g_samples];
+  b.int24  = new unsigned char[g_samples * 3];
+  b.int32  = new int[g_samples];
+  b.floats = new float[g_samples];
+  b.out16  = new short[g_samples];
+  srand(1);
+  for (int i = 0; i < g_samples; i++)
+  {
+    int v = (rand() & 0xffffff) - 0x800000;
+    b.int16[i] = (short)(v >> 8);
+    b.int24[i * 3] = v & 0xff;
+    b.int24[i * 3 + 1] = (v >> 8) & 0xff;
+    b.int24[i * 3 + 2] = (v >> 16) & 0xff;
+    b.int32[i] = v << 8;
+  }
+  sse2::CAudioDSP::Int16ToFloat(b.floats, b.int16, g_samples);
+
+  const char* names[] = { "Int16ToFloat", "Int24ToFloat", "Int32ToFloat", "Gain (clip)",
+                          "FloatToInt16 dither", "FloatToInt16" };
+  printf("%d samples per call\n\n", g_samples);
+  printf("%-20s %14s %14s %8s\n", "kernel", "scalar MS/s", "sse2 MS/s", "speedup");
+  for (int kernel = 0; kernel < 6; kernel++)
+  {
+    double plain = Time<scalar::CAudioDSP>(kernel, b);
+    double simd  = Time<sse2::CAudioDSP>(kernel, b);
+    printf("%-20s %14.0f %14.0f %7.1fx\n", names[kernel], plain / 1e6, simd / 1e6, simd / plain);
+  }
+  return 0;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// all xbmc/utils/AudioDSP.cpp needs to build outside of XBMC, see
+// audiodspbench.cpp
+
+#include <math.h>
+#include <string.h>
@@ -0,0 +1,198 @@
+#include <curl/curl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+/* fetches a batch of thumbnails from a local http server the two ways the
+   download queue has worked: one at a time on a fresh connection each, like
+   the old CHTTP based queue, and on a few workers that keep their curl
+   handle, and so their connection, like the CFile based one, at most a
+   couple at a time per host. the server is built in and answers every
+   request after the given delay, taking as long again to accept a new
+   connection, which is about what a handshake to a far away site costs.
+
+   build: g++ -O2 downloadbench.cpp -lcurl -lpthread -o downloadbench
+   usage: downloadbench [fetches] [workers] [per host] [delay ms] [thumb bytes] */
+
+static int g_delay;
+static int g_thumbSize;
+static int g_port;
+static volatile int g_next;
+static int g_fetches;
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/* keep-alive server, a thread per connection */
+static void* Serve(void* arg)
+{
+  int s = (int)(long)arg;
+  // header and body go out in one send, two would run into delayed acks
+  char* response = (char*)malloc(g_thumbSize + 256);
+  int len = sprintf(response, "HTTP/1.1 200 OK\r\nContent-Type: image/jpeg\r\nContent-Length: %d\r\n\r\n", g_thumbSize);
+  memset(response + len, 'x', g_thumbSize);
+  len += g_thumbSize;
+  char request[4096];
+  int have = 0;
+  usleep(g_delay * 1000);
+  while (true)
+  {
+    int got = recv(s, request + have, sizeof(request) - have - 1, 0);
+    if (got <= 0)
+      break;
+    have += got;
+    request[have] = 0;
+    char* end;
+    while ((end = strstr(request, "\r\n\r\n")) != NULL)
+    {
+      usleep(g_delay * 1000);
+      send(s, response, len, 0);
+      have -= end + 4 - request;
+      memmove(request, end + 4, have + 1);
+    }
+  }
+  close(s);
+  free(response);
+  return NULL;
+}
+
+static void* Listen(void* arg)
+{
+  int l = (int)(long)arg;
+  while (true)
+  {
+    int s = accept(l, NULL, NULL);
+    if (s < 0)
+      break;
+    pthread_t thread;
+    pthread_create(&thread, NULL, Serve, (void*)(long)s);
+    pthread_detach(thread);
+  }
+  return NULL;
+}
+
+static size_t Discard(void* data, size_t size, size_t count, void* user)
+{
+  *(long*)user += size * count;
+  return size * count;
+}
+
+static bool Fetch(CURL* curl, int i, long& bytes)
+{
+  char url[128];
+  sprintf(url, "http://127.0.0.1:%d/thumb%d.jpg", g_port, i);
+  curl_easy_setopt(curl, CURLOPT_URL, url);
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, Discard);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &bytes);
+  return curl_easy_perform(curl) == CURLE_OK;
+}
+
+/* the old queue: one at a time, a new connection every time */
+static void Serial()
+{
+  long bytes = 0;
+  int failed = 0;
+  double start = now();
+  for (int i = 0; i < g_fetches; i++)
+  {
+    CURL* curl = curl_easy_init();
+    if (!Fetch(curl, i, bytes))
+      failed++;
+    curl_easy_cleanup(curl);
+  }
+  double took = now() - start;
+  printf("serial, new connection each  %7.2f s  %7.1f fetches/s  %d failed\n", took, g_fetches / took, failed);
+}
+
+/* the new queue: workers keep their handle, one host so only as many run as
+   the per host limit allows */
+static void* Worker(void* arg)
+{
+  int* failed = (int*)arg;
+  CURL* curl = curl_easy_init();
+  long bytes = 0;
+  while (true)
+  {
+    pthread_mutex_lock(&g_lock);
+    int i = g_next++;
+    pthread_mutex_unlock(&g_lock);
+    if (i >= g_fetches)
+      break;
+    if (!Fetch(curl, i, bytes))
+      (*failed)++;
+  }
+  curl_easy_cleanup(curl);
+  return NULL;
+}
+
+static void Pooled(int workers, int perHost)
+{
+  int running = workers < perHost ? workers : perHost;
+  pthread_t* thread = new pthread_t[running];
+  int* failed = new int[running];
+  g_next = 0;
+  double start = now();
+  for (int i = 0; i < running; i++)
+  {
+    failed[i] = 0;
+    pthread_create(&thread[i], NULL, Worker, &failed[i]);
+  }
+  int totalFailed = 0;
+  for (int i = 0; i < running; i++)
+  {
+    pthread_join(thread[i], NULL);
+    totalFailed += failed[i];
+  }
+  double took = now() - start;
+  printf("%d workers (%d per host), reused %7.2f s  %7.1f fetches/s  %d failed\n", workers, perHost, took, g_fetches / took, totalFailed);
+  delete[] thread;
+  delete[] failed;
+}
+
+int main(int argc, char **argv)
+{
+  g_fetches   = argc > 1 ? atoi(argv[1]) : 1000;
+  int workers = argc > 2 ? atoi(argv[2]) : 4;
+  int perHost = argc > 3 ? atoi(argv[3]) : 2;
+  g_delay     = argc > 4 ? atoi(argv[4]) : 5;
+  g_thumbSize = argc > 5 ? atoi(argv[5]) : 20000;
+
+  if (g_fetches < 1 || workers < 1 || perHost < 1 || g_delay < 0 || g_thumbSize < 1)
+  {
+    printf("usage: %s [fetches] [workers] [per host] [delay ms] [thumb bytes]\n", argv[0]);
+    return -1;
+  }
+
+  int l = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t addrLen = sizeof(addr);
+  if (bind(l, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(l, 64) < 0
+   || getsockname(l, (struct sockaddr*)&addr, &addrLen) < 0)
+  {
+    printf("can't listen on the loopback\n");
+    return -1;
+  }
+  g_port = ntohs(addr.sin_port);
+  pthread_t listener;
+  pthread_create(&listener, NULL, Listen, (void*)(long)l);
+
+  curl_global_init(CURL_GLOBAL_ALL);
+  printf("%d fetches of %d bytes, %d ms per request and per connect\n", g_fetches, g_thumbSize, g_delay);
+  Serial();
+  Pooled(workers, perHost);
+  curl_global_cleanup();
+  return 0;
+}
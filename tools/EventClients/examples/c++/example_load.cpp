@@ -0,0 +1,83 @@
+#include "../../lib/c++/xbmcclient.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+/* puts the event server under load the way a few gyro remotes would:
+   every client moves the mouse and an analog stick as fast as it can,
+   or at the given rate. watch how well the pointer keeps up in XBMC.
+
+   usage: example_load [clients] [seconds] [packets per second per client] */
+
+static double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+int main(int argc, char **argv)
+{
+  int clients = argc > 1 ? atoi(argv[1]) : 4;
+  int seconds = argc > 2 ? atoi(argv[2]) : 10;
+  int rate    = argc > 3 ? atoi(argv[3]) : 0; // 0 => no limit
+
+  if (clients < 1 || seconds < 1 || rate < 0)
+  {
+    printf("usage: %s [clients] [seconds] [packets per second per client]\n", argv[0]);
+    return -1;
+  }
+
+  /* every client gets its own socket and UID, the UID is what the
+     event server tells clients apart by */
+  CXBMCClient **client = new CXBMCClient*[clients];
+  for (int i = 0; i < clients; i++)
+  {
+    char name[64];
+    sprintf(name, "Load Generator %d", i + 1);
+    client[i] = new CXBMCClient("127.0.0.1", 9777, -1, XBMCClientUtils::GetUniqueIdentifier() + i);
+    client[i]->SendHELO(name, ICON_NONE);
+  }
+
+  sleep(1);
+
+  double start = now();
+  long sent = 0;
+  int step = 0;
+  while (now() - start < seconds)
+  {
+    /* walk the pointer around the screen and swing the stick with it,
+       the server should only ever hand XBMC the latest of each */
+    unsigned short pos = (unsigned short)((step * 97) & 0xffff);
+    for (int i = 0; i < clients; i++)
+    {
+      client[i]->SendMOUSE(pos, 65535 - pos);
+      client[i]->SendButton("leftthumbstickright", "XG", BTN_DOWN | BTN_QUEUE | BTN_USE_AMOUNT | BTN_AXIS, pos);
+      sent += 2;
+    }
+    step++;
+
+    if (rate)
+    {
+      double due = start + (double)step * 2 / rate;
+      double wait = due - now();
+      if (wait > 0)
+        usleep((useconds_t)(wait * 1000000));
+    }
+  }
+  double elapsed = now() - start;
+
+  for (int i = 0; i < clients; i++)
+  {
+    client[i]->SendButton("leftthumbstickright", "XG", BTN_UP | BTN_QUEUE | BTN_USE_AMOUNT | BTN_AXIS, 32768);
+    delete client[i];
+  }
+  delete [] client;
+
+  printf("%ld packets from %d clients in %.1fs, %.0f packets/s\n",
+         sent, clients, elapsed, sent / elapsed);
+  return 0;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// what xbmc/DynamicDll.h needs from xbmc/linux/PlatformDefs.h, for the
+// ImageInfo in xbmc/DllImageLib.h
+
+typedef void* HMODULE;
+#define __cdecl
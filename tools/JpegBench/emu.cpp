@@ -0,0 +1,57 @@
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+/* ImageLib does its file io and allocation through the dll_* functions
+   xbmc/cores/DllLoader/exports/emu_msvcrt.cpp exports to the libraries XBMC
+   loads, here they go straight to libc. jpegbench has to be linked with
+   -rdynamic for ImageLib to find them. */
+
+extern "C"
+{
+  void dll_clearerr(FILE* stream) { clearerr(stream); }
+  int dll_close(int fd) { return close(fd); }
+  int dll_fclose(FILE* stream) { return fclose(stream); }
+  FILE* dll_fdopen(int i, const char* mode) { return fdopen(i, mode); }
+  int dll_feof(FILE* stream) { return feof(stream); }
+  int dll_ferror(FILE* stream) { return ferror(stream); }
+  int dll_fflush(FILE* stream) { return fflush(stream); }
+  int dll_fgetc(FILE* stream) { return fgetc(stream); }
+  int dll_fgetpos(FILE* stream, fpos_t* pos) { return fgetpos(stream, pos); }
+  char* dll_fgets(char* pszString, int num, FILE* stream) { return fgets(pszString, num, stream); }
+  int dll_fileno(FILE* stream) { return fileno(stream); }
+  FILE* dll_fopen(const char* filename, const char* mode) { return fopen(filename, mode); }
+  int dll_fputc(int character, FILE* stream) { return fputc(character, stream); }
+  int dll_fputs(const char* szLine, FILE* stream) { return fputs(szLine, stream); }
+  int dll_fread(void* buffer, size_t size, size_t count, FILE* stream) { return fread(buffer, size, count, stream); }
+  FILE* dll_freopen(const char* path, const char* mode, FILE* stream) { return freopen(path, mode, stream); }
+  int dll_fseek(FILE* stream, long offset, int origin) { return fseek(stream, offset, origin); }
+  int dll_fsetpos(FILE* stream, const fpos_t* pos) { return fsetpos(stream, pos); }
+  long dll_ftell(FILE* stream) { return ftell(stream); }
+  size_t dll_fwrite(const void* buffer, size_t size, size_t count, FILE* stream) { return fwrite(buffer, size, count, stream); }
+  int dll_getc(FILE* stream) { return getc(stream); }
+  int dll_ioctl(int fd, unsigned long int request, va_list va) { return ioctl(fd, request, va_arg(va, void*)); }
+  off_t dll_lseek(int fd, off_t lPos, int iWhence) { return lseek(fd, lPos, iWhence); }
+  off64_t dll_lseeki64(int fd, off64_t lPos, int iWhence) { return lseek64(fd, lPos, iWhence); }
+  int dll_open(const char* szFileName, int iMode) { return open(szFileName, iMode, 0644); }
+  int dll_putc(int c, FILE* stream) { return putc(c, stream); }
+  int dll_read(int fd, void* buffer, unsigned int uiSize) { return read(fd, buffer, uiSize); }
+  void dll_rewind(FILE* stream) { rewind(stream); }
+  int dll_ungetc(int c, FILE* stream) { return ungetc(c, stream); }
+  int dll_vfprintf(FILE* stream, const char* format, va_list va)
+  {
+    // XBMC logs what goes to stdout and stderr, that would only get in the
+    // way of the timings here
+    if (stream == stdout || stream == stderr)
+      return 0;
+    return vfprintf(stream, format, va);
+  }
+  int dll_write(int fd, const void* buffer, unsigned int uiSize) { return write(fd, buffer, uiSize); }
+  void* dllmalloc(size_t size) { return malloc(size); }
+  void dllfree(void* pPtr) { free(pPtr); }
+  void* dllcalloc(size_t num, size_t size) { return calloc(num, size); }
+  void* dllrealloc(void* memblock, size_t size) { return realloc(memblock, size); }
+}
@@ -0,0 +1,256 @@
+#include "stdafx.h"
+#include "utils/JpegDecoder.h"
+#include <dirent.h>
+#include <dlfcn.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+extern "C" {
+#include <jpeglib.h>
+}
+
+/* loads jpegs the two ways CPicture::Load can: through ImageLib, which
+   decodes the whole image before resampling it, followed by the swizzle to
+   BGRA that Load does while filling the texture, and through DecodeJpeg,
+   which has libjpeg drop DCT coefficients down to the scale closest to the
+   size asked for. every file is fitted into the thumbnail size and a 1080p
+   slideshow. without a directory, synthetic photos of a few camera sizes are
+   written to /tmp first. last is SwizzleRow against the byte loop it has
+   for the end of a row, over a 1080p frame.
+
+   build: g++ -O2 -rdynamic -I. -I../../xbmc -I../../guilib jpegbench.cpp emu.cpp
+            ../../xbmc/utils/JpegDecoder.cpp -ljpeg -ldl -o jpegbench
+   usage: jpegbench [directory of jpegs] [rounds], from this directory so
+          ../../system/ImageLib is found */
+
+#ifdef __x86_64__
+static const char* IMAGELIB = "../../system/ImageLib-x86_64-linux.so";
+#else
+static const char* IMAGELIB = "../../system/ImageLib-i486-linux.so";
+#endif
+
+static const unsigned int g_sizes[][2] = { { 512, 512 }, { 1920, 1080 } };
+static const unsigned int g_synthetic[][2] = { { 2048, 1536 }, { 3264, 2448 }, { 4288, 2848 } };
+
+typedef bool (*LoadImageFn)(const char*, unsigned int, unsigned int, ImageInfo*);
+typedef bool (*ReleaseImageFn)(ImageInfo*);
+static LoadImageFn g_loadImage;
+static ReleaseImageFn g_releaseImage;
+
+static double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/* smooth gradients with some detail and a little noise, so it compresses
+   roughly like a photo at quality 90 */
+static void WriteSynthetic(const char* path, unsigned int width, unsigned int height)
+{
+  FILE* f = fopen(path, "wb");
+  if (!f)
+    return;
+  struct jpeg_compress_struct cinfo;
+  struct jpeg_error_mgr jerr;
+  cinfo.err = jpeg_std_error(&jerr);
+  jpeg_create_compress(&cinfo);
+  jpeg_stdio_dest(&cinfo, f);
+  cinfo.image_width = width;
+  cinfo.image_height = height;
+  cinfo.input_components = 3;
+  cinfo.in_color_space = JCS_RGB;
+  jpeg_set_defaults(&cinfo);
+  jpeg_set_quality(&cinfo, 90, TRUE);
+  jpeg_start_compress(&cinfo, TRUE);
+  std::vector<JSAMPLE> row(width * 3);
+  srand(1);
+  for (unsigned int y = 0; y < height; y++)
+  {
+    for (unsigned int x = 0; x < width; x++)
+    {
+      int detail = (((x / 37) ^ (y / 23)) & 7) * 6;
+      int noise = rand() % 9 - 4;
+      row[x * 3 + 0] = (JSAMPLE)std::min(255, std::max(0, (int)(x * 200 / width) + detail + noise));
+      row[x * 3 + 1] = (JSAMPLE)std::min(255, std::max(0, (int)(y * 200 / height) + detail + noise));
+      row[x * 3 + 2] = (JSAMPLE)std::min(255, std::max(0, (int)((x + y) * 100 / (width + height)) + 80 + noise));
+    }
+    JSAMPROW rows[1] = { &row[0] };
+    jpeg_write_scanlines(&cinfo, rows, 1);
+  }
+  jpeg_finish_compress(&cinfo);
+  jpeg_destroy_compress(&cinfo);
+  fclose(f);
+}
+
+/* what CPicture::Load does with ImageLib: bottom up BGR with rows aligned
+   to 4 bytes, turned into top down BGRA */
+static bool LoadImageLib(const char* path, unsigned int width, unsigned int height, ImageInfo& info)
+{
+  memset(&info, 0, sizeof(info));
+  if (!g_loadImage(path, width, height, &info))
+    return false;
+  BYTE* pixels = new BYTE[info.width * info.height * 4];
+  unsigned int srcPitch = ((info.width + 1) * 3 / 4) * 4;
+  for (unsigned int y = 0; y < info.height; y++)
+    SwizzleRow(pixels + y * info.width * 4, info.texture + (info.height - 1 - y) * srcPitch, info.width, false);
+  g_releaseImage(&info);
+  delete[] pixels;
+  return true;
+}
+
+/* what CPicture::LoadJpeg does */
+static bool LoadDCT(const char* path, unsigned int width, unsigned int height, ImageInfo& info)
+{
+  FILE* f = fopen(path, "rb");
+  if (!f)
+    return false;
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  BYTE* data = new BYTE[size];
+  size_t read = fread(data, 1, size, f);
+  fclose(f);
+  memset(&info, 0, sizeof(info));
+  BYTE* pixels = DecodeJpeg(data, read, width, height, false, info);
+  delete[] data;
+  delete[] pixels;
+  return pixels != NULL;
+}
+
+static double Time(bool (*load)(const char*, unsigned int, unsigned int, ImageInfo&), const char* path,
+                   unsigned int width, unsigned int height, int rounds, ImageInfo& info)
+{
+  // the first load pulls the file into the page cache
+  if (!load(path, width, height, info))
+    return -1;
+  double started = now();
+  for (int i = 0; i < rounds; i++)
+    load(path, width, height, info);
+  return (now() - started) * 1000 / rounds;
+}
+
+static void TimeSwizzle(int rounds)
+{
+  const unsigned int width = 1920, height = 1080;
+  std::vector<BYTE> src(width * height * 3 + 16), dst(width * height * 4);
+  for (size_t i = 0; i < src.size(); i++)
+    src[i] = (BYTE)(i * 7);
+
+  double started = now();
+  for (int r = 0; r < rounds * 10; r++)
+    for (unsigned int y = 0; y < height; y++)
+      SwizzleRow(&dst[y * width * 4], &src[y * width * 3], width, true);
+  double swizzle = now() - started;
+
+  started = now();
+  for (int r = 0; r < rounds * 10; r++)
+  {
+    for (unsigned int y = 0; y < height; y++)
+    {
+      const BYTE* s = &src[y * width * 3];
+      BYTE* d = &dst[y * width * 4];
+      for (unsigned int x = 0; x < width; x++, s += 3, d += 4)
+      {
+        d[0] = s[2];
+        d[1] = s[1];
+        d[2] = s[0];
+        d[3] = 0xff;
+      }
+    }
+  }
+  double bytes = now() - started;
+
+  double mpix = (double)width * height * rounds * 10 / 1000000;
+  printf("\nswizzle RGB to BGRA: SwizzleRow %.0f MPix/s, byte loop %.0f MPix/s\n", mpix / swizzle, mpix / bytes);
+}
+
+int main(int argc, char* argv[])
+{
+  std::string dir = argc > 1 ? argv[1] : "";
+  int rounds = argc > 2 ? atoi(argv[2]) : 5;
+
+  // lazily, ImageLib refers to a few jbig functions it never calls for jpegs.
+  // it has its own copy of libjpeg's jinit_* functions, which have to win
+  // over those of the libjpeg DecodeJpeg uses, that may well be libjpeg-turbo
+  void* lib = dlopen(IMAGELIB, RTLD_LAZY | RTLD_DEEPBIND);
+  if (!lib)
+  {
+    fprintf(stderr, "%s\n", dlerror());
+    return 1;
+  }
+  g_loadImage = (LoadImageFn)dlsym(lib, "LoadImage");
+  g_releaseImage = (ReleaseImageFn)dlsym(lib, "ReleaseImage");
+
+  std::vector<std::string> files;
+  char temp[] = "/tmp/jpegbenchXXXXXX";
+  if (dir.empty())
+  {
+    dir = mkdtemp(temp);
+    for (unsigned int i = 0; i < sizeof(g_synthetic) / sizeof(g_synthetic[0]); i++)
+    {
+      char path[256];
+      sprintf(path, "%s/synthetic%ux%u.jpg", dir.c_str(), g_synthetic[i][0], g_synthetic[i][1]);
+      WriteSynthetic(path, g_synthetic[i][0], g_synthetic[i][1]);
+      files.push_back(path);
+    }
+  }
+  else
+  {
+    DIR* d = opendir(dir.c_str());
+    if (!d)
+    {
+      perror(dir.c_str());
+      return 1;
+    }
+    while (struct dirent* entry = readdir(d))
+    {
+      std::string name = entry->d_name;
+      std::string ext = name.size() > 4 ? name.substr(name.size() - 4) : "";
+      if (strcasecmp(ext.c_str(), ".jpg") == 0 || strcasecmp(ext.c_str(), "jpeg") == 0)
+        files.push_back(dir + "/" + name);
+    }
+    closedir(d);
+  }
+
+  printf("%-36s %-9s %-10s %11s %11s %8s\n", "file", "fit", "size", "ImageLib", "DCT scaled", "speedup");
+  double total[2] = { 0, 0 };
+  for (size_t f = 0; f < files.size(); f++)
+  {
+    const char* name = strrchr(files[f].c_str(), '/') + 1;
+    for (unsigned int s = 0; s < sizeof(g_sizes) / sizeof(g_sizes[0]); s++)
+    {
+      ImageInfo info;
+      // the DCT scaled load last, it fills in the original size
+      double imagelib = Time(LoadImageLib, files[f].c_str(), g_sizes[s][0], g_sizes[s][1], rounds, info);
+      double dct = Time(LoadDCT, files[f].c_str(), g_sizes[s][0], g_sizes[s][1], rounds, info);
+      char fit[32], size[32];
+      sprintf(fit, "%ux%u", g_sizes[s][0], g_sizes[s][1]);
+      sprintf(size, "%ux%u", info.originalwidth, info.originalheight);
+      if (dct < 0 || imagelib < 0)
+      { // rotated, CMYK or not a jpeg after all, CPicture would take ImageLib
+        printf("%-36.36s %-9s %-10s %11s\n", name, fit, size, "skipped");
+        continue;
+      }
+      printf("%-36.36s %-9s %-10s %8.1f ms %8.1f ms %7.1fx\n", name, fit, size, imagelib, dct, imagelib / dct);
+      total[0] += imagelib;
+      total[1] += dct;
+    }
+  }
+  if (total[1] > 0)
+    printf("%-36s %-9s %-10s %8.1f ms %8.1f ms %7.1fx\n", "total", "", "", total[0], total[1], total[0] / total[1]);
+
+  TimeSwizzle(rounds);
+
+  if (argc <= 1)
+  {
+    for (size_t f = 0; f < files.size(); f++)
+      unlink(files[f].c_str());
+    rmdir(temp);
+  }
+  dlclose(lib);
+  return 0;
+}
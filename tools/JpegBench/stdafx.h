@@ -0,0 +1,28 @@
+#pragma once
+
+// just enough of the xbmc environment for xbmc/utils/JpegDecoder.cpp to build
+// outside of XBMC, see jpegbench.cpp
+
+#ifndef _LINUX
+#define _LINUX
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+typedef uint32_t DWORD;
+typedef unsigned char BYTE;
+
+#define LOGDEBUG   0
+#define LOGINFO    1
+#define LOGNOTICE  2
+#define LOGWARNING 3
+#define LOGERROR   4
+
+class CLog
+{
+public:
+  static void Log(int, const char*, ...) {}
+};
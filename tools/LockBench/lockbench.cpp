@@ -0,0 +1,158 @@
+#include "stdafx.h"
+#include "../../xbmc/utils/SharedSection.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* hammers a CSharedSection the way a busy file item list sees it: many
+   threads reading, one or two writing now and then, and prints how many
+   locks each side got and how long a writer had to wait at worst. the same
+   load is run on a pthread rwlock to compare against.
+
+   build (linux): g++ -O2 -I. lockbench.cpp ../../xbmc/utils/SharedSection.cpp -lpthread -o lockbench
+   usage: lockbench [readers] [writers] [seconds] */
+
+static int  g_seconds;
+static volatile bool g_stop;
+static volatile int  g_value;
+
+static double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/* a few hundred cycles of work under the lock, roughly a list lookup */
+static int work()
+{
+  int sum = 0;
+  for (int i = 0; i < 200; i++)
+    sum += g_value ^ i;
+  return sum;
+}
+
+struct Result
+{
+  long   locks;
+  double worstWait;
+};
+
+class CSharedSectionLock
+{
+public:
+  void ReadLock()    { m_cs.EnterShared(); }
+  void ReadUnlock()  { m_cs.LeaveShared(); }
+  void WriteLock()   { m_cs.EnterExclusive(); }
+  void WriteUnlock() { m_cs.LeaveExclusive(); }
+  CSharedSection m_cs;
+};
+
+class CRWLock
+{
+public:
+  CRWLock()          { pthread_rwlock_init(&m_lock, NULL); }
+  ~CRWLock()         { pthread_rwlock_destroy(&m_lock); }
+  void ReadLock()    { pthread_rwlock_rdlock(&m_lock); }
+  void ReadUnlock()  { pthread_rwlock_unlock(&m_lock); }
+  void WriteLock()   { pthread_rwlock_wrlock(&m_lock); }
+  void WriteUnlock() { pthread_rwlock_unlock(&m_lock); }
+  pthread_rwlock_t m_lock;
+};
+
+template<class L> struct Job
+{
+  L*     lock;
+  Result result;
+};
+
+template<class L> static void* Reader(void* arg)
+{
+  Job<L>* job = (Job<L>*)arg;
+  while (!g_stop)
+  {
+    double start = now();
+    job->lock->ReadLock();
+    work();
+    job->lock->ReadUnlock();
+    double wait = now() - start;
+    if (wait > job->result.worstWait)
+      job->result.worstWait = wait;
+    job->result.locks++;
+  }
+  return NULL;
+}
+
+template<class L> static void* Writer(void* arg)
+{
+  Job<L>* job = (Job<L>*)arg;
+  while (!g_stop)
+  {
+    double start = now();
+    job->lock->WriteLock();
+    g_value++;
+    work();
+    job->lock->WriteUnlock();
+    double wait = now() - start;
+    if (wait > job->result.worstWait)
+      job->result.worstWait = wait;
+    job->result.locks++;
+    usleep(1000); // writers come by now and then, not all the time
+  }
+  return NULL;
+}
+
+template<class L> static void Run(const char* name, int readers, int writers)
+{
+  L lock;
+  int threads = readers + writers;
+  Job<L>*    job    = new Job<L>[threads];
+  pthread_t* thread = new pthread_t[threads];
+
+  g_stop = false;
+  for (int i = 0; i < threads; i++)
+  {
+    job[i].lock = &lock;
+    job[i].result.locks = 0;
+    job[i].result.worstWait = 0;
+    pthread_create(&thread[i], NULL, i < readers ? Reader<L> : Writer<L>, &job[i]);
+  }
+
+  sleep(g_seconds);
+  g_stop = true;
+
+  Result read  = { 0, 0 };
+  Result write = { 0, 0 };
+  for (int i = 0; i < threads; i++)
+  {
+    pthread_join(thread[i], NULL);
+    Result& r = i < readers ? read : write;
+    r.locks += job[i].result.locks;
+    if (job[i].result.worstWait > r.worstWait)
+      r.worstWait = job[i].result.worstWait;
+  }
+
+  printf("%-16s reads %10.0f/s (worst %7.2f ms)   writes %8.0f/s (worst %7.2f ms)\n", name,
+         (double)read.locks / g_seconds, read.worstWait * 1000,
+         (double)write.locks / g_seconds, write.worstWait * 1000);
+
+  delete[] thread;
+  delete[] job;
+}
+
+int main(int argc, char **argv)
+{
+  int readers = argc > 1 ? atoi(argv[1]) : 8;
+  int writers = argc > 2 ? atoi(argv[2]) : 1;
+  g_seconds   = argc > 3 ? atoi(argv[3]) : 5;
+
+  if (readers < 0 || writers < 0 || readers + writers < 1 || g_seconds < 1)
+  {
+    printf("usage: %s [readers] [writers] [seconds]\n", argv[0]);
+    return -1;
+  }
+
+  printf("%d readers, %d writers, %d seconds each\n", readers, writers, g_seconds);
+  Run<CSharedSectionLock>("CSharedSection", readers, writers);
+  Run<CRWLock>("pthread_rwlock", readers, writers);
+  return 0;
+}
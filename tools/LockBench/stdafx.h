@@ -0,0 +1,28 @@
+#pragma once
+
+// just enough of the win32 layer for xbmc/utils/SharedSection.cpp to build
+// outside of XBMC, see lockbench.cpp
+
+#ifndef _LINUX
+#define _LINUX
+#endif
+
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+typedef uint32_t DWORD;
+
+inline DWORD GetTickCount()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (DWORD)(tv.tv_sec * 1000 + tv.tv_usec / 1000);
+}
+
+inline DWORD GetCurrentThreadId()
+{
+  return (DWORD)syscall(SYS_gettid);
+}
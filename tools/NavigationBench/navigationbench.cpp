@@ -0,0 +1,195 @@
+#include "stdafx.h"
+#include "FileItem.h"
+#include "VideoInfoTag.h"
+#include "FileSystem/DirectoryCache.h"
+#include <stdio.h>
+#include <sys/time.h>
+
+using namespace DIRECTORY;
+
+/* goes back and forth between two library listings of movies the way a media
+   window does, through the directory cache and CFileItemList, and times each
+   step: the cache hands the listing out (CDirectory::GetDirectory), it is
+   passed on to the window (CGUIMediaWindow::GetDirectory and Update), the
+   window changes every item (labels, icons, sort) and the video nav filter
+   reads the watched state of every item. after that all items are queued
+   for playing, which copies them. the filter pass is timed reading the tags
+   through the non-const accessors, as it did, and the const ones: a tag
+   handed out by a non-const accessor is copied along with its item.
+
+   build: from xbmc/ of a configured tree
+          g++ -O2 -D_LINUX -I. -I../guilib -Ilinux -Iutils -IFileSystem -Icores -Iosx
+            ../tools/NavigationBench/navigationbench.cpp ../tools/NavigationBench/stubs.cpp
+            FileItem.cpp SortFileItem.cpp VideoInfoTag.cpp MusicInfoTag.cpp PictureInfoTag.cpp
+            FileSystem/DirectoryCache.cpp DateTime.cpp StringUtils.cpp DynamicDll.cpp
+            ../guilib/GUIListItem.cpp ../guilib/tinyXML/*.cpp utils/SharedSection.cpp
+            utils/CriticalSection.cpp utils/SingleLock.cpp utils/LockProfiler.cpp
+            linux/XCriticalSection.cpp utils/Metrics.cpp utils/ScraperUrl.cpp utils/Fanart.cpp
+            -no-pie -Wl,--unresolved-symbols=ignore-all -lpthread -o navigationbench
+          FileItem.cpp pulls in most of xbmc, stubs.cpp has the little the
+          steps timed here call into
+   usage: navigationbench [items] [rounds] */
+
+static double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/* a movie as the video database hands it out, with a plot and a cast */
+static CFileItemPtr MakeMovie(int id)
+{
+  CVideoInfoTag tag;
+  tag.m_strTitle.Format("Movie %05d", (id * 7919) % 100000);
+  tag.m_strPlot = "A plot of a few hundred characters, the way the scrapers leave it. "
+                  "It goes on about the characters and what happens to them, and then "
+                  "some more about where and when, so that it fills a few lines of the "
+                  "info panel and makes the tag about as big as a real one is.";
+  tag.m_strPlotOutline = "What happens, in short.";
+  tag.m_strGenre = "Drama / Comedy";
+  tag.m_strDirector = "Some Director";
+  tag.m_strStudio = "Some Studio";
+  tag.m_strFileNameAndPath.Format("/media/movies/Movie %05d/movie.mkv", id);
+  tag.m_iYear = 1950 + id % 60;
+  tag.m_fRating = (id % 100) / 10.0f;
+  tag.m_playCount = id % 3 == 0 ? 1 : 0;
+  tag.m_iDbId = id;
+  for (int i = 0; i < 10; i++)
+  {
+    SActorInfo actor;
+    actor.strName.Format("Actor %d", (id + i) % 5000);
+    actor.strRole.Format("Role %d", i);
+    tag.m_cast.push_back(actor);
+  }
+  CFileItem item(tag.m_strTitle);
+  *item.GetVideoInfoTag() = tag;
+  item.m_strPath.Format("videodb://1/2/%d", id);
+  item.SetIconImage("defaultVideo.png");
+  item.SetProperty("fanart_image", "special://profile/Thumbnails/Video/Fanart/x.tbn");
+  // the copy holds the tag read only, as CFileItem(const CVideoInfoTag&)
+  // leaves it, without looking for thumbs on the way
+  return CFileItemPtr(new CFileItem(item));
+}
+
+struct STimes
+{
+  double cache, window, change, filter, queue;
+  STimes() : cache(0), window(0), change(0), filter(0), queue(0) {}
+};
+
+/* one visit of strPath, from the cache as on the way back */
+static void Visit(const CStdString &strPath, CFileItemList &windowItems, CFileItemList &unfilteredItems,
+                  bool constTags, STimes &times)
+{
+  double start = now();
+  CFileItemList newItems;
+  double cached;
+  {
+    // CGUIMediaWindow::GetDirectory has CDirectory::GetDirectory fill a list of
+    // its own. the filter for allowed files only reads
+    CFileItemList items;
+    g_directoryCache.GetDirectory(strPath, items);
+    const CFileItemList &constItems = items;
+    for (int i = 0; i < items.Size(); ++i)
+    {
+      if (constItems[i]->GetPropertyBOOL("file:hidden"))
+        items.Remove(i--);
+    }
+    cached = now();
+    newItems.Assign(items, false);
+  }
+  // CGUIMediaWindow::Update
+  windowItems.Clear();
+  unfilteredItems.Clear();
+  windowItems.Assign(newItems);
+  newItems.ClearItems();
+  double assigned = now();
+
+  // labels, icons and the sort change every item
+  for (int i = 0; i < windowItems.Size(); i++)
+  {
+    CFileItemPtr item = windowItems[i];
+    CStdString label2;
+    label2.Format("%d", i);
+    item->SetLabel2(label2);
+  }
+  windowItems.Sort(SORT_METHOD_LABEL, SORT_ORDER_ASC);
+  double changed = now();
+
+  // CGUIWindowVideoNav::OnFinalizeFileItems keeps the unfiltered items, and
+  // FilterItems puts back the unwatched ones, reading every tag
+  unfilteredItems.Append(windowItems);
+  windowItems.ClearItems();
+  windowItems.SetFastLookup(true);
+  for (int i = 0; i < unfilteredItems.Size(); i++)
+  {
+    CFileItemPtr item = unfilteredItems.Get(i);
+    bool watched;
+    if (constTags)
+    {
+      const CVideoInfoTag *tag = ((const CFileItem *)item.get())->GetVideoInfoTag();
+      watched = tag && tag->m_playCount > 0;
+    }
+    else
+      watched = item->GetVideoInfoTag()->m_playCount > 0;
+    if (!watched && !windowItems.Contains(item->m_strPath))
+      windowItems.Add(item);
+  }
+  windowItems.SetFastLookup(false);
+  double filtered = now();
+
+  // queueing everything copies each item into the playlist
+  {
+    std::vector<CFileItemPtr> playlist;
+    playlist.reserve(windowItems.Size());
+    const CFileItemList &constWindow = windowItems;
+    for (int i = 0; i < constWindow.Size(); i++)
+      playlist.push_back(CFileItemPtr(new CFileItem(*constWindow[i])));
+  }
+  double queued = now();
+
+  times.cache += cached - start;
+  times.window += assigned - cached;
+  times.change += changed - assigned;
+  times.filter += filtered - changed;
+  times.queue += queued - filtered;
+}
+
+static void Run(const char *name, int items, int rounds, bool constTags)
+{
+  // the two listings, as the video database fills them in once
+  const char *paths[2] = { "videodb://1/2/", "videodb://1/3/" };
+  for (int p = 0; p < 2; p++)
+  {
+    CFileItemList listing;
+    for (int i = 0; i < items; i++)
+      listing.Add(MakeMovie(p * items + i));
+    g_directoryCache.SetDirectory(paths[p], listing, DIR_CACHE_ALWAYS);
+  }
+
+  CFileItemList windowItems, unfilteredItems;
+  STimes times;
+  double start = now();
+  for (int r = 0; r < rounds; r++)
+    Visit(paths[r % 2], windowItems, unfilteredItems, constTags, times);
+  double total = (now() - start) * 1000 / rounds;
+
+  printf("%-10s %8.2f %8.2f %8.2f %8.2f %8.2f %9.2f ms\n", name,
+         times.cache * 1000 / rounds, times.window * 1000 / rounds, times.change * 1000 / rounds,
+         times.filter * 1000 / rounds, times.queue * 1000 / rounds, total);
+
+  g_directoryCache.Clear();
+}
+
+int main(int argc, char *argv[])
+{
+  int items = argc > 1 ? atoi(argv[1]) : 10000;
+  int rounds = argc > 2 ? atoi(argv[2]) : 20;
+
+  printf("%d movies per listing, %d visits, ms per visit\n\n", items, rounds);
+  printf("%-10s %8s %8s %8s %8s %8s %12s\n", "tags", "cache", "window", "change", "filter", "queue", "total");
+  Run("non-const", items, rounds, false);
+  Run("const", items, rounds, true);
+  return 0;
+}
@@ -0,0 +1,181 @@
+#include "stdafx.h"
+#include "../../xbmc/cores/IAudioResampler.h"
+#include <stdio.h>
+#include <sys/time.h>
+#include <vector>
+
+/* runs the sample rate converters paplayer can pick through
+   <audio><resamplequality> over the rate pairs music usually needs, driving
+   them the way PAPlayer::ProcessPAP does. for each it prints how much of a
+   core two stereo streams take, as during a crossfade, and the THD+N of a
+   997Hz tone: the least squares fit of the tone is taken off the output and
+   what remains is compared to it. THD+N is measured on 24 bit output, so
+   the 16 bit dither doesn't hide the converter.
+
+   build: g++ -O2 -msse2 -I. -I../../xbmc resamplebench.cpp ../../xbmc/cores/PolyphaseResampler.cpp
+            ../../xbmc/cores/ssrc.cpp ../../xbmc/utils/AudioDSP.cpp -lpthread -o resamplebench
+   usage: resamplebench [seconds] */
+
+static const int CHANNELS = 2;
+static const int PACKET_SIZE = 3840 * 4; // same as paplayer
+static const double TONE = 997.0;
+
+static const char* g_names[] = { "ssrc", "poly 16", "poly 32", "poly 64" };
+
+static double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void MakeTone(std::vector<float>& input, int rate, int seconds)
+{
+  int frames = rate * seconds;
+  input.resize(frames * CHANNELS);
+  for (int i = 0; i < frames; i++)
+  {
+    float sample = (float)(0.5 * sin(2 * M_PI * TONE * i / rate));
+    for (int c = 0; c < CHANNELS; c++)
+      input[i * CHANNELS + c] = sample;
+  }
+}
+
+/* feeds all of input through, the output of the first channel goes to
+   output when it's given, as floats */
+static void Convert(IAudioResampler* resampler, const std::vector<float>& input, int bits, std::vector<float>* output)
+{
+  std::vector<unsigned char> packet(PACKET_SIZE);
+  size_t pos = 0;
+  while (true)
+  {
+    if (resampler->GetData(&packet[0]))
+    {
+      if (output)
+      {
+        int frames = PACKET_SIZE / (bits / 8) / CHANNELS;
+        for (int i = 0; i < frames; i++)
+        {
+          if (bits == 16)
+            output->push_back(((short*)&packet[0])[i * CHANNELS] / 32768.0f);
+          else if (bits == 24)
+          { // packed, little endian
+            const unsigned char* p = &packet[i * CHANNELS * 3];
+            int sample = (int)((p[2] << 24) | (p[1] << 16) | (p[0] << 8)) >> 8;
+            output->push_back(sample / 8388608.0f);
+          }
+          else
+            output->push_back(((int*)&packet[0])[i * CHANNELS] / 8388608.0f);
+        }
+      }
+      continue;
+    }
+    int amount = resampler->GetInputSamples();
+    if (amount <= 0 || pos + amount > input.size())
+      break;
+    resampler->PutFloatData((float*)&input[pos], amount);
+    pos += amount;
+  }
+}
+
+/* residual after taking off the best fitting a*sin + b*cos + dc, in dB
+   relative to the tone */
+static double THDN(const std::vector<float>& y, int rate)
+{
+  // skip the start up of the filters and the end
+  size_t start = rate / 2;
+  size_t end = y.size() - rate / 10;
+  if (end <= start)
+    return 0;
+
+  double m[3][3] = { { 0 } }, v[3] = { 0 };
+  for (size_t i = start; i < end; i++)
+  {
+    double w = 2 * M_PI * TONE * i / rate;
+    double basis[3] = { sin(w), cos(w), 1.0 };
+    for (int r = 0; r < 3; r++)
+    {
+      for (int c = 0; c < 3; c++)
+        m[r][c] += basis[r] * basis[c];
+      v[r] += basis[r] * y[i];
+    }
+  }
+
+  // gaussian elimination, the matrix is well conditioned
+  for (int p = 0; p < 3; p++)
+  {
+    for (int r = p + 1; r < 3; r++)
+    {
+      double f = m[r][p] / m[p][p];
+      for (int c = p; c < 3; c++)
+        m[r][c] -= f * m[p][c];
+      v[r] -= f * v[p];
+    }
+  }
+  double x[3];
+  for (int r = 2; r >= 0; r--)
+  {
+    x[r] = v[r];
+    for (int c = r + 1; c < 3; c++)
+      x[r] -= m[r][c] * x[c];
+    x[r] /= m[r][r];
+  }
+
+  double signal = 0, noise = 0;
+  for (size_t i = start; i < end; i++)
+  {
+    double w = 2 * M_PI * TONE * i / rate;
+    double fit = x[0] * sin(w) + x[1] * cos(w) + x[2];
+    signal += fit * fit;
+    noise += (y[i] - fit) * (y[i] - fit);
+  }
+  return 10 * log10(noise / signal);
+}
+
+int main(int argc, char* argv[])
+{
+  int seconds = argc > 1 ? atoi(argv[1]) : 30;
+  const int pairs[][2] = { { 44100, 48000 }, { 48000, 44100 }, { 44100, 96000 }, { 96000, 48000 } };
+
+  printf("%d s of stereo per stream, %d byte packets\n\n", seconds, PACKET_SIZE);
+  printf("%-13s %-8s %12s %14s\n", "rates", "quality", "2 streams", "THD+N (24bit)");
+  for (unsigned int p = 0; p < sizeof(pairs) / sizeof(pairs[0]); p++)
+  {
+    int from = pairs[p][0], to = pairs[p][1];
+    std::vector<float> input;
+    MakeTone(input, from, seconds);
+
+    for (int quality = RESAMPLE_QUALITY_SSRC; quality <= RESAMPLE_QUALITY_HIGH; quality++)
+    {
+      // two streams taking turns packet by packet would cost the same as
+      // one after the other, so time them back to back
+      IAudioResampler* streams[2];
+      for (int s = 0; s < 2; s++)
+      {
+        streams[s] = CAudioResamplerFactory::Create(quality);
+        streams[s]->InitConverter(from, 16, CHANNELS, to, 16, PACKET_SIZE);
+      }
+      double started = now();
+      for (int s = 0; s < 2; s++)
+        Convert(streams[s], input, 16, NULL);
+      double elapsed = now() - started;
+      for (int s = 0; s < 2; s++)
+        delete streams[s];
+
+      // ssrc gives packed 24 bit, the polyphase one unpacked
+      int bits = quality == RESAMPLE_QUALITY_SSRC ? 24 : 32;
+      IAudioResampler* resampler = CAudioResamplerFactory::Create(quality);
+      resampler->InitConverter(from, 16, CHANNELS, to, bits, PACKET_SIZE);
+      std::vector<float> output;
+      Convert(resampler, input, bits, &output);
+      delete resampler;
+
+      char rates[32];
+      sprintf(rates, "%d>%d", from, to);
+      printf("%-13s %-8s %10.2f%% %11.1f dB\n", rates, g_names[quality],
+             100.0 * elapsed / seconds, THDN(output, to));
+    }
+    printf("\n");
+  }
+  return 0;
+}
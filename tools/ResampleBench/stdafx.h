@@ -0,0 +1,30 @@
+#pragma once
+
+// just enough of the xbmc environment for xbmc/cores/PolyphaseResampler.cpp,
+// xbmc/cores/ssrc.cpp and xbmc/utils/AudioDSP.cpp to build outside of XBMC,
+// see resamplebench.cpp
+
+#ifndef _LINUX
+#define _LINUX
+#endif
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint32_t DWORD;
+
+#define ZeroMemory(p, n) memset((p), 0, (n))
+
+#define LOGDEBUG   0
+#define LOGINFO    1
+#define LOGNOTICE  2
+#define LOGWARNING 3
+#define LOGERROR   4
+
+class CLog
+{
+public:
+  static void Log(int, const char*, ...) {}
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+// stands in for xbmc/utils/CriticalSection.h, see ../stdafx.h
+
+#include <pthread.h>
+
+class CCriticalSection
+{
+public:
+  CCriticalSection() { pthread_mutex_init(&m_mutex, NULL); }
+  ~CCriticalSection() { pthread_mutex_destroy(&m_mutex); }
+
+  pthread_mutex_t m_mutex;
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+// stands in for xbmc/utils/SingleLock.h, see ../stdafx.h
+
+#include "CriticalSection.h"
+
+class CSingleLock
+{
+public:
+  CSingleLock(CCriticalSection& cs) : m_cs(cs) { pthread_mutex_lock(&m_cs.m_mutex); }
+  ~CSingleLock() { pthread_mutex_unlock(&m_cs.m_mutex); }
+
+private:
+  CCriticalSection& m_cs;
+};
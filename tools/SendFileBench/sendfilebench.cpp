@@ -0,0 +1,215 @@
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+/* streams a local file to a number of clients at once over loopback, the two
+   ways the upnp media server can: read into a 4k buffer and written to the
+   socket, like the stream copy through the neptune file layer, and handed to
+   sendfile(2) a megabyte at a time with read ahead hints, like the fast path
+   in NPT_BsdSocket::SendFile. each client reads the whole file and throws it
+   away. the cpu time is what the server threads used, the clients' isn't
+   counted.
+
+   build: g++ -O2 sendfilebench.cpp -lpthread -o sendfilebench
+   usage: sendfilebench [clients] [file MB] [rounds] [file] */
+
+static const int COPY_CHUNK = 4096;
+static const size_t SENDFILE_CHUNK = 1024 * 1024;
+
+static const char* g_path;
+static off_t g_size;
+static bool g_sendfile;
+static int g_port;
+static int g_listen;
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static double g_serverCpu;
+
+static double now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static double threadCpu()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+static void SendCopy(int s, int fd)
+{
+  char buffer[COPY_CHUNK];
+  while (true)
+  {
+    ssize_t got = read(fd, buffer, sizeof(buffer));
+    if (got <= 0)
+      break;
+    for (ssize_t sent = 0; sent < got; )
+    {
+      ssize_t n = send(s, buffer + sent, got - sent, MSG_NOSIGNAL);
+      if (n <= 0)
+        return;
+      sent += n;
+    }
+  }
+}
+
+static void SendFile(int s, int fd)
+{
+  off_t position = 0;
+  off_t size = g_size;
+  posix_fadvise(fd, 0, size, POSIX_FADV_SEQUENTIAL);
+  posix_fadvise(fd, 0, SENDFILE_CHUNK, POSIX_FADV_WILLNEED);
+  while (size)
+  {
+    size_t chunk = size > (off_t)SENDFILE_CHUNK ? SENDFILE_CHUNK : (size_t)size;
+    ssize_t n = sendfile(s, fd, &position, chunk);
+    if (n <= 0)
+      break;
+    size -= n;
+    posix_fadvise(fd, position, SENDFILE_CHUNK, POSIX_FADV_WILLNEED);
+  }
+}
+
+static void* Serve(void* arg)
+{
+  int s = (int)(long)arg;
+  double start = threadCpu();
+  int fd = open(g_path, O_RDONLY);
+  if (fd >= 0)
+  {
+    if (g_sendfile)
+      SendFile(s, fd);
+    else
+      SendCopy(s, fd);
+    close(fd);
+  }
+  double used = threadCpu() - start;
+  pthread_mutex_lock(&g_lock);
+  g_serverCpu += used;
+  pthread_mutex_unlock(&g_lock);
+  close(s);
+  return NULL;
+}
+
+static void* Accept(void* arg)
+{
+  int clients = (int)(long)arg;
+  pthread_t* threads = new pthread_t[clients];
+  for (int i = 0; i < clients; i++)
+  {
+    int s = accept(g_listen, NULL, NULL);
+    pthread_create(&threads[i], NULL, Serve, (void*)(long)s);
+  }
+  for (int i = 0; i < clients; i++)
+    pthread_join(threads[i], NULL);
+  delete[] threads;
+  return NULL;
+}
+
+static void* Client(void*)
+{
+  int s = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(g_port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(s, (struct sockaddr*)&addr, sizeof(addr)) == 0)
+  {
+    static char sink[256 * 1024];
+    while (recv(s, sink, sizeof(sink), 0) > 0)
+      ;
+  }
+  close(s);
+  return NULL;
+}
+
+static void Run(const char* name, bool sendfile, int clients, int rounds)
+{
+  g_sendfile = sendfile;
+  g_serverCpu = 0;
+  double start = now();
+  for (int round = 0; round < rounds; round++)
+  {
+    pthread_t acceptor;
+    pthread_create(&acceptor, NULL, Accept, (void*)(long)clients);
+    pthread_t* threads = new pthread_t[clients];
+    for (int i = 0; i < clients; i++)
+      pthread_create(&threads[i], NULL, Client, NULL);
+    for (int i = 0; i < clients; i++)
+      pthread_join(threads[i], NULL);
+    pthread_join(acceptor, NULL);
+    delete[] threads;
+  }
+  double elapsed = now() - start;
+  double mb = (double)g_size * clients * rounds / (1024 * 1024);
+  printf("%-9s %8.0f MB/s  server cpu %6.2f s  (%.2f ms per MB)\n",
+         name, mb / elapsed, g_serverCpu, g_serverCpu * 1000 / mb);
+}
+
+int main(int argc, char* argv[])
+{
+  int clients = argc > 1 ? atoi(argv[1]) : 4;
+  int sizeMB  = argc > 2 ? atoi(argv[2]) : 256;
+  int rounds  = argc > 3 ? atoi(argv[3]) : 3;
+  char temp[] = "/tmp/sendfilebenchXXXXXX";
+  if (argc > 4)
+  {
+    g_path = argv[4];
+    struct stat st;
+    if (stat(g_path, &st) != 0)
+    {
+      perror(g_path);
+      return 1;
+    }
+    g_size = st.st_size;
+  }
+  else
+  {
+    int fd = mkstemp(temp);
+    static char block[1024 * 1024];
+    memset(block, 'x', sizeof(block));
+    for (int i = 0; i < sizeMB; i++)
+      write(fd, block, sizeof(block));
+    close(fd);
+    g_path = temp;
+    g_size = (off_t)sizeMB * 1024 * 1024;
+  }
+
+  g_listen = socket(AF_INET, SOCK_STREAM, 0);
+  int option = 1;
+  setsockopt(g_listen, SOL_SOCKET, SO_REUSEADDR, &option, sizeof(option));
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  bind(g_listen, (struct sockaddr*)&addr, sizeof(addr));
+  listen(g_listen, clients);
+  socklen_t len = sizeof(addr);
+  getsockname(g_listen, (struct sockaddr*)&addr, &len);
+  g_port = ntohs(addr.sin_port);
+
+  printf("%d clients, %.0f MB file, %d rounds\n", clients, (double)g_size / (1024 * 1024), rounds);
+  // the first pass pulls the file into the page cache for both
+  Run("warmup", false, 1, 1);
+  Run("copy 4k", false, clients, rounds);
+  Run("sendfile", true, clients, rounds);
+
+  close(g_listen);
+  if (argc <= 4)
+    unlink(temp);
+  return 0;
+}
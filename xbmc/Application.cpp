@@ -78,6 +78,7 @@
 #include "FileSystem/CMythSession.h"
 #include "utils/TuxBoxUtil.h"
 #include "utils/SystemInfo.h"
+#include "utils/LockProfiler.h"
 #include "ApplicationRenderer.h"
 #include "GUILargeTextureManager.h"
 #include "LastFmManager.h"
@@ -4164,6 +4165,7 @@ HRESULT CApplication::Cleanup()
     CLog::Log(LOGNOTICE, "performance statistics");
     m_perfStats.DumpStats();
 #endif
+    CLockProfiler::DumpToLog(50);
 
   // reset our d3d params before we destroy
 #ifndef HAS_SDL
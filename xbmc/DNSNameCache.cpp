@@ -23,18 +23,38 @@
 #include "DNSNameCache.h"
 #include "Settings.h"
 #include "GUISettings.h"
+#ifdef _LINUX
+#include <netdb.h>
+#endif
 
-CDNSNameCache g_DNSCache;
+#define DNS_MAX_RESOLVERS     8
+#define DNS_TTL               600000  // ms a resolved name is kept
+#define DNS_NEGATIVE_TTL       30000  // ms a name that failed is kept
+#define DNS_REFRESH_WINDOW     60000  // names used this close to expiry are resolved again
 
-CCriticalSection CDNSNameCache::m_critical;
+using namespace std;
+
+CDNSNameCache g_DNSCache;
 
 CDNSNameCache::CDNSNameCache(void)
-{}
+{
+  m_bStop = false;
+  m_idle = 0;
+}
 
 CDNSNameCache::~CDNSNameCache(void)
-{}
+{
+  m_bStop = true;
+  for (unsigned int i = 0; i < m_resolvers.size(); i++)
+  {
+    m_queueEvent.Set();
+    m_resolvers[i]->StopThread();
+    delete m_resolvers[i];
+  }
+  m_resolvers.clear();
+}
 
-bool CDNSNameCache::Lookup(const CStdString& strHostName, CStdString& strIpAdres)
+bool CDNSNameCache::Lookup(const CStdString& strHostName, CStdString& strIpAdres, DWORD timeout)
 {
   // first see if this is already an ip address
   unsigned long ulHostIp = inet_addr( strHostName.c_str() );
@@ -46,18 +66,141 @@ bool CDNSNameCache::Lookup(const CStdString& strHostName, CStdString& strIpAdres
     return true;
   }
 
-  // nop this is a hostname
-  // check if we already cached the hostname <-> ip address
-  if(g_DNSCache.GetCached(strHostName, strIpAdres))
+  // nop this is a hostname, resolved by the cache
+  return g_DNSCache.GetCached(strHostName, strIpAdres, timeout);
+}
+
+bool CDNSNameCache::GetCached(const CStdString& strHostName, CStdString& strIpAdres, DWORD timeout)
+{
+  CStdString strName(strHostName);
+  strName.ToLower();
+
+  DWORD start = timeGetTime();
+  CSingleLock lock(m_critical);
+  while (!m_bStop)
   {
-    // it was already cached
-    return true;
+    CDNSName& name = m_names[strName];
+    DWORD age = timeGetTime() - name.m_resolved;
+    if (name.m_bValid && (name.m_bPermanent || age < name.m_ttl))
+    {
+      // still good, a name that is asked for near the end of its time is
+      // refreshed so that it doesn't expire while in use
+      if (!name.m_bPermanent && !name.m_bPending && !name.m_strIpAdres.IsEmpty() &&
+          age + DNS_REFRESH_WINDOW >= name.m_ttl)
+        Queue(strName, name);
+      strIpAdres = name.m_strIpAdres;
+      return !strIpAdres.IsEmpty();
+    }
+
+    // unknown or expired, join the lookup for it or start one
+    if (!name.m_bPending)
+      Queue(strName, name);
+
+    DWORD waited = timeGetTime() - start;
+    if (waited >= timeout)
+    {
+      CLog::Log(LOGDEBUG, "%s - %s not resolved after %u ms, not waiting any longer", __FUNCTION__, strHostName.c_str(), (unsigned int)waited);
+      return false;
+    }
+
+    lock.Leave();
+    m_resolvedEvent.WaitMSec(min(timeout - waited, (DWORD)100));
+    lock.Enter();
   }
+  return false;
+}
 
-  // hostname not found in cache.
-  // do a DNS lookup
-#ifndef _XBOX
+void CDNSNameCache::Queue(const CStdString& strHostName, CDNSName& name)
+{
+  // with m_critical held
+  name.m_bPending = true;
+  m_queue.push_back(strHostName);
+  if (m_queue.size() > m_idle && m_resolvers.size() < DNS_MAX_RESOLVERS)
+  { // everyone's busy, likely with a slow server, don't make this one wait
+    CThread *resolver = new CThread(this);
+    resolver->Create();
+    resolver->SetName("DNSResolver");
+    m_resolvers.push_back(resolver);
+  }
+  m_queueEvent.Set();
+}
+
+void CDNSNameCache::Run()
+{
+  while (!m_bStop)
   {
+    CStdString strHostName;
+    {
+      CSingleLock lock(m_critical);
+      if (!m_queue.empty())
+      {
+        strHostName = m_queue.front();
+        m_queue.pop_front();
+        // the event only wakes one of us, pass it on if there's more
+        if (!m_queue.empty())
+          m_queueEvent.Set();
+      }
+      else
+        m_idle++;
+    }
+    if (strHostName.IsEmpty())
+    {
+      m_queueEvent.WaitMSec(1000);
+      CSingleLock lock(m_critical);
+      m_idle--;
+      continue;
+    }
+
+    CStdString strIpAdres;
+    bool bResolved = Resolve(strHostName, strIpAdres);
+
+    CSingleLock lock(m_critical);
+    CDNSName& name = m_names[strHostName];
+    name.m_bPending = false;
+    if (!name.m_bPermanent)
+    {
+      // a failed refresh leaves the old address until it expires
+      DWORD age = timeGetTime() - name.m_resolved;
+      if (bResolved || !name.m_bValid || age >= name.m_ttl)
+      {
+        name.m_strIpAdres = bResolved ? strIpAdres : "";
+        name.m_ttl = bResolved ? DNS_TTL : DNS_NEGATIVE_TTL;
+        name.m_resolved = timeGetTime();
+        name.m_bValid = true;
+      }
+    }
+    m_resolvedEvent.Set();
+  }
+}
+
+bool CDNSNameCache::Resolve(const CStdString& strHostName, CStdString& strIpAdres)
+{
+#ifdef _LINUX
+  // the resolvers run side by side and gethostbyname() hands back a static
+  // buffer here, getaddrinfo() doesn't
+  struct addrinfo hints;
+  struct addrinfo *result = NULL;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+
+  int err = getaddrinfo(strHostName.c_str(), NULL, &hints, &result);
+  if (err != 0 || result == NULL)
+  {
+    CLog::Log(LOGERROR, "Unable to find host: %s (%s)", strHostName.c_str(), gai_strerror(err));
+    if (result)
+      freeaddrinfo(result);
+    return false;
+  }
+
+  const unsigned char *ip = (const unsigned char *)&((struct sockaddr_in *)result->ai_addr)->sin_addr.s_addr;
+  strIpAdres.Format("%d.%d.%d.%d", ip[0], ip[1], ip[2], ip[3]);
+  CLog::Log(LOGDEBUG, "host name = %s, address = %s", strHostName.c_str(), strIpAdres.c_str());
+  freeaddrinfo(result);
+  return true;
+#elif !defined(_XBOX)
+  {
+    // winsock keeps the result of gethostbyname() per thread
     SOCKET sd;          /* Socket descriptor */
     struct sockaddr_in socket_address;
     struct hostent *host;
@@ -127,7 +270,6 @@ bool CDNSNameCache::Lookup(const CStdString& strHostName, CStdString& strIpAdres
     if (host->h_addr_list[0])
     {
       strIpAdres.Format("%d.%d.%d.%d", (unsigned char)host->h_addr_list[0][0], (unsigned char)host->h_addr_list[0][1], (unsigned char)host->h_addr_list[0][2], (unsigned char)host->h_addr_list[0][3]);
-      g_DNSCache.Add(strHostName, strIpAdres);
     }
 
     closesocket(sd);
@@ -158,8 +300,6 @@ bool CDNSNameCache::Lookup(const CStdString& strHostName, CStdString& strIpAdres
 
     strIpAdres.Format("%d.%d.%d.%d", (ulHostIp & 0xFF), (ulHostIp & 0xFF00) >> 8, (ulHostIp & 0xFF0000) >> 16, (ulHostIp & 0xFF000000) >> 24 );
 
-    g_DNSCache.Add(fqdn, strIpAdres);
-
     XNetDnsRelease(pDns);
     WSACloseEvent(hEvent);
     return true;
@@ -176,33 +316,14 @@ bool CDNSNameCache::Lookup(const CStdString& strHostName, CStdString& strIpAdres
   return false;
 }
 
-bool CDNSNameCache::GetCached(const CStdString& strHostName, CStdString& strIpAdres)
-{
-  CSingleLock lock(m_critical);
-
-  // loop through all DNSname entries and see if strHostName is cached
-  for (int i = 0; i < (int)g_DNSCache.m_vecDNSNames.size(); ++i)
-  {
-    CDNSName& DNSname = g_DNSCache.m_vecDNSNames[i];
-    if ( DNSname.m_strHostName == strHostName )
-    {
-      strIpAdres = DNSname.m_strIpAdres;
-      return true;
-    }
-  }
-
-  // not cached
-  return false;
-}
-
 void CDNSNameCache::Add(const CStdString &strHostName, const CStdString &strIpAddress)
 {
-  CDNSName dnsName;
-
-  dnsName.m_strHostName = strHostName;
-  dnsName.m_strIpAdres  = strIpAddress;
-
-  CSingleLock lock(m_critical);
-  g_DNSCache.m_vecDNSNames.push_back(dnsName);
+  CStdString strName(strHostName);
+  strName.ToLower();
+
+  CSingleLock lock(g_DNSCache.m_critical);
+  CDNSName& name = g_DNSCache.m_names[strName];
+  name.m_strIpAdres = strIpAddress;
+  name.m_bValid = true;
+  name.m_bPermanent = true;
 }
-
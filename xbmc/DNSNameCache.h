@@ -22,26 +22,56 @@
  */
 
 #include "StdString.h"
+#include "utils/Thread.h"
+#include "utils/CriticalSection.h"
+#include "utils/Event.h"
 
+#include <map>
+#include <deque>
 #include <vector>
 
-class CDNSNameCache
+#define DNS_LOOKUP_TIMEOUT 10000  // ms a caller waits for a name by default
+
+// resolved names are kept for a while, failures for a shorter while. names
+// are resolved by a small pool of threads of our own that grows while all of
+// them are busy, so a new name doesn't queue behind slow lookups of others,
+// and several callers asking for the same name share one lookup. names still
+// being asked for shortly before they expire are resolved again in the
+// background, their callers don't wait for that.
+class CDNSNameCache : public IRunnable
 {
 public:
   class CDNSName
   {
   public:
-    CStdString m_strHostName;
-    CStdString m_strIpAdres;
+    CDNSName() { m_resolved = 0; m_ttl = 0; m_bValid = m_bPermanent = m_bPending = false; }
+    CStdString m_strIpAdres;  // empty if the name didn't resolve
+    DWORD m_resolved;         // timeGetTime() of the lookup
+    DWORD m_ttl;
+    bool m_bValid;            // has been resolved at least once
+    bool m_bPermanent;        // from advancedsettings, never expires
+    bool m_bPending;          // a lookup is queued or running
   };
   CDNSNameCache(void);
   virtual ~CDNSNameCache(void);
-  static bool Lookup(const CStdString& strHostName, CStdString& strIpAdres);
+  // waits at most timeout ms for a name that isn't cached yet. when that
+  // runs out false is returned, the lookup goes on and is cached for later.
+  static bool Lookup(const CStdString& strHostName, CStdString& strIpAdres, DWORD timeout = DNS_LOOKUP_TIMEOUT);
   static void Add(const CStdString& strHostName, const CStdString& strIpAdres);
 
 protected:
-  static bool GetCached(const CStdString& strHostName, CStdString& strIpAdres);
-  static CCriticalSection m_critical;
-  std::vector<CDNSName> m_vecDNSNames;
-  typedef std::vector<CDNSName>::iterator ivecDNSNames;
+  virtual void Run();
+  bool GetCached(const CStdString& strHostName, CStdString& strIpAdres, DWORD timeout);
+  void Queue(const CStdString& strHostName, CDNSName& name);
+  static bool Resolve(const CStdString& strHostName, CStdString& strIpAdres);
+
+  CCriticalSection m_critical;
+  std::map<CStdString, CDNSName> m_names;   // keyed by lower case name
+  typedef std::map<CStdString, CDNSName>::iterator iNames;
+  std::deque<CStdString> m_queue;
+  CEvent m_queueEvent;
+  CEvent m_resolvedEvent;
+  std::vector<CThread*> m_resolvers;
+  unsigned int m_idle;                      // resolvers waiting for work
+  volatile bool m_bStop;
 };
@@ -0,0 +1,216 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "DirectoryFingerprints.h"
+#include "FileSystem/File.h"
+#include "FileItem.h"
+#include "Settings.h"
+#include "Util.h"
+#include "utils/SingleLock.h"
+
+using namespace std;
+using namespace XFILE;
+
+CDirectoryFingerprints::CDirectoryFingerprints(const CStdString& strFileName)
+{
+  m_strFileName = strFileName;
+  m_bDirty = false;
+}
+
+void CDirectoryFingerprints::Load()
+{
+  CSingleLock lock(m_section);
+  m_entries.clear();
+  m_seen.clear();
+  m_bDirty = false;
+
+  CStdString strFile;
+  CUtil::AddFileToFolder(g_settings.GetDatabaseFolder(), m_strFileName, strFile);
+  TiXmlDocument doc;
+  if (!CFile::Exists(strFile) || !doc.LoadFile(strFile))
+    return;
+
+  TiXmlElement *root = doc.RootElement();
+  if (!root || strcmp(root->Value(), "fingerprints"))
+    return;
+
+  // format:
+  // <path stamp="4a3f2c01.4a3f2c01.1000" hash="..." count="3">/media/movies/
+  //   <folder label="Alien">/media/movies/Alien/</folder>
+  // </path>
+  for (TiXmlElement *path = root->FirstChildElement("path"); path; path = path->NextSiblingElement("path"))
+  {
+    const char *stamp = path->Attribute("stamp");
+    const char *hash = path->Attribute("hash");
+    const TiXmlNode *text = path->FirstChild();
+    if (!stamp || !hash || !text || text->Type() != TiXmlNode::TEXT)
+      continue;
+
+    SEntry &entry = m_entries[text->Value()];
+    entry.stamp = stamp;
+    entry.hash = hash;
+    entry.count = 0;
+    path->Attribute("count", &entry.count);
+    for (TiXmlElement *folder = path->FirstChildElement("folder"); folder; folder = folder->NextSiblingElement("folder"))
+    {
+      const char *label = folder->Attribute("label");
+      if (folder->FirstChild())
+        entry.folders.push_back(make_pair(CStdString(folder->FirstChild()->Value()), CStdString(label ? label : "")));
+    }
+  }
+  CLog::Log(LOGDEBUG, "%s - loaded %i entries from %s", __FUNCTION__, (int)m_entries.size(), m_strFileName.c_str());
+}
+
+bool CDirectoryFingerprints::Save()
+{
+  CSingleLock lock(m_section);
+  if (!m_bDirty)
+    return true;
+
+  TiXmlDocument doc;
+  TiXmlElement xmlRootElement("fingerprints");
+  TiXmlNode *rootNode = doc.InsertEndChild(xmlRootElement);
+  if (!rootNode) return false;
+
+  for (map<CStdString, SEntry>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    const SEntry &entry = it->second;
+    TiXmlElement pathNode("path");
+    pathNode.SetAttribute("stamp", entry.stamp.c_str());
+    pathNode.SetAttribute("hash", entry.hash.c_str());
+    pathNode.SetAttribute("count", entry.count);
+    TiXmlText path(it->first);
+    pathNode.InsertEndChild(path);
+    for (unsigned int i = 0; i < entry.folders.size(); i++)
+    {
+      TiXmlElement folderNode("folder");
+      folderNode.SetAttribute("label", entry.folders[i].second.c_str());
+      TiXmlText folder(entry.folders[i].first);
+      folderNode.InsertEndChild(folder);
+      pathNode.InsertEndChild(folderNode);
+    }
+    rootNode->InsertEndChild(pathNode);
+  }
+
+  CStdString strFile;
+  CUtil::AddFileToFolder(g_settings.GetDatabaseFolder(), m_strFileName, strFile);
+  if (!doc.SaveFile(strFile))
+  {
+    CLog::Log(LOGERROR, "%s - unable to save %s", __FUNCTION__, strFile.c_str());
+    return false;
+  }
+  m_bDirty = false;
+  return true;
+}
+
+bool CDirectoryFingerprints::GetStamp(const CStdString& strPath, CStdString& stamp, bool bStacked)
+{
+  // only where a stat is cheap and a directory's times mean something
+  if (!CUtil::IsHD(strPath) && !CUtil::IsSmb(strPath))
+    return false;
+
+  struct __stat64 buffer;
+  memset(&buffer, 0, sizeof(buffer));
+  if (CFile::Stat(strPath, &buffer) != 0)
+    return false;
+
+#ifndef _LINUX
+  unsigned long mtime = (unsigned long)buffer.st_mtime;
+  unsigned long ctime = (unsigned long)buffer.st_ctime;
+#else
+  unsigned long mtime = (unsigned long)buffer._st_mtime;
+  unsigned long ctime = (unsigned long)buffer._st_ctime;
+#endif
+  if (mtime == 0)
+    return false;
+
+  stamp.Format("%lx.%lx.%lx%s", mtime, ctime, (unsigned long)buffer.st_size, bStacked ? ".stacked" : "");
+  return true;
+}
+
+bool CDirectoryFingerprints::Lookup(const CStdString& strPath, const CStdString& stamp, SEntry& entry)
+{
+  CSingleLock lock(m_section);
+  m_seen.insert(strPath);
+  map<CStdString, SEntry>::const_iterator it = m_entries.find(strPath);
+  if (it == m_entries.end() || it->second.stamp != stamp)
+    return false;
+  entry = it->second;
+  return true;
+}
+
+void CDirectoryFingerprints::Set(const CStdString& strPath, const CStdString& stamp, const CStdString& hash, int count, const CFileItemList& items)
+{
+  SEntry entry;
+  entry.stamp = stamp;
+  entry.hash = hash;
+  entry.count = count;
+  for (int i = 0; i < items.Size(); i++)
+  {
+    const CFileItemPtr pItem = items[i];
+    if (pItem->m_bIsFolder && !pItem->IsParentFolder() && !pItem->IsPlayList())
+      entry.folders.push_back(make_pair(pItem->m_strPath, pItem->GetLabel()));
+  }
+
+  CSingleLock lock(m_section);
+  m_seen.insert(strPath);
+  m_entries[strPath] = entry;
+  m_bDirty = true;
+}
+
+void CDirectoryFingerprints::Remove(const CStdString& strPath)
+{
+  CSingleLock lock(m_section);
+  map<CStdString, SEntry>::iterator it = m_entries.lower_bound(strPath);
+  while (it != m_entries.end() && it->first.compare(0, strPath.size(), strPath) == 0)
+  {
+    m_entries.erase(it++);
+    m_bDirty = true;
+  }
+}
+
+void CDirectoryFingerprints::RemoveUnseen()
+{
+  CSingleLock lock(m_section);
+  map<CStdString, SEntry>::iterator it = m_entries.begin();
+  while (it != m_entries.end())
+  {
+    if (m_seen.find(it->first) == m_seen.end())
+    {
+      m_entries.erase(it++);
+      m_bDirty = true;
+    }
+    else
+      ++it;
+  }
+}
+
+void CDirectoryFingerprints::GetFolders(const SEntry& entry, CFileItemList& items)
+{
+  for (unsigned int i = 0; i < entry.folders.size(); i++)
+  {
+    CFileItemPtr pItem(new CFileItem(entry.folders[i].second));
+    pItem->m_strPath = entry.folders[i].first;
+    pItem->m_bIsFolder = true;
+    items.Add(pItem);
+  }
+}
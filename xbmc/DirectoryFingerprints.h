@@ -0,0 +1,80 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+#include "StdString.h"
+#include "utils/CriticalSection.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+#define FINGERPRINTS_VIDEO "MyVideosFingerprints.xml"
+#define FINGERPRINTS_MUSIC "MyMusicFingerprints.xml"
+
+class CFileItemList;
+
+// remembers what the library scanners found in a directory the last time they
+// listed it, keyed by a stamp taken from a stat of the directory itself. a
+// directory with the same stamp hasn't had anything added, removed or renamed
+// since, so its listing and hash can be taken from here instead of the disk.
+// a file rewritten in place doesn't touch the directory, which is why the
+// scanners only use this when <fingerprints> is turned on in advancedsettings.
+class CDirectoryFingerprints
+{
+public:
+  struct SEntry
+  {
+    CStdString stamp;
+    CStdString hash;    // path hash the listing gave, see the scanners' GetPathHash()
+    int count;          // media files in the directory, for the progress
+    std::vector< std::pair<CStdString, CStdString> > folders; // path, label
+  };
+
+  CDirectoryFingerprints(const CStdString& strFileName);
+
+  // reads/writes the store, the file lives in the profile's database folder
+  void Load();
+  bool Save();
+
+  // false if the directory can't be stat'ed, in which case it has to be listed.
+  // a stacked listing differs from a plain one, so that goes in the stamp too.
+  static bool GetStamp(const CStdString& strPath, CStdString& stamp, bool bStacked = false);
+
+  // succeeds if strPath was last seen with this stamp
+  bool Lookup(const CStdString& strPath, const CStdString& stamp, SEntry& entry);
+  void Set(const CStdString& strPath, const CStdString& stamp, const CStdString& hash, int count, const CFileItemList& items);
+
+  // drops strPath and everything below it, for paths taken out of the library
+  void Remove(const CStdString& strPath);
+  // drops what hasn't been looked up or set since Load(), for after a scan of
+  // the whole library - what it didn't come across is gone
+  void RemoveUnseen();
+
+  // fills items with the folders of the entry, as the listing would have
+  static void GetFolders(const SEntry& entry, CFileItemList& items);
+
+private:
+  CStdString m_strFileName;
+  std::map<CStdString, SEntry> m_entries;
+  std::set<CStdString> m_seen;
+  bool m_bDirty;
+  CCriticalSection m_section; // the scanners count files on a second thread
+};
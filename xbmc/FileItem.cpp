@@ -50,6 +50,12 @@
 #include "Settings.h"
 #include "CocoaUtils.h"
 
+#ifdef _LINUX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+
 using namespace std;
 using namespace XFILE;
 using namespace DIRECTORY;
@@ -58,13 +64,11 @@ using namespace MUSIC_INFO;
 
 CFileItem::CFileItem(const CSong& song)
 {
-  m_musicInfoTag = NULL;
-  m_videoInfoTag = NULL;
-  m_pictureInfoTag = NULL;
   Reset();
   SetLabel(song.strTitle);
   m_strPath = _P(song.strFileName);
-  GetMusicInfoTag()->SetSong(song);
+  m_musicInfoTag.reset(new CMusicInfoTag);
+  m_musicInfoTag->SetSong(song);
   m_lStartOffset = song.iStartOffset;
   m_lEndOffset = song.iEndOffset;
   m_strThumbnailImage = _P(song.strThumb);
@@ -72,16 +76,14 @@ CFileItem::CFileItem(const CSong& song)
 
 CFileItem::CFileItem(const CStdString &path, const CAlbum& album)
 {
-  m_musicInfoTag = NULL;
-  m_videoInfoTag = NULL;
-  m_pictureInfoTag = NULL;
   Reset();
   SetLabel(album.strAlbum);
   m_strPath = _P(path);
   m_bIsFolder = true;
   m_strLabel2 = album.strArtist;
   CUtil::AddSlashAtEnd(m_strPath);
-  GetMusicInfoTag()->SetAlbum(album);
+  m_musicInfoTag.reset(new CMusicInfoTag);
+  m_musicInfoTag->SetAlbum(album);
   if (album.thumbURL.m_url.size() > 0)
     m_strThumbnailImage = album.thumbURL.m_url[0].m_url;
   else
@@ -99,9 +101,6 @@ CFileItem::CFileItem(const CStdString &path, const CAlbum& album)
 
 CFileItem::CFileItem(const CVideoInfoTag& movie)
 {
-  m_musicInfoTag = NULL;
-  m_videoInfoTag = NULL;
-  m_pictureInfoTag = NULL;
   Reset();
   SetLabel(movie.m_strTitle);
   if (movie.m_strFileNameAndPath.IsEmpty())
@@ -115,7 +114,7 @@ CFileItem::CFileItem(const CVideoInfoTag& movie)
     m_strPath = _P(movie.m_strFileNameAndPath);
     m_bIsFolder = false;
   }
-  *GetVideoInfoTag() = movie;
+  m_videoInfoTag.reset(new CVideoInfoTag(movie));
   FillInDefaultIcon();
   SetVideoThumb();
   SetInvalid();
@@ -136,44 +135,34 @@ CFileItem::CFileItem(const CVideoInfoTag& movie)
 
 CFileItem::CFileItem(const CArtist& artist)
 {
-  m_musicInfoTag = NULL;
-  m_videoInfoTag = NULL;
-  m_pictureInfoTag = NULL;
   Reset();
   SetLabel(artist.strArtist);
   m_strPath = _P(artist.strArtist);
   m_bIsFolder = true;
   CUtil::AddSlashAtEnd(m_strPath);
-  GetMusicInfoTag()->SetArtist(artist.strArtist);
+  m_musicInfoTag.reset(new CMusicInfoTag);
+  m_musicInfoTag->SetArtist(artist.strArtist);
 }
 
 CFileItem::CFileItem(const CGenre& genre)
 {
-  m_musicInfoTag = NULL;
-  m_videoInfoTag = NULL;
-  m_pictureInfoTag = NULL;
   Reset();
   SetLabel(genre.strGenre);
   m_strPath = _P(genre.strGenre);
   m_bIsFolder = true;
   CUtil::AddSlashAtEnd(m_strPath);
-  GetMusicInfoTag()->SetGenre(genre.strGenre);
+  m_musicInfoTag.reset(new CMusicInfoTag);
+  m_musicInfoTag->SetGenre(genre.strGenre);
 }
 
 CFileItem::CFileItem(const CFileItem& item)
 {
-  m_musicInfoTag = NULL;
-  m_videoInfoTag = NULL;
-  m_pictureInfoTag = NULL;
   Reset();
   *this = item;
 }
 
 CFileItem::CFileItem(const CGUIListItem& item)
 {
-  m_musicInfoTag = NULL;
-  m_videoInfoTag = NULL;
-  m_pictureInfoTag = NULL;
   m_bIsSearchDir = false;
   Reset();
   // not particularly pretty, but it gets around the issue of Reset() defaulting
@@ -183,9 +172,6 @@ CFileItem::CFileItem(const CGUIListItem& item)
 
 CFileItem::CFileItem(void)
 {
-  m_musicInfoTag = NULL;
-  m_videoInfoTag = NULL;
-  m_pictureInfoTag = NULL;
   m_bIsSearchDir = false;
   Reset();
 }
@@ -193,9 +179,6 @@ CFileItem::CFileItem(void)
 CFileItem::CFileItem(const CStdString& strLabel)
     : CGUIListItem()
 {
-  m_musicInfoTag = NULL;
-  m_videoInfoTag = NULL;
-  m_pictureInfoTag = NULL;
   m_bIsSearchDir = false;
   Reset();
   SetLabel(strLabel);
@@ -203,9 +186,6 @@ CFileItem::CFileItem(const CStdString& strLabel)
 
 CFileItem::CFileItem(const CStdString& strPath, bool bIsFolder)
 {
-  m_musicInfoTag = NULL;
-  m_videoInfoTag = NULL;
-  m_pictureInfoTag = NULL;
   m_bIsSearchDir = false;
   Reset();
   m_strPath = _P(strPath);
@@ -225,9 +205,6 @@ CFileItem::CFileItem(const CStdString& strPath, bool bIsFolder)
 
 CFileItem::CFileItem(const CMediaSource& share)
 {
-  m_musicInfoTag = NULL;
-  m_videoInfoTag = NULL;
-  m_pictureInfoTag = NULL;
   Reset();
   m_bIsFolder = true;
   m_bIsShareOrDrive = true;
@@ -248,16 +225,25 @@ CFileItem::CFileItem(const CMediaSource& share)
 
 CFileItem::~CFileItem(void)
 {
-  if (m_musicInfoTag)
-    delete m_musicInfoTag;
-  if (m_videoInfoTag)
-    delete m_videoInfoTag;
-  if (m_pictureInfoTag)
-    delete m_pictureInfoTag;
+}
 
-  m_musicInfoTag = NULL;
-  m_videoInfoTag = NULL;
-  m_pictureInfoTag = NULL;
+// shares source's tag with dest. a tag source handed out for changing may
+// still be written through, so that one is copied. a tag dest handed out is
+// overwritten in place, which keeps pointers to it valid.
+template<class T>
+static void AssignInfoTag(boost::shared_ptr<T>& dest, bool& bDestWritable, const boost::shared_ptr<T>& source, bool bSourceWritable)
+{
+  if (!source)
+  {
+    dest.reset();
+    bDestWritable = false;
+  }
+  else if (dest && bDestWritable)
+    *dest = *source;
+  else if (bSourceWritable)
+    dest.reset(new T(*source));
+  else
+    dest = source;
 }
 
 const CFileItem& CFileItem::operator=(const CFileItem& item)
@@ -280,47 +266,11 @@ const CFileItem& CFileItem::operator=(const CFileItem& item)
   m_bIsShareOrDrive = item.m_bIsShareOrDrive;
   m_dateTime = item.m_dateTime;
   m_dwSize = item.m_dwSize;
-  if (item.HasMusicInfoTag())
-  {
-    m_musicInfoTag = GetMusicInfoTag();
-    if (m_musicInfoTag)
-      *m_musicInfoTag = *item.m_musicInfoTag;
-  }
-  else
-  {
-    if (m_musicInfoTag)
-      delete m_musicInfoTag;
-
-    m_musicInfoTag = NULL;
-  }
-
-  if (item.HasVideoInfoTag())
-  {
-    m_videoInfoTag = GetVideoInfoTag();
-    if (m_videoInfoTag)
-      *m_videoInfoTag = *item.m_videoInfoTag;
-  }
-  else
-  {
-    if (m_videoInfoTag)
-      delete m_videoInfoTag;
-
-    m_videoInfoTag = NULL;
-  }
-
-  if (item.HasPictureInfoTag())
-  {
-    m_pictureInfoTag = GetPictureInfoTag();
-    if (m_pictureInfoTag)
-      *m_pictureInfoTag = *item.m_pictureInfoTag;
-  }
-  else
-  {
-    if (m_pictureInfoTag)
-      delete m_pictureInfoTag;
-
-    m_pictureInfoTag = NULL;
-  }
+  // the tags are shared with item until one of the two asks to change them,
+  // see GetMusicInfoTag(), so copying items into and out of the caches is cheap
+  AssignInfoTag(m_musicInfoTag, m_bMusicInfoTagWritable, item.m_musicInfoTag, item.m_bMusicInfoTagWritable);
+  AssignInfoTag(m_videoInfoTag, m_bVideoInfoTagWritable, item.m_videoInfoTag, item.m_bVideoInfoTagWritable);
+  AssignInfoTag(m_pictureInfoTag, m_bPictureInfoTagWritable, item.m_pictureInfoTag, item.m_bPictureInfoTagWritable);
 
   m_lStartOffset = item.m_lStartOffset;
   m_lEndOffset = item.m_lEndOffset;
@@ -371,15 +321,12 @@ void CFileItem::Reset()
   m_iHasLock = 0;
   m_bCanQueue=true;
   m_contenttype = "";
-  if (m_musicInfoTag)
-    delete m_musicInfoTag;
-  m_musicInfoTag=NULL;
-  if (m_videoInfoTag)
-    delete m_videoInfoTag;
-  m_videoInfoTag=NULL;
-  if (m_pictureInfoTag)
-    delete m_pictureInfoTag;
-  m_pictureInfoTag=NULL;
+  m_musicInfoTag.reset();
+  m_videoInfoTag.reset();
+  m_pictureInfoTag.reset();
+  m_bMusicInfoTagWritable = false;
+  m_bVideoInfoTagWritable = false;
+  m_bPictureInfoTagWritable = false;
   m_extrainfo.Empty();
   m_strFanartUrl.Empty();
   
@@ -470,13 +417,22 @@ void CFileItem::Serialize(CArchive& ar)
     int iType;
     ar >> iType;
     if (iType == 1)
-      ar >> *GetMusicInfoTag();
+    {
+      m_musicInfoTag.reset(new CMusicInfoTag);
+      ar >> *m_musicInfoTag;
+    }
     ar >> iType;
     if (iType == 1)
-      ar >> *GetVideoInfoTag();
+    {
+      m_videoInfoTag.reset(new CVideoInfoTag);
+      ar >> *m_videoInfoTag;
+    }
     ar >> iType;
     if (iType == 1)
-      ar >> *GetPictureInfoTag();
+    {
+      m_pictureInfoTag.reset(new CPictureInfoTag);
+      ar >> *m_pictureInfoTag;
+    }
 
     SetInvalid();
   }
@@ -1183,6 +1139,8 @@ bool CFileItem::IsSamePath(const CFileItem *item) const
 
 CFileItemList::CFileItemList()
 {
+  m_items.reset(new VECFILEITEMS);
+  m_map.reset(new MAPFILEITEMS);
   m_fastLookup = false;
   m_bIsFolder=true;
   m_cacheToDisc=CACHE_IF_SLOW;
@@ -1198,6 +1156,8 @@ CFileItemList::CFileItemList()
 
 CFileItemList::CFileItemList(const CStdString& strPath)
 {
+  m_items.reset(new VECFILEITEMS);
+  m_map.reset(new MAPFILEITEMS);
   m_strPath=strPath;
   m_fastLookup = false;
   m_bIsFolder=true;
@@ -1239,35 +1199,35 @@ const CFileItemPtr CFileItemList::operator[] (const CStdString& strPath) const
 
 void CFileItemList::SetFastLookup(bool fastLookup)
 {
-  CSingleLock lock(m_lock);
+  CExclusiveLock lock(m_lock);
 
   if (fastLookup && !m_fastLookup)
-  { // generate the map
-    m_map.clear();
-    for (unsigned int i=0; i < m_items.size(); i++)
+  { // generate the map, a new one as the old may be shared with another list
+    m_map.reset(new MAPFILEITEMS);
+    for (unsigned int i=0; i < m_items->size(); i++)
     {
-      CFileItemPtr pItem = m_items[i];
+      CFileItemPtr pItem = (*m_items)[i];
       CStdString path(pItem->m_strPath); path.ToLower();
-      m_map.insert(MAPFILEITEMSPAIR(path, pItem));
+      m_map->insert(MAPFILEITEMSPAIR(path, pItem));
     }
   }
   if (!fastLookup && m_fastLookup)
-    m_map.clear();
+    m_map.reset(new MAPFILEITEMS);
   m_fastLookup = fastLookup;
 }
 
 bool CFileItemList::Contains(const CStdString& fileName) const
 {
-  CSingleLock lock(m_lock);
+  CSharedLock lock(m_lock);
 
   // checks case insensitive
   CStdString checkPath(fileName); checkPath.ToLower();
   if (m_fastLookup)
-    return m_map.find(checkPath) != m_map.end();
+    return m_map->find(checkPath) != m_map->end();
   // slow method...
-  for (unsigned int i = 0; i < m_items.size(); i++)
+  for (unsigned int i = 0; i < m_items->size(); i++)
   {
-    const CFileItemPtr pItem = m_items[i];
+    const CFileItemPtr pItem = (*m_items)[i];
     if (pItem->m_strPath.Equals(checkPath))
       return true;
   }
@@ -1276,7 +1236,7 @@ bool CFileItemList::Contains(const CStdString& fileName) const
 
 void CFileItemList::Clear()
 {
-  CSingleLock lock(m_lock);
+  CExclusiveLock lock(m_lock);
 
   ClearItems();
   m_sortMethod=SORT_METHOD_NONE;
@@ -1296,65 +1256,70 @@ void CFileItemList::Clear()
 
 void CFileItemList::ClearItems()
 {
-  CSingleLock lock(m_lock);
+  CExclusiveLock lock(m_lock);
 
   // make sure we free the memory of the items (these are GUIControls which may have allocated resources)
   FreeMemory();
-  for (unsigned int i = 0; i < m_items.size(); i++)
+  if (!m_items.unique())
+  { // another list still shows them, it keeps them as they are
+    m_items.reset(new VECFILEITEMS);
+    m_map.reset(new MAPFILEITEMS);
+    return;
+  }
+  for (unsigned int i = 0; i < m_items->size(); i++)
   {
-    CFileItemPtr item = m_items[i];
+    CFileItemPtr item = (*m_items)[i];
     item->FreeMemory();
   }
   
-  m_items.clear();
-  m_map.clear();
+  m_items->clear();
+  m_map->clear();
 }
 
 void CFileItemList::Add(const CFileItemPtr &pItem)
 {
-  CSingleLock lock(m_lock);
+  CExclusiveLock lock(m_lock);
+  Detach();
 
-  m_items.push_back(pItem);
+  m_items->push_back(pItem);
   if (m_fastLookup)
   {
     CStdString path(pItem->m_strPath); path.ToLower();
-    m_map.insert(MAPFILEITEMSPAIR(path, pItem));
+    m_map->insert(MAPFILEITEMSPAIR(path, pItem));
   }
 }
 
 void CFileItemList::AddFront(const CFileItemPtr &pItem, int itemPosition)
 {
-  CSingleLock lock(m_lock);
+  CExclusiveLock lock(m_lock);
+  Detach();
 
   if (itemPosition >= 0)
   {
-    m_items.insert(m_items.begin()+itemPosition, pItem);
+    m_items->insert(m_items->begin()+itemPosition, pItem);
   }
   else
   {
-    m_items.insert(m_items.begin()+(m_items.size()+itemPosition), pItem);
+    m_items->insert(m_items->begin()+(m_items->size()+itemPosition), pItem);
   }
   if (m_fastLookup)
   {
     CStdString path(pItem->m_strPath); path.ToLower();
-    m_map.insert(MAPFILEITEMSPAIR(path, pItem));
+    m_map->insert(MAPFILEITEMSPAIR(path, pItem));
   }
 }
 
 void CFileItemList::Remove(CFileItem* pItem)
 {
-  CSingleLock lock(m_lock);
+  CExclusiveLock lock(m_lock);
 
-  for (IVECFILEITEMS it = m_items.begin(); it != m_items.end(); ++it)
+  // pItem may have come from a const accessor while the items were shared,
+  // so find it before they are copied
+  for (int i = 0; i < (int)m_items->size(); i++)
   {
-    if (pItem == it->get())
+    if (pItem == (*m_items)[i].get())
     {
-      m_items.erase(it);
-      if (m_fastLookup)
-      {
-        CStdString path(pItem->m_strPath); path.ToLower();
-        m_map.erase(path);
-      }
+      Remove(i);
       break;
     }
   }
@@ -1362,24 +1327,39 @@ void CFileItemList::Remove(CFileItem* pItem)
 
 void CFileItemList::Remove(int iItem)
 {
-  CSingleLock lock(m_lock);
+  CExclusiveLock lock(m_lock);
+  Detach();
 
   if (iItem >= 0 && iItem < (int)Size())
   {
-    CFileItemPtr pItem = *(m_items.begin() + iItem);
+    CFileItemPtr pItem = *(m_items->begin() + iItem);
     if (m_fastLookup)
     {
       CStdString path(pItem->m_strPath); path.ToLower();
-      m_map.erase(path);
+      m_map->erase(path);
     }
-    m_items.erase(m_items.begin() + iItem);
+    m_items->erase(m_items->begin() + iItem);
   }
 }
 
 void CFileItemList::Append(const CFileItemList& itemlist)
 {
-  CSingleLock lock(m_lock);
+  CExclusiveLock lock(m_lock);
+
+  if (IsEmpty())
+  { // take the items over as they are, both lists copy them once they change
+    CSharedLock sourceLock(itemlist.m_lock);
+    m_items = itemlist.m_items;
+    m_map = itemlist.m_map;
+    if (m_fastLookup && !itemlist.m_fastLookup)
+    {
+      m_fastLookup = false;
+      SetFastLookup(true);
+    }
+    return;
+  }
 
+  Detach();
   for (int i = 0; i < itemlist.Size(); ++i)
   {
     // Clone.
@@ -1392,7 +1372,7 @@ void CFileItemList::Append(const CFileItemList& itemlist)
 
 void CFileItemList::Assign(const CFileItemList& itemlist, bool append)
 {
-  CSingleLock lock(m_lock);
+  CExclusiveLock lock(m_lock);
   if (!append)
     Clear();
   Append(itemlist);
@@ -1413,41 +1393,44 @@ void CFileItemList::Assign(const CFileItemList& itemlist, bool append)
 
 CFileItemPtr CFileItemList::Get(int iItem)
 {
-  CSingleLock lock(m_lock);
+  // the item may be changed through the pointer
+  Detach();
+  CSharedLock lock(m_lock);
 
   if (iItem > -1)
-    return m_items[iItem];
+    return (*m_items)[iItem];
 
   return CFileItemPtr();
 }
 
 const CFileItemPtr CFileItemList::Get(int iItem) const
 {
-  CSingleLock lock(m_lock);
+  CSharedLock lock(m_lock);
 
   if (iItem > -1)
-    return m_items[iItem];
+    return (*m_items)[iItem];
 
   return CFileItemPtr();
 }
 
 CFileItemPtr CFileItemList::Get(const CStdString& strPath)
 {
-  CSingleLock lock(m_lock);
+  Detach();
+  CSharedLock lock(m_lock);
 
   CStdString pathToCheck(strPath); pathToCheck.ToLower();
   if (m_fastLookup)
   {
-    IMAPFILEITEMS it=m_map.find(pathToCheck);
-    if (it != m_map.end())
+    IMAPFILEITEMS it=m_map->find(pathToCheck);
+    if (it != m_map->end())
       return it->second;
 
     return CFileItemPtr();
   }
   // slow method...
-  for (unsigned int i = 0; i < m_items.size(); i++)
+  for (unsigned int i = 0; i < m_items->size(); i++)
   {
-    CFileItemPtr pItem = m_items[i];
+    CFileItemPtr pItem = (*m_items)[i];
     if (pItem->m_strPath.Equals(pathToCheck))
       return pItem;
   }
@@ -1457,21 +1440,21 @@ CFileItemPtr CFileItemList::Get(const CStdString& strPath)
 
 const CFileItemPtr CFileItemList::Get(const CStdString& strPath) const
 {
-  CSingleLock lock(m_lock);
+  CSharedLock lock(m_lock);
 
   CStdString pathToCheck(strPath); pathToCheck.ToLower();
   if (m_fastLookup)
   {
-    map<CStdString, CFileItemPtr>::const_iterator it=m_map.find(pathToCheck);
-    if (it != m_map.end())
+    map<CStdString, CFileItemPtr>::const_iterator it=m_map->find(pathToCheck);
+    if (it != m_map->end())
       return it->second;
 
     return CFileItemPtr();
   }
   // slow method...
-  for (unsigned int i = 0; i < m_items.size(); i++)
+  for (unsigned int i = 0; i < m_items->size(); i++)
   {
-    CFileItemPtr pItem = m_items[i];
+    CFileItemPtr pItem = (*m_items)[i];
     if (pItem->m_strPath.Equals(pathToCheck))
       return pItem;
   }
@@ -1481,35 +1464,38 @@ const CFileItemPtr CFileItemList::Get(const CStdString& strPath) const
 
 int CFileItemList::Size() const
 {
-  CSingleLock lock(m_lock);
-  return (int)m_items.size();
+  CSharedLock lock(m_lock);
+  return (int)m_items->size();
 }
 
 bool CFileItemList::IsEmpty() const
 {
-  CSingleLock lock(m_lock);
-  return (m_items.size() <= 0);
+  CSharedLock lock(m_lock);
+  return (m_items->size() <= 0);
 }
 
 void CFileItemList::Reserve(int iCount)
 {
-  CSingleLock lock(m_lock);
-  m_items.reserve(iCount);
+  CExclusiveLock lock(m_lock);
+  Detach();
+  m_items->reserve(iCount);
 }
 
 void CFileItemList::Sort(FILEITEMLISTCOMPARISONFUNC func)
 {
-  CSingleLock lock(m_lock);
+  CExclusiveLock lock(m_lock);
+  Detach();
   DWORD dwStart = GetTickCount();
-  std::sort(m_items.begin(), m_items.end(), func);
+  std::sort(m_items->begin(), m_items->end(), func);
   DWORD dwElapsed = GetTickCount() - dwStart;
   CLog::Log(LOGDEBUG,"%s, sorting took %u millis", __FUNCTION__, dwElapsed);
 }
 
 void CFileItemList::FillSortFields(FILEITEMFILLFUNC func)
 {
-  CSingleLock lock(m_lock);
-  std::for_each(m_items.begin(), m_items.end(), func);
+  CExclusiveLock lock(m_lock);
+  Detach();
+  std::for_each(m_items->begin(), m_items->end(), func);
 }
 
 void CFileItemList::Sort(SORT_METHOD sortMethod, SORT_ORDER sortOrder)
@@ -1614,57 +1600,66 @@ void CFileItemList::Sort(SORT_METHOD sortMethod, SORT_ORDER sortOrder)
 
 void CFileItemList::Randomize()
 {
-  CSingleLock lock(m_lock);
-  random_shuffle(m_items.begin(), m_items.end());
+  CExclusiveLock lock(m_lock);
+  Detach();
+  random_shuffle(m_items->begin(), m_items->end());
+}
+
+void CFileItemList::Detach()
+{
+  // items are only shared after Append() to an empty list, so the usual case
+  // doesn't have to lock
+  if (m_items.unique())
+    return;
+
+  CExclusiveLock lock(m_lock);
+  if (m_items.unique())
+    return;
+
+  // the other list keeps the items, this one goes on with copies
+  boost::shared_ptr<VECFILEITEMS> items(new VECFILEITEMS);
+  items->reserve(m_items->size());
+  for (unsigned int i = 0; i < m_items->size(); i++)
+    items->push_back(CFileItemPtr(new CFileItem(*(*m_items)[i])));
+  m_items = items;
+
+  m_map.reset(new MAPFILEITEMS);
+  if (m_fastLookup)
+  {
+    m_fastLookup = false;
+    SetFastLookup(true);
+  }
 }
 
 void CFileItemList::Serialize(CArchive& ar)
 {
-  CSingleLock lock(m_lock);
   if (ar.IsStoring())
   {
+    CSharedLock lock(m_lock);
     CFileItem::Serialize(ar);
 
     int i = 0;
-    if (m_items.size() > 0 && m_items[0]->IsParentFolder())
+    if (m_items->size() > 0 && (*m_items)[0]->IsParentFolder())
       i = 1;
 
-    ar << (int)(m_items.size() - i);
-
-    ar << m_fastLookup;
-
-    ar << (int)m_sortMethod;
-    ar << (int)m_sortOrder;
-    ar << (int)m_cacheToDisc;
-
-    ar << (int)m_sortDetails.size();
-    for (unsigned int j = 0; j < m_sortDetails.size(); ++j)
-    {
-      const SORT_METHOD_DETAILS &details = m_sortDetails[j];
-      ar << (int)details.m_sortMethod;
-      ar << details.m_buttonLabel;
-      ar << details.m_labelMasks.m_strLabelFile;
-      ar << details.m_labelMasks.m_strLabelFolder;
-      ar << details.m_labelMasks.m_strLabel2File;
-      ar << details.m_labelMasks.m_strLabel2Folder;
-    }
+    ar << (int)(m_items->size() - i);
 
-    ar << m_content;
-    ar << m_firstTitle;
-    ar << m_secondTitle;
+    bool fastLookup = m_fastLookup;
+    SerializeListInfo(ar, fastLookup);
 
-    for (; i < (int)m_items.size(); ++i)
+    for (; i < (int)m_items->size(); ++i)
     {
-      CFileItemPtr pItem = m_items[i];
+      CFileItemPtr pItem = (*m_items)[i];
       ar << *pItem;
     }
   }
   else
   {
+    CExclusiveLock lock(m_lock);
     CFileItemPtr pParent;
     if (!IsEmpty())
     {
-      CFileItemPtr pItem=m_items[0];
+      CFileItemPtr pItem=(*m_items)[0];
       if (pItem->IsParentFolder())
         pParent.reset(new CFileItem(*pItem));
     }
@@ -1682,13 +1677,54 @@ void CFileItemList::Serialize(CArchive& ar)
 
     if (pParent)
     {
-      m_items.reserve(iSize + 1);
-      m_items.push_back(pParent);
+      m_items->reserve(iSize + 1);
+      m_items->push_back(pParent);
     }
     else
-      m_items.reserve(iSize);
+      m_items->reserve(iSize);
 
     bool fastLookup=false;
+    SerializeListInfo(ar, fastLookup);
+
+    for (int i = 0; i < iSize; ++i)
+    {
+      CFileItemPtr pItem(new CFileItem);
+      ar >> *pItem;
+      Add(pItem);
+    }
+
+    SetFastLookup(fastLookup);
+  }
+}
+
+void CFileItemList::SerializeListInfo(CArchive& ar, bool& fastLookup)
+{
+  if (ar.IsStoring())
+  {
+    ar << fastLookup;
+
+    ar << (int)m_sortMethod;
+    ar << (int)m_sortOrder;
+    ar << (int)m_cacheToDisc;
+
+    ar << (int)m_sortDetails.size();
+    for (unsigned int j = 0; j < m_sortDetails.size(); ++j)
+    {
+      const SORT_METHOD_DETAILS &details = m_sortDetails[j];
+      ar << (int)details.m_sortMethod;
+      ar << details.m_buttonLabel;
+      ar << details.m_labelMasks.m_strLabelFile;
+      ar << details.m_labelMasks.m_strLabelFolder;
+      ar << details.m_labelMasks.m_strLabel2File;
+      ar << details.m_labelMasks.m_strLabel2Folder;
+    }
+
+    ar << m_content;
+    ar << m_firstTitle;
+    ar << m_secondTitle;
+  }
+  else
+  {
     ar >> fastLookup;
 
     ar >> (int&)m_sortMethod;
@@ -1712,24 +1748,16 @@ void CFileItemList::Serialize(CArchive& ar)
     ar >> m_content;
     ar >> m_firstTitle;
     ar >> m_secondTitle;
-
-    for (int i = 0; i < iSize; ++i)
-    {
-      CFileItemPtr pItem(new CFileItem);
-      ar >> *pItem;
-      Add(pItem);
-    }
-
-    SetFastLookup(fastLookup);
   }
 }
 
 void CFileItemList::FillInDefaultIcons()
 {
-  CSingleLock lock(m_lock);
-  for (int i = 0; i < (int)m_items.size(); ++i)
+  CExclusiveLock lock(m_lock);
+  Detach();
+  for (int i = 0; i < (int)m_items->size(); ++i)
   {
-    CFileItemPtr pItem = m_items[i];
+    CFileItemPtr pItem = (*m_items)[i];
     if (Cocoa_IsAppBundle(pItem->m_strPath.c_str()))
     {
       pItem->SetThumbnailImage(Cocoa_GetAppIcon(pItem->m_strPath));
@@ -1751,13 +1779,14 @@ void CFileItemList::FillInDefaultIcons()
 
 void CFileItemList::SetMusicThumbs()
 {
-  CSingleLock lock(m_lock);
+  CExclusiveLock lock(m_lock);
+  Detach();
   //cache thumbnails directory
   g_directoryCache.InitMusicThumbCache();
 
-  for (int i = 0; i < (int)m_items.size(); ++i)
+  for (int i = 0; i < (int)m_items->size(); ++i)
   {
-    CFileItemPtr pItem = m_items[i];
+    CFileItemPtr pItem = (*m_items)[i];
     pItem->SetMusicThumb();
   }
 
@@ -1766,11 +1795,11 @@ void CFileItemList::SetMusicThumbs()
 
 int CFileItemList::GetFolderCount() const
 {
-  CSingleLock lock(m_lock);
+  CSharedLock lock(m_lock);
   int nFolderCount = 0;
-  for (int i = 0; i < (int)m_items.size(); i++)
+  for (int i = 0; i < (int)m_items->size(); i++)
   {
-    CFileItemPtr pItem = m_items[i];
+    CFileItemPtr pItem = (*m_items)[i];
     if (pItem->m_bIsFolder)
       nFolderCount++;
   }
@@ -1780,10 +1809,10 @@ int CFileItemList::GetFolderCount() const
 
 int CFileItemList::GetObjectCount() const
 {
-  CSingleLock lock(m_lock);
+  CSharedLock lock(m_lock);
 
-  int numObjects = (int)m_items.size();
-  if (numObjects && m_items[0]->IsParentFolder())
+  int numObjects = (int)m_items->size();
+  if (numObjects && (*m_items)[0]->IsParentFolder())
     numObjects--;
 
   return numObjects;
@@ -1791,11 +1820,11 @@ int CFileItemList::GetObjectCount() const
 
 int CFileItemList::GetFileCount() const
 {
-  CSingleLock lock(m_lock);
+  CSharedLock lock(m_lock);
   int nFileCount = 0;
-  for (int i = 0; i < (int)m_items.size(); i++)
+  for (int i = 0; i < (int)m_items->size(); i++)
   {
-    CFileItemPtr pItem = m_items[i];
+    CFileItemPtr pItem = (*m_items)[i];
     if (!pItem->m_bIsFolder)
       nFileCount++;
   }
@@ -1805,11 +1834,11 @@ int CFileItemList::GetFileCount() const
 
 int CFileItemList::GetSelectedCount() const
 {
-  CSingleLock lock(m_lock);
+  CSharedLock lock(m_lock);
   int count = 0;
-  for (int i = 0; i < (int)m_items.size(); i++)
+  for (int i = 0; i < (int)m_items->size(); i++)
   {
-    CFileItemPtr pItem = m_items[i];
+    CFileItemPtr pItem = (*m_items)[i];
     if (pItem->IsSelected())
       count++;
   }
@@ -1819,13 +1848,14 @@ int CFileItemList::GetSelectedCount() const
 
 void CFileItemList::FilterCueItems()
 {
-  CSingleLock lock(m_lock);
+  CExclusiveLock lock(m_lock);
+  Detach();
   // Handle .CUE sheet files...
   VECSONGS itemstoadd;
   CStdStringArray itemstodelete;
-  for (int i = 0; i < (int)m_items.size(); i++)
+  for (int i = 0; i < (int)m_items->size(); i++)
   {
-    CFileItemPtr pItem = m_items[i];
+    CFileItemPtr pItem = (*m_items)[i];
     if (!pItem->m_bIsFolder)
     { // see if it's a .CUE sheet
       if (pItem->IsCUESheet())
@@ -1936,12 +1966,12 @@ void CFileItemList::FilterCueItems()
   // now delete the .CUE files and underlying media files.
   for (int i = 0; i < (int)itemstodelete.size(); i++)
   {
-    for (int j = 0; j < (int)m_items.size(); j++)
+    for (int j = 0; j < (int)m_items->size(); j++)
     {
-      CFileItemPtr pItem = m_items[j];
+      CFileItemPtr pItem = (*m_items)[j];
       if (stricmp(pItem->m_strPath.c_str(), itemstodelete[i].c_str()) == 0)
       { // delete this item
-        m_items.erase(m_items.begin() + j);
+        m_items->erase(m_items->begin() + j);
         break;
       }
     }
@@ -1951,28 +1981,30 @@ void CFileItemList::FilterCueItems()
   {
     // now create the file item, and add to the item list.
     CFileItemPtr pItem(new CFileItem(itemstoadd[i]));
-    m_items.push_back(pItem);
+    m_items->push_back(pItem);
   }
 }
 
 // Remove the extensions from the filenames
 void CFileItemList::RemoveExtensions()
 {
-  CSingleLock lock(m_lock);
+  CExclusiveLock lock(m_lock);
+  Detach();
   for (int i = 0; i < Size(); ++i)
-    m_items[i]->RemoveExtension();
+    (*m_items)[i]->RemoveExtension();
 }
 
 void CFileItemList::CleanFileNames()
 {
-  CSingleLock lock(m_lock);
+  CExclusiveLock lock(m_lock);
+  Detach();
   for (int i = 0; i < Size(); ++i)
-    m_items[i]->CleanFileName();
+    (*m_items)[i]->CleanFileName();
 }
 
 void CFileItemList::Stack()
 {
-  CSingleLock lock(m_lock);
+  CExclusiveLock lock(m_lock);
 
   // not allowed here
   if (IsVirtualDirectoryRoot() || IsTuxBox())
@@ -2174,43 +2206,235 @@ void CFileItemList::Stack()
   }
 }
 
-bool CFileItemList::Load()
+// disc cache layout, offsets are from the start of the file and everything is
+// in the byte order of the machine that wrote it, as with CArchive:
+//   SDiscCacheHeader
+//   the list record: the list's own item and SerializeListInfo()
+//   the item records, one CFileItem::Serialize() each, padded to 4 bytes
+//   the index: items + 1 record offsets, the last one being the end of the records
+//   the string table: a count, count + 1 offsets into the characters, the characters
+// strings in the records are indices into the string table, so a value repeated
+// across a listing (genres, studios, paths of a season) is stored once. nothing
+// in the file needs fixing up after loading, so it is used straight from a mapping.
+#define DISC_CACHE_VERSION 1
+
+struct SDiscCacheHeader
 {
-  CFile file;
-  if (file.Open(GetDiscCacheFile()))
+  char magic[4];
+  unsigned int version;
+  unsigned int items;
+  unsigned int indexOffset;
+  unsigned int stringsOffset;
+  unsigned int size;            // of the whole file, catches truncated writes
+};
+
+// a disc cache file in memory, mapped where we can
+class CDiscCacheImage
+{
+public:
+  CDiscCacheImage() { m_data = NULL; m_size = 0; m_mapped = false; }
+  ~CDiscCacheImage() { Close(); }
+
+  bool Open(const CStdString& strFile)
   {
-    CLog::Log(LOGDEBUG,"Loading fileitems [%s]",m_strPath.c_str());
-    CArchive ar(&file, CArchive::load);
-    ar >> *this;
-    CLog::Log(LOGDEBUG,"  -- items: %i, directory: %s sort method: %i, ascending: %s",Size(),m_strPath.c_str(), m_sortMethod, m_sortOrder ? "true" : "false");
-    ar.Close();
-    file.Close();
+#ifdef _LINUX
+    int fd = open(strFile.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+      struct stat st;
+      if (fstat(fd, &st) == 0 && st.st_size > 0)
+      {
+        void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+          m_data = (const BYTE *)data;
+          m_size = (unsigned int)st.st_size;
+          m_mapped = true;
+        }
+      }
+      close(fd);
+      if (m_mapped)
+        return true;
+    }
+#endif
+    // read it in one go instead
+    CFile file;
+    if (!file.Open(strFile))
+      return false;
+    __int64 size = file.GetLength();
+    if (size <= 0 || size > 0x7fffffff)
+      return false;
+    m_buffer.resize((unsigned int)size);
+    if ((__int64)file.Read(&m_buffer[0], size) != size)
+      return false;
+    m_data = &m_buffer[0];
+    m_size = (unsigned int)size;
     return true;
   }
 
-  return false;
+  void Close()
+  {
+#ifdef _LINUX
+    if (m_mapped)
+      munmap((void *)m_data, m_size);
+#endif
+    m_mapped = false;
+    m_buffer.clear();
+    m_data = NULL;
+    m_size = 0;
+  }
+
+  const BYTE *m_data;
+  unsigned int m_size;
+
+private:
+  bool m_mapped;
+  vector<BYTE> m_buffer;
+};
+
+bool CFileItemList::Load()
+{
+  CDiscCacheImage image;
+  if (!image.Open(GetDiscCacheFile()))
+    return false;
+
+  // anything we don't understand is a cache miss, the directory is fetched and saved again
+  const SDiscCacheHeader *header = (const SDiscCacheHeader *)image.m_data;
+  if (image.m_size < sizeof(SDiscCacheHeader) || memcmp(header->magic, "XFIL", 4) ||
+      header->version != DISC_CACHE_VERSION || header->size != image.m_size ||
+      header->indexOffset % 4 || header->indexOffset > header->stringsOffset ||
+      header->stringsOffset > image.m_size - 4 || header->items >= image.m_size / 4 ||
+      header->stringsOffset - header->indexOffset != 4 * (header->items + 1))
+  {
+    CLog::Log(LOGDEBUG,"Ignoring unknown or damaged cache for fileitems [%s]",m_strPath.c_str());
+    return false;
+  }
+
+  CLog::Log(LOGDEBUG,"Loading fileitems [%s]",m_strPath.c_str());
+
+  // string table, each distinct string is only allocated once
+  CArchiveStringPool strings;
+  const unsigned int *stringOffsets = (const unsigned int *)(image.m_data + header->stringsOffset);
+  unsigned int stringCount = stringOffsets[0];
+  unsigned int charsOffset = header->stringsOffset + 4 * (stringCount + 2);
+  if (stringCount > (image.m_size - header->stringsOffset) / 4 || charsOffset > image.m_size)
+    return false;
+  strings.m_strings.resize(stringCount);
+  for (unsigned int i = 0; i < stringCount; i++)
+  {
+    unsigned int from = stringOffsets[i + 1], to = stringOffsets[i + 2];
+    if (from > to || to > image.m_size - charsOffset)
+      return false;
+    strings.m_strings[i].assign((const char *)image.m_data + charsOffset + from, to - from);
+  }
+
+  const unsigned int *index = (const unsigned int *)(image.m_data + header->indexOffset);
+  for (unsigned int i = 0; i <= header->items; i++)
+  {
+    if (index[i] < sizeof(SDiscCacheHeader) || index[i] > header->indexOffset || (i && index[i] < index[i - 1]))
+      return false;
+  }
+
+  CExclusiveLock lock(m_lock);
+  CFileItemPtr pParent;
+  if (!IsEmpty() && (*m_items)[0]->IsParentFolder())
+    pParent.reset(new CFileItem(*(*m_items)[0]));
+
+  SetFastLookup(false);
+  Clear();
+
+  bool fastLookup = false;
+  {
+    CArchive ar(image.m_data + sizeof(SDiscCacheHeader), index[0] - sizeof(SDiscCacheHeader), &strings);
+    CFileItem::Serialize(ar);
+    SerializeListInfo(ar, fastLookup);
+  }
+
+  m_items->reserve(header->items + (pParent ? 1 : 0));
+  if (pParent)
+    m_items->push_back(pParent);
+  for (unsigned int i = 0; i < header->items; i++)
+  {
+    CArchive ar(image.m_data + index[i], index[i + 1] - index[i], &strings);
+    CFileItemPtr pItem(new CFileItem);
+    ar >> *pItem;
+    Add(pItem);
+  }
+  SetFastLookup(fastLookup);
+
+  CLog::Log(LOGDEBUG,"  -- items: %i, directory: %s sort method: %i, ascending: %s",Size(),m_strPath.c_str(), m_sortMethod, m_sortOrder ? "true" : "false");
+  return true;
 }
 
 bool CFileItemList::Save()
 {
+  CSharedLock lock(m_lock);
   int iSize = Size();
   if (iSize <= 0)
     return false;
 
   CLog::Log(LOGDEBUG,"Saving fileitems [%s]",m_strPath.c_str());
 
-  CFile file;
-  if (file.OpenForWrite(GetDiscCacheFile(), true, true)) // overwrite always
+  // the parent folder item is left out, as with Serialize()
+  int first = (*m_items)[0]->IsParentFolder() ? 1 : 0;
+
+  vector<BYTE> data(sizeof(SDiscCacheHeader));
+  vector<unsigned int> index;
+  CArchiveStringPool strings;
   {
-    CArchive ar(&file, CArchive::store);
-    ar << *this;
-    CLog::Log(LOGDEBUG,"  -- items: %i, sort method: %i, ascending: %s",iSize,m_sortMethod, m_sortOrder ? "true" : "false");
+    CArchive ar(data, &strings);
+    CFileItem::Serialize(ar);
+    bool fastLookup = m_fastLookup;
+    SerializeListInfo(ar, fastLookup);
+    for (int i = first; i < iSize; i++)
+    {
+      ar.Close();
+      data.resize((data.size() + 3) & ~3);
+      index.push_back(data.size());
+      ar << *(*m_items)[i];
+    }
     ar.Close();
-    file.Close();
-    return true;
+    data.resize((data.size() + 3) & ~3);
+    index.push_back(data.size());
   }
 
-  return false;
+  SDiscCacheHeader header;
+  memcpy(header.magic, "XFIL", 4);
+  header.version = DISC_CACHE_VERSION;
+  header.items = index.size() - 1;
+  header.indexOffset = data.size();
+  data.insert(data.end(), (const BYTE *)&index[0], (const BYTE *)(&index[0] + index.size()));
+
+  header.stringsOffset = data.size();
+  vector<unsigned int> stringOffsets;
+  stringOffsets.push_back(strings.m_strings.size());
+  unsigned int chars = 0;
+  stringOffsets.push_back(chars);
+  for (unsigned int i = 0; i < strings.m_strings.size(); i++)
+  {
+    chars += strings.m_strings[i].size();
+    stringOffsets.push_back(chars);
+  }
+  data.insert(data.end(), (const BYTE *)&stringOffsets[0], (const BYTE *)(&stringOffsets[0] + stringOffsets.size()));
+  for (unsigned int i = 0; i < strings.m_strings.size(); i++)
+    data.insert(data.end(), strings.m_strings[i].begin(), strings.m_strings[i].end());
+
+  header.size = data.size();
+  memcpy(&data[0], &header, sizeof(header));
+
+  CFile file;
+  if (!file.OpenForWrite(GetDiscCacheFile(), true, true)) // overwrite always
+    return false;
+  bool ok = file.Write(&data[0], data.size()) == (int)data.size();
+  file.Close();
+  if (!ok)
+  {
+    CLog::Log(LOGERROR,"Unable to write cache for fileitems [%s]",m_strPath.c_str());
+    CFile::Delete(GetDiscCacheFile());
+    return false;
+  }
+  CLog::Log(LOGDEBUG,"  -- items: %i, strings: %i, bytes: %i, sort method: %i, ascending: %s",header.items,(int)strings.m_strings.size(),header.size,m_sortMethod, m_sortOrder ? "true" : "false");
+  return true;
 }
 
 void CFileItemList::RemoveDiscCache() const
@@ -2252,33 +2476,36 @@ bool CFileItemList::AlwaysCache() const
 
 void CFileItemList::SetCachedVideoThumbs()
 {
-  CSingleLock lock(m_lock);
+  CExclusiveLock lock(m_lock);
+  Detach();
   // TODO: Investigate caching time to see if it speeds things up
-  for (unsigned int i = 0; i < m_items.size(); ++i)
+  for (unsigned int i = 0; i < m_items->size(); ++i)
   {
-    CFileItemPtr pItem = m_items[i];
+    CFileItemPtr pItem = (*m_items)[i];
     pItem->SetCachedVideoThumb();
   }
 }
 
 void CFileItemList::SetCachedProgramThumbs()
 {
-  CSingleLock lock(m_lock);
+  CExclusiveLock lock(m_lock);
+  Detach();
   // TODO: Investigate caching time to see if it speeds things up
-  for (unsigned int i = 0; i < m_items.size(); ++i)
+  for (unsigned int i = 0; i < m_items->size(); ++i)
   {
-    CFileItemPtr pItem = m_items[i];
+    CFileItemPtr pItem = (*m_items)[i];
     pItem->SetCachedProgramThumb();
   }
 }
 
 void CFileItemList::SetCachedMusicThumbs()
 {
-  CSingleLock lock(m_lock);
+  CExclusiveLock lock(m_lock);
+  Detach();
   // TODO: Investigate caching time to see if it speeds things up
-  for (unsigned int i = 0; i < m_items.size(); ++i)
+  for (unsigned int i = 0; i < m_items->size(); ++i)
   {
-    CFileItemPtr pItem = m_items[i];
+    CFileItemPtr pItem = (*m_items)[i];
     pItem->SetCachedMusicThumb();
   }
 }
@@ -2614,7 +2841,7 @@ CStdString CFileItem::CacheFanart(bool probe) const
   {
     if (!HasVideoInfoTag())
       return ""; // nothing can be done
-    CFileItem dbItem(m_bIsFolder ? GetVideoInfoTag()->m_strPath : GetVideoInfoTag()->m_strFileNameAndPath, m_bIsFolder);
+    CFileItem dbItem(m_bIsFolder ? m_videoInfoTag->m_strPath : m_videoInfoTag->m_strFileNameAndPath, m_bIsFolder);
     return dbItem.CacheFanart();
   }
 
@@ -2703,7 +2930,7 @@ CStdString CFileItem::GetCachedFanart() const
   {
     if (!HasVideoInfoTag())
       return "";
-    return CFileItem::GetCachedFanart(m_bIsFolder ? GetVideoInfoTag()->m_strPath : GetVideoInfoTag()->m_strFileNameAndPath);
+    return CFileItem::GetCachedFanart(m_bIsFolder ? m_videoInfoTag->m_strPath : m_videoInfoTag->m_strFileNameAndPath);
   }
   return CFileItem::GetCachedFanart(m_strPath);
 }
@@ -2836,10 +3063,11 @@ void CFileItem::SetUserProgramThumb()
 
 void CFileItemList::SetProgramThumbs()
 {
+  Detach();
   // TODO: Is there a speed up if we cache the program thumbs first?
-  for (unsigned int i = 0; i < m_items.size(); i++)
+  for (unsigned int i = 0; i < m_items->size(); i++)
   {
-    CFileItemPtr pItem = m_items[i];
+    CFileItemPtr pItem = (*m_items)[i];
     if (pItem->IsParentFolder())
       continue;
     pItem->SetCachedProgramThumb();
@@ -2922,21 +3150,23 @@ void CFileItem::SetCachedGameSavesThumb()
 
 void CFileItemList::SetCachedGameSavesThumbs()
 {
+  Detach();
   // TODO: Investigate caching time to see if it speeds things up
-  for (unsigned int i = 0; i < m_items.size(); ++i)
+  for (unsigned int i = 0; i < m_items->size(); ++i)
   {
-    CFileItemPtr pItem = m_items[i];
+    CFileItemPtr pItem = (*m_items)[i];
     pItem->SetCachedGameSavesThumb();
   }
 }
 
 void CFileItemList::SetGameSavesThumbs()
 {
+  Detach();
   // No User thumbs
   // TODO: Is there a speed up if we cache the program thumbs first?
-  for (unsigned int i = 0; i < m_items.size(); i++)
+  for (unsigned int i = 0; i < m_items->size(); i++)
   {
-    CFileItemPtr pItem = m_items[i];
+    CFileItemPtr pItem = (*m_items)[i];
     if (pItem->IsParentFolder())
       continue;
     pItem->SetCachedGameSavesThumb();  // was  pItem->SetCachedProgramThumb(); oringally
@@ -2945,8 +3175,9 @@ void CFileItemList::SetGameSavesThumbs()
 
 void CFileItemList::Swap(unsigned int item1, unsigned int item2)
 {
-  if (item1 != item2 && item1 < m_items.size() && item2 < m_items.size())
-    std::swap(m_items[item1], m_items[item2]);
+  Detach();
+  if (item1 != item2 && item1 < m_items->size() && item2 < m_items->size())
+    std::swap((*m_items)[item1], (*m_items)[item2]);
 }
 
 void CFileItemList::UpdateItem(const CFileItem *item)
@@ -2981,25 +3212,36 @@ void CFileItemList::ClearSortState()
 CVideoInfoTag* CFileItem::GetVideoInfoTag()
 {
   if (!m_videoInfoTag)
-    m_videoInfoTag = new CVideoInfoTag;
+    m_videoInfoTag.reset(new CVideoInfoTag);
+  else if (!m_videoInfoTag.unique())
+    m_videoInfoTag.reset(new CVideoInfoTag(*m_videoInfoTag));
 
-  return m_videoInfoTag;
+  m_bVideoInfoTagWritable = true;
+  return m_videoInfoTag.get();
 }
 
 CPictureInfoTag* CFileItem::GetPictureInfoTag()
 {
   if (!m_pictureInfoTag)
-    m_pictureInfoTag = new CPictureInfoTag;
+    m_pictureInfoTag.reset(new CPictureInfoTag);
+  else if (!m_pictureInfoTag.unique())
+    m_pictureInfoTag.reset(new CPictureInfoTag(*m_pictureInfoTag));
 
-  return m_pictureInfoTag;
+  m_bPictureInfoTagWritable = true;
+  return m_pictureInfoTag.get();
 }
 
 MUSIC_INFO::CMusicInfoTag* CFileItem::GetMusicInfoTag()
 {
+  // a tag still shared with a copy of this item is copied before handing it
+  // out for changes, the same goes for the video and picture tags
   if (!m_musicInfoTag)
-    m_musicInfoTag = new MUSIC_INFO::CMusicInfoTag;
+    m_musicInfoTag.reset(new MUSIC_INFO::CMusicInfoTag);
+  else if (!m_musicInfoTag.unique())
+    m_musicInfoTag.reset(new MUSIC_INFO::CMusicInfoTag(*m_musicInfoTag));
 
-  return m_musicInfoTag;
+  m_bMusicInfoTagWritable = true;
+  return m_musicInfoTag.get();
 }
 
 void CFileItem::SetQuickFanart(const CStdString& fanartURL)
@@ -32,6 +32,7 @@
 #include "utils/LabelFormatter.h"
 #include "GUIPassword.h"
 #include "utils/CriticalSection.h"
+#include "utils/SharedSection.h"
 
 #include <vector>
 #include "boost/shared_ptr.hpp"
@@ -142,36 +143,41 @@ public:
 
   bool HasMusicInfoTag() const
   {
-    return m_musicInfoTag != NULL;
+    return m_musicInfoTag.get() != NULL;
   }
 
+  // the non-const Get*InfoTag() are for changing the tag. they detach it from
+  // any copies of the item first, and from then on copies of this item get a
+  // tag of their own, so writes through the pointer only ever reach this item.
+  // readers should go through the const versions, which leave the tag shared
+  // and return NULL if there is none.
   MUSIC_INFO::CMusicInfoTag* GetMusicInfoTag();
 
   inline const MUSIC_INFO::CMusicInfoTag* GetMusicInfoTag() const
   {
-    return m_musicInfoTag;
+    return m_musicInfoTag.get();
   }
 
   bool HasVideoInfoTag() const
   {
-    return m_videoInfoTag != NULL;
+    return m_videoInfoTag.get() != NULL;
   }
   
   CVideoInfoTag* GetVideoInfoTag();
   
   inline const CVideoInfoTag* GetVideoInfoTag() const
   {
-    return m_videoInfoTag;
+    return m_videoInfoTag.get();
   }
 
   bool HasPictureInfoTag() const
   {
-    return m_pictureInfoTag != NULL;
+    return m_pictureInfoTag.get() != NULL;
   }
 
   inline const CPictureInfoTag* GetPictureInfoTag() const
   {
-    return m_pictureInfoTag;
+    return m_pictureInfoTag.get();
   }
 
   CPictureInfoTag* GetPictureInfoTag();
@@ -275,9 +281,14 @@ private:
   bool m_bLabelPreformated;
   CStdString m_contenttype;
   CStdString m_extrainfo;
-  MUSIC_INFO::CMusicInfoTag* m_musicInfoTag;
-  CVideoInfoTag* m_videoInfoTag;
-  CPictureInfoTag* m_pictureInfoTag;
+  // shared between copies of the item, copy on write
+  boost::shared_ptr<MUSIC_INFO::CMusicInfoTag> m_musicInfoTag;
+  boost::shared_ptr<CVideoInfoTag> m_videoInfoTag;
+  boost::shared_ptr<CPictureInfoTag> m_pictureInfoTag;
+  // set once a non-const Get*InfoTag() handed out the tag, which isn't shared from then on
+  bool m_bMusicInfoTagWritable;
+  bool m_bVideoInfoTagWritable;
+  bool m_bPictureInfoTagWritable;
 };
 
 /*!
@@ -348,6 +359,10 @@ public:
   const CFileItemPtr Get(const CStdString& strPath) const;
   int Size() const;
   bool IsEmpty() const;
+  // an empty list takes the items of itemlist without copying them. the two
+  // share them until either changes its items or hands one out through a
+  // non-const accessor, then that list makes its own copies. read through a
+  // const list where nothing is changed.
   void Append(const CFileItemList& itemlist);
   void Assign(const CFileItemList& itemlist, bool append = false);
   void Reserve(int iCount);
@@ -408,9 +423,12 @@ private:
   void Sort(FILEITEMLISTCOMPARISONFUNC func);
   void FillSortFields(FILEITEMFILLFUNC func);
   CStdString GetDiscCacheFile() const;
+  void SerializeListInfo(CArchive& ar, bool& fastLookup);
+  void Detach();
 
-  VECFILEITEMS m_items;
-  MAPFILEITEMS m_map;
+  // shared with the lists Append() gave them to or took them from, see Detach()
+  boost::shared_ptr<VECFILEITEMS> m_items;
+  boost::shared_ptr<MAPFILEITEMS> m_map;
   bool m_fastLookup;
   SORT_METHOD m_sortMethod;
   SORT_ORDER m_sortOrder;
@@ -424,5 +442,5 @@ private:
 
   std::vector<SORT_METHOD_DETAILS> m_sortDetails;
 
-  CCriticalSection m_lock;
+  CSharedSection m_lock; // the GUI reads lists while they are filled in the background
 };
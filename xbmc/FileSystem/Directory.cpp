@@ -84,11 +84,13 @@ bool CDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items, C
         g_directoryCache.SetDirectory(strPath, items, pDirectory->GetCacheType(strPath));
     }
 
-    // now filter for allowed files
+    // now filter for allowed files. the items are read through a const list,
+    // as a listing from the cache is shared with it until one is changed
+    const CFileItemList &constItems = items;
     pDirectory->SetMask(strMask);
     for (int i = 0; i < items.Size(); ++i)
     {
-      CFileItemPtr item = items[i];
+      const CFileItemPtr item = constItems[i];
       if (item->IsPlexMediaServer() == false && items.IsPlexMediaServer() == false)
       {
         if ((!item->m_bIsFolder && !pDirectory->IsAllowed(item->m_strPath)) ||
@@ -106,9 +108,11 @@ bool CDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items, C
     {
       for (int i=0; i< items.Size(); ++i)
       {
-        CFileItemPtr pItem=items[i];
-        if ((!pItem->m_bIsFolder) && (!pItem->IsInternetStream()))
+        const CFileItemPtr item = constItems[i];
+        if ((!item->m_bIsFolder) && (!item->IsInternetStream()))
         {
+          // the file directory may change the item
+          CFileItemPtr pItem=items[i];
           auto_ptr<IFileDirectory> pDirectory(CFactoryFileDirectory::Create(pItem->m_strPath,pItem.get(),strMask));
           if (pDirectory.get())
             pItem->m_bIsFolder = true;
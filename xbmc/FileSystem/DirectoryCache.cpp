@@ -24,6 +24,7 @@
 #include "Util.h"
 #include "Settings.h"
 #include "FileItem.h"
+#include "utils/Metrics.h"
 
 using namespace std;
 using namespace DIRECTORY;
@@ -55,7 +56,7 @@ CDirectoryCache::~CDirectoryCache(void)
 
 bool CDirectoryCache::GetDirectory(const CStdString& strPath, CFileItemList &items) const
 {
-  CSingleLock lock (m_cs);
+  CSharedLock lock (m_cs);
 
   CStdString storedPath = _P(strPath);
   CUtil::RemoveSlashAtEnd(storedPath);
@@ -66,9 +67,11 @@ bool CDirectoryCache::GetDirectory(const CStdString& strPath, CFileItemList &ite
     if (dir->m_strPath == storedPath && dir->m_cacheType == DIR_CACHE_ALWAYS)
     {
       items.Assign(*dir->m_Items);
+      CMetrics::Increment("directory_cache_requests_total{result=\"hit\"}");
       return true;
     }
   }
+  CMetrics::Increment("directory_cache_requests_total{result=\"miss\"}");
   return false;
 }
 
@@ -88,7 +91,9 @@ void CDirectoryCache::SetDirectory(const CStdString& strPath, const CFileItemLis
   // IDEALLY, any further processing on the item would actually create a new item 
   // instead of altering it, but we can't really enforce that in an easy way, so
   // this is the best solution for now.
-  CSingleLock lock (m_cs);
+  // Assign() puts off the copy: the cache and the caller share the items until
+  // one of the two changes them, and that one gets the copies.
+  CExclusiveLock lock (m_cs);
 
   ClearDirectory(strPath);
 
@@ -102,7 +107,7 @@ void CDirectoryCache::SetDirectory(const CStdString& strPath, const CFileItemLis
 
 void CDirectoryCache::ClearDirectory(const CStdString& strPath)
 {
-  CSingleLock lock (m_cs);
+  CExclusiveLock lock (m_cs);
 
   CStdString storedPath = _P(strPath);
   CUtil::RemoveSlashAtEnd(storedPath);
@@ -121,7 +126,7 @@ void CDirectoryCache::ClearDirectory(const CStdString& strPath)
 
 void CDirectoryCache::ClearSubPaths(const CStdString& strPath)
 {
-  CSingleLock lock (m_cs);
+  CExclusiveLock lock (m_cs);
 
   CStdString storedPath = _P(strPath);
   CUtil::RemoveSlashAtEnd(storedPath);
@@ -157,7 +162,7 @@ void CDirectoryCache::ClearSubPaths(const CStdString& strPath)
 
 bool CDirectoryCache::FileExists(const CStdString& strFile, bool& bInCache) const
 {
-  CSingleLock lock (m_cs);
+  CSharedLock lock (m_cs);
   bInCache = false;
 
   // ideally there should be no translation needed, but due to pervasive use of _P() in the sources
@@ -184,7 +189,7 @@ bool CDirectoryCache::FileExists(const CStdString& strFile, bool& bInCache) cons
 void CDirectoryCache::Clear()
 {
   // this routine clears everything except things we always cache
-  CSingleLock lock (m_cs);
+  CExclusiveLock lock (m_cs);
 
   ivecCache i = m_vecCache.begin();
   while (i != m_vecCache.end() )
@@ -240,7 +245,7 @@ bool CDirectoryCache::IsCacheDir(const CStdString &strPath) const
 
 void CDirectoryCache::InitThumbCache()
 {
-  CSingleLock lock (m_cs);
+  CExclusiveLock lock (m_cs);
 
   if (m_iThumbCacheRefCount > 0)
   {
@@ -267,7 +272,7 @@ void CDirectoryCache::InitThumbCache()
 
 void CDirectoryCache::ClearThumbCache()
 {
-  CSingleLock lock (m_cs);
+  CExclusiveLock lock (m_cs);
 
   if (m_iThumbCacheRefCount > 1)
   {
@@ -281,7 +286,7 @@ void CDirectoryCache::ClearThumbCache()
 
 void CDirectoryCache::InitMusicThumbCache()
 {
-  CSingleLock lock (m_cs);
+  CExclusiveLock lock (m_cs);
 
   if (m_iMusicThumbCacheRefCount > 0)
   {
@@ -308,7 +313,7 @@ void CDirectoryCache::InitMusicThumbCache()
 
 void CDirectoryCache::ClearMusicThumbCache()
 {
-  CSingleLock lock (m_cs);
+  CExclusiveLock lock (m_cs);
 
   if (m_iMusicThumbCacheRefCount > 1)
   {
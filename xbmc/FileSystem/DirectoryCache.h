@@ -22,6 +22,7 @@
 
 #include "IDirectory.h"
 #include "Directory.h"
+#include "utils/SharedSection.h"
 
 #include <set>
 
@@ -62,7 +63,7 @@ namespace DIRECTORY
     typedef std::vector<CDir*>::iterator ivecCache;
     typedef std::vector<CDir*>::const_iterator civecCache;
 
-    CCriticalSection m_cs;
+    CSharedSection m_cs;
     std::set<CStdString> m_thumbDirs;
     std::set<CStdString> m_musicThumbDirs;
     int m_iThumbCacheRefCount;
@@ -287,6 +287,7 @@ CFileCurl::CFileCurl()
   m_ftppasvip = false;
   m_bufferSize = 128*1024;
   m_binary = true;
+  m_httpresponse = 0;
   m_state = new CReadState();
 }
 
@@ -602,10 +603,16 @@ bool CFileCurl::Open(const CURL& url, bool bBinary)
   SetRequestHeaders(m_state);
 
   m_opened = true;
+  m_httpresponse = 0;
 
   long response = m_state->Connect(m_bufferSize);
   if( response < 0 )
+  {
+    // an error status fails the transfer, but the caller may want to know which
+    g_curlInterface.easy_getinfo(m_state->m_easyHandle, CURLINFO_RESPONSE_CODE, &m_httpresponse);
     return false;
+  }
+  m_httpresponse = response;
   
   SetCorrectHeaders(m_state);
 
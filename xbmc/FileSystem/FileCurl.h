@@ -68,6 +68,9 @@ namespace XFILE
       
       const CHttpHeader& GetHttpHeader() { return m_state->m_httpheader; }
 
+      /* http status of the last Open(), 0 if the server never answered */
+      long GetHttpResponse() const                               { return m_httpresponse; }
+
       /* static function that will get content type of a file */      
       static bool GetHttpHeader(const CURL &url, CHttpHeader &headers);
       static bool GetContent(const CURL &url, CStdString &content, CStdString useragent="");
@@ -132,6 +135,7 @@ namespace XFILE
       bool            m_seekable;
       bool            m_multisession;
       bool            m_binary;
+      long            m_httpresponse;
 
       CRingBuffer     m_buffer;           // our ringhold buffer
       char *          m_overflowBuffer;   // in the rare case we would overflow the above buffer
@@ -624,10 +624,13 @@ bool CGUIMediaWindow::Update(const CStdString &strDirectory)
     return false;
   }
 
-  // Assign the new file items.
+  // Assign the new file items. newItems lets go of them after, else our list
+  // would copy them all as soon as it changes them below.
   ClearFileItems();
   m_vecItems->ClearProperties();
   m_vecItems->Assign(newItems);
+  bool bNoNewItems = newItems.IsEmpty();
+  newItems.ClearItems();
   
   // if we're getting the root source listing
   // make sure the path history is clean
@@ -715,7 +718,7 @@ bool CGUIMediaWindow::Update(const CStdString &strDirectory)
     CGUIDialogOK::ShowAndGetInput(newItems.m_displayMessageTitle, newItems.m_displayMessageContents, "", "");
   
     // If the container has no child items, return to the previous directory
-    if (newItems.Size() == 0)
+    if (bNoNewItems)
       return false;
   }
   
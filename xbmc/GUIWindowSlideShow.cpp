@@ -42,6 +42,8 @@ using namespace DIRECTORY;
 
 #define IMMEDIATE_TRANSISTION_TIME          20
 
+#define LOOKAHEAD_WORKERS                    2
+
 #define PICTURE_MOVE_AMOUNT              0.02f
 #define PICTURE_MOVE_AMOUNT_ANALOG       0.01f
 #define PICTURE_VIEW_BOX_COLOR      0xffffff00 // YELLOW
@@ -62,16 +64,58 @@ CBackgroundPicLoader::CBackgroundPicLoader()
   m_pCallback = NULL;
   m_loadPic = CreateEvent(NULL,false,false,NULL);
   m_isLoading = false;
+  m_wantedWidth = 0;
+  m_wantedHeight = 0;
+  m_decodedSize = 0;
+  m_bStopWorkers = false;
 }
 
 CBackgroundPicLoader::~CBackgroundPicLoader()
-{}
+{
+  StopThread();
+}
 
 void CBackgroundPicLoader::Create(CGUIWindowSlideShow *pCallback)
 {
   m_pCallback = pCallback;
   m_isLoading = false;
   CThread::Create(false);
+
+  m_bStopWorkers = false;
+  if (g_advancedSettings.m_slideshowLookAheadMemory > 0 &&
+      g_advancedSettings.m_slideshowLookAhead + g_advancedSettings.m_slideshowLookBehind > 0)
+  {
+    for (int i = 0; i < LOOKAHEAD_WORKERS; i++)
+    {
+      CThread *worker = new CThread(this);
+      worker->Create();
+      worker->SetName("SlideShowLookAhead");
+      worker->SetPriority(THREAD_PRIORITY_BELOW_NORMAL);
+      m_workers.push_back(worker);
+    }
+  }
+}
+
+void CBackgroundPicLoader::StopThread()
+{
+  m_bStopWorkers = true;
+  for (unsigned int i = 0; i < m_workers.size(); i++)
+  {
+    m_wantedEvent.Set();
+    m_workers[i]->StopThread();
+    delete m_workers[i];
+  }
+  m_workers.clear();
+
+  CThread::StopThread();
+
+  CSingleLock lock(m_lookAheadSection);
+  for (unsigned int i = 0; i < m_decoded.size(); i++)
+    Free(m_decoded[i]);
+  m_decoded.clear();
+  m_decoding.clear();
+  m_wanted.clear();
+  m_decodedSize = 0;
 }
 
 void CBackgroundPicLoader::Process()
@@ -84,34 +128,218 @@ void CBackgroundPicLoader::Process()
     {
       if (m_pCallback)
       {
-        CPicture pic;
+        SDecodedPic pic;
+        pic.iSlideNumber = m_iSlideNumber;
+        pic.strFileName = m_strFileName;
+        pic.maxWidth = m_maxWidth;
+        pic.maxHeight = m_maxHeight;
         DWORD start = timeGetTime();
-#ifndef HAS_SDL
-        IDirect3DTexture8 *pTexture = pic.Load(m_strFileName, m_maxWidth, m_maxHeight);
-#else
-        SDL_Surface *pTexture = pic.Load(m_strFileName, m_maxWidth, m_maxHeight);
-#endif
+
+        // take it from the look ahead if it's there or on its way, otherwise
+        // decode it here, keeping the workers off it while we do
+        bool bDecode = false;
+        bool bDone = false;
+        const unsigned int estimate = pic.maxWidth * pic.maxHeight * 4;
+        while (!bDone && !m_bStop)
+        {
+          CSingleLock lock(m_lookAheadSection);
+          bDone = true;
+          for (unsigned int i = 0; i < m_decoded.size(); i++)
+          {
+            if (m_decoded[i].Matches(pic.iSlideNumber, pic.strFileName, pic.maxWidth, pic.maxHeight))
+            {
+              pic = m_decoded[i];
+              m_decodedSize -= pic.iWidth * pic.iHeight * 4;
+              m_decoded.erase(m_decoded.begin() + i);
+              Unwant(pic);
+              break;
+            }
+          }
+          if (pic.pTexture)
+            break;
+          for (unsigned int i = 0; i < m_decoding.size(); i++)
+          {
+            if (m_decoding[i].Matches(pic.iSlideNumber, pic.strFileName, pic.maxWidth, pic.maxHeight))
+              bDone = false;
+          }
+          if (bDone)
+          {
+            m_decoding.push_back(pic);
+            m_decodedSize += estimate;
+            Unwant(pic);
+            bDecode = true;
+          }
+          else
+          {
+            lock.Leave();
+            m_decodedEvent.WaitMSec(10);
+          }
+        }
+
+        if (bDecode)
+        {
+          Decode(pic);
+          CSingleLock lock(m_lookAheadSection);
+          for (unsigned int i = 0; i < m_decoding.size(); i++)
+          {
+            if (m_decoding[i].Matches(pic.iSlideNumber, pic.strFileName, pic.maxWidth, pic.maxHeight))
+            {
+              m_decoding.erase(m_decoding.begin() + i);
+              m_decodedSize -= estimate;
+              break;
+            }
+          }
+        }
+        if (m_bStop)
+          break;
         totalTime += timeGetTime() - start;
         count++;
         // tell our parent
-        bool bFullSize = ((int)pic.GetWidth() < m_maxWidth) && ((int)pic.GetHeight() < m_maxHeight);
-        if (!bFullSize)
-        {
-          int iSize = pic.GetWidth() * pic.GetHeight() - MAX_PICTURE_SIZE;
-          if ((iSize + (int)pic.GetWidth() > 0) || (iSize + (int)pic.GetHeight() > 0))
-            bFullSize = true;
-          if (!bFullSize && pic.GetWidth() == g_graphicsContext.GetMaxTextureSize())
-            bFullSize = true;
-          if (!bFullSize && pic.GetHeight() == g_graphicsContext.GetMaxTextureSize())
-            bFullSize = true;
-        }
-        m_pCallback->OnLoadPic(m_iPic, m_iSlideNumber, pTexture, pic.GetWidth(), pic.GetHeight(), pic.GetOriginalWidth(), pic.GetOriginalHeight(), pic.GetExifInfo()->Orientation, bFullSize);
+        m_pCallback->OnLoadPic(m_iPic, pic.iSlideNumber, pic.pTexture, pic.iWidth, pic.iHeight, pic.iOriginalWidth, pic.iOriginalHeight, pic.iRotate, pic.bFullSize);
         m_isLoading = false;
       }
     }
   }
   CLog::Log(LOGDEBUG, "Time for loading %u images: %u ms, average %u ms",
-            count, totalTime, totalTime / count);
+            count, totalTime, count ? totalTime / count : 0);
+}
+
+void CBackgroundPicLoader::Run()
+{
+  while (!m_bStopWorkers)
+  {
+    SDecodedPic pic;
+    bool bFound = false;
+    {
+      CSingleLock lock(m_lookAheadSection);
+      const unsigned int budget = g_advancedSettings.m_slideshowLookAheadMemory * 1024 * 1024;
+      const unsigned int estimate = m_wantedWidth * m_wantedHeight * 4;
+      for (unsigned int i = 0; i < m_wanted.size() && !bFound; i++)
+      {
+        const int slide = m_wanted[i].first;
+        const CStdString &file = m_wanted[i].second;
+        bool bHave = false;
+        for (unsigned int j = 0; j < m_decoded.size() && !bHave; j++)
+          bHave = m_decoded[j].Matches(slide, file, m_wantedWidth, m_wantedHeight);
+        for (unsigned int j = 0; j < m_decoding.size() && !bHave; j++)
+          bHave = m_decoding[j].Matches(slide, file, m_wantedWidth, m_wantedHeight);
+        if (bHave)
+          continue;
+        if (m_decodedSize + estimate > budget)
+          break; // the rest are further away
+
+        pic.iSlideNumber = slide;
+        pic.strFileName = file;
+        pic.maxWidth = m_wantedWidth;
+        pic.maxHeight = m_wantedHeight;
+        m_decoding.push_back(pic);
+        m_decodedSize += estimate;
+        bFound = true;
+      }
+    }
+    if (!bFound)
+    {
+      m_wantedEvent.WaitMSec(100);
+      continue;
+    }
+
+    Decode(pic);
+
+    CSingleLock lock(m_lookAheadSection);
+    for (unsigned int i = 0; i < m_decoding.size(); i++)
+    {
+      if (m_decoding[i].Matches(pic.iSlideNumber, pic.strFileName, pic.maxWidth, pic.maxHeight))
+      {
+        m_decoding.erase(m_decoding.begin() + i);
+        m_decodedSize -= pic.maxWidth * pic.maxHeight * 4;
+        break;
+      }
+    }
+    if (pic.pTexture && !m_bStopWorkers && IsWanted(pic))
+    {
+      m_decoded.push_back(pic);
+      m_decodedSize += pic.iWidth * pic.iHeight * 4;
+    }
+    else
+      Free(pic); // the user has moved on while we were at it
+    m_decodedEvent.Set();
+  }
+}
+
+void CBackgroundPicLoader::Decode(SDecodedPic &pic)
+{
+  CPicture picture;
+  pic.pTexture = picture.Load(pic.strFileName, pic.maxWidth, pic.maxHeight);
+  pic.iWidth = picture.GetWidth();
+  pic.iHeight = picture.GetHeight();
+  pic.iOriginalWidth = picture.GetOriginalWidth();
+  pic.iOriginalHeight = picture.GetOriginalHeight();
+  pic.iRotate = picture.GetExifInfo()->Orientation;
+
+  pic.bFullSize = (pic.iWidth < pic.maxWidth) && (pic.iHeight < pic.maxHeight);
+  if (!pic.bFullSize)
+  {
+    int iSize = pic.iWidth * pic.iHeight - MAX_PICTURE_SIZE;
+    if ((iSize + pic.iWidth > 0) || (iSize + pic.iHeight > 0))
+      pic.bFullSize = true;
+    if (!pic.bFullSize && pic.iWidth == g_graphicsContext.GetMaxTextureSize())
+      pic.bFullSize = true;
+    if (!pic.bFullSize && pic.iHeight == g_graphicsContext.GetMaxTextureSize())
+      pic.bFullSize = true;
+  }
+}
+
+void CBackgroundPicLoader::Free(SDecodedPic &pic)
+{
+  if (!pic.pTexture)
+    return;
+#ifndef HAS_SDL
+  pic.pTexture->Release();
+#else
+  SDL_FreeSurface(pic.pTexture);
+#endif
+  pic.pTexture = NULL;
+}
+
+bool CBackgroundPicLoader::IsWanted(const SDecodedPic &pic) const
+{
+  for (unsigned int i = 0; i < m_wanted.size(); i++)
+  {
+    if (pic.Matches(m_wanted[i].first, m_wanted[i].second, m_wantedWidth, m_wantedHeight))
+      return true;
+  }
+  return false;
+}
+
+// the slide is handed out, so the workers must not decode it again. it's
+// wanted again if a later look ahead lists it.
+void CBackgroundPicLoader::Unwant(const SDecodedPic &pic)
+{
+  for (int i = (int)m_wanted.size() - 1; i >= 0; i--)
+  {
+    if (pic.Matches(m_wanted[i].first, m_wanted[i].second, m_wantedWidth, m_wantedHeight))
+      m_wanted.erase(m_wanted.begin() + i);
+  }
+}
+
+void CBackgroundPicLoader::SetLookAhead(const std::vector< std::pair<int, CStdString> > &slides, const int maxWidth, const int maxHeight)
+{
+  CSingleLock lock(m_lookAheadSection);
+  m_wanted = slides;
+  m_wantedWidth = maxWidth;
+  m_wantedHeight = maxHeight;
+
+  // drop what's no longer near, anything still decoding is dropped when it's done
+  for (int i = (int)m_decoded.size() - 1; i >= 0; i--)
+  {
+    if (!IsWanted(m_decoded[i]))
+    {
+      m_decodedSize -= m_decoded[i].iWidth * m_decoded[i].iHeight * 4;
+      Free(m_decoded[i]);
+      m_decoded.erase(m_decoded.begin() + i);
+    }
+  }
+  m_wantedEvent.Set();
 }
 
 void CBackgroundPicLoader::LoadPic(int iPic, int iSlideNumber, const CStdString &strFileName, const int maxWidth, const int maxHeight)
@@ -160,6 +388,9 @@ void CGUIWindowSlideShow::Reset()
   m_iCurrentSlide = 0;
   m_iNextSlide = 1;
   m_iCurrentPic = 0;
+  m_iLookAheadSlide = -1;
+  m_iLookAheadNext = -1;
+  m_iLookAheadZoom = 0;
   CSingleLock lock(m_slideSection);
   m_slides->Clear();
   m_Resolution = INVALID;
@@ -288,6 +519,8 @@ void CGUIWindowSlideShow::Render()
     m_pBackgroundLoader->Create(this);
   }
 
+  UpdateLookAhead();
+
   bool bSlideShow = m_bSlideShow && !m_bPause;
 
   if (m_bErrorMessage)
@@ -780,11 +1013,50 @@ void CGUIWindowSlideShow::OnLoadPic(int iPic, int iSlideNumber, SDL_Surface* pTe
   }
 }
 
+void CGUIWindowSlideShow::UpdateLookAhead()
+{
+  if (m_iLookAheadSlide == m_iCurrentSlide && m_iLookAheadNext == m_iNextSlide && m_iLookAheadZoom == m_iZoomFactor)
+    return;
+  m_iLookAheadSlide = m_iCurrentSlide;
+  m_iLookAheadNext = m_iNextSlide;
+  m_iLookAheadZoom = m_iZoomFactor;
+
+  // same size as the next image is loaded at
+  int maxWidth, maxHeight;
+  GetCheckedSize((float)g_settings.m_ResInfo[m_Resolution].iWidth * zoomamount[m_iZoomFactor - 1],
+                 (float)g_settings.m_ResInfo[m_Resolution].iHeight * zoomamount[m_iZoomFactor - 1],
+                 maxWidth, maxHeight);
+
+  // the way we're going first, starting with the next slide, then back the other way
+  std::vector< std::pair<int, CStdString> > slides;
+  {
+    CSingleLock lock(m_slideSection);
+    int iSlides = m_slides->Size();
+    if (iSlides < 2)
+      return;
+    int direction = (m_iNextSlide == (m_iCurrentSlide + iSlides - 1) % iSlides) ? -1 : 1;
+    int ahead = g_advancedSettings.m_slideshowLookAhead;
+    int behind = g_advancedSettings.m_slideshowLookBehind;
+    for (int i = 0; i < ahead + behind; i++)
+    {
+      int offset = (i < ahead) ? (i + 1) * direction : -(i - ahead + 1) * direction;
+      int slide = ((m_iCurrentSlide + offset) % iSlides + iSlides) % iSlides;
+      bool bListed = (slide == m_iCurrentSlide);
+      for (unsigned int j = 0; j < slides.size() && !bListed; j++)
+        bListed = (slides[j].first == slide);
+      if (!bListed)
+        slides.push_back(std::make_pair(slide, m_slides->Get(slide)->m_strPath));
+    }
+  }
+  m_pBackgroundLoader->SetLookAhead(slides, maxWidth, maxHeight);
+}
+
 void CGUIWindowSlideShow::Shuffle()
 {
   m_slides->Randomize();
   m_iCurrentSlide = 0;
   m_iNextSlide = 1;
+  m_iLookAheadSlide = -1;
 }
 
 int CGUIWindowSlideShow::NumSlides() const
@@ -28,22 +28,65 @@
 #include "DllImageLib.h"
 #include "Stopwatch.h"
 
+#include <vector>
+
 class CFileItemList;
 
 class CGUIWindowSlideShow;
 
-class CBackgroundPicLoader : public CThread
+// loads the pictures the slideshow asks for with LoadPic() on its own thread.
+// the slides around the current one, as given by SetLookAhead(), are decoded
+// in advance by a couple of workers and kept until asked for, as long as they
+// fit in the <slideshow><lookaheadmemory> budget.
+class CBackgroundPicLoader : public CThread, public IRunnable
 {
 public:
   CBackgroundPicLoader();
   ~CBackgroundPicLoader();
 
   void Create(CGUIWindowSlideShow *pCallback);
+  virtual void StopThread();
   void LoadPic(int iPic, int iSlideNumber, const CStdString &strFileName, const int maxWidth, const int maxHeight);
   bool IsLoading() { return m_isLoading;};
 
+  // slide number and file of the slides wanted next, most wanted first.
+  // anything decoded or queued that isn't in the list is dropped.
+  void SetLookAhead(const std::vector< std::pair<int, CStdString> > &slides, const int maxWidth, const int maxHeight);
+
 private:
+  struct SDecodedPic
+  {
+    int iSlideNumber;
+    CStdString strFileName;
+    int maxWidth;
+    int maxHeight;
+#ifndef HAS_SDL
+    LPDIRECT3DTEXTURE8 pTexture;
+#else
+    SDL_Surface* pTexture;
+#endif
+    int iWidth;
+    int iHeight;
+    int iOriginalWidth;
+    int iOriginalHeight;
+    int iRotate;
+    bool bFullSize;
+
+    SDecodedPic() : iSlideNumber(-1), maxWidth(0), maxHeight(0), pTexture(NULL), iWidth(0), iHeight(0),
+                    iOriginalWidth(0), iOriginalHeight(0), iRotate(0), bFullSize(false) {}
+    bool Matches(int slide, const CStdString &file, int width, int height) const
+    {
+      return iSlideNumber == slide && maxWidth == width && maxHeight == height && strFileName == file;
+    }
+  };
+
   void Process();
+  virtual void Run(); // look ahead worker
+  static void Decode(SDecodedPic &pic);
+  static void Free(SDecodedPic &pic);
+  bool IsWanted(const SDecodedPic &pic) const;
+  void Unwant(const SDecodedPic &pic);
+
   int m_iPic;
   int m_iSlideNumber;
   CStdString m_strFileName;
@@ -54,6 +97,19 @@ private:
   bool m_isLoading;
 
   CGUIWindowSlideShow *m_pCallback;
+
+  // look ahead, all under m_lookAheadSection
+  CCriticalSection m_lookAheadSection;
+  std::vector< std::pair<int, CStdString> > m_wanted;
+  int m_wantedWidth;
+  int m_wantedHeight;
+  std::vector<SDecodedPic> m_decoded;
+  std::vector<SDecodedPic> m_decoding;   // being worked on, no texture yet
+  unsigned int m_decodedSize;            // bytes held by m_decoded and m_decoding
+  CEvent m_wantedEvent;
+  CEvent m_decodedEvent;
+  volatile bool m_bStopWorkers;
+  std::vector<CThread*> m_workers;
 };
 
 class CGUIWindowSlideShow : public CGUIWindow
@@ -98,6 +154,7 @@ private:
   void Move(float fX, float fY);
   void GetCheckedSize(float width, float height, int &maxWidth, int &maxHeight);
   void UpdateDescription();
+  void UpdateLookAhead();
 
   int m_iCurrentSlide;
   int m_iNextSlide;
@@ -119,6 +176,9 @@ private:
   bool m_bWaitForNextPic;
   bool m_bLoadNextPic;
   bool m_bReloadImage;
+  int m_iLookAheadSlide;   // the current slide when the look ahead was last set
+  int m_iLookAheadNext;
+  int m_iLookAheadZoom;
   DllImageLib m_ImageLib;
   RESOLUTION m_Resolution;
   CStopWatch stopwatch;
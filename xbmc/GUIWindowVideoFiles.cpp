@@ -41,6 +41,7 @@
 #include "GUIDialogYesNo.h"
 #include "FileSystem/File.h"
 #include "PlayList.h"
+#include "DirectoryFingerprints.h"
 
 using namespace std;
 using namespace MEDIA_DETECT;
@@ -479,6 +480,11 @@ void CGUIWindowVideoFiles::OnUnAssignContent(int iItem)
   {
     m_database.RemoveContentForPath(m_vecItems->Get(iItem)->m_strPath,m_dlgProgress);
     CUtil::DeleteVideoDatabaseDirectoryCache();
+
+    CDirectoryFingerprints fingerprints(FINGERPRINTS_VIDEO);
+    fingerprints.Load();
+    fingerprints.Remove(m_vecItems->Get(iItem)->m_strPath);
+    fingerprints.Save();
   }
   else
   {
@@ -1074,9 +1074,12 @@ void CGUIWindowVideoNav::FilterItems(CFileItemList &items)
   for (int i = 0; i < m_unfilteredItems->Size(); i++)
   {
     CFileItemPtr item = m_unfilteredItems->Get(i);
+    // the tag is only read, through the const item. one without a tag is unwatched
+    const CVideoInfoTag *tag = ((const CFileItem *)item.get())->GetVideoInfoTag();
+    bool watched = tag && tag->m_playCount > 0;
     if (item->IsParentFolder()         ||
       (filter.IsEmpty() && (!filterWatched               ||
-      (item->GetVideoInfoTag()->m_playCount>0) == (g_stSettings.m_iMyVideoWatchMode==2))))
+      watched == (g_stSettings.m_iMyVideoWatchMode==2))))
     {
       if ((params.GetContentType() != VIDEODB_CONTENT_MOVIES  && params.GetContentType() != VIDEODB_CONTENT_MUSICVIDEOS) || !items.Contains(item->m_strPath))
         items.Add(item);
@@ -1100,7 +1103,7 @@ void CGUIWindowVideoNav::FilterItems(CFileItemList &items)
 
     size_t pos = StringUtils::FindWords(match.c_str(), filter.c_str());
     if (pos != CStdString::npos &&
-       (!filterWatched || (item->GetVideoInfoTag()->m_playCount>0) == (g_stSettings.m_iMyVideoWatchMode==2)))
+       (!filterWatched || watched == (g_stSettings.m_iMyVideoWatchMode==2)))
     {
       if ((params.GetContentType() != VIDEODB_CONTENT_MOVIES && params.GetContentType() != VIDEODB_CONTENT_MUSICVIDEOS) || !items.Contains(item->m_strPath))
         items.Add(item); 
@@ -84,7 +84,7 @@ bool CMusicInfoLoader::LoadAdditionalTagInfo(CFileItem* pItem)
 
   CStdString path(pItem->m_strPath);
   if (pItem->IsMusicDb())
-    path = pItem->GetMusicInfoTag()->GetURL();
+    path = ((const CFileItem*)pItem)->GetMusicInfoTag()->GetURL();
 
   CLog::Log(LOGDEBUG, "Loading additional tag info for file %s", path.c_str());
 
@@ -110,7 +110,10 @@ bool CMusicInfoLoader::LoadItem(CFileItem* pItem)
   if (pItem->m_bIsFolder || pItem->IsPlayList() || pItem->IsNFO() || pItem->IsInternetStream())
     return false;
 
-  if (pItem->HasMusicInfoTag() && pItem->GetMusicInfoTag()->Loaded())
+  // read through the const item, a tag that is already loaded stays shared
+  // with the listing the item was copied from
+  const CFileItem &item = *pItem;
+  if (item.HasMusicInfoTag() && item.GetMusicInfoTag()->Loaded())
     return true;
 
   // first check the cached item
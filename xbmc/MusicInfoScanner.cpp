@@ -50,11 +50,12 @@ using namespace MUSIC_INFO;
 using namespace DIRECTORY;
 using namespace MUSIC_GRABBER;
 
-CMusicInfoScanner::CMusicInfoScanner()
+CMusicInfoScanner::CMusicInfoScanner() : m_fingerprints(FINGERPRINTS_MUSIC)
 {
   m_bRunning = false;
   m_pObserver = NULL;
   m_bCanInterrupt = false;
+  m_bScanAll = false;
   m_currentItem=0;
   m_itemCount=0;
 }
@@ -91,6 +92,8 @@ void CMusicInfoScanner::Process()
       m_currentItem=0;
       m_itemCount=-1;
 
+      m_fingerprints.Load();
+
       // Create the thread to count all files to be scanned
       SetPriority(THREAD_PRIORITY_IDLE);
       CThread fileCountReader(this);
@@ -134,6 +137,9 @@ void CMusicInfoScanner::Process()
       //  m_musicDatabase.RollbackTransaction();
 
       fileCountReader.StopThread();
+      if (commit && m_bScanAll)
+        m_fingerprints.RemoveUnseen();
+      m_fingerprints.Save();
 
       m_musicDatabase.EmptyCache();
 
@@ -217,6 +223,7 @@ void CMusicInfoScanner::Start(const CStdString& strDirectory)
   }
   else
     m_pathsToScan.insert(strDirectory);
+  m_bScanAll = strDirectory.IsEmpty();
   m_pathsToCount = m_pathsToScan;
   m_scanType = 0;
   StopThread();
@@ -328,22 +335,41 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
   if (m_pObserver)
     m_pObserver->OnDirectoryChanged(strDirectory);
 
+  // if nothing has been added, removed or renamed since the hash in the database
+  // was taken, the directory doesn't need listing - only its subfolders are needed
+  CStdString stamp, hash, dbHash;
+  CDirectoryFingerprints::SEntry entry;
+  bool bStamp = g_advancedSettings.m_bMusicLibraryFingerprints && CDirectoryFingerprints::GetStamp(strDirectory, stamp);
+  bool bUnchanged = bStamp && m_fingerprints.Lookup(strDirectory, stamp, entry) &&
+                    m_musicDatabase.GetPathHash(strDirectory, dbHash) && !dbHash.IsEmpty() && dbHash == entry.hash;
+
   // load subfolder
   CFileItemList items;
-  CDirectory::GetDirectory(strDirectory, items, g_stSettings.m_musicExtensions + "|.jpg|.tbn");
+  int numFilesInFolder;
+  if (bUnchanged)
+  {
+    CDirectoryFingerprints::GetFolders(entry, items);
+    hash = entry.hash;
+    numFilesInFolder = entry.count;
+  }
+  else
+  {
+    CDirectory::GetDirectory(strDirectory, items, g_stSettings.m_musicExtensions + "|.jpg|.tbn");
 
-  // sort and get the path hash.  Note that we don't filter .cue sheet items here as we want
-  // to detect changes in the .cue sheet as well.  The .cue sheet items only need filtering
-  // if we have a changed hash.
-  items.Sort(SORT_METHOD_LABEL, SORT_ORDER_ASC);
-  CStdString hash;
-  GetPathHash(items, hash);
+    // sort and get the path hash.  Note that we don't filter .cue sheet items here as we want
+    // to detect changes in the .cue sheet as well.  The .cue sheet items only need filtering
+    // if we have a changed hash.
+    items.Sort(SORT_METHOD_LABEL, SORT_ORDER_ASC);
+    numFilesInFolder = GetPathHash(items, hash);
+
+    // get the folder's thumb (this will cache the album thumb).
+    items.SetMusicThumb(true); // true forces it to get a remote thumb
 
-  // get the folder's thumb (this will cache the album thumb).
-  items.SetMusicThumb(true); // true forces it to get a remote thumb
+    if (bStamp)
+      m_fingerprints.Set(strDirectory, stamp, hash, numFilesInFolder, items);
+  }
 
   // check whether we need to rescan or not
-  CStdString dbHash;
   if (!m_musicDatabase.GetPathHash(strDirectory, dbHash) || dbHash != hash)
   { // path has changed - rescan
     if (dbHash.IsEmpty())
@@ -368,7 +394,7 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
   else
   { // path is the same - no need to rescan
     CLog::Log(LOGDEBUG, "%s Skipping dir '%s' due to no change", __FUNCTION__, strDirectory.c_str());
-    m_currentItem += CountFiles(items, false);  // false for non-recursive
+    m_currentItem += numFilesInFolder;
 
     // notify our observer of our progress
     if (m_pObserver)
@@ -678,14 +704,24 @@ int CMusicInfoScanner::CountFilesRecursively(const CStdString& strPath)
 {
   // load subfolder
   CFileItemList items;
+  int count = 0;
 //  CLog::Log(LOGDEBUG, __FUNCTION__" - processing dir: %s", strPath.c_str());
-  CDirectory::GetDirectory(strPath, items, g_stSettings.m_musicExtensions, false);
+  CStdString stamp;
+  CDirectoryFingerprints::SEntry entry;
+  if (g_advancedSettings.m_bMusicLibraryFingerprints && CDirectoryFingerprints::GetStamp(strPath, stamp) &&
+      m_fingerprints.Lookup(strPath, stamp, entry))
+  { // only an estimate for the progress, no need to check the database
+    CDirectoryFingerprints::GetFolders(entry, items);
+    count = entry.count;
+  }
+  else
+    CDirectory::GetDirectory(strPath, items, g_stSettings.m_musicExtensions, false);
 
   if (m_bStop)
     return 0;
 
   // true for recursive counting
-  int count = CountFiles(items, true);
+  count += CountFiles(items, true);
 
   // remove this path from the list we're processing
   set<CStdString>::iterator it = m_pathsToCount.find(strPath);
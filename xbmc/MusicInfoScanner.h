@@ -22,6 +22,7 @@
 #include "utils/Thread.h"
 #include "MusicDatabase.h"
 #include "MusicAlbumInfo.h"
+#include "DirectoryFingerprints.h"
 
 class CAlbum;
 class CArtist;
@@ -79,7 +80,9 @@ protected:
   bool m_bCanInterrupt;
   bool m_needsCleanup;
   int m_scanType; // 0 - load from files, 1 - albums, 2 - artists
+  bool m_bScanAll; // every path in the database, not just one
   CMusicDatabase m_musicDatabase;
+  CDirectoryFingerprints m_fingerprints;
 
   std::set<CStdString> m_pathsToScan;
   std::set<CAlbum> m_albumsToScan;
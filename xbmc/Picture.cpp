@@ -25,6 +25,7 @@
 #include "Settings.h"
 #include "FileItem.h"
 #include "FileSystem/File.h"
+#include "utils/JpegDecoder.h"
 
 using namespace XFILE;
 
@@ -44,13 +45,21 @@ IDirect3DTexture8* CPicture::Load(const CStdString& strFileName, int iMaxWidth,
 SDL_Surface* CPicture::Load(const CStdString& strFileName, int iMaxWidth, int iMaxHeight)
 #endif
 {
-  if (!m_dll.Load()) return NULL;
-
   memset(&m_info, 0, sizeof(ImageInfo));
-  if (!m_dll.LoadImage(strFileName.c_str(), iMaxWidth, iMaxHeight, &m_info))
+#ifdef _LINUX
+  BYTE *pixels = LoadJpeg(strFileName, iMaxWidth, iMaxHeight, false);
+#else
+  BYTE *pixels = NULL;
+#endif
+  if (!pixels)
   {
-    CLog::Log(LOGERROR, "PICTURE: Error loading image %s", strFileName.c_str());
-    return NULL;
+    if (!m_dll.Load()) return NULL;
+
+    if (!m_dll.LoadImage(strFileName.c_str(), iMaxWidth, iMaxHeight, &m_info))
+    {
+      CLog::Log(LOGERROR, "PICTURE: Error loading image %s", strFileName.c_str());
+      return NULL;
+    }
   }
 #ifndef HAS_SDL
   LPDIRECT3DTEXTURE8 pTexture = NULL;
@@ -72,25 +81,36 @@ SDL_Surface* CPicture::Load(const CStdString& strFileName, int iMaxWidth, int iM
       DWORD destPitch = lr.Pitch;
       // CxImage aligns rows to 4 byte boundaries
       DWORD srcPitch = ((m_info.width + 1)* 3 / 4) * 4;
-      BYTE *pixels = (BYTE *)lr.pBits;
+      BYTE *dest = (BYTE *)lr.pBits;
 #else
     if (SDL_LockSurface(pTexture) == 0)
     {
       DWORD destPitch = pTexture->pitch;
       DWORD srcPitch = ((m_info.width + 1)* 3 / 4) * 4; 
-      BYTE *pixels = (BYTE *)pTexture->pixels;
+      BYTE *dest = (BYTE *)pTexture->pixels;
 #endif
       for (unsigned int y = 0; y < m_info.height; y++)
       {
-        BYTE *dst = pixels + y * destPitch;
+        BYTE *dst = dest + y * destPitch;
+        if (pixels)
+        { // already BGRA and top down
+          memcpy(dst, pixels + y * m_info.width * 4, m_info.width * 4);
+          continue;
+        }
+        // CxImage gives bottom up BGR
         BYTE *src = m_info.texture + (m_info.height - 1 - y) * srcPitch;
+        if (!m_info.alpha)
+        {
+          SwizzleRow(dst, src, m_info.width, false);
+          continue;
+        }
         BYTE *alpha = m_info.alpha + (m_info.height - 1 - y) * m_info.width;
         for (unsigned int x = 0; x < m_info.width; x++)
         {
           *dst++ = *src++;
           *dst++ = *src++;
           *dst++ = *src++;
-          *dst++ = (m_info.alpha) ? *alpha++ : 0xff;  // alpha
+          *dst++ = *alpha++;
         }
       }
   
@@ -101,10 +121,44 @@ SDL_Surface* CPicture::Load(const CStdString& strFileName, int iMaxWidth, int iM
 #endif
     }
   }
-  m_dll.ReleaseImage(&m_info);
+  if (pixels)
+    delete[] pixels;
+  else
+    m_dll.ReleaseImage(&m_info);
   return pTexture;
 }
 
+#ifdef _LINUX
+BYTE* CPicture::LoadJpeg(const CStdString& strFileName, unsigned int iMaxWidth, unsigned int iMaxHeight, bool bRotate)
+{
+  CFile file;
+  if (!file.Open(strFileName))
+    return NULL;
+
+  // check the SOI marker before pulling in the whole file
+  BYTE soi[2];
+  __int64 length = file.GetLength();
+  if (length < 4 || length > 64 * 1024 * 1024 || file.Read(soi, 2) != 2 || soi[0] != 0xFF || soi[1] != 0xD8)
+    return NULL;
+
+  BYTE *data = new BYTE[(unsigned int)length];
+  memcpy(data, soi, 2);
+  unsigned int pos = 2;
+  while (pos < length)
+  {
+    unsigned int read = file.Read(data + pos, length - pos);
+    if (read == 0)
+      break;
+    pos += read;
+  }
+  file.Close();
+
+  BYTE *pixels = DecodeJpeg(data, pos, iMaxWidth, iMaxHeight, bRotate, m_info);
+  delete[] data;
+  return pixels;
+}
+#endif
+
 bool CPicture::DoCreateThumbnail(const CStdString& strFileName, const CStdString& strThumbFileName, bool checkExistence /*= false*/)
 {
   // don't create the thumb if it already exists
@@ -133,6 +187,17 @@ bool CPicture::DoCreateThumbnail(const CStdString& strFileName, const CStdString
     if (!m_dll.Load()) return false;
   
     memset(&m_info, 0, sizeof(ImageInfo));
+#ifdef _LINUX
+    // ImageLib decodes at full size before scaling, do jpegs at reduced size ourselves
+    BYTE *pixels = LoadJpeg(strFileName, g_advancedSettings.m_thumbSize, g_advancedSettings.m_thumbSize, g_guiSettings.GetBool("pictures.useexifrotation"));
+    if (pixels)
+    {
+      bool success = m_dll.CreateThumbnailFromSurface(pixels, m_info.width, m_info.height, m_info.width * 4, strThumbFileName.c_str());
+      delete[] pixels;
+      if (success)
+        return true;
+    }
+#endif
     if (!m_dll.CreateThumbnail(strFileName.c_str(), strThumbFileName.c_str(), g_advancedSettings.m_thumbSize, g_advancedSettings.m_thumbSize, g_guiSettings.GetBool("pictures.useexifrotation")))
     {
       CLog::Log(LOGERROR, "PICTURE::DoCreateThumbnail: Unable to create thumbfile %s from image %s", strThumbFileName.c_str(), strFileName.c_str());
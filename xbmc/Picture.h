@@ -60,7 +60,15 @@ public:
   bool CacheSkinImage(const CStdString &srcFile, const CStdString &destFile);
 
 protected:
-  
+#ifdef _LINUX
+  // decodes a jpeg straight to a BGRA buffer of m_info.width * m_info.height,
+  // letting libjpeg drop DCT coefficients when the image is larger than
+  // needed. returns NULL if the file isn't a jpeg we can handle, or when it
+  // needs rotating and bRotate is set, so the caller can fall back to ImageLib.
+  // the buffer is to be delete[]'d.
+  BYTE* LoadJpeg(const CStdString& strFileName, unsigned int iMaxWidth, unsigned int iMaxHeight, bool bRotate);
+#endif
+
 private:
 #ifndef HAS_SDL
   struct VERTEX
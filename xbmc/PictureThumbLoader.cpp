@@ -105,16 +105,18 @@ void CPictureThumbLoader::OnLoaderFinish()
 
 bool CPictureThumbLoader::DownloadVideoThumb(CFileItem *item, const CStdString &cachedThumb)
 {
-  if (item->GetVideoInfoTag()->m_strPictureURL.m_url.size())
+  // only the thumb changes, the tag is read through the const item
+  const CVideoInfoTag *tag = ((const CFileItem *)item)->GetVideoInfoTag();
+  if (tag->m_strPictureURL.m_url.size())
   { // yep - download using this thumb
-    if (CScraperUrl::DownloadThumbnail(cachedThumb, item->GetVideoInfoTag()->m_strPictureURL.m_url[0]))
+    if (CScraperUrl::DownloadThumbnail(cachedThumb, tag->m_strPictureURL.m_url[0]))
       item->SetThumbnailImage(cachedThumb);
     else
       item->SetThumbnailImage("");
   }
-  else if (item->GetVideoInfoTag()->m_fanart.GetNumFanarts() > 0 && item->HasProperty("fanart_number"))
+  else if (tag->m_fanart.GetNumFanarts() > 0 && item->HasProperty("fanart_number"))
   { // yep - download our fanart preview
-    if (item->GetVideoInfoTag()->m_fanart.DownloadThumb(item->GetPropertyInt("fanart_number"), cachedThumb))
+    if (tag->m_fanart.DownloadThumb(item->GetPropertyInt("fanart_number"), cachedThumb))
       item->SetThumbnailImage(cachedThumb);
     else
       item->SetThumbnailImage("");
@@ -10,17 +10,33 @@
 #include <boost/regex.hpp>
 #include "stdafx.h"
 #include "PlexMediaServerScrobbler.h"
-#include "HTTP.h"
+#include "FileSystem/File.h"
+#include "FileSystem/FileCurl.h"
+#include "Settings.h"
 #include "URL.h"
 #include "Util.h"
+#include "tinyXML/tinyxml.h"
 
 using namespace boost;
+using namespace XFILE;
+
+#define SCROBBLE_RETRY_DELAY     5000     // ms before the first retry, doubles after each failure
+#define SCROBBLE_RETRY_MAX_DELAY 600000
+#define SCROBBLE_MAX_ATTEMPTS    20
+#define SCROBBLE_MAX_PENDING     500
+#define SCROBBLE_SPOOL_FILE      "PlexScrobbleSpool.xml"
 
 CPlexMediaServerScrobbler* CPlexMediaServerScrobbler::g_instance = 0;
 
+// If we have something like this: plex://localhost/music/iTunes/Artists/OST/58514/58486.mp3
+// Then we want to hit plex://localhost/:/scrobble?key=Artists/OST/58514/58486.mp3&prefix=audio/iTunes
+//
+static const regex g_scrobbleExpression("(plex://[^/]+/)([^/]+/[^/]+)/(.*)");
+
 ///////////////////////////////////////////////////////////////////////////////
 CPlexMediaServerScrobbler::CPlexMediaServerScrobbler()
   : m_acceptPlay(false)
+  , m_spoolDirty(false)
 {
   m_hWorkerEvent = CreateEvent(NULL, false, false, NULL);
   Create();
@@ -30,8 +46,10 @@ CPlexMediaServerScrobbler::CPlexMediaServerScrobbler()
 ///////////////////////////////////////////////////////////////////////////////
 CPlexMediaServerScrobbler::~CPlexMediaServerScrobbler()
 {
-  CloseHandle(m_hWorkerEvent);
+  m_bStop = true;
+  SetEvent(m_hWorkerEvent);
   StopThread();
+  CloseHandle(m_hWorkerEvent);
   CLog::Log(LOGINFO,"Plex Media Server scrobbler destroyed");
 }
 
@@ -39,80 +57,282 @@ CPlexMediaServerScrobbler::~CPlexMediaServerScrobbler()
 void CPlexMediaServerScrobbler::Process()
 {
   CLog::Log(LOGINFO,"Plex Media Server scrobbler running");
+  LoadSpool();
   
   while (!m_bStop)
   {
-    // Wait for an event.
-    WaitForSingleObject(m_hWorkerEvent, INFINITE);
+    // Wait for an event, or until the next retry is due.
+    DWORD wait = INFINITE;
+    DWORD now = timeGetTime();
+    for (size_t i=0; i<m_pending.size(); i++)
+    {
+      int due = m_pending[i]->dueIn(now);
+      DWORD delay = (due > 0) ? (DWORD)due : 0;
+      if (wait == INFINITE || delay < wait)
+        wait = delay;
+    }
+    
+    WaitForSingleObject(m_hWorkerEvent, wait);
     if (m_bStop)
       break;
     
-    for (bool done=false; done == false; )
+    // Take everything queued in one go, so a burst becomes a batch.
     {
-      // Pull items off and scrobble.
-      ::EnterCriticalSection(m_lock);
-      if (m_queue.size() > 0)
+      CSingleLock lock(m_lock);
+      while (m_queue.size() > 0)
       {
-        // Process and action.
-        ScrobbleActionPtr action = m_queue.front();
+        Merge(m_queue.front());
         m_queue.pop();
-        ::LeaveCriticalSection(m_lock);
-        
-        CURL url(action->url);
-        if (url.GetProtocol() == "plex")
-        {
-          printf("Scrobbling: %s\n", action->url.c_str());
-          
-          // If we have something like this: plex://localhost/music/iTunes/Artists/OST/58514/58486.mp3
-          // Then we want to hit plex://localhost/:/scrobble?key=Artists/OST/58514/58486.mp3&prefix=audio/iTunes
-          //
-          regex expression("(plex://[^/]+/)([^/]+/[^/]+)/(.*)"); 
-          cmatch what; 
-          if (regex_match(action->url.c_str(), what, expression))
-          {
-            CStdString base = (string)what[1];
-            CStdString prefix = "/" + (string)what[2];
-            CStdString key = (string)what[3];
-            
-            CUtil::URLEncode(prefix);
-            CUtil::URLEncode(key);
-            
-            // Build the final URL.
-            CStdString url = base;
-            url += ":/scrobble?key=";
-            url += key;
-            url += "&prefix=";
-            url += prefix;
-            url += "&verb=";
-            url += action->getVerb();
-            
-            if (action->param.size() > 0)
-            {
-              url += "&param=";
-              url += action->param;
-            }
-            
-            CURL theURL(url);
-                
-            theURL.SetProtocol("http");
-            theURL.SetPort(32400);
-            theURL.GetURL(url);
+      }
+    }
+    
+    SendPending();
+    
+    if (m_spoolDirty)
+      SaveSpool();
+  }
+  
+  // Whatever's left goes in the spool for next time.
+  {
+    CSingleLock lock(m_lock);
+    while (m_queue.size() > 0)
+    {
+      Merge(m_queue.front());
+      m_queue.pop();
+    }
+  }
+  if (m_spoolDirty)
+    SaveSpool();
+  
+  CLog::Log(LOGINFO,"Plex Media Server scrobbler thread terminated");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CPlexMediaServerScrobbler::Merge(const ScrobbleActionPtr& action)
+{
+  for (size_t i=0; i<m_pending.size(); i++)
+  {
+    ScrobbleActionPtr& pending = m_pending[i];
+    if (action->verb == RATE && pending->verb == RATE && pending->url == action->url)
+    {
+      // Only the last rating counts. Every play is reported, the server
+      // counts them.
+      //
+      pending->param = action->param;
+      m_spoolDirty = true;
+      return;
+    }
+  }
+  
+  if (m_pending.size() >= SCROBBLE_MAX_PENDING)
+  {
+    CLog::Log(LOGWARNING, "Plex Media Server scrobbler has too many actions pending, dropping %s of %s", m_pending[0]->getVerb().c_str(), m_pending[0]->url.c_str());
+    m_pending.erase(m_pending.begin());
+  }
+  
+  m_pending.push_back(action);
+  m_spoolDirty = true;
+}
 
-            // Make the request.
-            printf("Making request to %s\n", url.c_str());
-            CHTTP http;
-            http.Open(url, "GET", 0);
-          }
-        }        
+///////////////////////////////////////////////////////////////////////////////
+void CPlexMediaServerScrobbler::SendPending()
+{
+  bool sent = false;
+  DWORD now = timeGetTime();
+  
+  vector<ScrobbleActionPtr>::iterator it = m_pending.begin();
+  while (it != m_pending.end() && !m_bStop)
+  {
+    ScrobbleActionPtr action = *it;
+    if (action->dueIn(now) > 0)
+    {
+      ++it;
+      continue;
+    }
+    
+    SendResult result = Send(*action);
+    if (result == SEND_DONE)
+    {
+      it = m_pending.erase(it);
+      m_spoolDirty = true;
+      sent = true;
+      continue;
+    }
+    
+    DWORD delay = SCROBBLE_RETRY_DELAY;
+    for (int i=1; i<=action->attempts && delay < SCROBBLE_RETRY_MAX_DELAY; i++)
+      delay *= 2;
+    action->nextAttempt = now + min(delay, (DWORD)SCROBBLE_RETRY_MAX_DELAY);
+    
+    if (result == SEND_UNREACHABLE)
+    {
+      // Don't sit through a connect timeout for every other action, they all
+      // wait for this one. Once something gets through they're replayed below.
+      //
+      for (size_t i=0; i<m_pending.size(); i++)
+      {
+        ScrobbleActionPtr& other = m_pending[i];
+        if (other != action && other->dueIn(action->nextAttempt) <= 0)
+        {
+          other->attempts = max(other->attempts, 1);
+          other->nextAttempt = action->nextAttempt;
+        }
       }
-      else
+    }
+    
+    if (++action->attempts >= SCROBBLE_MAX_ATTEMPTS)
+    {
+      CLog::Log(LOGERROR, "Plex Media Server scrobbler giving up on %s of %s", action->getVerb().c_str(), action->url.c_str());
+      it = m_pending.erase(it);
+      m_spoolDirty = true;
+    }
+    else
+    {
+      ++it;
+    }
+    
+    if (result == SEND_UNREACHABLE)
+      break;
+  }
+  
+  // The server is back, replay anything that was waiting on it.
+  if (sent && !m_pending.empty())
+  {
+    for (size_t i=0; i<m_pending.size(); i++)
+    {
+      if (m_pending[i]->attempts > 0)
       {
-        // Nothing to process.
-        ::LeaveCriticalSection(m_lock);
-        done = true;
+        m_pending[i]->nextAttempt = now;
+        SetEvent(m_hWorkerEvent);
       }
     }
   }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+CPlexMediaServerScrobbler::SendResult CPlexMediaServerScrobbler::Send(const ScrobbleAction& action)
+{
+  CURL url(action.url);
+  if (url.GetProtocol() != "plex")
+    return SEND_DONE;
   
-  CLog::Log(LOGINFO,"Plex Media Server scrobbler thread terminated");
+  CLog::Log(LOGDEBUG, "Plex Media Server scrobbler sending %s of %s", action.getVerb().c_str(), action.url.c_str());
+  cmatch what; 
+  if (!regex_match(action.url.c_str(), what, g_scrobbleExpression))
+    return SEND_DONE;
+  
+  CStdString base = (string)what[1];
+  CStdString prefix = "/" + (string)what[2];
+  CStdString key = (string)what[3];
+  
+  CUtil::URLEncode(prefix);
+  CUtil::URLEncode(key);
+  
+  // Build the final URL.
+  CStdString strURL = base;
+  strURL += ":/scrobble?key=";
+  strURL += key;
+  strURL += "&prefix=";
+  strURL += prefix;
+  strURL += "&verb=";
+  strURL += action.getVerb();
+  
+  if (action.param.size() > 0)
+  {
+    strURL += "&param=";
+    strURL += action.param;
+  }
+  
+  CURL theURL(strURL);
+  
+  theURL.SetProtocol("http");
+  theURL.SetPort(32400);
+  theURL.GetURL(strURL);
+  
+  // Make the request, curl keeps the connection to the server open between requests.
+  CLog::Log(LOGDEBUG, "Plex Media Server scrobbler making request to %s", strURL.c_str());
+  CFileCurl http;
+  if (!http.Open(CURL(strURL)))
+  {
+    // Only worth trying again if the server wasn't there or had trouble, it
+    // won't like the same request any better later.
+    //
+    long response = http.GetHttpResponse();
+    if (response == 0)
+    {
+      CLog::Log(LOGWARNING, "Plex Media Server scrobbler unable to reach %s", strURL.c_str());
+      return SEND_UNREACHABLE;
+    }
+    if (response >= 500)
+    {
+      CLog::Log(LOGWARNING, "Plex Media Server scrobbler failed %s (%ld)", strURL.c_str(), response);
+      return SEND_RETRY;
+    }
+    
+    CLog::Log(LOGERROR, "Plex Media Server scrobbler dropping %s, rejected with %ld", strURL.c_str(), response);
+    return SEND_DONE;
+  }
+  http.Close();
+  return SEND_DONE;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CPlexMediaServerScrobbler::LoadSpool()
+{
+  CStdString strFile;
+  CUtil::AddFileToFolder(g_settings.GetProfileUserDataFolder(), SCROBBLE_SPOOL_FILE, strFile);
+  
+  TiXmlDocument doc;
+  if (!CFile::Exists(strFile) || !doc.LoadFile(strFile))
+    return;
+  
+  TiXmlElement* root = doc.RootElement();
+  for (TiXmlElement* action = root ? root->FirstChildElement("action") : 0; action; action = action->NextSiblingElement("action"))
+  {
+    const char* verb = action->Attribute("verb");
+    const char* param = action->Attribute("param");
+    if (!verb || !action->FirstChild())
+      continue;
+    
+    ScrobbleActionVerb theVerb = (strcmp(verb, "rate") == 0) ? RATE : PLAY;
+    Merge(ScrobbleActionPtr(new ScrobbleAction(theVerb, action->FirstChild()->Value(), param ? param : "")));
+  }
+  
+  CLog::Log(LOGINFO, "Plex Media Server scrobbler replaying %d spooled actions", (int)m_pending.size());
+  m_spoolDirty = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CPlexMediaServerScrobbler::SaveSpool()
+{
+  CStdString strFile;
+  CUtil::AddFileToFolder(g_settings.GetProfileUserDataFolder(), SCROBBLE_SPOOL_FILE, strFile);
+  m_spoolDirty = false;
+  
+  if (m_pending.empty())
+  {
+    if (CFile::Exists(strFile))
+      CFile::Delete(strFile);
+    return;
+  }
+  
+  TiXmlDocument doc;
+  TiXmlElement root("scrobbles");
+  TiXmlNode* rootNode = doc.InsertEndChild(root);
+  if (!rootNode)
+    return;
+  
+  for (size_t i=0; i<m_pending.size(); i++)
+  {
+    TiXmlElement action("action");
+    action.SetAttribute("verb", m_pending[i]->getVerb().c_str());
+    if (m_pending[i]->param.size() > 0)
+      action.SetAttribute("param", m_pending[i]->param.c_str());
+    TiXmlText url(m_pending[i]->url.c_str());
+    action.InsertEndChild(url);
+    rootNode->InsertEndChild(action);
+  }
+  
+  if (!doc.SaveFile(strFile))
+    CLog::Log(LOGERROR, "Plex Media Server scrobbler unable to save %s", strFile.c_str());
 }
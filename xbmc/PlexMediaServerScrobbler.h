@@ -12,6 +12,7 @@
 #include <boost/shared_ptr.hpp>
 #include <string>
 #include <queue>
+#include <vector>
 
 #include <boost/lexical_cast.hpp>
 #include "CriticalSection.h"
@@ -57,7 +58,7 @@ class CPlexMediaServerScrobbler : public CThread
     CSingleLock lock(m_lock);
     if (m_acceptPlay)
     {
-      printf("Queuing play of %s\n", url.c_str());
+      CLog::Log(LOGDEBUG, "Plex Media Server scrobbler queuing play of %s", url.c_str());
       m_queue.push(ScrobbleActionPtr(new ScrobbleAction(PLAY, url)));
       m_acceptPlay = false;
       SetEvent(m_hWorkerEvent);
@@ -85,9 +86,11 @@ class CPlexMediaServerScrobbler : public CThread
     ScrobbleAction(ScrobbleActionVerb verb, const string& url, const string& param="")
       : verb(verb)
       , url(url)
-      , param(param) {}
+      , param(param)
+      , attempts(0)
+      , nextAttempt(0) {}
     
-    string getVerb()
+    string getVerb() const
     {
       switch (verb)
       {
@@ -100,11 +103,38 @@ class CPlexMediaServerScrobbler : public CThread
     ScrobbleActionVerb verb;
     string url;
     string param;
+    /// Milliseconds until the next try, 0 or less if it's due. Compared as a
+    /// signed 32 bit difference so it survives the wrap of timeGetTime().
+    int dueIn(DWORD now) const
+    {
+      return attempts == 0 ? 0 : (int)(nextAttempt - now);
+    }
+    
+    int    attempts;      // failed sends so far, at least 1 while held back
+    DWORD  nextAttempt;   // timeGetTime() of the next try, once a send failed
   };
   typedef boost::shared_ptr<ScrobbleAction> ScrobbleActionPtr;
    
   void QueueAction();
   virtual void Process();
+  
+  /// Add to the pending actions, a rating replaces one pending for the same item.
+  void Merge(const ScrobbleActionPtr& action);
+  
+  /// Send the pending actions that are due, failures are retried later.
+  void SendPending();
+  
+  enum SendResult
+  {
+    SEND_DONE,         // sent, or refused by the server for good
+    SEND_RETRY,        // the server had trouble with it, try again later
+    SEND_UNREACHABLE   // no answer, nothing else will get through either
+  };
+  SendResult Send(const ScrobbleAction& action);
+  
+  /// Actions not sent yet survive a restart in the spool.
+  void LoadSpool();
+  void SaveSpool();
 
  private:
   static CPlexMediaServerScrobbler* g_instance;
@@ -113,5 +143,9 @@ class CPlexMediaServerScrobbler : public CThread
   HANDLE                   m_hWorkerEvent;
   CCriticalSection         m_lock;
   queue<ScrobbleActionPtr> m_queue;
+  
+  // Only touched by the scrobbler thread.
+  vector<ScrobbleActionPtr> m_pending;
+  bool                      m_spoolDirty;
 };
 
@@ -39,6 +39,7 @@
 #include "FileSystem/MultiPathDirectory.h"
 #include "GUIBaseContainer.h" // for VIEW_TYPE enum
 #include "utils/FanController.h"
+#include "utils/LockProfiler.h"
 #include "MediaManager.h"
 #include "XBVideoConfig.h"
 #include "DNSNameCache.h"
@@ -189,6 +190,7 @@ CSettings::CSettings(void)
   g_advancedSettings.m_DisableModChipDetection = true;
 
   g_advancedSettings.m_audioHeadRoom = 0;
+  g_advancedSettings.m_audioResampleQuality = 2; // RESAMPLE_QUALITY_MEDIUM
   g_advancedSettings.m_karaokeSyncDelay = 0.0f;
 
   g_advancedSettings.m_videoSubsDelayRange = 10;
@@ -206,6 +208,10 @@ CSettings::CSettings(void)
   g_advancedSettings.m_videoPercentSeekForwardBig = 10;
   g_advancedSettings.m_videoPercentSeekBackwardBig = -10;
   g_advancedSettings.m_videoBlackBarColour = 1;
+  g_advancedSettings.m_videoUsePBO = true;
+  g_advancedSettings.m_videoPBOBuffers = 3;
+  g_advancedSettings.m_videoDirectRendering = true;
+  g_advancedSettings.m_videoPictureQueueSize = 4;
   
   g_advancedSettings.m_musicUseTimeSeeking = true;
   g_advancedSettings.m_musicTimeSeekForward = 10;
@@ -220,6 +226,9 @@ CSettings::CSettings(void)
   g_advancedSettings.m_slideshowPanAmount = 2.5f;
   g_advancedSettings.m_slideshowZoomAmount = 5.0f;
   g_advancedSettings.m_slideshowBlackBarCompensation = 20.0f;
+  g_advancedSettings.m_slideshowLookAhead = 3;
+  g_advancedSettings.m_slideshowLookBehind = 1;
+  g_advancedSettings.m_slideshowLookAheadMemory = 64;
 
   g_advancedSettings.m_lcdRows = 4;
   g_advancedSettings.m_lcdColumns = 20;
@@ -234,6 +243,7 @@ CSettings::CSettings(void)
   g_advancedSettings.m_songInfoDuration = 10;
   g_advancedSettings.m_busyDialogDelay = 2000;
   g_advancedSettings.m_logLevel = LOG_LEVEL_NORMAL;
+  g_advancedSettings.m_lockProfiling = false;
   g_advancedSettings.m_cddbAddress = "freedb.freedb.org";
   g_advancedSettings.m_usePCDVDROM = false;
   g_advancedSettings.m_noDVDROM = false;
@@ -280,6 +290,7 @@ CSettings::CSettings(void)
   g_advancedSettings.m_bMusicLibraryHideAllItems = false;
   g_advancedSettings.m_bMusicLibraryAllItemsOnBottom = false;
   g_advancedSettings.m_bMusicLibraryAlbumsSortByArtistThenYear = false;
+  g_advancedSettings.m_bMusicLibraryFingerprints = false;
   g_advancedSettings.m_strMusicLibraryAlbumFormat = "";
   g_advancedSettings.m_strMusicLibraryAlbumFormatRight = "";
   g_advancedSettings.m_prioritiseAPEv2tags = false;
@@ -291,6 +302,8 @@ CSettings::CSettings(void)
   g_advancedSettings.m_bVideoLibraryHideRecentlyAddedItems = false;
   g_advancedSettings.m_bVideoLibraryHideEmptySeries = false;
   g_advancedSettings.m_bVideoLibraryCleanOnUpdate = false;
+  g_advancedSettings.m_videoScraperThreads = 4;
+  g_advancedSettings.m_bVideoLibraryFingerprints = false;
 
   g_advancedSettings.m_bUseEvilB = true;
 
@@ -304,6 +317,8 @@ CSettings::CSettings(void)
   g_advancedSettings.m_iTuxBoxZapWaitTime = 0; // Time in sec. Default 0:OFF
 
   g_advancedSettings.m_curlclienttimeout = 10;
+  g_advancedSettings.m_iDownloadThreads = 4;
+  g_advancedSettings.m_iDownloadsPerHost = 2;
 
 #ifdef HAS_SDL
   g_advancedSettings.m_fullScreen = false;
@@ -1204,6 +1219,7 @@ void CSettings::LoadAdvancedSettings()
   if (pElement)
   {
     GetInteger(pElement, "headroom", g_advancedSettings.m_audioHeadRoom, 0, 12);
+    GetInteger(pElement, "resamplequality", g_advancedSettings.m_audioResampleQuality, 0, 3);
     GetFloat(pElement, "karaokesyncdelay", g_advancedSettings.m_karaokeSyncDelay, -3.0f, 3.0f);
 
     XMLUtils::GetBoolean(pElement, "usetimeseeking", g_advancedSettings.m_musicUseTimeSeeking);
@@ -1238,6 +1254,10 @@ void CSettings::LoadAdvancedSettings()
     GetInteger(pElement, "percentseekforwardbig", g_advancedSettings.m_videoPercentSeekForwardBig, 0, 100);
     GetInteger(pElement, "percentseekbackwardbig", g_advancedSettings.m_videoPercentSeekBackwardBig, -100, 0);
     GetInteger(pElement, "blackbarcolour", g_advancedSettings.m_videoBlackBarColour, 0, 255);
+    XMLUtils::GetBoolean(pElement, "usepbo", g_advancedSettings.m_videoUsePBO);
+    GetInteger(pElement, "pbobuffers", g_advancedSettings.m_videoPBOBuffers, 2, 3); // NUM_BUFFERS in LinuxRendererGL.h
+    XMLUtils::GetBoolean(pElement, "directrendering", g_advancedSettings.m_videoDirectRendering);
+    GetInteger(pElement, "picturequeuesize", g_advancedSettings.m_videoPictureQueueSize, 0, 16);
   }
 
   pElement = pRootElement->FirstChildElement("musiclibrary");
@@ -1247,6 +1267,7 @@ void CSettings::LoadAdvancedSettings()
     XMLUtils::GetBoolean(pElement, "prioritiseapetags", g_advancedSettings.m_prioritiseAPEv2tags);
     XMLUtils::GetBoolean(pElement, "allitemsonbottom", g_advancedSettings.m_bMusicLibraryAllItemsOnBottom);
     XMLUtils::GetBoolean(pElement, "albumssortbyartistthenyear", g_advancedSettings.m_bMusicLibraryAlbumsSortByArtistThenYear);
+    XMLUtils::GetBoolean(pElement, "fingerprints", g_advancedSettings.m_bMusicLibraryFingerprints);
     GetString(pElement, "albumformat", g_advancedSettings.m_strMusicLibraryAlbumFormat);
     GetString(pElement, "albumformatright", g_advancedSettings.m_strMusicLibraryAlbumFormatRight);
     GetString(pElement, "itemseparator", g_advancedSettings.m_musicItemSeparator);
@@ -1260,6 +1281,8 @@ void CSettings::LoadAdvancedSettings()
     XMLUtils::GetBoolean(pElement, "hiderecentlyaddeditems", g_advancedSettings.m_bVideoLibraryHideRecentlyAddedItems);
     XMLUtils::GetBoolean(pElement, "hideemptyseries", g_advancedSettings.m_bVideoLibraryHideEmptySeries);
     XMLUtils::GetBoolean(pElement, "cleanonupdate", g_advancedSettings.m_bVideoLibraryCleanOnUpdate);
+    GetInteger(pElement, "scraperthreads", g_advancedSettings.m_videoScraperThreads, 0, 16);
+    XMLUtils::GetBoolean(pElement, "fingerprints", g_advancedSettings.m_bVideoLibraryFingerprints);
     GetString(pElement, "itemseparator", g_advancedSettings.m_videoItemSeparator);
   }
 
@@ -1269,6 +1292,9 @@ void CSettings::LoadAdvancedSettings()
     GetFloat(pElement, "panamount", g_advancedSettings.m_slideshowPanAmount, 0.0f, 20.0f);
     GetFloat(pElement, "zoomamount", g_advancedSettings.m_slideshowZoomAmount, 0.0f, 20.0f);
     GetFloat(pElement, "blackbarcompensation", g_advancedSettings.m_slideshowBlackBarCompensation, 0.0f, 50.0f);
+    GetInteger(pElement, "lookahead", g_advancedSettings.m_slideshowLookAhead, 0, 10);
+    GetInteger(pElement, "lookbehind", g_advancedSettings.m_slideshowLookBehind, 0, 10);
+    GetInteger(pElement, "lookaheadmemory", g_advancedSettings.m_slideshowLookAheadMemory, 0, 1024);
   }
 
   pElement = pRootElement->FirstChildElement("lcd");
@@ -1286,6 +1312,8 @@ void CSettings::LoadAdvancedSettings()
   {
     GetInteger(pElement, "autodetectpingtime", g_advancedSettings.m_autoDetectPingTime, 1, 240);
     GetInteger(pElement, "curlclienttimeout", g_advancedSettings.m_curlclienttimeout, 1, 1000);
+    GetInteger(pElement, "downloadthreads", g_advancedSettings.m_iDownloadThreads, 1, 16);
+    GetInteger(pElement, "downloadsperhost", g_advancedSettings.m_iDownloadsPerHost, 1, 8);
   }
 
   GetFloat(pRootElement, "playcountminimumpercent", g_advancedSettings.m_playCountMinimumPercent, 1.0f, 100.0f);
@@ -1308,6 +1336,9 @@ void CSettings::LoadAdvancedSettings()
       setting->SetAdvanced();
     }
   }
+  XMLUtils::GetBoolean(pRootElement, "lockprofiling", g_advancedSettings.m_lockProfiling);
+  if (g_advancedSettings.m_lockProfiling)
+    CLockProfiler::Enable(); // can't be switched off again, sections rely on it
   GetString(pRootElement, "cddbaddress", g_advancedSettings.m_cddbAddress);
 #ifdef HAS_HAL
   XMLUtils::GetBoolean(pRootElement, "usehalmount", g_advancedSettings.m_useHalMount);
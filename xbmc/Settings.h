@@ -141,6 +141,7 @@ public:
     bool m_DisableModChipDetection;
 
     int m_audioHeadRoom;
+    int m_audioResampleQuality;
     float m_karaokeSyncDelay;
 
     float m_videoSubsDelayRange;
@@ -167,10 +168,17 @@ public:
     int m_musicPercentSeekForwardBig;
     int m_musicPercentSeekBackwardBig;
     int m_videoBlackBarColour;
+    bool m_videoUsePBO;
+    int m_videoPBOBuffers;
+    bool m_videoDirectRendering;
+    int m_videoPictureQueueSize;
 
     float m_slideshowBlackBarCompensation;
     float m_slideshowZoomAmount;
     float m_slideshowPanAmount;
+    int m_slideshowLookAhead;        // slides decoded ahead of the current one
+    int m_slideshowLookBehind;       // and behind it
+    int m_slideshowLookAheadMemory;  // MB the decoded slides may take
 
     int m_lcdRows;
     int m_lcdColumns;
@@ -185,6 +193,7 @@ public:
     int m_songInfoDuration;
     int m_busyDialogDelay;
     int m_logLevel;
+    bool m_lockProfiling;
     CStdString m_cddbAddress;
     bool m_usePCDVDROM;
     bool m_noDVDROM;
@@ -212,6 +221,7 @@ public:
     bool m_bMusicLibraryHideAllItems;
     bool m_bMusicLibraryAllItemsOnBottom;
     bool m_bMusicLibraryAlbumsSortByArtistThenYear;
+    bool m_bMusicLibraryFingerprints;
     CStdString m_strMusicLibraryAlbumFormat;
     CStdString m_strMusicLibraryAlbumFormatRight;
     bool m_prioritiseAPEv2tags;
@@ -224,6 +234,8 @@ public:
     bool m_bVideoLibraryHideRecentlyAddedItems;
     bool m_bVideoLibraryHideEmptySeries;
     bool m_bVideoLibraryCleanOnUpdate;
+    int m_videoScraperThreads;
+    bool m_bVideoLibraryFingerprints;
     bool m_sambastatfiles;
     bool m_bUseEvilB;
     std::vector<CStdString> m_vecTokens; // cleaning strings tied to language
@@ -238,6 +250,8 @@ public:
     bool m_bTuxBoxSendAllAPids;
 
     int m_curlclienttimeout;
+    int m_iDownloadThreads;
+    int m_iDownloadsPerHost;
 
 #ifdef HAS_SDL
     bool m_fullScreen;
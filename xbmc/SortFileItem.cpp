@@ -30,6 +30,24 @@
 
 #define RETURN_IF_NULL(x,y) if ((x) == NULL) { CLog::Log(LOGWARNING, "%s, sort item is null", __FUNCTION__); return y; }
 
+using namespace MUSIC_INFO;
+
+// the tags are only read here, through the const accessors so they stay
+// shared with the copies in the directory cache. items without one sort as empty.
+static const CMusicInfoTag& MusicTag(const CFileItemPtr &item)
+{
+  static const CMusicInfoTag empty;
+  const CFileItem &file = *item;
+  return file.HasMusicInfoTag() ? *file.GetMusicInfoTag() : empty;
+}
+
+static const CVideoInfoTag& VideoTag(const CFileItemPtr &item)
+{
+  static const CVideoInfoTag empty;
+  const CFileItem &file = *item;
+  return file.HasVideoInfoTag() ? *file.GetVideoInfoTag() : empty;
+}
+
 inline int StartsWithToken(const CStdString& strLabel)
 {
   for (unsigned int i=0;i<g_advancedSettings.m_vecTokens.size();++i)
@@ -141,14 +159,14 @@ void SSortFileItem::ByDriveType(CFileItemPtr &item)
 void SSortFileItem::BySongTitle(CFileItemPtr &item)
 {
   if (!item) return;
-  item->SetSortLabel(item->GetMusicInfoTag()->GetTitle());
+  item->SetSortLabel(MusicTag(item).GetTitle());
 }
 
 void SSortFileItem::BySongTitleNoThe(CFileItemPtr &item)
 {
   if (!item) return;
-  int start = StartsWithToken(item->GetMusicInfoTag()->GetTitle());
-  item->SetSortLabel(item->GetMusicInfoTag()->GetTitle().Mid(start));
+  int start = StartsWithToken(MusicTag(item).GetTitle());
+  item->SetSortLabel(MusicTag(item).GetTitle().Mid(start));
 }
 
 void SSortFileItem::BySongAlbum(CFileItemPtr &item)
@@ -157,19 +175,19 @@ void SSortFileItem::BySongAlbum(CFileItemPtr &item)
 
   CStdString label;
   if (item->HasMusicInfoTag())
-    label = item->GetMusicInfoTag()->GetAlbum();
+    label = MusicTag(item).GetAlbum();
   else if (item->HasVideoInfoTag())
-    label = item->GetVideoInfoTag()->m_strAlbum;
+    label = VideoTag(item).m_strAlbum;
 
   CStdString artist;
   if (item->HasMusicInfoTag())
-    artist = item->GetMusicInfoTag()->GetArtist();
+    artist = MusicTag(item).GetArtist();
   else if (item->HasVideoInfoTag())
-    artist = item->GetVideoInfoTag()->m_strArtist;
+    artist = VideoTag(item).m_strArtist;
   label += " " + artist;
 
   if (item->HasMusicInfoTag())
-    label.AppendFormat(" %i", item->GetMusicInfoTag()->GetTrackAndDiskNumber());
+    label.AppendFormat(" %i", MusicTag(item).GetTrackAndDiskNumber());
 
   item->SetSortLabel(label);
 }
@@ -179,21 +197,21 @@ void SSortFileItem::BySongAlbumNoThe(CFileItemPtr &item)
   if (!item) return;
   CStdString label;
   if (item->HasMusicInfoTag())
-    label = item->GetMusicInfoTag()->GetAlbum();
+    label = MusicTag(item).GetAlbum();
   else if (item->HasVideoInfoTag())
-    label = item->GetVideoInfoTag()->m_strAlbum;
+    label = VideoTag(item).m_strAlbum;
   label = label.Mid(StartsWithToken(label));
 
   CStdString artist;
   if (item->HasMusicInfoTag())
-    artist = item->GetMusicInfoTag()->GetArtist();
+    artist = MusicTag(item).GetArtist();
   else if (item->HasVideoInfoTag())
-    artist = item->GetVideoInfoTag()->m_strArtist;
+    artist = VideoTag(item).m_strArtist;
   artist = artist.Mid(StartsWithToken(artist));
   label += " " + artist;
 
   if (item->HasMusicInfoTag())
-    label.AppendFormat(" %i", item->GetMusicInfoTag()->GetTrackAndDiskNumber());
+    label.AppendFormat(" %i", MusicTag(item).GetTrackAndDiskNumber());
 
   item->SetSortLabel(label);
 }
@@ -204,29 +222,29 @@ void SSortFileItem::BySongArtist(CFileItemPtr &item)
 
   CStdString label;
   if (item->HasMusicInfoTag())
-    label = item->GetMusicInfoTag()->GetArtist();
+    label = MusicTag(item).GetArtist();
   else if (item->HasVideoInfoTag())
-    label = item->GetVideoInfoTag()->m_strArtist;
+    label = VideoTag(item).m_strArtist;
 
   if (g_advancedSettings.m_bMusicLibraryAlbumsSortByArtistThenYear)
   {
     int year = 0;
     if (item->HasMusicInfoTag())
-      year = item->GetMusicInfoTag()->GetYear();
+      year = MusicTag(item).GetYear();
     else if (item->HasVideoInfoTag())
-      year = item->GetVideoInfoTag()->m_iYear;
+      year = VideoTag(item).m_iYear;
     label.AppendFormat(" %i", year);
   }
 
   CStdString album;
   if (item->HasMusicInfoTag())
-    album = item->GetMusicInfoTag()->GetAlbum();
+    album = MusicTag(item).GetAlbum();
   else if (item->HasVideoInfoTag())
-    album = item->GetVideoInfoTag()->m_strAlbum;
+    album = VideoTag(item).m_strAlbum;
   label += " " + album;
 
   if (item->HasMusicInfoTag())
-    label.AppendFormat(" %i", item->GetMusicInfoTag()->GetTrackAndDiskNumber());
+    label.AppendFormat(" %i", MusicTag(item).GetTrackAndDiskNumber());
 
   item->SetSortLabel(label);
 }
@@ -237,31 +255,31 @@ void SSortFileItem::BySongArtistNoThe(CFileItemPtr &item)
 
   CStdString label;
   if (item->HasMusicInfoTag())
-    label = item->GetMusicInfoTag()->GetArtist();
+    label = MusicTag(item).GetArtist();
   else if (item->HasVideoInfoTag())
-    label = item->GetVideoInfoTag()->m_strArtist;
+    label = VideoTag(item).m_strArtist;
   label = label.Mid(StartsWithToken(label));
 
   if (g_advancedSettings.m_bMusicLibraryAlbumsSortByArtistThenYear)
   {
     int year = 0;
     if (item->HasMusicInfoTag())
-      year = item->GetMusicInfoTag()->GetYear();
+      year = MusicTag(item).GetYear();
     else if (item->HasVideoInfoTag())
-      year = item->GetVideoInfoTag()->m_iYear;
+      year = VideoTag(item).m_iYear;
     label.AppendFormat(" %i", year);
   }
 
   CStdString album;
   if (item->HasMusicInfoTag())
-    album = item->GetMusicInfoTag()->GetAlbum();
+    album = MusicTag(item).GetAlbum();
   else if (item->HasVideoInfoTag())
-    album = item->GetVideoInfoTag()->m_strAlbum;
+    album = VideoTag(item).m_strAlbum;
   album = album.Mid(StartsWithToken(album));
   label += " " + album;
 
   if (item->HasMusicInfoTag())
-    label.AppendFormat(" %i", item->GetMusicInfoTag()->GetTrackAndDiskNumber());
+    label.AppendFormat(" %i", MusicTag(item).GetTrackAndDiskNumber());
 
   item->SetSortLabel(label);
 }
@@ -270,7 +288,7 @@ void SSortFileItem::BySongTrackNum(CFileItemPtr &item)
 {
   if (!item) return;
   CStdString label;
-  label.Format("%i", item->GetMusicInfoTag()->GetTrackAndDiskNumber());
+  label.Format("%i", MusicTag(item).GetTrackAndDiskNumber());
   item->SetSortLabel(label);
 }
 
@@ -278,7 +296,7 @@ void SSortFileItem::BySongDuration(CFileItemPtr &item)
 {
   if (!item) return;
   CStdString label;
-  label.Format("%i", item->GetMusicInfoTag()->GetDuration());
+  label.Format("%i", MusicTag(item).GetDuration());
   item->SetSortLabel(label);
 }
 
@@ -286,7 +304,7 @@ void SSortFileItem::BySongRating(CFileItemPtr &item)
 {
   if (!item) return;
   CStdString label;
-  label.Format("%c %s", item->GetMusicInfoTag()->GetRating(), item->GetMusicInfoTag()->GetTitle().c_str());
+  label.Format("%c %s", MusicTag(item).GetRating(), MusicTag(item).GetTitle().c_str());
   item->SetSortLabel(label);
 }
 
@@ -303,9 +321,9 @@ void SSortFileItem::ByGenre(CFileItemPtr &item)
   if (!item) return;
 
   if (item->HasMusicInfoTag())
-    item->SetSortLabel(item->GetMusicInfoTag()->GetGenre());
+    item->SetSortLabel(MusicTag(item).GetGenre());
   else
-    item->SetSortLabel(item->GetVideoInfoTag()->m_strGenre);
+    item->SetSortLabel(VideoTag(item).m_strGenre);
 }
 
 void SSortFileItem::ByYear(CFileItemPtr &item)
@@ -314,48 +332,48 @@ void SSortFileItem::ByYear(CFileItemPtr &item)
 
   CStdString label;
   if (item->HasMusicInfoTag())
-    label.Format("%i %s", item->GetMusicInfoTag()->GetYear(), item->GetLabel().c_str());
+    label.Format("%i %s", MusicTag(item).GetYear(), item->GetLabel().c_str());
   else
-    label.Format("%s %s %i %s", item->GetVideoInfoTag()->m_strPremiered.c_str(), item->GetVideoInfoTag()->m_strFirstAired, item->GetVideoInfoTag()->m_iYear, item->GetLabel().c_str());
+    label.Format("%s %s %i %s", VideoTag(item).m_strPremiered.c_str(), VideoTag(item).m_strFirstAired, VideoTag(item).m_iYear, item->GetLabel().c_str());
   item->SetSortLabel(label);
 }
 
 void SSortFileItem::ByMovieTitle(CFileItemPtr &item)
 {
   if (!item) return;
-  item->SetSortLabel(item->GetVideoInfoTag()->m_strTitle);
+  item->SetSortLabel(VideoTag(item).m_strTitle);
 }
 
 void SSortFileItem::ByMovieRating(CFileItemPtr &item)
 {
   if (!item) return;
   CStdString label;
-  label.Format("%f %s", item->GetVideoInfoTag()->m_fRating, item->GetLabel().c_str());
+  label.Format("%f %s", VideoTag(item).m_fRating, item->GetLabel().c_str());
   item->SetSortLabel(label);
 }
 
 void SSortFileItem::ByMovieRuntime(CFileItemPtr &item)
 {
   if (!item) return;
-  item->SetSortLabel(item->GetVideoInfoTag()->m_strRuntime);
+  item->SetSortLabel(VideoTag(item).m_strRuntime);
 }
 
 void SSortFileItem::ByMPAARating(CFileItemPtr &item)
 {
   if (!item) return;
-  item->SetSortLabel(item->GetVideoInfoTag()->m_strMPAARating + " " + item->GetLabel());
+  item->SetSortLabel(VideoTag(item).m_strMPAARating + " " + item->GetLabel());
 }
 
 void SSortFileItem::ByStudio(CFileItemPtr &item)
 {
   if (!item) return;
-  item->SetSortLabel(item->GetVideoInfoTag()->m_strStudio);
+  item->SetSortLabel(VideoTag(item).m_strStudio);
 }
 
 void SSortFileItem::ByStudioNoThe(CFileItemPtr &item)
 {
   if (!item) return;
-  CStdString studio = item->GetVideoInfoTag()->m_strStudio;
+  CStdString studio = VideoTag(item).m_strStudio;
   item->SetSortLabel(studio.Mid(StartsWithToken(studio)));
 }
 
@@ -363,7 +381,7 @@ void SSortFileItem::ByEpisodeNum(CFileItemPtr &item)
 {
   if (!item) return;
 
-  const CVideoInfoTag *tag = item->GetVideoInfoTag();
+  const CVideoInfoTag *tag = &VideoTag(item);
 
   // we calculate an offset number based on the episode's
   // sort season and episode values. in addition
@@ -389,6 +407,6 @@ void SSortFileItem::ByEpisodeNum(CFileItemPtr &item)
 void SSortFileItem::ByProductionCode(CFileItemPtr &item)
 {
   if (!item) return;
-  item->SetSortLabel(item->GetVideoInfoTag()->m_strProductionCode);
+  item->SetSortLabel(VideoTag(item).m_strProductionCode);
 }
 
@@ -22,13 +22,18 @@
 #include "stdafx.h"
 #include "ThumbnailCache.h"
 #include "FileSystem/File.h"
+#include "utils/Metrics.h"
 
 using namespace std;
 using namespace XFILE;
 
 CThumbnailCache* CThumbnailCache::m_pCacheInstance = NULL;
 
-CCriticalSection CThumbnailCache::m_cs;
+CSharedSection CThumbnailCache::m_cs;
+
+// every thumb the lists show is looked up here, often more than once a frame
+static CMetricCounter g_hits("thumbnail_cache_requests_total{result=\"hit\"}");
+static CMetricCounter g_misses("thumbnail_cache_requests_total{result=\"miss\"}");
 
 CThumbnailCache::~CThumbnailCache()
 {}
@@ -39,8 +44,13 @@ CThumbnailCache::CThumbnailCache()
 
 CThumbnailCache* CThumbnailCache::GetThumbnailCache()
 {
-  CSingleLock lock (m_cs);
+  {
+    CSharedLock lock (m_cs);
+    if (m_pCacheInstance != NULL)
+      return m_pCacheInstance;
+  }
 
+  CExclusiveLock lock (m_cs);
   if (m_pCacheInstance == NULL)
     m_pCacheInstance = new CThumbnailCache;
 
@@ -49,14 +59,20 @@ CThumbnailCache* CThumbnailCache::GetThumbnailCache()
 
 bool CThumbnailCache::ThumbExists(const CStdString& strFileName, bool bAddCache /*=false*/)
 {
-  CSingleLock lock (m_cs);
-
   if (strFileName.size() == 0) return false;
-  map<CStdString, bool>::iterator it;
-  it = m_Cache.find(strFileName);
-  if (it != m_Cache.end())
-    return it->second;
+  {
+    CSharedLock lock (m_cs);
+    map<CStdString, bool>::iterator it;
+    it = m_Cache.find(strFileName);
+    if (it != m_Cache.end())
+    {
+      g_hits.Increment();
+      return it->second;
+    }
+  }
+  g_misses.Increment();
 
+  // not under the lock, this may well go out to the network
   bool bExists = CFile::Exists(strFileName);
 
   if (bAddCache)
@@ -66,7 +82,7 @@ bool CThumbnailCache::ThumbExists(const CStdString& strFileName, bool bAddCache
 
 bool CThumbnailCache::IsCached(const CStdString& strFileName)
 {
-  CSingleLock lock (m_cs);
+  CSharedLock lock (m_cs);
 
   map<CStdString, bool>::iterator it;
   it = m_Cache.find(strFileName);
@@ -78,7 +94,7 @@ bool CThumbnailCache::IsCached(const CStdString& strFileName)
 
 void CThumbnailCache::Clear()
 {
-  CSingleLock lock (m_cs);
+  CExclusiveLock lock (m_cs);
 
   if (m_pCacheInstance != NULL)
   {
@@ -91,7 +107,7 @@ void CThumbnailCache::Clear()
 
 void CThumbnailCache::Add(const CStdString& strFileName, bool bExists)
 {
-  CSingleLock lock (m_cs);
+  CExclusiveLock lock (m_cs);
 
   map<CStdString, bool>::iterator it;
   it = m_Cache.find(strFileName);
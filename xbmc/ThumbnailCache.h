@@ -20,6 +20,8 @@
  *
  */
 
+#include "utils/SharedSection.h"
+
 class CThumbnailCache
 {
 private:
@@ -38,5 +40,5 @@ protected:
 
   std::map<CStdString, bool> m_Cache;
 
-  static CCriticalSection m_cs;
+  static CSharedSection m_cs;
 };
@@ -57,6 +57,11 @@ extern CGUIInfoManager g_infoManager;
 
 NPT_SET_LOCAL_LOGGER("xbmc.upnp")
 
+// containers kept listed for paging, and how long one not from the library
+// is trusted - a share has no update id telling us it changed
+#define UPNP_BROWSE_CACHE_SIZE  8
+#define UPNP_BROWSE_CACHE_TTL   60000
+
 typedef struct {
   const char* extension;
   const char* mimetype;
@@ -177,12 +182,16 @@ class CUPnPServer : public PLT_MediaConnect
 {
 public:
     CUPnPServer(const char* friendly_name, const char* uuid = NULL, int port = 0) : 
-        PLT_MediaConnect("", friendly_name, true, uuid, port) {
+        PLT_MediaConnect("", friendly_name, true, uuid, port), m_SystemUpdateID(0) {
         // hack: override path to make sure it's empty
         // urls will contain full paths to local files
         m_Path = "";
     }
 
+    // PLT_MediaServer methods
+    virtual NPT_Result OnGetSystemUpdateID(PLT_ActionReference&          action, 
+                                           const NPT_HttpRequestContext& context);
+
     // PLT_MediaServer methods
     virtual NPT_Result OnBrowseMetadata(PLT_ActionReference&          action, 
                                         const char*                   object_id, 
@@ -230,10 +239,30 @@ private:
                            bool                          with_count, 
                            const NPT_HttpRequestContext& context,
                            const char*                   parent_id = NULL);
+
+    // a container as it was last listed. control points page through big
+    // containers a few items at a time, so the listing is kept along with
+    // the didl of every item sent so far.
+    struct SBrowseListing {
+        NPT_String              id;
+        long                    update_id;  // see CUtil::GetDirectoryCacheUpdateID()
+        DWORD                   listed;     // tick count the container was listed at
+        CFileItemList           items;
+        NPT_String              didl_key;   // filter, interface and parent mode the didl was built for
+        std::vector<NPT_String> didl;       // per item, empty if it couldn't be built
+        std::vector<bool>       didl_built;
+        CCriticalSection        section;
+    };
+    typedef boost::shared_ptr<SBrowseListing> SBrowseListingPtr;
+
+    SBrowseListingPtr GetListing(const NPT_String& id);
+    long              RefreshUpdateID();
+    // with a listing, its didl is used and filled in, the caller holds its section
     NPT_Result       BuildResponse(PLT_ActionReference&          action,
                                    CFileItemList&                items,
                                    const NPT_HttpRequestContext& context,
-                                   const char*                   parent_id);
+                                   const char*                   parent_id,
+                                   SBrowseListing*               listing = NULL);
                            
     static NPT_String GetParentFolder(NPT_String file_path) {       
         int index = file_path.ReverseFind("\\");
@@ -242,6 +271,10 @@ private:
         return file_path.Left(index);
     }
     static NPT_String GetProtocolInfo(const CFileItem& item, const NPT_String& protocol);
+
+    CCriticalSection              m_BrowseSection;
+    std::list<SBrowseListingPtr>  m_BrowseCache;    // most recently browsed first
+    long                          m_SystemUpdateID;
 };
 
 /*----------------------------------------------------------------------
@@ -1031,45 +1064,123 @@ CUPnPServer::OnBrowseMetadata(PLT_ActionReference&          action,
     NPT_CHECK(action->SetArgumentValue("NumberReturned", "1"));
     NPT_CHECK(action->SetArgumentValue("TotalMatches", "1"));
 
-    // update ID may be wrong here, it should be the one of the container?
-    NPT_CHECK(action->SetArgumentValue("UpdateId", "0"));
-
-    // TODO: We need to keep track of the overall SystemUpdateID of the CDS
+    // the system update id, we don't track containers separately
+    NPT_CHECK(action->SetArgumentValue("UpdateId", NPT_String::FromInteger(RefreshUpdateID())));
 
     return NPT_SUCCESS;
 }
 
 /*----------------------------------------------------------------------
-|   CUPnPServer::OnBrowseDirectChildren
+|   CUPnPServer::OnGetSystemUpdateID
 +---------------------------------------------------------------------*/
 NPT_Result
-CUPnPServer::OnBrowseDirectChildren(PLT_ActionReference&          action, 
-                                    const char*                   object_id, 
-                                    const NPT_HttpRequestContext& context)
+CUPnPServer::OnGetSystemUpdateID(PLT_ActionReference&          action, 
+                                 const NPT_HttpRequestContext& context)
 {
-    CFileItemList items;
-    NPT_String    parent_id = TranslateWMPObjectId(object_id);    
+    RefreshUpdateID();
+    return PLT_MediaConnect::OnGetSystemUpdateID(action, context);
+}
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::RefreshUpdateID
++---------------------------------------------------------------------*/
+long
+CUPnPServer::RefreshUpdateID()
+{
+    // the library bumps this whenever it throws its directory caches away
+    long update_id = CUtil::GetDirectoryCacheUpdateID();
+
+    CSingleLock lock(m_BrowseSection);
+    if (update_id != m_SystemUpdateID) {
+        // evented, so subscribed control points know to browse again
+        PLT_Service* service = NULL;
+        if (NPT_SUCCEEDED(FindServiceByType("urn:schemas-upnp-org:service:ContentDirectory:1", service))) {
+            service->SetStateVariable("SystemUpdateID", NPT_String::FromInteger(update_id));
+        }
+        m_SystemUpdateID = update_id;
+        m_BrowseCache.clear();
+    }
+    return update_id;
+}
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::GetListing
++---------------------------------------------------------------------*/
+CUPnPServer::SBrowseListingPtr
+CUPnPServer::GetListing(const NPT_String& id)
+{
+    long update_id = RefreshUpdateID();
+    bool library = id.StartsWith("musicdb://") || id.StartsWith("videodb://");
+
+    {
+        CSingleLock lock(m_BrowseSection);
+        for (list<SBrowseListingPtr>::iterator it = m_BrowseCache.begin(); it != m_BrowseCache.end(); ++it) {
+            SBrowseListingPtr listing = *it;
+            if (listing->id != id) continue;
+
+            m_BrowseCache.erase(it);
+            if (listing->update_id == update_id && 
+                (library || GetTickCount() - listing->listed < UPNP_BROWSE_CACHE_TTL)) {
+                m_BrowseCache.push_front(listing);
+                return listing;
+            }
+            break;
+        }
+    }
 
-    items.m_strPath = parent_id;
+    // list without holding the cache, a slow share mustn't hold up other browses
+    SBrowseListingPtr listing(new SBrowseListing);
+    listing->id        = id;
+    listing->update_id = update_id;
+    listing->listed    = GetTickCount();
+
+    CFileItemList& items = listing->items;
+    items.m_strPath = (const char*)id;
     if (!items.Load()) {
         // cache anything that takes more than a second to retrieve
         DWORD time = GetTickCount() + 1000;
 
-        if (parent_id.StartsWith("virtualpath://")) {
+        if (id.StartsWith("virtualpath://")) {
             CUPnPVirtualPathDirectory dir;
-            dir.GetDirectory((const char*)parent_id, items);
+            dir.GetDirectory((const char*)id, items);
         } else {
-            CDirectory::GetDirectory((const char*)parent_id, items);
+            CDirectory::GetDirectory((const char*)id, items);
         }
         if (items.CacheToDiscAlways() || (items.CacheToDiscIfSlow() && time < GetTickCount()))
           items.Save();
     }
 
+    CSingleLock lock(m_BrowseSection);
+    // another browse may have listed it meanwhile
+    for (list<SBrowseListingPtr>::iterator it = m_BrowseCache.begin(); it != m_BrowseCache.end(); ++it) {
+        if ((*it)->id == id) {
+            m_BrowseCache.erase(it);
+            break;
+        }
+    }
+    m_BrowseCache.push_front(listing);
+    if (m_BrowseCache.size() > UPNP_BROWSE_CACHE_SIZE)
+        m_BrowseCache.pop_back();
+    return listing;
+}
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::OnBrowseDirectChildren
++---------------------------------------------------------------------*/
+NPT_Result
+CUPnPServer::OnBrowseDirectChildren(PLT_ActionReference&          action, 
+                                    const char*                   object_id, 
+                                    const NPT_HttpRequestContext& context)
+{
+    NPT_String        parent_id = TranslateWMPObjectId(object_id);    
+    SBrowseListingPtr listing = GetListing(parent_id);
+
     // Don't pass parent_id if action is Search not BrowseDirectChildren, as
     // we want the engine to determine the best parent id, not necessarily the one
     // passed
     NPT_String action_name = action->GetActionDesc()->GetName();
-    return BuildResponse(action, items, context, (action_name.Compare("Search", true)==0)?NULL:parent_id.GetChars());
+    CSingleLock lock(listing->section);
+    return BuildResponse(action, listing->items, context, (action_name.Compare("Search", true)==0)?NULL:parent_id.GetChars(), listing.get());
 }
 
 /*----------------------------------------------------------------------
@@ -1079,7 +1190,8 @@ NPT_Result
 CUPnPServer::BuildResponse(PLT_ActionReference&          action, 
                            CFileItemList&                items, 
                            const NPT_HttpRequestContext& context, 
-                           const char*                   parent_id /* = NULL */)
+                           const char*                   parent_id,
+                           SBrowseListing*               listing /* = NULL */)
 {
     NPT_String filter;
     NPT_String startingInd;
@@ -1098,18 +1210,39 @@ CUPnPServer::BuildResponse(PLT_ActionReference&          action,
     max_count  = (req_count == 0)?30:min((unsigned long)req_count, (unsigned long)30);
     stop_index = min((unsigned long)(start_index + max_count), (unsigned long)items.Size()); // don't return more than we can
 
+    // the didl of an item depends on the filter, the interface the request
+    // came in on (resource urls) and whether the parent id was given
+    if (listing) {
+        NPT_String key = filter + "|" + context.GetLocalAddress().GetIpAddress().ToString() + "|" + (parent_id?parent_id:"");
+        if (listing->didl_key != key || listing->didl.size() != (unsigned long)items.Size()) {
+            listing->didl_key = key;
+            listing->didl.clear();
+            listing->didl.resize(items.Size());
+            listing->didl_built.assign(items.Size(), false);
+        }
+    }
+
     NPT_Cardinal count = 0;
     NPT_String didl = didl_header;
     PLT_MediaObjectReference item;
     for (unsigned long i=start_index; i<stop_index; ++i) {
-        item = Build(items[i], true, context, parent_id);
-        if (item.IsNull()) {
+        NPT_String tmp;
+        if (listing && listing->didl_built[i]) {
+            tmp = listing->didl[i];
+        } else {
+            item = Build(items[i], true, context, parent_id);
+            if (!item.IsNull()) {
+                NPT_CHECK(PLT_Didl::ToDidl(*item.AsPointer(), filter, tmp));
+            }
+            if (listing) {
+                listing->didl[i] = tmp;
+                listing->didl_built[i] = true;
+            }
+        }
+        if (tmp.IsEmpty()) {
             continue;
         }
 
-        NPT_String tmp;
-        NPT_CHECK(PLT_Didl::ToDidl(*item.AsPointer(), filter, tmp));
-
         // Neptunes string growing is dead slow for small additions
         if (didl.GetCapacity() < tmp.GetLength() + didl.GetLength()) {
             didl.Reserve((tmp.GetLength() + didl.GetLength())*2);
@@ -1123,7 +1256,7 @@ CUPnPServer::BuildResponse(PLT_ActionReference&          action,
     NPT_CHECK(action->SetArgumentValue("Result", didl));
     NPT_CHECK(action->SetArgumentValue("NumberReturned", NPT_String::FromInteger(count)));
     NPT_CHECK(action->SetArgumentValue("TotalMatches", NPT_String::FromInteger(items.Size())));
-    NPT_CHECK(action->SetArgumentValue("UpdateId", "0"));
+    NPT_CHECK(action->SetArgumentValue("UpdateId", NPT_String::FromInteger(listing?listing->update_id:RefreshUpdateID())));
     return NPT_SUCCESS;
 }
 
@@ -1348,11 +1481,28 @@ CUPnPServer::ServeFile(NPT_HttpRequest&              request,
         return NPT_SUCCESS;
     }
     
-    return PLT_MediaConnect::ServeFile(request, 
-                                       context, 
-                                       response, 
-                                       uri_path, 
-                                       file_path);
+    NPT_Result result = PLT_MediaConnect::ServeFile(request, 
+                                                    context, 
+                                                    response, 
+                                                    uri_path, 
+                                                    file_path);
+
+    // files on a local disk can be sent by the kernel, the server task falls
+    // back to reading through CFile where that isn't supported
+    NPT_HttpEntity* entity = response.GetEntity();
+    if (NPT_SUCCEEDED(result) && entity && 
+        (response.GetStatusCode() == 200 || response.GetStatusCode() == 206)) {
+        CStdString local = _P((const char*)file_path);
+        NPT_InputStreamReference stream;
+        NPT_Position offset;
+        if (CUtil::IsHD(local) && local.Find("://") < 0 &&
+            NPT_SUCCEEDED(entity->GetInputStream(stream)) && !stream.IsNull() &&
+            NPT_SUCCEEDED(stream->Tell(offset))) {
+            // the stream was already moved to the start of the range
+            entity->SetFile(local.c_str(), offset);
+        }
+    }
+    return result;
 }
 
 /*----------------------------------------------------------------------
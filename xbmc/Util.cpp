@@ -140,6 +140,7 @@ static const __int64 SECS_BETWEEN_EPOCHS = 11644473600LL;
 static const __int64 SECS_TO_100NS = 10000000;
 
 HANDLE CUtil::m_hCurrentCpuUsage = NULL;
+long CUtil::m_directoryCacheUpdateID = 1;
 
 using namespace AUTOPTR;
 using namespace MEDIA_DETECT;
@@ -1962,8 +1963,10 @@ bool CUtil::IsOnLAN(const CStdString& strPath)
   unsigned long address = ntohl(inet_addr(host.c_str()));
   if(address == INADDR_NONE)
   {
+    // this gets asked from the gui thread while browsing, a dns server that
+    // doesn't answer quickly shouldn't hold it up for long
     CStdString ip;
-    if(CDNSNameCache::Lookup(host, ip))
+    if(CDNSNameCache::Lookup(host, ip, 1000))
       address = ntohl(inet_addr(ip.c_str()));
   }
 
@@ -5117,6 +5120,8 @@ void CUtil::DeleteVideoDatabaseDirectoryCache()
 
 void CUtil::DeleteDirectoryCache(const CStdString strType /* = ""*/)
 {
+  InterlockedIncrement(&m_directoryCacheUpdateID);
+
   WIN32_FIND_DATA wfd;
   memset(&wfd, 0, sizeof(wfd));
 
@@ -301,6 +301,8 @@ public:
   static void DeleteDirectoryCache(const CStdString strType = "");
   static void DeleteMusicDatabaseDirectoryCache();
   static void DeleteVideoDatabaseDirectoryCache();
+  // bumped whenever a directory cache is thrown away, ie. whenever the library changes
+  static long GetDirectoryCacheUpdateID() { return m_directoryCacheUpdateID; }
   static CStdString MusicPlaylistsLocation();
   static CStdString VideoPlaylistsLocation();
   static CStdString SubstitutePath(const CStdString& strFileName);
@@ -358,5 +360,6 @@ public:
 private:
   
   static HANDLE m_hCurrentCpuUsage;
+  static long m_directoryCacheUpdateID;
 };
 
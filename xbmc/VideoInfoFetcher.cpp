@@ -0,0 +1,179 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "VideoInfoFetcher.h"
+#include "VideoInfoScanner.h"
+#include "utils/IMDB.h"
+#include "utils/SingleLock.h"
+
+using namespace std;
+
+namespace VIDEO
+{
+  CVideoInfoFetcher::CVideoInfoFetcher()
+  {
+    m_iMaxQueued = 0;
+    m_iBusy = 0;
+    m_bStop = false;
+  }
+
+  CVideoInfoFetcher::~CVideoInfoFetcher()
+  {
+    Stop();
+  }
+
+  void CVideoInfoFetcher::Start(int iWorkers, unsigned int iMaxQueued)
+  {
+    Stop();
+    m_bStop = false;
+    m_iMaxQueued = iMaxQueued;
+    for (int i = 0; i < iWorkers; i++)
+    {
+      CThread *worker = new CThread(this);
+      worker->Create();
+      worker->SetName("VideoInfoFetcher");
+      worker->SetPriority(THREAD_PRIORITY_BELOW_NORMAL);
+      m_workers.push_back(worker);
+    }
+    CLog::Log(LOGDEBUG, "%s - started %d workers", __FUNCTION__, iWorkers);
+  }
+
+  void CVideoInfoFetcher::Stop()
+  {
+    if (m_workers.empty())
+      return;
+
+    m_bStop = true;
+    for (unsigned int i = 0; i < m_workers.size(); i++)
+    {
+      m_jobEvent.Set();
+      m_workers[i]->StopThread();
+      delete m_workers[i];
+    }
+    m_workers.clear();
+
+    CSingleLock lock(m_section);
+    m_jobs.clear();
+    m_results.clear();
+    m_iBusy = 0;
+  }
+
+  void CVideoInfoFetcher::Cancel()
+  {
+    m_bStop = true;
+    m_jobEvent.Set();
+    m_doneEvent.Set();
+  }
+
+  void CVideoInfoFetcher::Queue(const SFetchJob& job)
+  {
+    while (!m_bStop)
+    {
+      {
+        CSingleLock lock(m_section);
+        if (m_jobs.size() < m_iMaxQueued)
+        {
+          m_jobs.push_back(job);
+          break;
+        }
+      }
+      m_doneEvent.WaitMSec(100);
+    }
+    m_jobEvent.Set();
+  }
+
+  bool CVideoInfoFetcher::GetResult(SFetchJob& job, bool bWait)
+  {
+    while (!m_bStop)
+    {
+      {
+        CSingleLock lock(m_section);
+        if (!m_results.empty())
+        {
+          job = m_results.front();
+          m_results.pop_front();
+          return true;
+        }
+        if (!bWait || (m_jobs.empty() && m_iBusy == 0))
+          return false;
+      }
+      m_doneEvent.WaitMSec(100);
+    }
+    return false;
+  }
+
+  unsigned int CVideoInfoFetcher::GetResultCount()
+  {
+    CSingleLock lock(m_section);
+    return m_results.size();
+  }
+
+  void CVideoInfoFetcher::Run()
+  {
+    while (!m_bStop)
+    {
+      SFetchJob job;
+      {
+        CSingleLock lock(m_section);
+        if (!m_jobs.empty())
+        {
+          job = m_jobs.front();
+          m_jobs.pop_front();
+          m_iBusy++;
+        }
+      }
+      if (!job.item)
+      { // nothing to do, the event only wakes one of us so don't wait long
+        m_jobEvent.WaitMSec(100);
+        continue;
+      }
+
+      Fetch(job);
+
+      CSingleLock lock(m_section);
+      m_iBusy--;
+      if (!m_bStop)
+        m_results.push_back(job);
+      m_doneEvent.Set();
+    }
+  }
+
+  void CVideoInfoFetcher::Fetch(SFetchJob& job)
+  {
+    job.bFound = false;
+
+    CIMDB IMDB;
+    IMDB_MOVIELIST movielist;
+    IMDB.SetScraperInfo(job.pathInfo);
+    if (!IMDB.FindMovie(job.strMovieName, movielist) || movielist.empty() || m_bStop)
+      return;
+
+    CIMDB details;
+    details.SetScraperInfo(job.info);
+    job.details.m_strFileNameAndPath = job.item->m_strPath;
+    if (!details.GetDetails(movielist[0], job.details) || m_bStop)
+      return;
+
+    job.bFound = true;
+    CVideoInfoScanner::DownloadArtwork(job.item.get(), job.details, job.bApplyToDir);
+  }
+}
@@ -0,0 +1,85 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+#include "utils/Thread.h"
+#include "utils/CriticalSection.h"
+#include "utils/Event.h"
+#include "ScraperSettings.h"
+#include "VideoInfoTag.h"
+#include "FileItem.h"
+
+#include <deque>
+
+namespace VIDEO
+{
+  // a movie or music video on its way through the fetcher
+  struct SFetchJob
+  {
+    CFileItemPtr item;
+    CStdString strDirectory;  // the scanned directory the item belongs to
+    CStdString strMovieName;
+    SScraperInfo pathInfo;    // scraper set for the item's path, used for the search
+    SScraperInfo info;        // scraper of the scan, used for the details
+    bool bApplyToDir;
+    bool bFound;
+    CVideoInfoTag details;
+  };
+
+  // runs the network side of a scan - search, details and artwork - on a few
+  // worker threads, leaving the scanner thread free to walk the directories.
+  // finished jobs are collected with GetResult() so that all database writes
+  // still happen on the scanner thread.
+  class CVideoInfoFetcher : public IRunnable
+  {
+  public:
+    CVideoInfoFetcher();
+    virtual ~CVideoInfoFetcher();
+
+    void Start(int iWorkers, unsigned int iMaxQueued);
+    void Stop();  // drops anything not done yet
+    // makes Queue() and GetResult() return and the workers give up on their
+    // jobs, without waiting for them. Stop() still has to be called.
+    void Cancel();
+    bool IsRunning() const { return !m_workers.empty(); }
+
+    // blocks while the queue is full
+    void Queue(const SFetchJob& job);
+
+    // hands out a finished job. with bWait set it waits while jobs are
+    // still being worked on, false means there are none left.
+    bool GetResult(SFetchJob& job, bool bWait);
+    unsigned int GetResultCount();
+
+  protected:
+    virtual void Run();
+    void Fetch(SFetchJob& job);
+
+    CCriticalSection m_section;
+    CEvent m_jobEvent;
+    CEvent m_doneEvent;
+    std::deque<SFetchJob> m_jobs;
+    std::deque<SFetchJob> m_results;
+    unsigned int m_iMaxQueued;
+    int m_iBusy;
+    volatile bool m_bStop;
+    std::vector<CThread*> m_workers;
+  };
+}
@@ -38,6 +38,7 @@
 #include "CocoaUtils.h"
 
 #define REGEXSAMPLEFILE "[-\\._ ](sample|trailer)[-\\._ ]"
+#define SCAN_COMMIT_BATCH 20 // fetched items written per transaction
 
 using namespace std;
 using namespace DIRECTORY;
@@ -46,7 +47,7 @@ using namespace XFILE;
 namespace VIDEO 
 {
 
-  CVideoInfoScanner::CVideoInfoScanner()
+  CVideoInfoScanner::CVideoInfoScanner() : m_fingerprints(FINGERPRINTS_VIDEO)
   {
     m_bRunning = false;
     m_pObserver = NULL;
@@ -79,6 +80,9 @@ namespace VIDEO
       m_currentItem=0;
       m_itemCount=-1;
 
+      m_fingerprints.Load();
+      CScraperUrl::SetCaching(true);
+
       // Create the thread to count all files to be scanned
       SetPriority(THREAD_PRIORITY_IDLE);
       CThread fileCountReader(this);    
@@ -90,6 +94,10 @@ namespace VIDEO
       // result in unexpected behaviour.
       m_bCanInterrupt = false;
 
+      // movie and music video lookups are handed to the fetcher's workers
+      if (g_advancedSettings.m_videoScraperThreads > 0)
+        m_fetcher.Start(g_advancedSettings.m_videoScraperThreads, g_advancedSettings.m_videoScraperThreads * 4);
+
       bool bCancelled = false;
       for(std::map<CStdString,VIDEO::SScanSettings>::iterator it = m_pathsToScan.begin(); it != m_pathsToScan.end(); it++)
       {
@@ -100,6 +108,13 @@ namespace VIDEO
         }
       }
 
+      if (!bCancelled)
+        CommitFetched(true);
+      m_fetcher.Stop();
+      m_pendingFetches.clear();
+      m_pendingHashes.clear();
+      CScraperUrl::SetCaching(false);
+
       if (!bCancelled)
       {
         if (m_bClean)
@@ -113,6 +128,9 @@ namespace VIDEO
       }
 
       fileCountReader.StopThread();
+      if (!bCancelled && m_strStartDir.IsEmpty())
+        m_fingerprints.RemoveUnseen();
+      m_fingerprints.Save();
 
       m_database.Close();
       CLog::Log(LOGDEBUG, "%s - Finished scan", __FUNCTION__);
@@ -129,6 +147,7 @@ namespace VIDEO
     }
     catch (...)
     {
+      CScraperUrl::SetCaching(false);
       CLog::Log(LOGERROR, "VideoInfoScanner: Exception while scanning.");
     }
   }
@@ -171,6 +190,8 @@ namespace VIDEO
     if (m_bCanInterrupt)
       m_database.Interupt();
 
+    // the scanner thread may be waiting on the fetcher
+    m_fetcher.Cancel();
     StopThread();
   }
 
@@ -189,6 +210,7 @@ namespace VIDEO
         m_pObserver->OnStateChanged(REMOVING_OLD);
 
       m_database.RemoveContentForPath(strDirectory);
+      m_fingerprints.Remove(strDirectory);
     }
 
     if (m_pObserver)
@@ -211,10 +233,7 @@ namespace VIDEO
       if (m_pObserver)
         m_pObserver->OnStateChanged(FETCHING_MOVIE_INFO);
 
-      CDirectory::GetDirectory(strDirectory,items,g_stSettings.m_videoExtensions);
-      items.m_strPath = strDirectory;
-      items.Stack();
-      int numFilesInFolder = GetPathHash(items, hash);
+      int numFilesInFolder = ListDirectory(strDirectory, items, hash, true);
 
       if (!m_database.GetPathHash(strDirectory, dbHash) || dbHash != hash)
       { // path has changed - rescan
@@ -245,9 +264,7 @@ namespace VIDEO
 
       if (iFound == 1 && !settings.parent_name_root)
       {
-        CDirectory::GetDirectory(strDirectory,items,g_stSettings.m_videoExtensions);
-        items.m_strPath = strDirectory;
-        GetPathHash(items, hash);
+        ListDirectory(strDirectory, items, hash, false);
         bSkip = true;
         if (!m_database.GetPathHash(strDirectory, dbHash) || dbHash != hash)
         {
@@ -271,10 +288,7 @@ namespace VIDEO
       if (m_pObserver)
         m_pObserver->OnStateChanged(FETCHING_MUSICVIDEO_INFO);
 
-      CDirectory::GetDirectory(strDirectory,items,g_stSettings.m_videoExtensions);
-      items.m_strPath = strDirectory;
-
-      int numFilesInFolder = GetPathHash(items, hash);
+      int numFilesInFolder = ListDirectory(strDirectory, items, hash, false);
       if (!m_database.GetPathHash(strDirectory, dbHash) || dbHash != hash)
       { // path has changed - rescan
         if (dbHash.IsEmpty())
@@ -318,10 +332,7 @@ namespace VIDEO
     {
       RetrieveVideoInfo(items,settings.parent_name_root,m_info);
       if (!m_bStop && (m_info.strContent.Equals("movies") || m_info.strContent.Equals("musicvideos")))
-      {
-        m_database.SetPathHash(strDirectory, hash);
-        m_pathsToClean.push_back(m_database.GetPathId(strDirectory));
-      }
+        MarkPathScanned(strDirectory, hash);
     }
 
     if (m_pObserver)
@@ -608,6 +619,22 @@ namespace VIDEO
             }
           }
 
+          if (m_fetcher.IsRunning() && !pURL && !pDlgProgress && !info.strContent.Equals("tvshows"))
+          { // the lookup happens on the fetcher's workers, we'll pick it up in CommitFetched()
+            SFetchJob job;
+            job.item.reset(new CFileItem(*pItem));
+            job.strDirectory = items.m_strPath;
+            job.strMovieName = strMovieName;
+            job.pathInfo = info2;
+            job.info = info;
+            job.bApplyToDir = bDirNames && info.strContent.Equals("movies");
+            job.bFound = false;
+            m_pendingFetches[items.m_strPath]++;
+            m_fetcher.Queue(job);
+            CommitFetched(false);
+            continue;
+          }
+
           IMDB_MOVIELIST movielist;
           if (pURL || IMDB.FindMovie(strMovieName, movielist, pDlgProgress))
           {
@@ -687,9 +714,21 @@ namespace VIDEO
     // load subfolder
     CFileItemList items;
     CLog::Log(LOGDEBUG, "%s - processing dir: %s", __FUNCTION__, strPath.c_str());
-    CDirectory::GetDirectory(strPath, items, g_stSettings.m_videoExtensions, true);
-    if (m_info.strContent.Equals("movies"))
-      items.Stack();
+    CStdString stamp;
+    CDirectoryFingerprints::SEntry entry;
+    if (g_advancedSettings.m_bVideoLibraryFingerprints &&
+        CDirectoryFingerprints::GetStamp(strPath, stamp, m_info.strContent.Equals("movies")) &&
+        m_fingerprints.Lookup(strPath, stamp, entry))
+    { // only an estimate for the progress, no need to check the database
+      CDirectoryFingerprints::GetFolders(entry, items);
+      count = entry.count;
+    }
+    else
+    {
+      CDirectory::GetDirectory(strPath, items, g_stSettings.m_videoExtensions, true);
+      if (m_info.strContent.Equals("movies"))
+        items.Stack();
+    }
 
     for (int i=0; i<items.Size(); ++i)
     {
@@ -847,6 +886,13 @@ namespace VIDEO
   }
 
   long CVideoInfoScanner::AddMovieAndGetThumb(CFileItem *pItem, const CStdString &content, CVideoInfoTag &movieDetails, long idShow, bool bApplyToDir /*=false*/, CGUIDialogProgress* pDialog /* = NULL */)
+  {
+    long lResult = AddMovie(pItem, content, movieDetails, idShow);
+    DownloadArtwork(pItem, movieDetails, bApplyToDir, pDialog);
+    return lResult;
+  }
+
+  long CVideoInfoScanner::AddMovie(CFileItem *pItem, const CStdString &content, CVideoInfoTag &movieDetails, long idShow)
   {
     long lResult=-1;
     // add to all movies in the stacked set
@@ -876,6 +922,11 @@ namespace VIDEO
     {
       m_database.SetDetailsForMusicVideo(pItem->m_strPath, movieDetails);
     }
+    return lResult;
+  }
+
+  void CVideoInfoScanner::DownloadArtwork(CFileItem *pItem, CVideoInfoTag &movieDetails, bool bApplyToDir /*=false*/, CGUIDialogProgress* pDialog /* = NULL */)
+  {
     pItem->CacheFanart();
     // get & save fanart image
     if (!CFile::Exists(pItem->GetCachedFanart()))
@@ -940,7 +991,6 @@ namespace VIDEO
 
     if (g_guiSettings.GetBool("videolibrary.actorthumbs"))
       FetchActorThumbs(movieDetails.m_cast);
-    return lResult;
   }
 
   void CVideoInfoScanner::OnProcessSeriesFolder(IMDB_EPISODELIST& episodes, IMDB_EPISODELIST& files, long lShowId, CIMDB& IMDB, const CStdString& strShowTitle, CGUIDialogProgress* pDlgProgress /* = NULL */)
@@ -1143,6 +1193,82 @@ namespace VIDEO
     }
   }
 
+  void CVideoInfoScanner::CommitFetched(bool bFinal)
+  {
+    if (!bFinal && m_fetcher.GetResultCount() < SCAN_COMMIT_BATCH)
+      return;
+
+    int iUncommitted = 0;
+    SFetchJob job;
+    while (m_fetcher.GetResult(job, bFinal))
+    {
+      if (job.bFound)
+      {
+        if (iUncommitted == 0)
+          m_database.BeginTransaction();
+        if (m_pObserver)
+          m_pObserver->OnSetTitle(job.details.m_strTitle);
+        CUtil::ClearCache();
+        AddMovie(job.item.get(), job.info.strContent, job.details, -1);
+        if (++iUncommitted == SCAN_COMMIT_BATCH)
+        {
+          m_database.CommitTransaction();
+          iUncommitted = 0;
+        }
+      }
+
+      // the last item of a directory is in, it can be marked as scanned now
+      if (--m_pendingFetches[job.strDirectory] <= 0)
+      {
+        m_pendingFetches.erase(job.strDirectory);
+        map<CStdString,CStdString>::iterator it = m_pendingHashes.find(job.strDirectory);
+        if (it != m_pendingHashes.end())
+        {
+          CStdString hash = it->second;
+          m_pendingHashes.erase(it);
+          MarkPathScanned(job.strDirectory, hash);
+        }
+      }
+    }
+    if (iUncommitted)
+      m_database.CommitTransaction();
+  }
+
+  void CVideoInfoScanner::MarkPathScanned(const CStdString& strDirectory, const CStdString& hash)
+  {
+    if (m_pendingFetches.find(strDirectory) != m_pendingFetches.end())
+    {
+      m_pendingHashes[strDirectory] = hash;
+      return;
+    }
+    m_database.SetPathHash(strDirectory, hash);
+    m_pathsToClean.push_back(m_database.GetPathId(strDirectory));
+  }
+
+  int CVideoInfoScanner::ListDirectory(const CStdString& strDirectory, CFileItemList& items, CStdString& hash, bool bStack)
+  {
+    CStdString stamp, dbHash;
+    CDirectoryFingerprints::SEntry entry;
+    bool bStamp = g_advancedSettings.m_bVideoLibraryFingerprints && CDirectoryFingerprints::GetStamp(strDirectory, stamp, bStack);
+    if (bStamp && m_fingerprints.Lookup(strDirectory, stamp, entry) &&
+        m_database.GetPathHash(strDirectory, dbHash) && !dbHash.IsEmpty() && dbHash == entry.hash)
+    { // nothing added, removed or renamed since the hash in the database was taken
+      CDirectoryFingerprints::GetFolders(entry, items);
+      items.m_strPath = strDirectory;
+      hash = entry.hash;
+      return entry.count;
+    }
+
+    CDirectory::GetDirectory(strDirectory,items,g_stSettings.m_videoExtensions);
+    items.m_strPath = strDirectory;
+    if (bStack)
+      items.Stack();
+    int count = GetPathHash(items, hash);
+    if (bStamp)
+      m_fingerprints.Set(strDirectory, stamp, hash, count, items);
+    return count;
+  }
+
   int CVideoInfoScanner::GetPathHash(const CFileItemList &items, CStdString &hash)
   {
     // Create a hash based on the filenames, filesize and filedate.  Also count the number of files
@@ -23,6 +23,8 @@
 #include "VideoDatabase.h"
 #include "ScraperSettings.h"
 #include "NfoFile.h"
+#include "VideoInfoFetcher.h"
+#include "DirectoryFingerprints.h"
 
 class CIMDB;
 
@@ -62,6 +64,8 @@ namespace VIDEO
 
     void EnumerateSeriesFolder(const CFileItem* item, std::map<std::pair<int,int>,CScraperUrl>& episodeList);
     long AddMovieAndGetThumb(CFileItem *pItem, const CStdString &content, CVideoInfoTag &movieDetails, long idShow, bool bApplyToDir=false, CGUIDialogProgress* pDialog = NULL);
+    long AddMovie(CFileItem *pItem, const CStdString &content, CVideoInfoTag &movieDetails, long idShow);
+    static void DownloadArtwork(CFileItem *pItem, CVideoInfoTag &movieDetails, bool bApplyToDir=false, CGUIDialogProgress* pDialog = NULL);
     void OnProcessSeriesFolder(std::map<std::pair<int,int>,CScraperUrl>& episodes, std::map<std::pair<int,int>,CScraperUrl>& files, long lShowId, CIMDB& IMDB, const CStdString& strShowTitle, CGUIDialogProgress* pDlgProgress = NULL);
     static CStdString GetnfoFile(CFileItem *item, bool bGrabAny=false);
     long GetIMDBDetails(CFileItem *pItem, CScraperUrl &url, const SScraperInfo& info, bool bUseDirNames=false, CGUIDialogProgress* pDialog=NULL);
@@ -81,8 +85,18 @@ namespace VIDEO
     virtual void Run();
     int CountFiles(const CStdString& strPath);
     void FetchSeasonThumbs(long lTvShowId);
-    void FetchActorThumbs(const std::vector<SActorInfo>& actors);
+    static void FetchActorThumbs(const std::vector<SActorInfo>& actors);
     static int GetPathHash(const CFileItemList &items, CStdString &hash);
+    // lists a directory and hashes it, or takes both from the fingerprints
+    // when the directory is unchanged. only the folders are listed then.
+    int ListDirectory(const CStdString& strDirectory, CFileItemList& items, CStdString& hash, bool bStack);
+
+    // writes what the fetcher has finished to the database. without bFinal
+    // it returns until a batch worth is ready, with it it waits for all of it.
+    void CommitFetched(bool bFinal);
+    // stores the hash of a scanned directory, or holds on to it until the
+    // fetcher is done with the directory's items
+    void MarkPathScanned(const CStdString& strDirectory, const CStdString& hash);
 
   protected:
     IVideoInfoScannerObserver* m_pObserver;
@@ -94,10 +108,15 @@ namespace VIDEO
     bool m_bClean;
     CStdString m_strStartDir;
     CVideoDatabase m_database;
+    CDirectoryFingerprints m_fingerprints;
     SScraperInfo m_info;
     std::map<CStdString,SScanSettings> m_pathsToScan;
     std::set<CStdString> m_pathsToCount;
     std::vector<long> m_pathsToClean;
+
+    CVideoInfoFetcher m_fetcher;
+    std::map<CStdString,int> m_pendingFetches;        // directory -> items still with the fetcher
+    std::map<CStdString,CStdString> m_pendingHashes;  // directory -> hash to store once they are in
   };
 }
 
@@ -0,0 +1,65 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+// IAudioResampler.h: interface for the sample rate converters.
+//
+//////////////////////////////////////////////////////////////////////
+
+#if !defined(AFX_IAUDIORESAMPLER_H__INCLUDED_)
+#define AFX_IAUDIORESAMPLER_H__INCLUDED_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+// <audio><resamplequality> in advancedsettings.xml
+#define RESAMPLE_QUALITY_SSRC   0 // the original fft based converter
+#define RESAMPLE_QUALITY_LOW    1 // polyphase, 16 taps
+#define RESAMPLE_QUALITY_MEDIUM 2 // polyphase, 32 taps
+#define RESAMPLE_QUALITY_HIGH   3 // polyphase, 64 taps
+
+// float samples go in, OutputBufferSize bytes of NewBPS samples come out at a time.
+// see Cssrc for the details of the calling sequence.
+class IAudioResampler
+{
+public:
+  virtual ~IAudioResampler() {}
+
+  virtual bool InitConverter(int OldFreq, int OldBPS, int Channels, int NewFreq, int NewBPS, int OutputBufferSize) = 0;
+  virtual void DeInitialize() = 0;
+
+  // returns true and fills pOutData with OutputBufferSize bytes when a full buffer is ready
+  virtual bool GetData(unsigned char *pOutData) = 0;
+
+  // number of float samples the next PutFloatData() wants, 0 if GetData() should be called first
+  virtual int GetInputSamples() = 0;
+
+  // returns the number of samples used, -1 if numSamples is less than GetInputSamples()
+  virtual int PutFloatData(float *pInData, int numSamples) = 0;
+};
+
+class CAudioResamplerFactory
+{
+public:
+  static IAudioResampler* Create(int iQuality);
+};
+
+#endif // !defined(AFX_IAUDIORESAMPLER_H__INCLUDED_)
@@ -0,0 +1,324 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include <math.h>
+#include "PolyphaseResampler.h"
+#include "ssrc.h"
+#include "utils/SingleLock.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define MAX_PHASES   1024 // above this the table gets silly, use ssrc instead
+#define MAX_CHANNELS 8
+
+static const struct
+{
+  int    taps;
+  double beta;    // kaiser window shape, higher is more stopband attenuation
+  double rolloff; // passband edge, relative to the nyquist of the slower rate
+} g_presets[] =
+{
+  { 16, 5.0, 0.90 }, // RESAMPLE_QUALITY_LOW
+  { 32, 7.0, 0.94 }, // RESAMPLE_QUALITY_MEDIUM
+  { 64, 9.0, 0.96 }, // RESAMPLE_QUALITY_HIGH
+};
+
+IAudioResampler* CAudioResamplerFactory::Create(int iQuality)
+{
+  if (iQuality <= RESAMPLE_QUALITY_SSRC)
+    return new Cssrc();
+  if (iQuality > RESAMPLE_QUALITY_HIGH)
+    iQuality = RESAMPLE_QUALITY_HIGH;
+  return new CPolyphaseResampler(iQuality);
+}
+
+static int gcd(int a, int b)
+{
+  while (b)
+  {
+    int t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+// zeroth order modified bessel function, for the kaiser window
+static double I0(double x)
+{
+  double sum = 1.0, term = 1.0;
+  for (int k = 1; k < 50; k++)
+  {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+    if (term < sum * 1e-12)
+      break;
+  }
+  return sum;
+}
+
+CCriticalSection CPolyphaseResampler::m_filterSection;
+std::vector<CPolyphaseResampler::SFilter*> CPolyphaseResampler::m_filters;
+
+const CPolyphaseResampler::SFilter* CPolyphaseResampler::GetFilter(int L, int M, int iQuality)
+{
+  CSingleLock lock(m_filterSection);
+  for (unsigned int i = 0; i < m_filters.size(); i++)
+  {
+    const SFilter* filter = m_filters[i];
+    if (filter->L == L && filter->M == M && filter->quality == iQuality)
+      return filter;
+  }
+
+  const int taps = g_presets[iQuality - RESAMPLE_QUALITY_LOW].taps;
+  const double beta = g_presets[iQuality - RESAMPLE_QUALITY_LOW].beta;
+  const int length = L * taps;
+
+  // cutoff in cycles per sample of the upsampled (L * input rate) signal
+  const double fc = 0.5 / (L > M ? L : M) * g_presets[iQuality - RESAMPLE_QUALITY_LOW].rolloff;
+  const double center = (length - 1) * 0.5;
+  const double norm = I0(beta);
+
+  std::vector<double> h(length);
+  for (int k = 0; k < length; k++)
+  {
+    double t = k - center;
+    double sinc = (t == 0.0) ? 2.0 * fc : sin(2.0 * M_PI * fc * t) / (M_PI * t);
+    double r = 2.0 * k / (length - 1) - 1.0;
+    double w = I0(beta * sqrt(1.0 - r * r)) / norm;
+    h[k] = sinc * w * L; // every phase only sees 1 in L of the taps, make up for it
+  }
+
+  // split into phases, each row is ordered to match the input from oldest
+  // to newest so the convolution is a plain dot product
+  SFilter* filter = new SFilter;
+  filter->L = L;
+  filter->M = M;
+  filter->taps = taps;
+  filter->quality = iQuality;
+  filter->coeffs.resize(length);
+  for (int p = 0; p < L; p++)
+    for (int q = 0; q < taps; q++)
+      filter->coeffs[p * taps + q] = (float)h[p + (taps - 1 - q) * L];
+
+  m_filters.push_back(filter);
+  CLog::Log(LOGDEBUG, "%s - created %d tap filter for %d/%d", __FUNCTION__, taps, L, M);
+  return filter;
+}
+
+float CPolyphaseResampler::Convolve(const float *coeffs, const float *input, int taps)
+{
+  int i = 0;
+  float result = 0.0f;
+#ifdef __SSE2__
+  __m128 sum = _mm_setzero_ps();
+  for (; i + 4 <= taps; i += 4)
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(coeffs + i), _mm_loadu_ps(input + i)));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  _mm_store_ss(&result, sum);
+#endif
+  for (; i < taps; i++)
+    result += coeffs[i] * input[i];
+  return result;
+}
+
+CPolyphaseResampler::CPolyphaseResampler(int iQuality)
+{
+  m_iQuality = iQuality;
+  m_pFilter = NULL;
+  m_pFallback = NULL;
+  m_channels = 0;
+  m_outBPS = 0;
+  m_L = m_M = 1;
+  m_taps = 0;
+  m_inputFrames = 0;
+  m_time = 0;
+  m_outputSize = 0;
+  m_outputPos = 0;
+}
+
+CPolyphaseResampler::~CPolyphaseResampler()
+{
+  DeInitialize();
+}
+
+bool CPolyphaseResampler::InitConverter(int OldFreq, int OldBPS, int Channels, int NewFreq, int NewBPS, int OutputBufferSize)
+{
+  DeInitialize();
+
+  if (Channels < 1 || Channels > MAX_CHANNELS || (NewBPS != 16 && NewBPS != 32) || OldFreq <= 0 || NewFreq <= 0)
+  {
+    CLog::Log(LOGERROR, "%s - unsupported format %d channels %d bits", __FUNCTION__, Channels, NewBPS);
+    return false;
+  }
+
+  int div = gcd(OldFreq, NewFreq);
+  m_L = NewFreq / div;
+  m_M = OldFreq / div;
+
+  if (m_L > MAX_PHASES)
+  {
+    CLog::Log(LOGINFO, "%s - %d -> %d needs %d phases, using ssrc", __FUNCTION__, OldFreq, NewFreq, m_L);
+    m_pFallback = new Cssrc();
+    return m_pFallback->InitConverter(OldFreq, OldBPS, Channels, NewFreq, NewBPS, OutputBufferSize);
+  }
+
+  m_channels = Channels;
+  m_outBPS = NewBPS / 8;
+  m_outputSize = OutputBufferSize;
+  m_outputPos = 0;
+  m_time = 0;
+
+  // take about one output buffer worth of input per run
+  int outputFrames = OutputBufferSize / (m_outBPS * m_channels);
+  m_inputFrames = (int)(((long long)outputFrames * m_M) / m_L);
+  if (m_inputFrames < 1)
+    m_inputFrames = 1;
+
+  int maxFrames = outputFrames;
+  if (m_L != m_M)
+  {
+    m_pFilter = GetFilter(m_L, m_M, m_iQuality);
+    m_taps = m_pFilter->taps;
+    for (int c = 0; c < m_channels; c++)
+    {
+      m_history[c].reserve(m_taps + m_inputFrames + 1);
+      m_history[c].assign(m_taps - 1, 0.0f);
+    }
+    maxFrames = (int)(((long long)m_inputFrames * m_L) / m_M) + 2;
+    m_frame.resize(maxFrames * m_channels);
+  }
+
+  m_output.resize(m_outputSize + maxFrames * m_channels * m_outBPS);
+  return true;
+}
+
+void CPolyphaseResampler::DeInitialize()
+{
+  delete m_pFallback;
+  m_pFallback = NULL;
+  m_pFilter = NULL; // the table stays cached for the next stream
+  for (int c = 0; c < MAX_CHANNELS; c++)
+    m_history[c].clear();
+  m_frame.clear();
+  m_output.clear();
+  m_outputPos = 0;
+  m_outputSize = 0;
+}
+
+bool CPolyphaseResampler::GetData(unsigned char *pOutData)
+{
+  if (m_pFallback)
+    return m_pFallback->GetData(pOutData);
+
+  if (m_outputSize <= 0 || m_outputPos < m_outputSize)
+    return false;
+
+  memcpy(pOutData, &m_output[0], m_outputSize);
+  m_outputPos -= m_outputSize;
+  if (m_outputPos)
+    memmove(&m_output[0], &m_output[m_outputSize], m_outputPos);
+  return true;
+}
+
+int CPolyphaseResampler::GetInputSamples()
+{
+  if (m_pFallback)
+    return m_pFallback->GetInputSamples();
+
+  if (m_outputPos >= m_outputSize)
+    return 0;  // need to take data out first!
+  return m_inputFrames * m_channels;
+}
+
+int CPolyphaseResampler::PutFloatData(float *pInData, int numSamples)
+{
+  if (m_pFallback)
+    return m_pFallback->PutFloatData(pInData, numSamples);
+
+  if (m_outputPos >= m_outputSize)
+    return 0;  // need to take data out first!
+
+  int iAmountToRead = m_inputFrames * m_channels;
+  if (numSamples < iAmountToRead)
+    return -1;
+
+  const float *pFrames = pInData;
+  int frames = m_inputFrames;
+
+  if (m_pFilter)
+  {
+    for (int c = 0; c < m_channels; c++)
+    {
+      std::vector<float> &history = m_history[c];
+      unsigned int old = history.size();
+      history.resize(old + m_inputFrames);
+      for (int i = 0; i < m_inputFrames; i++)
+        history[old + i] = pInData[i * m_channels + c];
+    }
+
+    const unsigned int length = m_history[0].size();
+    frames = 0;
+    while (m_time / m_L + m_taps <= length)
+    {
+      const unsigned int base = m_time / m_L;
+      const float *coeffs = &m_pFilter->coeffs[(m_time % m_L) * m_taps];
+      for (int c = 0; c < m_channels; c++)
+        m_frame[frames * m_channels + c] = Convolve(coeffs, &m_history[c][base], m_taps);
+      frames++;
+      m_time += m_M;
+    }
+
+    // drop the input no output sample can reach anymore
+    unsigned int used = m_time / m_L;
+    for (int c = 0; c < m_channels; c++)
+      m_history[c].erase(m_history[c].begin(), m_history[c].begin() + used);
+    m_time -= used * m_L;
+
+    pFrames = &m_frame[0];
+  }
+
+  int samples = frames * m_channels;
+  if (m_outBPS == 2)
+  {
+    CAudioDSP::FloatToInt16((short *)&m_output[m_outputPos], pFrames, samples, &m_dither);
+  }
+  else
+  { // unpacked 24 bit, same as ssrc gives
+    int *p24bit = (int *)&m_output[m_outputPos];
+    for (int i = 0; i < samples; i++)
+    {
+      float result = floorf(8388607.0f * pFrames[i] + 0.5f);
+      if (result > 8388607.0f)
+        result = 8388607.0f;
+      else if (result < -8388608.0f)
+        result = -8388608.0f;
+      p24bit[i] = (int)result;
+    }
+  }
+  m_outputPos += samples * m_outBPS;
+
+  return iAmountToRead;
+}
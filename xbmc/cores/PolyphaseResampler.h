@@ -0,0 +1,91 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+// PolyphaseResampler.h: interface for the CPolyphaseResampler class.
+//
+//////////////////////////////////////////////////////////////////////
+
+#if !defined(AFX_POLYPHASERESAMPLER_H__INCLUDED_)
+#define AFX_POLYPHASERESAMPLER_H__INCLUDED_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include "IAudioResampler.h"
+#include "utils/AudioDSP.h"
+#include "utils/CriticalSection.h"
+#include <vector>
+
+class Cssrc;
+
+// windowed sinc resampler. the rate ratio is reduced to L/M, and a kaiser
+// windowed low pass prototype of L * taps coefficients is split into L
+// phases, so every output sample is a single dot product over the input.
+// filter tables are shared between all instances using the same ratio and
+// quality, a crossfade between two streams only costs the convolution twice.
+class CPolyphaseResampler : public IAudioResampler
+{
+public:
+  CPolyphaseResampler(int iQuality);
+  virtual ~CPolyphaseResampler();
+
+  virtual bool InitConverter(int OldFreq, int OldBPS, int Channels, int NewFreq, int NewBPS, int OutputBufferSize);
+  virtual void DeInitialize();
+  virtual bool GetData(unsigned char *pOutData);
+  virtual int  GetInputSamples();
+  virtual int  PutFloatData(float *pInData, int numSamples);
+
+private:
+  struct SFilter
+  {
+    int L, M, taps, quality;
+    std::vector<float> coeffs; // L rows of taps coefficients, in input order
+  };
+
+  static const SFilter* GetFilter(int L, int M, int iQuality);
+  static CCriticalSection m_filterSection;
+  static std::vector<SFilter*> m_filters;
+
+  static float Convolve(const float *coeffs, const float *input, int taps);
+
+  int m_iQuality;
+  const SFilter* m_pFilter;
+  Cssrc* m_pFallback;         // used for ratios needing too many phases
+
+  int m_channels;
+  int m_outBPS;
+  int m_L, m_M;
+  int m_taps;
+  int m_inputFrames;          // frames taken per PutFloatData()
+  unsigned int m_time;        // position of the next output sample, in 1/L input samples
+
+  std::vector<float> m_history[8];  // per channel, taps - 1 old samples followed by new input
+  std::vector<float> m_frame;       // one interleaved output block, before conversion
+
+  std::vector<unsigned char> m_output;
+  int m_outputSize;           // OutputBufferSize
+  int m_outputPos;
+
+  CAudioDSP::DitherState m_dither;
+};
+
+#endif // !defined(AFX_POLYPHASERESAMPLER_H__INCLUDED_)
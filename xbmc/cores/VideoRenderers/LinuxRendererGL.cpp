@@ -30,6 +30,7 @@
 #include "../../XBVideoConfig.h"
 #include "../../../guilib/Surface.h"
 #include "../../../guilib/FrameBufferObject.h"
+#include "../dvdplayer/DVDCodecs/Video/DVDVideoBufferPool.h"
 
 #define ALIGN(value, alignment) (((value)+((alignment)-1))&~((alignment)-1))
 
@@ -78,6 +79,15 @@ CLinuxRendererGL::CLinuxRendererGL()
 
   memset(m_image, 0, sizeof(m_image));
   memset(m_YUVTexture, 0, sizeof(m_YUVTexture));
+  memset(m_pbo, 0, sizeof(m_pbo));
+  memset(m_pboSize, 0, sizeof(m_pboSize));
+  memset(m_pboMapped, 0, sizeof(m_pboMapped));
+  memset(m_pboDirty, 0, sizeof(m_pboDirty));
+  memset(m_pboFallback, 0, sizeof(m_pboFallback));
+  m_pboSupported = false;
+  memset(m_directBuffer, 0, sizeof(m_directBuffer));
+  memset(m_directPlane, 0, sizeof(m_directPlane));
+  memset(m_directStride, 0, sizeof(m_directStride));
 
   m_rgbBuffer = NULL;
   m_rgbBufferSize = 0;
@@ -554,6 +564,16 @@ bool CLinuxRendererGL::ValidateRenderTarget()
       m_textureTarget = GL_TEXTURE_RECTANGLE_ARB;
     }
 
+    // upload through pixel buffer objects if we can, and keep more frames in flight
+    m_pboSupported = g_advancedSettings.m_videoUsePBO && glewIsSupported("GL_ARB_pixel_buffer_object");
+    if (m_pboSupported)
+    {
+      m_NumYV12Buffers = g_advancedSettings.m_videoPBOBuffers;
+      CLog::Log(LOGNOTICE, "GL: Using pixel buffer objects for YUV upload (%d buffers)", m_NumYV12Buffers);
+    }
+    else
+      m_NumYV12Buffers = 2;
+
      // create the yuv textures    
     LoadShaders();
     for (int i = 0 ; i < m_NumYV12Buffers ; i++)
@@ -759,6 +779,8 @@ int CLinuxRendererGL::GetImage(YV12Image *image, int source, bool readonly)
       if( WaitForSingleObject(m_eventTexturesDone[source], 500) == WAIT_TIMEOUT )
         CLog::Log(LOGWARNING, "%s - Timeout waiting for texture %d", __FUNCTION__, source);
 
+      // caller will write into our own planes again
+      DetachImage(source);
       m_image[source].flags |= IMAGE_FLAG_WRITING;
     }
 
@@ -785,7 +807,10 @@ int CLinuxRendererGL::GetImage(YV12Image *image, int source, bool readonly)
 void CLinuxRendererGL::ReleaseImage(int source, bool preserve)
 {
   if( m_image[source].flags & IMAGE_FLAG_WRITING )
+  {
     SetEvent(m_eventTexturesDone[source]);
+    m_pboDirty[source] = true;
+  }
 
   m_image[source].flags &= ~IMAGE_FLAG_INUSE;
   m_image[source].flags |= IMAGE_FLAG_READY;
@@ -797,6 +822,46 @@ void CLinuxRendererGL::ReleaseImage(int source, bool preserve)
   m_bImageReady = true;
 }
 
+bool CLinuxRendererGL::AttachImage(int source, BYTE *plane[], int stride[], CDVDVideoBuffer *buffer)
+{
+  if (!buffer || source < 0 || !(m_image[source].flags & IMAGE_FLAG_WRITING))
+    return false;
+
+  // mapped pbo's are already what the decoder would be copied into, and
+  // the rgb path converts into its own buffer anyway
+  if (m_pbo[source][0] || m_bRGBImageSet)
+    return false;
+
+  YV12Image &im = m_image[source];
+  for (int p = 0; p < MAX_PLANES; p++)
+  {
+    m_directPlane[source][p]  = im.plane[p];
+    m_directStride[source][p] = im.stride[p];
+    im.plane[p]  = plane[p];
+    im.stride[p] = stride[p];
+  }
+
+  buffer->Acquire();
+  m_directBuffer[source] = buffer;
+  return true;
+}
+
+void CLinuxRendererGL::DetachImage(int index)
+{
+  if (!m_directBuffer[index])
+    return;
+
+  YV12Image &im = m_image[index];
+  for (int p = 0; p < MAX_PLANES; p++)
+  {
+    im.plane[p]  = m_directPlane[index][p];
+    im.stride[p] = m_directStride[index][p];
+  }
+
+  m_directBuffer[index]->Release();
+  m_directBuffer[index] = NULL;
+}
+
 void CLinuxRendererGL::LoadTextures(int source)
 {
   YV12Image* im = &m_image[source];
@@ -849,6 +914,26 @@ void CLinuxRendererGL::LoadTextures(int source)
     m_renderMethod = RENDER_SW;
   }
 
+  // decoder is done writing into the mapped buffers, hand them back to the driver
+  // so the uploads below are sourced from the bound pbo instead of client memory
+  bool pbo = !(m_renderMethod & RENDER_SW) && im == &m_image[source] && m_pbo[source][0];
+  if (pbo && !m_pboDirty[source])
+  {
+    // drawn again without a new picture (paused, second field, display faster
+    // than the video). the buffers were orphaned after the last upload so the
+    // textures are all we have, a change of deinterlacing shows with the next picture.
+    SetEvent(m_eventTexturesDone[source]);
+    return;
+  }
+  // the buffers couldn't be mapped again after the last upload, so the
+  // decoder wrote this picture into client memory. it's uploaded from there
+  // and the buffers are mapped for the next one.
+  bool remap = pbo;
+  if (pbo && !m_pboMapped[source])
+    pbo = false;
+  if (pbo)
+    UnmapYV12PBO(source);
+
   static int imaging = -1;
   static GLfloat brightness = 0;
   static GLfloat contrast   = 0;
@@ -941,13 +1026,15 @@ void CLinuxRendererGL::LoadTextures(int source)
     if (deinterlacing)
     {
       // Load Y fields
+      if (pbo)
+        glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, m_pbo[source][0]);
       glPixelStorei(GL_UNPACK_ROW_LENGTH, im->stride[0]*2);
       glBindTexture(m_textureTarget, fields[FIELD_ODD][0]);
-      glTexSubImage2D(m_textureTarget, 0, 0, 0, im->width, (im->height>>1), GL_LUMINANCE, GL_UNSIGNED_BYTE, im->plane[0]);
+      glTexSubImage2D(m_textureTarget, 0, 0, 0, im->width, (im->height>>1), GL_LUMINANCE, GL_UNSIGNED_BYTE, pbo ? NULL : im->plane[0]);
 
       glPixelStorei(GL_UNPACK_SKIP_PIXELS, im->stride[0]);
       glBindTexture(m_textureTarget, fields[FIELD_EVEN][0]);
-      glTexSubImage2D(m_textureTarget, 0, 0, 0, im->width, (im->height>>1), GL_LUMINANCE, GL_UNSIGNED_BYTE, im->plane[0]);
+      glTexSubImage2D(m_textureTarget, 0, 0, 0, im->width, (im->height>>1), GL_LUMINANCE, GL_UNSIGNED_BYTE, pbo ? NULL : im->plane[0]);
 
       glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
       glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
@@ -955,9 +1042,11 @@ void CLinuxRendererGL::LoadTextures(int source)
     else
     {
       // Load Y plane
+      if (pbo)
+        glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, m_pbo[source][0]);
       glPixelStorei(GL_UNPACK_ROW_LENGTH, im->stride[0]);
       glBindTexture(m_textureTarget, fields[FIELD_FULL][0]);
-      glTexSubImage2D(m_textureTarget, 0, 0, 0, im->width, im->height, GL_LUMINANCE, GL_UNSIGNED_BYTE, im->plane[0]);
+      glTexSubImage2D(m_textureTarget, 0, 0, 0, im->width, im->height, GL_LUMINANCE, GL_UNSIGNED_BYTE, pbo ? NULL : im->plane[0]);
 
       glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
     }
@@ -984,24 +1073,32 @@ void CLinuxRendererGL::LoadTextures(int source)
     if (deinterlacing)
     {
       // Load Even U & V Fields
+      if (pbo)
+        glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, m_pbo[source][1]);
       glPixelStorei(GL_UNPACK_ROW_LENGTH, im->stride[1]*2);
       glBindTexture(m_textureTarget, fields[FIELD_ODD][1]);
-      glTexSubImage2D(m_textureTarget, 0, 0, 0, (im->width >> im->cshift_x), (im->height >> (im->cshift_y+1)), GL_LUMINANCE, GL_UNSIGNED_BYTE, im->plane[1]);
+      glTexSubImage2D(m_textureTarget, 0, 0, 0, (im->width >> im->cshift_x), (im->height >> (im->cshift_y+1)), GL_LUMINANCE, GL_UNSIGNED_BYTE, pbo ? NULL : im->plane[1]);
 
+      if (pbo)
+        glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, m_pbo[source][2]);
       glPixelStorei(GL_UNPACK_ROW_LENGTH, im->stride[2]*2);
       glBindTexture(m_textureTarget, fields[FIELD_ODD][2]);
-      glTexSubImage2D(m_textureTarget, 0, 0, 0, (im->width >> im->cshift_x), (im->height >> (im->cshift_y+1)), GL_LUMINANCE, GL_UNSIGNED_BYTE, im->plane[2]);
+      glTexSubImage2D(m_textureTarget, 0, 0, 0, (im->width >> im->cshift_x), (im->height >> (im->cshift_y+1)), GL_LUMINANCE, GL_UNSIGNED_BYTE, pbo ? NULL : im->plane[2]);
 
       // Load Odd U & V Fields
+      if (pbo)
+        glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, m_pbo[source][1]);
       glPixelStorei(GL_UNPACK_SKIP_PIXELS, im->stride[1]);
       glPixelStorei(GL_UNPACK_ROW_LENGTH, im->stride[1]*2);
       glBindTexture(m_textureTarget, fields[FIELD_EVEN][1]);
-      glTexSubImage2D(m_textureTarget, 0, 0, 0, (im->width >> im->cshift_x), (im->height >> (im->cshift_y+1)), GL_LUMINANCE, GL_UNSIGNED_BYTE, im->plane[1]);
+      glTexSubImage2D(m_textureTarget, 0, 0, 0, (im->width >> im->cshift_x), (im->height >> (im->cshift_y+1)), GL_LUMINANCE, GL_UNSIGNED_BYTE, pbo ? NULL : im->plane[1]);
 
+      if (pbo)
+        glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, m_pbo[source][2]);
       glPixelStorei(GL_UNPACK_SKIP_PIXELS, im->stride[2]);
       glPixelStorei(GL_UNPACK_ROW_LENGTH, im->stride[2]*2);
       glBindTexture(m_textureTarget, fields[FIELD_EVEN][2]);
-      glTexSubImage2D(m_textureTarget, 0, 0, 0, (im->width >> im->cshift_x), (im->height >> (im->cshift_y+1)), GL_LUMINANCE, GL_UNSIGNED_BYTE, im->plane[2]);
+      glTexSubImage2D(m_textureTarget, 0, 0, 0, (im->width >> im->cshift_x), (im->height >> (im->cshift_y+1)), GL_LUMINANCE, GL_UNSIGNED_BYTE, pbo ? NULL : im->plane[2]);
       VerifyGLState();
 
       glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
@@ -1009,18 +1106,43 @@ void CLinuxRendererGL::LoadTextures(int source)
     }
     else
     {
+      if (pbo)
+        glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, m_pbo[source][1]);
       glPixelStorei(GL_UNPACK_ROW_LENGTH,im->stride[1]);
       glBindTexture(m_textureTarget, fields[FIELD_FULL][1]);
-      glTexSubImage2D(m_textureTarget, 0, 0, 0, (im->width >> im->cshift_x), (im->height >> im->cshift_y), GL_LUMINANCE, GL_UNSIGNED_BYTE, im->plane[1]);
+      glTexSubImage2D(m_textureTarget, 0, 0, 0, (im->width >> im->cshift_x), (im->height >> im->cshift_y), GL_LUMINANCE, GL_UNSIGNED_BYTE, pbo ? NULL : im->plane[1]);
       VerifyGLState();
 
+      if (pbo)
+        glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, m_pbo[source][2]);
       glPixelStorei(GL_UNPACK_ROW_LENGTH,im->stride[2]);
       glBindTexture(m_textureTarget, fields[FIELD_FULL][2]);
-      glTexSubImage2D(m_textureTarget, 0, 0, 0, (im->width >> im->cshift_x), (im->height >> im->cshift_y), GL_LUMINANCE, GL_UNSIGNED_BYTE, im->plane[2]);
+      glTexSubImage2D(m_textureTarget, 0, 0, 0, (im->width >> im->cshift_x), (im->height >> im->cshift_y), GL_LUMINANCE, GL_UNSIGNED_BYTE, pbo ? NULL : im->plane[2]);
       VerifyGLState();
 
       glPixelStorei(GL_UNPACK_ROW_LENGTH,0);
     }
+
+    if (remap)
+    {
+      glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+      m_pboDirty[source] = false;
+
+      // orphan and remap so the decoder can fill the next frame while the
+      // driver is still transferring this one. the textures have this frame
+      // already, so if that fails only the next one goes through client memory.
+      if (!MapYV12PBO(source))
+      {
+        if (!m_pboFallback[source][0])
+        {
+          CLog::Log(LOGWARNING, "GL: Failed to remap pixel buffer objects %d, uploading from client memory until it succeeds", source);
+          for (int p = 0; p < MAX_PLANES; p++)
+            m_pboFallback[source][p] = new BYTE[m_pboSize[source][p]];
+        }
+        for (int p = 0; p < MAX_PLANES; p++)
+          m_image[source].plane[p] = m_pboFallback[source][p];
+      }
+    }
     SetEvent(m_eventTexturesDone[source]);
   }
 
@@ -2176,6 +2298,8 @@ void CLinuxRendererGL::DeleteYV12Texture(int index)
   YV12Image &im = m_image[index];
   YUVFIELDS &fields = m_YUVTexture[index];
 
+  DetachImage(index);
+
   if( fields[FIELD_FULL][0] == 0 ) return;
 
   CLog::Log(LOGDEBUG, "Deleted YV12 texture %i", index);
@@ -2196,6 +2320,7 @@ void CLinuxRendererGL::DeleteYV12Texture(int index)
       }
     }
   }
+  DeleteYV12PBO(index);
   g_graphicsContext.EndPaint();
 
   for(int p = 0;p<MAX_PLANES;p++)
@@ -2239,9 +2364,15 @@ bool CLinuxRendererGL::CreateYV12Texture(int index, bool clear)
     im.stride[0] = im.width;
     im.stride[1] = im.width/2;
     im.stride[2] = im.width/2;
-    im.plane[0] = new BYTE[im.width * m_iSourceHeight];
-    im.plane[1] = new BYTE[(im.width/2) * (m_iSourceHeight/2)];
-    im.plane[2] = new BYTE[(im.width/2) * (m_iSourceHeight/2)];
+
+    // s/w yuv2rgb and s/w upscaling read the planes back on the cpu,
+    // which is slow on mapped buffers, so only use pbos for the shader paths
+    if (!m_pboSupported || (m_renderMethod & RENDER_SW) || IsSoftwareUpscaling() || !CreateYV12PBO(index))
+    {
+      im.plane[0] = new BYTE[im.width * m_iSourceHeight];
+      im.plane[1] = new BYTE[(im.width/2) * (m_iSourceHeight/2)];
+      im.plane[2] = new BYTE[(im.width/2) * (m_iSourceHeight/2)];
+    }
 
     im.cshift_x = 1;
     im.cshift_y = 1;
@@ -2365,6 +2496,91 @@ bool CLinuxRendererGL::CreateYV12Texture(int index, bool clear)
   return true;
 }
 
+bool CLinuxRendererGL::CreateYV12PBO(int index)
+{
+  YV12Image &im = m_image[index];
+
+  m_pboSize[index][0] = im.stride[0] * im.height;
+  m_pboSize[index][1] = im.stride[1] * (im.height >> 1);
+  m_pboSize[index][2] = im.stride[2] * (im.height >> 1);
+
+  glGenBuffersARB(MAX_PLANES, m_pbo[index]);
+  m_pboMapped[index] = false;
+  m_pboDirty[index] = false;
+  if (!MapYV12PBO(index))
+  {
+    CLog::Log(LOGERROR, "GL: Unable to map pixel buffer objects for buffer %d", index);
+    DeleteYV12PBO(index);
+    return false;
+  }
+
+  CLog::Log(LOGDEBUG, "GL: Created YV12 pixel buffer objects %d", index);
+  return true;
+}
+
+void CLinuxRendererGL::DeleteYV12PBO(int index)
+{
+  if (!m_pbo[index][0])
+    return;
+
+  UnmapYV12PBO(index);
+  glDeleteBuffersARB(MAX_PLANES, m_pbo[index]);
+  memset(m_pbo[index], 0, sizeof(m_pbo[index]));
+
+  // planes pointed into the buffers or the fallback, make sure nobody frees them
+  for (int p = 0; p < MAX_PLANES; p++)
+  {
+    m_image[index].plane[p] = NULL;
+    delete[] m_pboFallback[index][p];
+    m_pboFallback[index][p] = NULL;
+  }
+
+  CLog::Log(LOGDEBUG, "GL: Deleted YV12 pixel buffer objects %d", index);
+}
+
+bool CLinuxRendererGL::MapYV12PBO(int index)
+{
+  YV12Image &im = m_image[index];
+
+  for (int p = 0; p < MAX_PLANES; p++)
+  {
+    glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, m_pbo[index][p]);
+    // passing NULL orphans the old storage, so we never wait for a pending upload
+    glBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, m_pboSize[index][p], NULL, GL_STREAM_DRAW_ARB);
+    im.plane[p] = (BYTE*)glMapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB);
+    if (!im.plane[p])
+    {
+      // unmap whatever we managed to map so far
+      for (int q = 0; q < p; q++)
+      {
+        glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, m_pbo[index][q]);
+        glUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB);
+        im.plane[q] = NULL;
+      }
+      glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+      m_pboMapped[index] = false;
+      return false;
+    }
+  }
+  glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+  m_pboMapped[index] = true;
+  return true;
+}
+
+void CLinuxRendererGL::UnmapYV12PBO(int index)
+{
+  if (!m_pboMapped[index])
+    return;
+
+  for (int p = 0; p < MAX_PLANES; p++)
+  {
+    glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, m_pbo[index][p]);
+    glUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB);
+  }
+  glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+  m_pboMapped[index] = false;
+}
+
 void CLinuxRendererGL::SetTextureFilter(GLenum method)
 {
   for (int i = 0 ; i<m_NumYV12Buffers ; i++)
@@ -49,6 +49,8 @@ typedef struct YV12Image
 #define IMAGE_FLAG_READY     0x16 /* image is ready to be uploaded to texture memory */
 #define IMAGE_FLAG_INUSE (IMAGE_FLAG_WRITING | IMAGE_FLAG_READING | IMAGE_FLAG_RESERVED)
 
+class CDVDVideoBuffer;
+
 struct DRAWRECT
 {
   float left;
@@ -128,6 +130,7 @@ public:
   virtual bool Configure(unsigned int width, unsigned int height, unsigned int d_width, unsigned int d_height, float fps, unsigned flags);
   virtual int          GetImage(YV12Image *image, int source = AUTOSOURCE, bool readonly = false);
   virtual void         ReleaseImage(int source, bool preserve = false);
+  bool                 AttachImage(int source, BYTE *plane[], int stride[], CDVDVideoBuffer *buffer);
   virtual unsigned int DrawSlice(unsigned char *src[], int stride[], int w, int h, int x, int y);
   virtual void         DrawAlpha(int x0, int y0, int w, int h, unsigned char *src, unsigned char *srca, int stride);
   virtual void         FlipPage(int source);
@@ -169,6 +172,11 @@ protected:
   virtual bool CreateYV12Texture(int index, bool clear=true);
   void CopyYV12Texture(int dest);
   int  NextYV12Texture();
+  bool CreateYV12PBO(int index);
+  void DeleteYV12PBO(int index);
+  bool MapYV12PBO(int index);
+  void UnmapYV12PBO(int index);
+  void DetachImage(int index);
   virtual bool ValidateRenderTarget();
   virtual void LoadShaders(int renderMethod=FIELD_FULL);
   void LoadTextures(int source);
@@ -238,6 +246,22 @@ protected:
   // field index 0 is full image, 1 is odd scanlines, 2 is even scanlines
   YUVBUFFERS m_YUVTexture;
 
+  // pixel buffer objects backing the YV12 planes, when the driver supports them.
+  // while mapped, m_image[].plane points straight into driver memory so the
+  // decoder writes there and LoadTextures only has to kick off a DMA upload.
+  GLuint m_pbo[NUM_BUFFERS][MAX_PLANES];
+  unsigned m_pboSize[NUM_BUFFERS][MAX_PLANES];
+  bool m_pboMapped[NUM_BUFFERS];
+  bool m_pboDirty[NUM_BUFFERS]; // written by the decoder since the last upload
+  bool m_pboSupported;
+  // client memory the decoder writes to after a remap failed, see LoadTextures
+  BYTE* m_pboFallback[NUM_BUFFERS][MAX_PLANES];
+
+  // decoder buffers shown in place of the image's own planes, see AttachImage
+  CDVDVideoBuffer* m_directBuffer[NUM_BUFFERS];
+  BYTE* m_directPlane[NUM_BUFFERS][MAX_PLANES];
+  unsigned m_directStride[NUM_BUFFERS][MAX_PLANES];
+
   //BaseYUV2RGBGLSLShader     *m_pYUVShaderGLSL;
   //BaseYUV2RGBARBShader      *m_pYUVShaderARB;
   CShaderProgram        *m_pYUVShader;
@@ -32,6 +32,8 @@
 #include "utils/SharedSection.h"
 #include "utils/Thread.h"
 
+class CDVDVideoBuffer;
+
 class CXBoxRenderManager : private CThread
 {
 public:
@@ -74,6 +76,17 @@ public:
     if (m_pRenderer)
       m_pRenderer->ReleaseImage(source, preserve);
   }
+  // show the decoder's own planes for the image obtained by GetImage instead of
+  // copying them, buffer is referenced until the image is written again
+  inline bool AttachImage(int source, BYTE *plane[], int stride[], CDVDVideoBuffer *buffer)
+  {
+#ifdef HAS_SDL_OPENGL
+    CSharedLock lock(m_sharedSection);
+    if (m_pRenderer)
+      return m_pRenderer->AttachImage(source, plane, stride, buffer);
+#endif
+    return false;
+  }
   inline unsigned int DrawSlice(unsigned char *src[], int stride[], int w, int h, int x, int y)
   {
     CSharedLock lock(m_sharedSection);
@@ -421,7 +421,7 @@ DWORD CALSADirectSound::AddPackets(unsigned char *data, DWORD len)
 
 	// handle volume de-amp 
 	if (!m_bPassthrough)
-           m_amp.DeAmplify((short *)pcmPtr, framesToWrite * m_uiChannels);
+           m_amp.DeAmplifyInt16((int16_t *)pcmPtr, framesToWrite * m_uiChannels, g_guiSettings.GetBool("audiooutput.normalisevolume"), true);
 	
 	int writeResult = snd_pcm_writei(m_pPlayHandle, pcmPtr, framesToWrite);
 	if (  writeResult == -EPIPE  ) {
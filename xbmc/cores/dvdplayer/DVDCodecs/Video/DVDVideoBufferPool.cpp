@@ -0,0 +1,149 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "DVDVideoBufferPool.h"
+#include "utils/SingleLock.h"
+
+#define BUFFER_ALIGN 32
+
+CDVDVideoBuffer::CDVDVideoBuffer(CDVDVideoBufferPool* pPool)
+{
+  m_pPool = pPool;
+  m_references = 0;
+  iWidth = iHeight = iEdge = 0;
+  for (int i = 0; i < 3; i++)
+  {
+    m_pBase[i] = NULL;
+    data[i] = NULL;
+    linesize[i] = 0;
+  }
+}
+
+CDVDVideoBuffer::~CDVDVideoBuffer()
+{
+  for (int i = 0; i < 3; i++)
+  {
+    if (m_pBase[i])
+      _aligned_free(m_pBase[i]);
+  }
+}
+
+long CDVDVideoBuffer::Acquire()
+{
+  return InterlockedIncrement(&m_references);
+}
+
+long CDVDVideoBuffer::Release()
+{
+  long count = InterlockedDecrement(&m_references);
+  if (count == 0)
+    m_pPool->Return(this);
+  return count;
+}
+
+CDVDVideoBufferPool::CDVDVideoBufferPool()
+{
+  m_references = 1;
+  m_iAllocated = 0;
+}
+
+CDVDVideoBufferPool::~CDVDVideoBufferPool()
+{
+  for (unsigned int i = 0; i < m_free.size(); i++)
+    delete m_free[i];
+  m_free.clear();
+}
+
+long CDVDVideoBufferPool::Acquire()
+{
+  return InterlockedIncrement(&m_references);
+}
+
+long CDVDVideoBufferPool::Release()
+{
+  long count = InterlockedDecrement(&m_references);
+  if (count == 0) delete this;
+  return count;
+}
+
+CDVDVideoBuffer* CDVDVideoBufferPool::Get(int iWidth, int iHeight, int iEdge)
+{
+  CDVDVideoBuffer* pBuffer = NULL;
+  {
+    CSingleLock lock(m_section);
+    while (!m_free.empty())
+    {
+      pBuffer = m_free.back();
+      m_free.pop_back();
+      if (pBuffer->iWidth == iWidth && pBuffer->iHeight == iHeight && pBuffer->iEdge == iEdge)
+        break;
+
+      // size changed, free the old one
+      delete pBuffer;
+      pBuffer = NULL;
+      m_iAllocated--;
+    }
+  }
+
+  if (!pBuffer)
+  {
+    pBuffer = new CDVDVideoBuffer(this);
+    pBuffer->iWidth = iWidth;
+    pBuffer->iHeight = iHeight;
+    pBuffer->iEdge = iEdge;
+
+    for (int i = 0; i < 3; i++)
+    {
+      int shift = i ? 1 : 0;
+      int edge = iEdge >> shift;
+      int w = (iWidth >> shift) + edge * 2;
+      int h = (iHeight >> shift) + edge * 2;
+
+      pBuffer->linesize[i] = (w + BUFFER_ALIGN - 1) & ~(BUFFER_ALIGN - 1);
+      pBuffer->m_pBase[i] = (BYTE*)_aligned_malloc(pBuffer->linesize[i] * h, BUFFER_ALIGN);
+      if (!pBuffer->m_pBase[i])
+      {
+        CLog::Log(LOGERROR, "%s - unable to allocate %dx%d picture", __FUNCTION__, iWidth, iHeight);
+        delete pBuffer;
+        return NULL;
+      }
+      pBuffer->data[i] = pBuffer->m_pBase[i] + edge * pBuffer->linesize[i] + edge;
+    }
+
+    CSingleLock lock(m_section);
+    m_iAllocated++;
+  }
+
+  // every buffer out of the pool keeps the pool alive
+  Acquire();
+  pBuffer->m_references = 1;
+  return pBuffer;
+}
+
+void CDVDVideoBufferPool::Return(CDVDVideoBuffer* pBuffer)
+{
+  {
+    CSingleLock lock(m_section);
+    m_free.push_back(pBuffer);
+  }
+  Release();
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/CriticalSection.h"
+#include <vector>
+
+class CDVDVideoBufferPool;
+
+// reference counted YUV 4:2:0 picture used for direct rendering.
+// the decoder holds a reference while it needs the picture as a reference
+// frame, the renderer takes another one while the picture is on screen.
+// when the last reference goes away the buffer is returned to its pool.
+class CDVDVideoBuffer
+{
+public:
+  long Acquire();
+  long Release();
+
+  BYTE* data[3];     // first visible pixel of each plane
+  int   linesize[3];
+
+  int   iWidth;      // allocated size, without edges
+  int   iHeight;
+  int   iEdge;
+
+protected:
+  friend class CDVDVideoBufferPool;
+
+  CDVDVideoBuffer(CDVDVideoBufferPool* pPool);
+  ~CDVDVideoBuffer();
+
+  BYTE* m_pBase[3];
+  long  m_references;
+  CDVDVideoBufferPool* m_pPool;
+};
+
+class CDVDVideoBufferPool
+{
+public:
+  CDVDVideoBufferPool();
+
+  long Acquire();
+  long Release();
+
+  /*
+   * returns a buffer with a reference count of one, planes are
+   * aligned for simd and padded with iEdge pixels on all sides
+   */
+  CDVDVideoBuffer* Get(int iWidth, int iHeight, int iEdge);
+
+  int GetAllocated() { return m_iAllocated; }
+
+protected:
+  friend class CDVDVideoBuffer;
+
+  ~CDVDVideoBufferPool();
+  void Return(CDVDVideoBuffer* pBuffer);
+
+  CCriticalSection m_section;
+  std::vector<CDVDVideoBuffer*> m_free;
+  int  m_iAllocated;
+  long m_references;
+};
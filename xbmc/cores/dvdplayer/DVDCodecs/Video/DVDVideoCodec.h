@@ -28,6 +28,8 @@
 #define FRAME_TYPE_B 3
 #define FRAME_TYPE_D 4
 
+class CDVDVideoBuffer;
+
 // video structure with PIX_FMT_YUV420P data
 // should be entirely filled by all codecs
 typedef struct stDVDVideoPicture
@@ -49,6 +51,8 @@ typedef struct stDVDVideoPicture
   unsigned int iHeight;
   unsigned int iDisplayWidth;  // width of the picture without black bars
   unsigned int iDisplayHeight; // height of the picture without black bars
+
+  CDVDVideoBuffer* pBuffer; // set when data points into a direct rendering buffer, acquire it to keep it past the next Decode call
 }
 DVDVideoPicture;
 
@@ -67,6 +71,7 @@ DVDVideoUserData;
 #define DVP_FLAG_NOSKIP             0x00000010 // indicate this picture should never be dropped
 #define DVP_FLAG_DROPPED            0x00000020 // indicate that this picture has been dropped in decoder stage, will have no data
 #define DVP_FLAG_NOAUTOSYNC         0x00000040 // disregard any smooth syncing on this picture
+#define DVP_FLAG_STILL              0x00000080 // picture is repeated while the stream stalls, can't be synced to the clock
 
 // DVP_FLAG 0x00000100 - 0x00000f00 is in use by libmpeg2!
 
@@ -80,6 +85,14 @@ typedef std::vector<CDVDCodecOption> CDVDCodecOptions;
 #define VC_PICTURE  0x00000004  // the decoder got a picture, call Decode(NULL, 0) again to parse the rest of the data
 #define VC_USERDATA 0x00000008  // the decoder found some userdata,  call Decode(NULL, 0) again to parse the rest of the data
 
+// VC_SKIP_ levels, each level includes the ones below it
+#define VC_SKIP_NONE        0 // decode everything
+#define VC_SKIP_LOOPFILTER  1 // skip the loop filter on non reference frames
+#define VC_SKIP_IDCT        2 // skip idct on non reference frames
+#define VC_SKIP_NONREF      3 // skip non reference frames entirely
+#define VC_SKIP_BIDIR       4 // skip all b-frames
+#define VC_SKIP_LEVELS      5
+
 class CDVDVideoCodec
 {
 public:
@@ -133,6 +146,12 @@ public:
    */
   virtual void SetDropState(bool bDrop) = 0;
 
+  /*
+   * graded version of SetDropState, takes one of the VC_SKIP_ levels.
+   * codecs that can only drop whole frames do so from VC_SKIP_NONREF up
+   */
+  virtual void SetSkipLevel(int iLevel)             { SetDropState(iLevel >= VC_SKIP_NONREF); }
+
   /*
    *
    * should return codecs name
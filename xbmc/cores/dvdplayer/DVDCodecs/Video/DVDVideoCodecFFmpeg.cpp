@@ -21,6 +21,7 @@
 
 #include "stdafx.h"
 #include "DVDVideoCodecFFmpeg.h"
+#include "DVDVideoBufferPool.h"
 #include "DVDDemuxers/DVDDemux.h"
 #include "DVDStreamInfo.h"
 #include "DVDClock.h"
@@ -30,6 +31,7 @@
 #include "utils/CPUInfo.h"
 #endif
 #include "GUISettings.h"
+#include "Settings.h"
 
 #ifndef _LINUX
 #define RINT(x) ((x) >= 0 ? ((int)((x) + 0.5)) : ((int)((x) - 0.5)))
@@ -38,12 +40,71 @@
 #define RINT lrint
 #endif
 
+// EDGE_WIDTH in libavcodec, codecs without CODEC_FLAG_EMU_EDGE draw motion
+// vectors pointing outside the picture into this border
+#define DR_EDGE_WIDTH 16
+
+int my_get_buffer(struct AVCodecContext *avctx, AVFrame *pic)
+{
+  CDVDVideoCodecFFmpeg* ctx = (CDVDVideoCodecFFmpeg*)avctx->opaque;
+
+  // only planar 4:2:0 can be handed to the renderer as is
+  if (avctx->pix_fmt != PIX_FMT_YUV420P && avctx->pix_fmt != PIX_FMT_YUVJ420P)
+    return ctx->m_dllAvCodec.avcodec_default_get_buffer(avctx, pic);
+
+  int width  = avctx->width;
+  int height = avctx->height;
+  ctx->m_dllAvCodec.avcodec_align_dimensions(avctx, &width, &height);
+
+  int edge = (avctx->flags & CODEC_FLAG_EMU_EDGE) ? 0 : DR_EDGE_WIDTH;
+
+  CDVDVideoBuffer* buffer = ctx->m_pBufferPool->Get(width, height, edge);
+  if (!buffer)
+    return ctx->m_dllAvCodec.avcodec_default_get_buffer(avctx, pic);
+
+  for (int i = 0; i < 3; i++)
+  {
+    pic->base[i]     = buffer->data[i];
+    pic->data[i]     = buffer->data[i];
+    pic->linesize[i] = buffer->linesize[i];
+  }
+  pic->base[3]     = pic->data[3] = NULL;
+  pic->linesize[3] = 0;
+
+  pic->opaque = buffer;
+  pic->type   = FF_BUFFER_TYPE_USER;
+  // content is unknown, don't let the codec skip unchanged blocks
+  pic->age    = 256*256*256*64;
+  pic->reordered_opaque = avctx->reordered_opaque;
+  return 0;
+}
+
+void my_release_buffer(struct AVCodecContext *avctx, AVFrame *pic)
+{
+  CDVDVideoCodecFFmpeg* ctx = (CDVDVideoCodecFFmpeg*)avctx->opaque;
+
+  if (pic->type != FF_BUFFER_TYPE_USER)
+  {
+    ctx->m_dllAvCodec.avcodec_default_release_buffer(avctx, pic);
+    return;
+  }
+
+  CDVDVideoBuffer* buffer = (CDVDVideoBuffer*)pic->opaque;
+  if (buffer)
+    buffer->Release();
+
+  for (int i = 0; i < 4; i++)
+    pic->data[i] = pic->base[i] = NULL;
+  pic->opaque = NULL;
+}
+
 
 CDVDVideoCodecFFmpeg::CDVDVideoCodecFFmpeg() : CDVDVideoCodec()
 {
   m_pCodecContext = NULL;
   m_pConvertFrame = NULL;
   m_pFrame = NULL;
+  m_pBufferPool = NULL;
 
   m_iPictureWidth = 0;
   m_iPictureHeight = 0;
@@ -87,6 +148,15 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
   if (pCodec->id != CODEC_ID_H264 && pCodec->capabilities & CODEC_CAP_DR1)
     m_pCodecContext->flags |= CODEC_FLAG_EMU_EDGE;
 
+  // decode directly into buffers we can pass on to the renderer
+  if (g_advancedSettings.m_videoDirectRendering && pCodec->capabilities & CODEC_CAP_DR1)
+  {
+    m_pBufferPool = new CDVDVideoBufferPool();
+    m_pCodecContext->get_buffer = my_get_buffer;
+    m_pCodecContext->release_buffer = my_release_buffer;
+    CLog::Log(LOGDEBUG,"CDVDVideoCodecFFmpeg::Open() Using direct rendering");
+  }
+
   // Hack to correct wrong frame rates that seem to be generated by some
   // codecs
   if (m_pCodecContext->time_base.den > 1000 && m_pCodecContext->time_base.num == 1)
@@ -160,37 +230,41 @@ void CDVDVideoCodecFFmpeg::Dispose()
     m_dllAvUtil.av_free(m_pCodecContext);
     m_pCodecContext = NULL;
   }
+
+  // buffers still held by the renderer keep the pool alive
+  if (m_pBufferPool)
+  {
+    m_pBufferPool->Release();
+    m_pBufferPool = NULL;
+  }
   
   m_dllAvCodec.Unload();
   m_dllAvUtil.Unload();
 }
 
 void CDVDVideoCodecFFmpeg::SetDropState(bool bDrop)
+{
+  SetSkipLevel(bDrop ? VC_SKIP_NONREF : VC_SKIP_NONE);
+}
+
+void CDVDVideoCodecFFmpeg::SetSkipLevel(int iLevel)
 {
   if( m_pCodecContext )
   {
-    // i don't know exactly how high this should be set
-    // couldn't find any good docs on it. think it varies
-    // from codec to codec on what it does
-
-    //  2 seem to be to high.. it causes video to be ruined on following images
-    if( bDrop )
-    {
-      // TODO: 'hurry_up' has been deprecated in favor of the skip_* variables
-      // Use those instead.
-
-      m_pCodecContext->hurry_up = 1;
-      //m_pCodecContext->skip_frame = AVDISCARD_NONREF;
-      //m_pCodecContext->skip_idct = AVDISCARD_NONREF;
-      //m_pCodecContext->skip_loop_filter = AVDISCARD_NONREF;
-    }
+    // the skip_* fields only take effect in codecs that check them,
+    // hurry_up is kept for the older ones that only look at that.
+    // h264 is the one that benefits most of the first two levels
+    m_pCodecContext->skip_loop_filter = iLevel >= VC_SKIP_LOOPFILTER ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+    m_pCodecContext->skip_idct        = iLevel >= VC_SKIP_IDCT       ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+
+    if( iLevel >= VC_SKIP_BIDIR )
+      m_pCodecContext->skip_frame = AVDISCARD_BIDIR;
+    else if( iLevel >= VC_SKIP_NONREF )
+      m_pCodecContext->skip_frame = AVDISCARD_NONREF;
     else
-    {
-      m_pCodecContext->hurry_up = 0;
-      //m_pCodecContext->skip_frame = AVDISCARD_DEFAULT;
-      //m_pCodecContext->skip_idct = AVDISCARD_DEFAULT;
-      //m_pCodecContext->skip_loop_filter = AVDISCARD_DEFAULT;
-    }
+      m_pCodecContext->skip_frame = AVDISCARD_DEFAULT;
+
+    m_pCodecContext->hurry_up = iLevel >= VC_SKIP_NONREF ? 1 : 0;
   }
 }
 
@@ -335,6 +409,7 @@ bool CDVDVideoCodecFFmpeg::GetPicture(DVDVideoPicture* pDvdVideoPicture)
     pDvdVideoPicture->iHeight = m_pCodecContext->height;
 
   pDvdVideoPicture->pts = DVD_NOPTS_VALUE;
+  pDvdVideoPicture->pBuffer = NULL;
 
   // if we have a converted frame, use that
   AVFrame *frame = m_pFrame;
@@ -355,6 +430,9 @@ bool CDVDVideoCodecFFmpeg::GetPicture(DVDVideoPicture* pDvdVideoPicture)
       pDvdVideoPicture->data[i]      = frame->data[i];
     for (int i = 0; i < 4; i++)
       pDvdVideoPicture->iLineSize[i] = frame->linesize[i];
+
+    if (frame->type == FF_BUFFER_TYPE_USER)
+      pDvdVideoPicture->pBuffer = (CDVDVideoBuffer*)frame->opaque;
   }
   pDvdVideoPicture->iRepeatPicture = frame->repeat_pict;
   pDvdVideoPicture->iFlags = DVP_FLAG_ALLOCATED;    
@@ -26,6 +26,8 @@
 #include "cores/ffmpeg/DllAvFormat.h"
 #include "cores/ffmpeg/DllSwScale.h"
 
+class CDVDVideoBufferPool;
+
 class CDVDVideoCodecFFmpeg : public CDVDVideoCodec
 {
 public:
@@ -37,6 +39,7 @@ public:
   virtual void Reset();
   virtual bool GetPicture(DVDVideoPicture* pDvdVideoPicture);
   virtual void SetDropState(bool bDrop);
+  virtual void SetSkipLevel(int iLevel);
   virtual const char* GetName() { return "FFmpeg"; };
 
 protected:
@@ -50,6 +53,9 @@ protected:
 
   AVPicture* m_pConvertFrame;
 
+  // direct rendering, frames are decoded into ref counted buffers from this pool
+  CDVDVideoBufferPool* m_pBufferPool;
+
   int m_iPictureWidth;
   int m_iPictureHeight;
 
@@ -21,6 +21,41 @@
 
 #include "stdafx.h"
 #include "DVDVideoPPFFmpeg.h"
+#include "utils/CPUInfo.h"
+
+// bands smaller than this aren't worth a thread
+#define PP_MIN_BAND_HEIGHT 128
+#define PP_MAX_BANDS       8
+// lines of context processed above and below a band, more than any of the
+// deinterlacers look at. a multiple of 16 to keep chroma on 8 line blocks.
+#define PP_BAND_CONTEXT    16
+
+CDVDVideoPPFFmpegBand::CDVDVideoPPFFmpegBand(CDVDVideoPPFFmpeg* pParent, const SPPBand& band)
+{
+  m_pParent = pParent;
+  m_band    = band;
+}
+
+CDVDVideoPPFFmpegBand::~CDVDVideoPPFFmpegBand()
+{
+  m_bStop = true;
+  m_eventStart.Set();
+  StopThread();
+  m_pParent->FreeBand(m_band);
+}
+
+void CDVDVideoPPFFmpegBand::Process()
+{
+  while (true)
+  {
+    m_eventStart.Wait();
+    if (m_bStop)
+      break;
+
+    m_pParent->ProcessBand(m_band);
+    m_eventDone.Set();
+  }
+}
 
 CDVDVideoPPFFmpeg::CDVDVideoPPFFmpeg(EPPTYPE mType)
 {
@@ -28,6 +63,8 @@ CDVDVideoPPFFmpeg::CDVDVideoPPFFmpeg(EPPTYPE mType)
   m_pMode = m_pContext = NULL;
   m_pSource = m_pTarget = NULL;
   m_iInitWidth = m_iInitHeight = 0;
+  m_iBandHeight = 0;
+  memset(&m_firstBand, 0, sizeof(m_firstBand));
   memset(&m_FrameBuffer, 0, sizeof(DVDVideoPicture));
 }
 CDVDVideoPPFFmpeg::~CDVDVideoPPFFmpeg()
@@ -36,6 +73,12 @@ CDVDVideoPPFFmpeg::~CDVDVideoPPFFmpeg()
 }
 void CDVDVideoPPFFmpeg::Dispose()
 {
+  for (unsigned int i = 0; i < m_bands.size(); i++)
+    delete m_bands[i];
+  m_bands.clear();
+  FreeBand(m_firstBand);
+  m_iBandHeight = 0;
+
   if (m_pMode)
   {
     m_dll.pp_free_mode(m_pMode);
@@ -78,7 +121,39 @@ bool CDVDVideoPPFFmpeg::CheckInit(int iWidth, int iHeight)
       Dispose();
     }
 
-    m_pContext = m_dll.pp_get_context(m_pSource->iWidth, m_pSource->iHeight, PP_CPU_CAPS_MMX | PP_CPU_CAPS_MMX2 | PP_FORMAT_420);
+    // split tall pictures in bands, each with its own context as
+    // libpostproc keeps per line state in there
+    int iBands = std::min(PP_MAX_BANDS, g_cpuInfo.getCPUCount());
+    iBands = std::max(1, std::min(iBands, (int)m_pSource->iHeight / PP_MIN_BAND_HEIGHT));
+
+    // multiple of 16 so chroma bands start on libpostproc's 8 line blocks
+    m_iBandHeight = ((m_pSource->iHeight + iBands - 1) / iBands + 15) & ~15;
+
+    int flags = PP_CPU_CAPS_MMX | PP_CPU_CAPS_MMX2 | PP_FORMAT_420;
+
+    if (m_iBandHeight < (int)m_pSource->iHeight
+     && InitBand(m_firstBand, 0, m_iBandHeight, flags))
+    {
+      for (int iTop = m_iBandHeight; iTop < (int)m_pSource->iHeight; iTop += m_iBandHeight)
+      {
+        SPPBand band;
+        if (!InitBand(band, iTop, std::min(m_iBandHeight, (int)m_pSource->iHeight - iTop), flags))
+          break;
+
+        CDVDVideoPPFFmpegBand* pBand = new CDVDVideoPPFFmpegBand(this, band);
+        pBand->Create();
+        m_bands.push_back(pBand);
+      }
+    }
+    // the bands have contexts of their own, the whole picture only needs
+    // one when it's done in one go
+    if (m_bands.empty())
+    {
+      FreeBand(m_firstBand);
+      m_pContext = m_dll.pp_get_context(m_pSource->iWidth, m_pSource->iHeight, flags);
+    }
+    else
+      CLog::Log(LOGDEBUG, "%s - postprocessing %dx%d in %d bands", __FUNCTION__, m_pSource->iWidth, m_pSource->iHeight, (int)m_bands.size() + 1);
 
     m_iInitWidth = m_pSource->iWidth;
     m_iInitHeight = m_pSource->iHeight;
@@ -132,12 +207,25 @@ void CDVDVideoPPFFmpeg::Process(DVDVideoPicture* pPicture)
     }
   }
 
-  m_dll.pp_postprocess(m_pSource->data, m_pSource->iLineSize, 
-                m_pTarget->data, m_pTarget->iLineSize,        
-                m_pSource->iWidth, m_pSource->iHeight,
-                0, 0,
-                m_pMode, m_pContext, 
-                PP_PICT_TYPE_QP2); //m_pSource->iFrameType);
+  if (m_bands.empty())
+  {
+    m_dll.pp_postprocess(m_pSource->data, m_pSource->iLineSize,
+                  m_pTarget->data, m_pTarget->iLineSize,
+                  m_pSource->iWidth, m_pSource->iHeight,
+                  0, 0,
+                  m_pMode, m_pContext,
+                  PP_PICT_TYPE_QP2); //m_pSource->iFrameType);
+  }
+  else
+  { // other bands run while this thread does the first one
+    for (unsigned int i = 0; i < m_bands.size(); i++)
+      m_bands[i]->Start();
+
+    ProcessBand(m_firstBand);
+
+    for (unsigned int i = 0; i < m_bands.size(); i++)
+      m_bands[i]->Wait();
+  }
 
   //Copy frame information over to target, but make sure it is set as allocated should decoder have forgotten
   m_pTarget->iFlags = m_pSource->iFlags | DVP_FLAG_ALLOCATED;
@@ -154,6 +242,64 @@ void CDVDVideoPPFFmpeg::Process(DVDVideoPicture* pPicture)
  
 
 
+bool CDVDVideoPPFFmpeg::InitBand(SPPBand& band, int iTop, int iHeight, int flags)
+{
+  memset(&band, 0, sizeof(band));
+  band.iTop    = iTop;
+  band.iHeight = iHeight;
+  band.iStart  = std::max(0, iTop - PP_BAND_CONTEXT);
+  band.iLines  = std::min((int)m_pSource->iHeight, iTop + iHeight + PP_BAND_CONTEXT) - band.iStart;
+
+  band.pContext = m_dll.pp_get_context(m_pSource->iWidth, band.iLines, flags);
+  if (!band.pContext)
+    return false;
+
+  band.iScratchStride[0] = m_pSource->iWidth;
+  band.iScratchStride[1] = m_pSource->iWidth / 2;
+  band.iScratchStride[2] = m_pSource->iWidth / 2;
+  band.scratch[0] = new BYTE[band.iScratchStride[0] * band.iLines];
+  band.scratch[1] = new BYTE[band.iScratchStride[1] * ((band.iLines + 1) / 2)];
+  band.scratch[2] = new BYTE[band.iScratchStride[2] * ((band.iLines + 1) / 2)];
+  return true;
+}
+
+void CDVDVideoPPFFmpeg::FreeBand(SPPBand& band)
+{
+  if (band.pContext)
+    m_dll.pp_free_context(band.pContext);
+  for (int i = 0; i < 3; i++)
+    delete[] band.scratch[i];
+  memset(&band, 0, sizeof(band));
+}
+
+void CDVDVideoPPFFmpeg::ProcessBand(SPPBand& band)
+{
+  uint8_t* src[3];
+  for (int i = 0; i < 3; i++)
+  {
+    int y = i ? band.iStart >> 1 : band.iStart;
+    src[i] = m_pSource->data[i] + y * m_pSource->iLineSize[i];
+  }
+
+  m_dll.pp_postprocess(src, m_pSource->iLineSize,
+                band.scratch, band.iScratchStride,
+                m_pSource->iWidth, band.iLines,
+                0, 0,
+                m_pMode, band.pContext,
+                PP_PICT_TYPE_QP2); //m_pSource->iFrameType);
+
+  // the context lines belong to the neighbours, only our own go out
+  for (int i = 0; i < 3; i++)
+  {
+    int first = i ? band.iTop >> 1 : band.iTop;
+    int end   = i ? (band.iTop + band.iHeight + 1) >> 1 : band.iTop + band.iHeight;
+    int skip  = i ? band.iStart >> 1 : band.iStart;
+    int width = i ? m_pSource->iWidth / 2 : m_pSource->iWidth;
+    for (int y = first; y < end; y++)
+      memcpy(m_pTarget->data[i] + y * m_pTarget->iLineSize[i], band.scratch[i] + (y - skip) * band.iScratchStride[i], width);
+  }
+}
+
 bool CDVDVideoPPFFmpeg::CheckFrameBuffer(const DVDVideoPicture* pSource)
 {
   if( m_FrameBuffer.iFlags & DVP_FLAG_ALLOCATED && (m_FrameBuffer.iWidth != pSource->iWidth || m_FrameBuffer.iHeight != pSource->iHeight))
@@ -171,9 +317,10 @@ bool CDVDVideoPPFFmpeg::CheckFrameBuffer(const DVDVideoPicture* pSource)
   {
     memset(&m_FrameBuffer, 0, sizeof(DVDVideoPicture));
 
-    m_FrameBuffer.iLineSize[0] = pSource->iLineSize[0];   //Y
-    m_FrameBuffer.iLineSize[1] = pSource->iLineSize[1]; //U
-    m_FrameBuffer.iLineSize[2] = pSource->iLineSize[2]; //V
+    // source lines are usually padded, our planes are allocated unpadded
+    m_FrameBuffer.iLineSize[0] = pSource->iWidth;   //Y
+    m_FrameBuffer.iLineSize[1] = pSource->iWidth/2; //U
+    m_FrameBuffer.iLineSize[2] = pSource->iWidth/2; //V
     m_FrameBuffer.iLineSize[3] = 0;
 
     m_FrameBuffer.iWidth = pSource->iWidth;
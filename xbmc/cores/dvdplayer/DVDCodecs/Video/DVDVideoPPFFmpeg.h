@@ -23,6 +23,45 @@
 
 #include "DVDVideoCodec.h"
 #include "cores/ffmpeg/DllPostProc.h"
+#include "utils/Thread.h"
+#include <vector>
+
+class CDVDVideoPPFFmpeg;
+
+// one horizontal band of the picture. it's postprocessed together with a few
+// lines above and below it, so the filters see the same neighbours as they
+// would on the whole picture, into a buffer of its own. only the band's own
+// lines are then copied to the target.
+struct SPPBand
+{
+  void* pContext;
+  int iTop;       // first luma line of the band
+  int iHeight;
+  int iStart;     // first luma line processed, iTop less the context above
+  int iLines;     // lines processed, the band and its context
+  BYTE* scratch[3];
+  int iScratchStride[3];
+};
+
+// worker postprocessing one band of each picture
+class CDVDVideoPPFFmpegBand : public CThread
+{
+public:
+  CDVDVideoPPFFmpegBand(CDVDVideoPPFFmpeg* pParent, const SPPBand& band);
+  virtual ~CDVDVideoPPFFmpegBand();
+
+  void Start()                                      { m_eventStart.Set(); }
+  void Wait()                                       { m_eventDone.Wait(); }
+
+protected:
+  virtual void Process();
+
+  CDVDVideoPPFFmpeg* m_pParent;
+  SPPBand m_band;
+
+  CEvent m_eventStart;
+  CEvent m_eventDone;
+};
 
 class CDVDVideoPPFFmpeg
 {
@@ -44,6 +83,8 @@ public:
   bool GetPicture(DVDVideoPicture *pPicture);
 
 protected:
+  friend class CDVDVideoPPFFmpegBand;
+
   EPPTYPE m_eType;
 
   void *m_pContext;
@@ -58,6 +99,16 @@ protected:
   int m_iInitWidth, m_iInitHeight;
   bool CheckInit(int iWidth, int iHeight);
   bool CheckFrameBuffer(const DVDVideoPicture* pSource);
+
+  // the picture is split in bands of m_iBandHeight lines, the first one is
+  // done on the calling thread with m_firstBand, the others by m_bands. with
+  // a single band it's m_pContext straight into the target.
+  bool InitBand(SPPBand& band, int iTop, int iHeight, int flags);
+  void FreeBand(SPPBand& band);
+  void ProcessBand(SPPBand& band);
+  SPPBand m_firstBand;
+  std::vector<CDVDVideoPPFFmpegBand*> m_bands;
+  int m_iBandHeight;
   
   DllPostProc m_dll;
 };
@@ -40,6 +40,7 @@
 #include "utils/GUIInfoManager.h"
 #include "Application.h"
 #include "DVDPerformanceCounter.h"
+#include "utils/Metrics.h"
 #include "../../FileSystem/cdioSupport.h"
 #include "../../Picture.h"
 #include "../ffmpeg/DllSwScale.h"
@@ -956,6 +957,7 @@ void CDVDPlayer::Process()
     SetCaching(true);
 #endif
 
+  DWORD lastMetrics = 0;
   while (!m_bAbortRequest)
   {
     // handle messages send to this thread, like seek or demuxer reset requests
@@ -1124,6 +1126,25 @@ void CDVDPlayer::Process()
     // process the packet
     ProcessPacket(pStream, pPacket);
 
+    // publish the queue levels and decode times for the http api now and then
+    if (timeGetTime() - lastMetrics >= 500)
+    {
+      lastMetrics = timeGetTime();
+      CMetrics::SetGauge("dvdplayer_queue_bytes{stream=\"audio\"}", m_dvdPlayerAudio.m_messageQueue.GetDataSize());
+      CMetrics::SetGauge("dvdplayer_queue_bytes{stream=\"video\"}", m_dvdPlayerVideo.m_messageQueue.GetDataSize());
+      CMetrics::SetGauge("dvdplayer_cache_level_percent", GetCacheLevel());
+      CMetrics::SetGauge("dvdplayer_source_bitrate", GetSourceBitrate());
+
+      unsigned int count;
+      double ms;
+      m_dvdPlayerAudio.m_decodeTime.Take(count, ms);
+      CMetrics::Increment("dvdplayer_decodes_total{stream=\"audio\"}", count);
+      CMetrics::SetGauge("dvdplayer_decode_avg_ms{stream=\"audio\"}", count ? ms / count : 0.0);
+      m_dvdPlayerVideo.m_decodeTime.Take(count, ms);
+      CMetrics::Increment("dvdplayer_decodes_total{stream=\"video\"}", count);
+      CMetrics::SetGauge("dvdplayer_decode_avg_ms{stream=\"video\"}", count ? ms / count : 0.0);
+    }
+
     // present the cache dialog until playback actually started
     if (m_pDlgCache)
     {
@@ -1603,6 +1624,13 @@ void CDVDPlayer::OnExit()
 {
   g_dvdPerformanceCounter.DisableMainPerformance();
 
+  CMetrics::RemoveGauge("dvdplayer_queue_bytes{stream=\"audio\"}");
+  CMetrics::RemoveGauge("dvdplayer_queue_bytes{stream=\"video\"}");
+  CMetrics::RemoveGauge("dvdplayer_cache_level_percent");
+  CMetrics::RemoveGauge("dvdplayer_source_bitrate");
+  CMetrics::RemoveGauge("dvdplayer_decode_avg_ms{stream=\"audio\"}");
+  CMetrics::RemoveGauge("dvdplayer_decode_avg_ms{stream=\"video\"}");
+
   if (m_pDlgCache)
     m_pDlgCache->SetMessage(g_localizeStrings.Get(10212));
 
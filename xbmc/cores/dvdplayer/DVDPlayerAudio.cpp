@@ -271,7 +271,9 @@ int CDVDPlayerAudio::DecodeFrame(DVDAudioFrame &audioframe, bool bDropPacket)
       if (dts != DVD_NOPTS_VALUE)
         m_audioClock = dts;
 
-		int len = m_pAudioCodec->Decode(m_decode.data, m_decode.size);
+      double decodeStart = CDVDClock::GetAbsoluteClock();
+      int len = m_pAudioCodec->Decode(m_decode.data, m_decode.size);
+      m_decodeTime.Add((CDVDClock::GetAbsoluteClock() - decodeStart) * 1000 / DVD_TIME_BASE);
       m_audioStats.AddSampleBytes(m_decode.size);
       if (len < 0)
       {
@@ -28,6 +28,7 @@
 #include "DVDDemuxers/DVDDemuxUtils.h"
 #include "DVDStreamInfo.h"
 #include "BitstreamStats.h"
+#include "../../utils/Metrics.h"
 
 class CDVDPlayer;
 class CDVDAudioCodec;
@@ -112,6 +113,7 @@ public:
   CDVDStreamInfo m_streaminfo;
   
   CDVDMessageQueue m_messageQueue;
+  CMetricAccumulator m_decodeTime;  // time spent in the codec, published by CDVDPlayer
   CPTSOutputQueue m_ptsOutput;
   CPTSInputQueue  m_ptsInput;
 
@@ -48,6 +48,7 @@ CDVDPlayerVideo::CDVDPlayerVideo(CDVDClock* pClock, CDVDOverlayContainer* pOverl
   m_pTempOverlayPicture = NULL;
   m_pVideoCodec = NULL;
   m_pOverlayCodecCC = NULL;
+  m_pOutputThread = NULL;
   m_speed = DVD_PLAYSPEED_NORMAL;
   
   m_bRenderSubs = false;
@@ -57,6 +58,7 @@ CDVDPlayerVideo::CDVDPlayerVideo(CDVDClock* pClock, CDVDOverlayContainer* pOverl
   m_iSubtitleDelay = 0;
   m_fForcedAspectRatio = 0;
   m_iNrOfPicturesNotToSkip = 0;
+  m_iStepFrames = 0;
   InitializeCriticalSection(&m_critCodecSection);
   m_messageQueue.SetMaxDataSize(CDVDPlayer::GetCacheSize() * 1024); // 20 * 256 * 1024 
   printf("Setting video cache size to %dKB\n", CDVDPlayer::GetCacheSize());
@@ -64,7 +66,10 @@ CDVDPlayerVideo::CDVDPlayerVideo(CDVDClock* pClock, CDVDOverlayContainer* pOverl
   
   m_iCurrentPts = DVD_NOPTS_VALUE;
   m_iDroppedFrames = 0;
+  m_iDroppedRow = 0;
   m_bDropFrames = true;
+  m_iSkipLevel = VC_SKIP_NONE;
+  memset(m_iSkipCount, 0, sizeof(m_iSkipCount));
   m_fFrameRate = 25;
   m_bAllowFullscreen = false;
   memset(&m_output, 0, sizeof(m_output));
@@ -87,7 +92,8 @@ CDVDPlayerVideo::~CDVDPlayerVideo()
 
 double CDVDPlayerVideo::GetOutputDelay()
 {
-    double time = m_messageQueue.GetPacketCount(CDVDMsg::DEMUXER_PACKET);
+    double time = m_messageQueue.GetPacketCount(CDVDMsg::DEMUXER_PACKET)
+                + m_pictureQueue.GetSize();
     if( m_fFrameRate )
       time = (time * DVD_TIME_BASE) / m_fFrameRate;
     else
@@ -147,25 +153,50 @@ bool CDVDPlayerVideo::OpenStream( CDVDStreamInfo &hint )
 
   m_messageQueue.Init();
 
+  // present from a separate thread, so a slow frame to decode
+  // eats into the queued pictures instead of delaying output
+  if (g_advancedSettings.m_videoPictureQueueSize > 0)
+  {
+    m_pictureQueue.Init(g_advancedSettings.m_videoPictureQueueSize);
+    m_pOutputThread = new CThread(this);
+  }
+
   CLog::Log(LOGNOTICE, "Creating video thread");
   Create();
 
+  // output thread runs for as long as the decoding thread's m_bStop is clear
+  if (m_pOutputThread)
+  {
+    CLog::Log(LOGNOTICE, "Creating video output thread, queueing %d pictures", m_pictureQueue.GetMaxSize());
+    m_pOutputThread->Create();
+  }
+
   return true;
 }
 
 void CDVDPlayerVideo::CloseStream(bool bWaitForBuffers)
 {
   // wait until buffers are empty
-  if (bWaitForBuffers && m_speed > 0) m_messageQueue.WaitUntilEmpty();
+  if (bWaitForBuffers && m_speed > 0) WaitForBuffers();
 
   m_messageQueue.Abort();
+  m_pictureQueue.Abort();
 
   // wait for decode_video thread to end
   CLog::Log(LOGNOTICE, "waiting for video thread to exit");
 
   StopThread(); // will set this->m_bStop to true  
 
+  if (m_pOutputThread)
+  {
+    CLog::Log(LOGNOTICE, "waiting for video output thread to exit");
+    m_pOutputThread->StopThread();
+    delete m_pOutputThread;
+    m_pOutputThread = NULL;
+  }
+
   m_messageQueue.End();
+  m_pictureQueue.End();
 
   CLog::Log(LOGNOTICE, "deleting video codec");
   if (m_pVideoCodec)
@@ -186,9 +217,16 @@ void CDVDPlayerVideo::OnStartup()
 {
   CThread::SetName("CDVDPlayerVideo");
   m_iDroppedFrames = 0;
+  m_iDroppedRow = 0;
+  m_iSkipLevel = VC_SKIP_NONE;
+  m_iSkipFrames = 0;
+  m_iSkipOnTime = 0;
+  m_iLateness = 0;
+  memset(m_iSkipCount, 0, sizeof(m_iSkipCount));
   
   m_iCurrentPts = DVD_NOPTS_VALUE;
   m_FlipTimeStamp = m_pClock->GetAbsoluteClock();
+  m_pictureQueue.SetFlipTime(m_FlipTimeStamp);
 
 #ifdef HAS_VIDEO_PLAYBACK
   if(!m_output.inited)
@@ -212,13 +250,13 @@ void CDVDPlayerVideo::Process()
   double pts = 0;
   double frametime = (double)DVD_TIME_BASE / m_fFrameRate;
 
-  int iDropped = 0; //frames dropped in a row
-  bool bRequestDrop = false;  
 
   m_videoStats.Start();
 
   while (!m_bStop)
   {
+    m_iNrOfPicturesNotToSkip += InterlockedExchange(&m_iStepFrames, 0);
+
     int iQueueTimeOut = (int)(m_stalled ? frametime / 4 : frametime * 10) / 1000;
     int iPriority = (m_speed == DVD_PLAYSPEED_PAUSE && m_iNrOfPicturesNotToSkip == 0) ? 1 : 0;
 
@@ -250,8 +288,11 @@ void CDVDPlayerVideo::Process()
         //Remove interlaced flag before outputting
         //no need to output this as if it was interlaced
         picture.iFlags &= ~DVP_FLAG_INTERLACED;
-        picture.iFlags |= DVP_FLAG_NOSKIP;
-        OutputPicture(&picture, pts);
+        picture.iFlags |= DVP_FLAG_NOSKIP | DVP_FLAG_STILL;
+        picture.iRepeatPicture = 0;
+        EnterCriticalSection(&m_critCodecSection);
+        QueuePicture(&picture, pts);
+        LeaveCriticalSection(&m_critCodecSection);
         pts+= frametime;
       }
 
@@ -276,7 +317,11 @@ void CDVDPlayerVideo::Process()
       if(pMsgGeneralResync->m_timestamp != DVD_NOPTS_VALUE)
         pts = pMsgGeneralResync->m_timestamp;
 
-      double delay = m_FlipTimeStamp - m_pClock->GetAbsoluteClock();
+      // pictures already queued belong to the old timeline, let them go first
+      if(pMsgGeneralResync->m_clock)
+        m_pictureQueue.WaitUntilEmpty((unsigned int)DVD_TIME_TO_MSEC(frametime * m_pictureQueue.GetSize()));
+
+      double delay = m_pictureQueue.GetFlipTime() - m_pClock->GetAbsoluteClock();
       if( delay > frametime ) delay = frametime;
       else if( delay < 0 )    delay = 0;
 
@@ -314,6 +359,10 @@ void CDVDPlayerVideo::Process()
       if(m_pVideoCodec)
         m_pVideoCodec->Reset();
       LeaveCriticalSection(&m_critCodecSection);
+      m_pictureQueue.Flush();
+
+      // the codec let go of whatever the last picture pointed to
+      memset(&picture, 0, sizeof(DVDVideoPicture));
     }
     else if (pMsg->IsType(CDVDMsg::VIDEO_NOSKIP))
     {
@@ -346,22 +395,26 @@ void CDVDPlayerVideo::Process()
         //in normal mpegs
         m_iNrOfPicturesNotToSkip = 5;
       }
-      else if( iDropped*frametime > DVD_MSEC_TO_TIME(100) )
+      else if( m_iDroppedRow*frametime > DVD_MSEC_TO_TIME(100) )
       { // if we dropped too many pictures in a row, insert a forced picture
         m_iNrOfPicturesNotToSkip++;
       }
 
+      int iSkipLevel = m_iSkipLevel;
+
 #ifdef PROFILE
-      bRequestDrop = false;
+      iSkipLevel = VC_SKIP_NONE;
 #else
-      if (m_iNrOfPicturesNotToSkip > 0) bRequestDrop = false;
-      if (m_speed < 0)                  bRequestDrop = false;
-      if (m_bDropFrames == false)       bRequestDrop = false;
+      if (m_iNrOfPicturesNotToSkip > 0) iSkipLevel = VC_SKIP_NONE;
+      if (m_speed < 0)                  iSkipLevel = VC_SKIP_NONE;
+      if (m_bDropFrames == false)       iSkipLevel = VC_SKIP_NONE;
 #endif
 
       // if player want's us to drop this packet, do so nomatter what
       if(bPacketDrop)
-        bRequestDrop = true;
+        iSkipLevel = VC_SKIP_LEVELS - 1;
+      else
+        m_iSkipCount[iSkipLevel]++;
 
 
       EnterCriticalSection(&m_critCodecSection);
@@ -369,18 +422,20 @@ void CDVDPlayerVideo::Process()
       // problem here, if one packet contains more than one frame
       // both frames will be dropped in that case instead of just the first
       // decoder still needs to provide an empty image structure, with correct flags
-      m_pVideoCodec->SetDropState(bRequestDrop);
+      m_pVideoCodec->SetSkipLevel(iSkipLevel);
 
+      double decodeStart = CDVDClock::GetAbsoluteClock();
       int iDecoderState = m_pVideoCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->pts);
+      m_decodeTime.Add((CDVDClock::GetAbsoluteClock() - decodeStart) * 1000 / DVD_TIME_BASE);
       m_videoStats.AddSampleBytes(pPacket->iSize);
       // assume decoder dropped a picture if it didn't give us any
       // picture from a demux packet, this should be reasonable
       // for libavformat as a demuxer as it normally packetizes
       // pictures when they come from demuxer
-      if(bRequestDrop && !bPacketDrop && (iDecoderState & VC_BUFFER) && !(iDecoderState & VC_PICTURE))
+      if(iSkipLevel >= VC_SKIP_NONREF && !bPacketDrop && (iDecoderState & VC_BUFFER) && !(iDecoderState & VC_PICTURE))
       {
         m_iDroppedFrames++;
-        iDropped++;
+        m_iDroppedRow++;
       }
 
       // loop while no error
@@ -435,25 +490,11 @@ void CDVDPlayerVideo::Process()
             if(picture.pts != DVD_NOPTS_VALUE)
               pts = picture.pts;
 
-            int iResult;
-            do 
-            {
-              try 
-              {
-                iResult = OutputPicture(&picture, pts);
-              }
-              catch (...)
-              {
-                CLog::Log(LOGERROR, "%s - Exception caught when outputing picture", __FUNCTION__);
-                iResult = EOS_ABORT;
-              }
-
-              if (iResult == EOS_ABORT) break;
-
-              // guess next frame pts. iDuration is always valid
-              pts += picture.iDuration * m_speed / abs(m_speed);
-            }
-            while (!m_bStop && picture.iRepeatPicture-- > 0);
+            int iResult = QueuePicture(&picture, pts);
+
+            // guess next frame pts. iDuration is always valid
+            if (m_speed)
+              pts += picture.iDuration * (picture.iRepeatPicture + 1) * m_speed / abs(m_speed);
 
             if( iResult & EOS_ABORT )
             {
@@ -464,16 +505,6 @@ void CDVDPlayerVideo::Process()
               iDecoderState = m_pVideoCodec->Decode(NULL, 0, DVD_NOPTS_VALUE);
               break;
             }
-
-            if( (iResult & EOS_DROPPED) && !bPacketDrop )
-            {
-              m_iDroppedFrames++;
-              iDropped++;
-            }
-            else
-              iDropped = 0;
-
-            bRequestDrop = (iResult & EOS_VERYLATE) == EOS_VERYLATE;
           }
           else
           {
@@ -516,6 +547,150 @@ void CDVDPlayerVideo::Process()
   }
 }
 
+// called holding m_critCodecSection once, pPicture may point into the codec's buffers
+int CDVDPlayerVideo::QueuePicture(DVDVideoPicture* pPicture, double pts, unsigned int iTimeout)
+{
+  if (!m_pOutputThread)
+    return PresentPicture(pPicture, pts);
+
+  DVDVideoPicture* pQueued = m_pictureQueue.Reference(pPicture);
+  if (!pQueued)
+    return EOS_DROPPED;
+
+  // only our copy is used from here on, so the codec isn't kept locked
+  // while the presentation side makes room
+  LeaveCriticalSection(&m_critCodecSection);
+  MsgQueueReturnCode ret = m_pictureQueue.PutReference(pQueued, pts, iTimeout);
+  EnterCriticalSection(&m_critCodecSection);
+
+  if (ret == MSGQ_TIMEOUT)
+    return EOS_DROPPED;
+  if (ret != MSGQ_OK)
+    return EOS_ABORT;
+  return 0;
+}
+
+int CDVDPlayerVideo::PresentPicture(DVDVideoPicture* pPicture, double pts)
+{
+  unsigned int iRepeat = pPicture->iRepeatPicture;
+  int iResult;
+  do 
+  {
+    try 
+    {
+      iResult = OutputPicture(pPicture, pts);
+    }
+    catch (...)
+    {
+      CLog::Log(LOGERROR, "%s - Exception caught when outputing picture", __FUNCTION__);
+      iResult = EOS_ABORT;
+    }
+
+    if (iResult == EOS_ABORT) break;
+
+    if (m_speed)
+      pts += pPicture->iDuration * m_speed / abs(m_speed);
+  }
+  while (!m_bStop && iRepeat-- > 0);
+
+  if( iResult & EOS_ABORT )
+    return iResult;
+
+  if( (iResult & EOS_DROPPED) && !(pPicture->iFlags & DVP_FLAG_DROPPED) )
+  {
+    m_iDroppedFrames++;
+    m_iDroppedRow++;
+  }
+  else
+    m_iDroppedRow = 0;
+
+  if( !(pPicture->iFlags & DVP_FLAG_STILL) )
+    UpdateSkipLevel(m_iLateness);
+
+  return iResult;
+}
+
+// steps the decoder's skip level up while pictures keep coming out later
+// than the clock, and back down one level at a time once they have been
+// on time for about a second
+void CDVDPlayerVideo::UpdateSkipLevel(double iLateness)
+{
+  m_iSkipFrames++;
+
+  if( iLateness > DVD_MSEC_TO_TIME(100) )
+  {
+    m_iSkipOnTime = 0;
+
+    // pictures still queued were decoded at the old level, wait for those
+    // to be out of the way before concluding the level isn't enough
+    if( m_iSkipLevel < VC_SKIP_LEVELS - 1 && m_iSkipFrames > m_pictureQueue.GetSize() )
+    {
+      m_iSkipLevel++;
+      m_iSkipFrames = 0;
+      CLog::Log(LOGDEBUG, "%s - %d ms late, skip level raised to %d", __FUNCTION__, DVD_TIME_TO_MSEC(iLateness), (int)m_iSkipLevel);
+    }
+  }
+  else if( iLateness <= 0.0 )
+  {
+    if( m_iSkipLevel > VC_SKIP_NONE && ++m_iSkipOnTime >= m_fFrameRate )
+    {
+      m_iSkipLevel--;
+      m_iSkipFrames = 0;
+      m_iSkipOnTime = 0;
+      CLog::Log(LOGDEBUG, "%s - on time, skip level lowered to %d", __FUNCTION__, (int)m_iSkipLevel);
+    }
+  }
+  else
+    m_iSkipOnTime = 0;
+}
+
+void CDVDPlayerVideo::Run()
+{
+  CLog::Log(LOGNOTICE, "running thread: video_output_thread");
+
+  DVDVideoPicture* pPicture = NULL;
+  unsigned int iFlushCount = 0;
+  double pts = 0;
+
+  while (!m_bStop)
+  {
+    if (!pPicture)
+    {
+      MsgQueueReturnCode ret = m_pictureQueue.Get(&pPicture, &pts, 100);
+      if (ret == MSGQ_TIMEOUT)
+        continue;
+      if (MSGQ_IS_ERROR(ret) || ret == MSGQ_ABORT)
+        break;
+      iFlushCount = m_pictureQueue.GetFlushCount();
+    }
+
+    // hold on to the picture while paused, unless it has to be shown anyway.
+    // one that has to be shown may be queued behind it, eg. when stepping frames
+    if (m_speed == DVD_PLAYSPEED_PAUSE && !(pPicture->iFlags & DVP_FLAG_NOSKIP))
+    {
+      if (iFlushCount != m_pictureQueue.GetFlushCount() || m_pictureQueue.HasPicture(DVP_FLAG_NOSKIP))
+      {
+        m_pictureQueue.Release(pPicture);
+        pPicture = NULL;
+      }
+      else
+        Sleep(10);
+      continue;
+    }
+
+    if (PresentPicture(pPicture, pts) & EOS_ABORT)
+      CLog::Log(LOGWARNING, "%s - failed to output picture", __FUNCTION__);
+
+    m_pictureQueue.Release(pPicture);
+    pPicture = NULL;
+  }
+
+  if (pPicture)
+    m_pictureQueue.Release(pPicture);
+
+  CLog::Log(LOGNOTICE, "thread end: video_output_thread");
+}
+
 void CDVDPlayerVideo::OnExit()
 {
   g_dvdPerformanceCounter.DisableVideoDecodePerformance();
@@ -592,9 +767,19 @@ void CDVDPlayerVideo::SetSpeed(int speed)
     m_speed = speed;
 }
 
+void CDVDPlayerVideo::WaitForBuffers()
+{
+  m_messageQueue.WaitUntilEmpty();
+
+  // then give the presentation side time to show what was decoded
+  double frametime = (double)DVD_TIME_BASE / m_fFrameRate;
+  m_pictureQueue.WaitUntilEmpty((unsigned int)DVD_TIME_TO_MSEC(frametime * (m_pictureQueue.GetSize() + 1)));
+}
+
 void CDVDPlayerVideo::StepFrame()
 {
-  m_iNrOfPicturesNotToSkip++;
+  // picked up by the decoding thread, which owns m_iNrOfPicturesNotToSkip
+  InterlockedIncrement(&m_iStepFrames);
 }
 
 void CDVDPlayerVideo::Flush()
@@ -603,6 +788,7 @@ void CDVDPlayerVideo::Flush()
   /* and any demux packet that has been taken out of queue need to */
   /* be disposed of before we flush */
   m_messageQueue.Flush();
+  m_pictureQueue.Flush();
   m_messageQueue.Put(new CDVDMsg(CDVDMsg::GENERAL_FLUSH));
 }
 
@@ -758,7 +944,7 @@ int CDVDPlayerVideo::OutputPicture(DVDVideoPicture* pPicture, double pts)
   iClockSleep = min(iClockSleep, DVD_MSEC_TO_TIME(500));
   iFrameSleep = min(iFrameSleep, DVD_MSEC_TO_TIME(500));
 
-  if( m_stalled )
+  if( pPicture->iFlags & DVP_FLAG_STILL )
   { // when we render a still, we can't sync to clock anyway
     iSleepTime = iFrameSleep;
   }
@@ -777,17 +963,17 @@ int CDVDPlayerVideo::OutputPicture(DVDVideoPicture* pPicture, double pts)
 
   // present the current pts of this frame to user, and include the actual
   // presentation delay, to allow him to adjust for it
-  if( !m_stalled )
+  if( !(pPicture->iFlags & DVP_FLAG_STILL) )
     m_iCurrentPts = pts - max(0.0, iSleepTime);
 
   // timestamp when we think next picture should be displayed based on current duration
   m_FlipTimeStamp  = iCurrentClock;
   m_FlipTimeStamp += max(0.0, iSleepTime);
   m_FlipTimeStamp += iFrameDuration;
+  m_pictureQueue.SetFlipTime(m_FlipTimeStamp);
 
-  // ask decoder to drop frames next round, as we are very late
-  if( iClockSleep < -DVD_MSEC_TO_TIME(100) )
-    result |= EOS_VERYLATE;
+  // lateness against the clock drives the decoder's skip level
+  m_iLateness = -iClockSleep;
 
   if( m_speed < 0 )
   {
@@ -852,7 +1038,18 @@ int CDVDPlayerVideo::OutputPicture(DVDVideoPicture* pPicture, double pts)
   if (index < 0) 
     return EOS_DROPPED;
 
-  ProcessOverlays(pPicture, &image, pts);
+  // without anything to blend on top, the renderer can show the decoder's
+  // buffer as is instead of us copying it into the image
+  bool bAttached = false;
+  if (pPicture->pBuffer)
+  {
+    m_pOverlayContainer->CleanUp(min(pts, pts - m_iSubtitleDelay));
+    if (m_pOverlayContainer->GetSize() == 0)
+      bAttached = g_renderManager.AttachImage(index, pPicture->data, pPicture->iLineSize, pPicture->pBuffer);
+  }
+
+  if (!bAttached)
+    ProcessOverlays(pPicture, &image, pts);
   
   // tell the renderer that we've finished with the image (so it can do any
   // post processing before FlipPage() is called.)
@@ -880,11 +1077,14 @@ void CDVDPlayerVideo::UpdateMenuPicture()
   if (m_pVideoCodec)
   {
     DVDVideoPicture picture;
+    memset(&picture, 0, sizeof(DVDVideoPicture));
     EnterCriticalSection(&m_critCodecSection);
     if (m_pVideoCodec->GetPicture(&picture))
     {
       picture.iFlags |= DVP_FLAG_NOSKIP;
-      OutputPicture(&picture, 0);
+      // called from the player thread, don't wait for room. a full
+      // queue means newer pictures are on their way anyway.
+      QueuePicture(&picture, 0, 0);
     }
     LeaveCriticalSection(&m_critCodecSection);
   }
@@ -895,6 +1095,12 @@ std::string CDVDPlayerVideo::GetPlayerInfo()
   std::ostringstream s;
   s << "vq:" << std::setw(3) << min(99,100 * m_messageQueue.GetDataSize() / m_messageQueue.GetMaxDataSize()) << "%";
   s << ", ";
+  if (m_pOutputThread)
+    s << "pq:" << m_pictureQueue.GetSize() << "/" << m_pictureQueue.GetMaxSize() << ", ";
+  s << "skip:" << m_iSkipLevel << " (";
+  for (int i = VC_SKIP_LOOPFILTER; i < VC_SKIP_LEVELS; i++)
+    s << (i > VC_SKIP_LOOPFILTER ? "/" : "") << m_iSkipCount[i];
+  s << "), ";
   s << "cpu: " << (int)(100 * CThread::GetRelativeUsage()) << "%, ";
   s << "bitrate: " << std::setprecision(4) << (double)GetVideoBitrate() / (1024.0*1024.0) << " MBit/s";
   return s.str();
@@ -27,6 +27,8 @@
 #include "DVDCodecs/Video/DVDVideoCodec.h"
 #include "DVDClock.h"
 #include "DVDOverlayContainer.h"
+#include "DVDVideoPictureQueue.h"
+#include "../../utils/Metrics.h"
 #ifdef HAS_VIDEO_PLAYBACK
 #include "cores/VideoRenderers/RenderManager.h"
 #endif
@@ -37,7 +39,7 @@ class CDVDOverlayCodecCC;
 
 #define VIDEO_PICTURE_QUEUE_SIZE 1
 
-class CDVDPlayerVideo : public CThread
+class CDVDPlayerVideo : public CThread, public IRunnable
 {
 public:
   CDVDPlayerVideo(CDVDClock* pClock, CDVDOverlayContainer* pOverlayContainer);
@@ -51,7 +53,7 @@ public:
 
   // waits untill all available data has been rendered
   // just waiting for packetqueue should be enough for video
-  void WaitForBuffers()                             { m_messageQueue.WaitUntilEmpty(); }
+  void WaitForBuffers();
   bool AcceptsData()                                { return !m_messageQueue.IsFull(); }
   void SendMessage(CDVDMsg* pMsg)                   { m_messageQueue.Put(pMsg); }
 
@@ -102,6 +104,8 @@ public:
 
   // classes
   CDVDMessageQueue m_messageQueue;
+  CDVDVideoPictureQueue m_pictureQueue; // decoded pictures waiting for presentation
+  CMetricAccumulator m_decodeTime;      // time spent in the codec, published by CDVDPlayer
   CDVDOverlayContainer* m_pOverlayContainer;
   
   CDVDClock* m_pClock;
@@ -110,11 +114,14 @@ protected:
   virtual void OnStartup();
   virtual void OnExit();
   virtual void Process();
+  virtual void Run(); // presentation thread, pulls from m_pictureQueue
 
 #define EOS_ABORT 1
 #define EOS_DROPPED 2
-#define EOS_VERYLATE 4
 
+  int QueuePicture(DVDVideoPicture* pPicture, double pts, unsigned int iTimeout = INFINITE);
+  int PresentPicture(DVDVideoPicture* pPicture, double pts);
+  void UpdateSkipLevel(double iLateness);
   int OutputPicture(DVDVideoPicture* pPicture, double pts);
   void ProcessOverlays(DVDVideoPicture* pSource, YV12Image* pDest, double pts);
   void ProcessVideoUserData(DVDVideoUserData* pVideoUserData, double pts);
@@ -123,10 +130,19 @@ protected:
   double m_iVideoDelay;
   double m_iSubtitleDelay;
   double m_FlipTimeStamp; // time stamp of last flippage. used to play at a forced framerate
+                          // the presentation side's once OnStartup() set it, others read m_pictureQueue.GetFlipTime()
 
   int m_iDroppedFrames;
+  int m_iDroppedRow; // frames dropped in a row
   bool m_bDropFrames;
 
+  // graded frame skipping, see UpdateSkipLevel
+  volatile int m_iSkipLevel;          // VC_SKIP_ level the decoder should use
+  int m_iSkipFrames;                  // pictures shown since the level last changed
+  int m_iSkipOnTime;                  // pictures in a row that were on time
+  int m_iSkipCount[VC_SKIP_LEVELS];   // packets decoded at each level
+  double m_iLateness;                 // how far the last picture was behind the clock
+
   float m_fFrameRate;
 
   struct SOutputConfiguration
@@ -146,13 +162,14 @@ protected:
   
   float m_fForcedAspectRatio;
   
-  int m_iNrOfPicturesNotToSkip;
+  int m_iNrOfPicturesNotToSkip; // decoding thread only, see m_iStepFrames
+  LONG m_iStepFrames;           // frames StepFrame() asked for, not yet added to the above
   int m_speed;
 
   double m_droptime;
   double m_dropbase;
 
-  bool m_stalled;
+  bool m_stalled;  // decoding thread only, pictures repeated meanwhile carry DVP_FLAG_STILL
   bool m_started;
 
   /* autosync decides on how much of clock we should use when deciding sleep time */
@@ -165,6 +182,7 @@ protected:
   // classes
   CDVDVideoCodec* m_pVideoCodec;
   CDVDOverlayCodecCC* m_pOverlayCodecCC;
+  CThread* m_pOutputThread;
   
   DVDVideoPicture* m_pTempOverlayPicture;
   
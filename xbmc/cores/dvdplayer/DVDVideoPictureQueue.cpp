@@ -0,0 +1,351 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "DVDVideoPictureQueue.h"
+#include "DVDCodecs/DVDCodecUtils.h"
+#include "DVDCodecs/Video/DVDVideoBufferPool.h"
+
+using namespace std;
+
+CDVDVideoPictureQueue::CDVDVideoPictureQueue()
+{
+  m_iMaxSize      = 0;
+  m_iFlushCount   = 0;
+  m_flipTime      = 0.0;
+  m_bAbortRequest = false;
+  m_bInitialized  = false;
+
+  InitializeCriticalSection(&m_critSection);
+  m_hPutEvent = CreateEvent(NULL, true, false, NULL);
+  m_hGetEvent = CreateEvent(NULL, true, false, NULL);
+}
+
+CDVDVideoPictureQueue::~CDVDVideoPictureQueue()
+{
+  End();
+
+  DeleteCriticalSection(&m_critSection);
+  CloseHandle(m_hPutEvent);
+  CloseHandle(m_hGetEvent);
+}
+
+void CDVDVideoPictureQueue::Init(int iMaxSize)
+{
+  EnterCriticalSection(&m_critSection);
+  m_iMaxSize      = iMaxSize;
+  m_bAbortRequest = false;
+  m_bInitialized  = true;
+  LeaveCriticalSection(&m_critSection);
+}
+
+void CDVDVideoPictureQueue::Flush()
+{
+  EnterCriticalSection(&m_critSection);
+  deque<SQueuedPicture> queue;
+  queue.swap(m_queue);
+  m_iFlushCount++;
+  SetEvent(m_hGetEvent); // there is room again
+  LeaveCriticalSection(&m_critSection);
+
+  for (unsigned int i = 0; i < queue.size(); i++)
+    Release(queue[i].pPicture);
+}
+
+void CDVDVideoPictureQueue::Abort()
+{
+  EnterCriticalSection(&m_critSection);
+
+  m_bAbortRequest = true;
+
+  // inform waiters on both ends
+  SetEvent(m_hPutEvent);
+  SetEvent(m_hGetEvent);
+
+  LeaveCriticalSection(&m_critSection);
+}
+
+void CDVDVideoPictureQueue::End()
+{
+  Flush();
+
+  EnterCriticalSection(&m_critSection);
+
+  for (unsigned int i = 0; i < m_unused.size(); i++)
+    FreePicture(m_unused[i]);
+  m_unused.clear();
+
+  m_bInitialized  = false;
+  m_bAbortRequest = false;
+
+  LeaveCriticalSection(&m_critSection);
+}
+
+DVDVideoPicture* CDVDVideoPictureQueue::Reference(DVDVideoPicture* pSource)
+{
+  DVDVideoPicture* pPicture;
+
+  if (pSource->pBuffer)
+  {
+    // buffer stays valid for as long as we hold a reference to it
+    pPicture = new DVDVideoPicture;
+    *pPicture = *pSource;
+    pPicture->pBuffer->Acquire();
+    return pPicture;
+  }
+
+  pPicture = NULL;
+
+  EnterCriticalSection(&m_critSection);
+  while (!m_unused.empty())
+  {
+    pPicture = m_unused.back();
+    m_unused.pop_back();
+    if (pPicture->iWidth == pSource->iWidth && pPicture->iHeight == pSource->iHeight)
+      break;
+
+    FreePicture(pPicture);
+    pPicture = NULL;
+  }
+  LeaveCriticalSection(&m_critSection);
+
+  if (!pPicture)
+  {
+    pPicture = CDVDCodecUtils::AllocatePicture(pSource->iWidth, pSource->iHeight);
+    if (!pPicture)
+      return NULL;
+  }
+
+  BYTE* data[4];
+  int   linesize[4];
+  memcpy(data,     pPicture->data,      sizeof(data));
+  memcpy(linesize, pPicture->iLineSize, sizeof(linesize));
+
+  *pPicture = *pSource;
+
+  memcpy(pPicture->data,      data,     sizeof(data));
+  memcpy(pPicture->iLineSize, linesize, sizeof(linesize));
+  pPicture->pBuffer = NULL;
+
+  // dropped pictures carry no data
+  if (!(pSource->iFlags & DVP_FLAG_DROPPED))
+    CDVDCodecUtils::CopyPicture(pPicture, pSource);
+  return pPicture;
+}
+
+void CDVDVideoPictureQueue::Release(DVDVideoPicture* pPicture)
+{
+  if (pPicture->pBuffer)
+  {
+    pPicture->pBuffer->Release();
+    delete pPicture;
+    return;
+  }
+
+  EnterCriticalSection(&m_critSection);
+  if ((int)m_unused.size() < m_iMaxSize)
+  {
+    m_unused.push_back(pPicture);
+    pPicture = NULL;
+  }
+  LeaveCriticalSection(&m_critSection);
+
+  if (pPicture)
+    FreePicture(pPicture);
+}
+
+void CDVDVideoPictureQueue::FreePicture(DVDVideoPicture* pPicture)
+{
+  CDVDCodecUtils::FreePicture(pPicture);
+}
+
+MsgQueueReturnCode CDVDVideoPictureQueue::Put(DVDVideoPicture* pPicture, double pts, unsigned int iTimeoutInMilliSeconds)
+{
+  if (!m_bInitialized)
+  {
+    CLog::Log(LOGWARNING, "CDVDVideoPictureQueue::Put MSGQ_NOT_INITIALIZED");
+    return MSGQ_NOT_INITIALIZED;
+  }
+
+  // take our copy before waiting, the presentation side keeps running meanwhile
+  DVDVideoPicture* pReference = Reference(pPicture);
+  if (!pReference)
+    return MSGQ_OUT_OF_MEMORY;
+
+  return PutReference(pReference, pts, iTimeoutInMilliSeconds);
+}
+
+MsgQueueReturnCode CDVDVideoPictureQueue::PutReference(DVDVideoPicture* pPicture, double pts, unsigned int iTimeoutInMilliSeconds)
+{
+  SQueuedPicture item;
+  item.pPicture = pPicture;
+  item.pts      = pts;
+
+  if (!m_bInitialized)
+  {
+    CLog::Log(LOGWARNING, "CDVDVideoPictureQueue::PutReference MSGQ_NOT_INITIALIZED");
+    Release(item.pPicture);
+    return MSGQ_NOT_INITIALIZED;
+  }
+
+  MsgQueueReturnCode ret = MSGQ_ABORT;
+
+  EnterCriticalSection(&m_critSection);
+
+  while (!m_bAbortRequest)
+  {
+    if ((int)m_queue.size() < m_iMaxSize)
+    {
+      m_queue.push_back(item);
+      item.pPicture = NULL;
+      SetEvent(m_hPutEvent); // inform waiter for new picture
+      ret = MSGQ_OK;
+      break;
+    }
+    else if (!iTimeoutInMilliSeconds)
+    {
+      ret = MSGQ_TIMEOUT;
+      break;
+    }
+    else
+    {
+      ResetEvent(m_hGetEvent);
+      LeaveCriticalSection(&m_critSection);
+
+      // wait for the presentation side to take a picture
+      if (WaitForSingleObject(m_hGetEvent, iTimeoutInMilliSeconds) == WAIT_TIMEOUT)
+      {
+        Release(item.pPicture);
+        return MSGQ_TIMEOUT;
+      }
+      EnterCriticalSection(&m_critSection);
+    }
+  }
+
+  LeaveCriticalSection(&m_critSection);
+
+  if (item.pPicture)
+    Release(item.pPicture);
+
+  return ret;
+}
+
+MsgQueueReturnCode CDVDVideoPictureQueue::Get(DVDVideoPicture** pPicture, double* pts, unsigned int iTimeoutInMilliSeconds)
+{
+  *pPicture = NULL;
+
+  if (!m_bInitialized)
+    return MSGQ_NOT_INITIALIZED;
+
+  MsgQueueReturnCode ret = MSGQ_ABORT;
+
+  EnterCriticalSection(&m_critSection);
+
+  while (!m_bAbortRequest)
+  {
+    if (!m_queue.empty())
+    {
+      *pPicture = m_queue.front().pPicture;
+      *pts      = m_queue.front().pts;
+      m_queue.pop_front();
+      SetEvent(m_hGetEvent); // there is room for another picture
+      ret = MSGQ_OK;
+      break;
+    }
+    else if (!iTimeoutInMilliSeconds)
+    {
+      ret = MSGQ_TIMEOUT;
+      break;
+    }
+    else
+    {
+      ResetEvent(m_hPutEvent);
+      LeaveCriticalSection(&m_critSection);
+
+      // wait for a new picture
+      if (WaitForSingleObject(m_hPutEvent, iTimeoutInMilliSeconds) == WAIT_TIMEOUT)
+        return MSGQ_TIMEOUT;
+
+      EnterCriticalSection(&m_critSection);
+    }
+  }
+
+  LeaveCriticalSection(&m_critSection);
+  return ret;
+}
+
+bool CDVDVideoPictureQueue::WaitUntilEmpty(unsigned int iTimeoutInMilliSeconds)
+{
+  DWORD dwTimeout = GetTickCount() + iTimeoutInMilliSeconds;
+
+  EnterCriticalSection(&m_critSection);
+  while (!m_queue.empty() && !m_bAbortRequest)
+  {
+    DWORD dwNow = GetTickCount();
+    if ((int)(dwTimeout - dwNow) <= 0)
+      break;
+
+    ResetEvent(m_hGetEvent);
+    LeaveCriticalSection(&m_critSection);
+    WaitForSingleObject(m_hGetEvent, dwTimeout - dwNow);
+    EnterCriticalSection(&m_critSection);
+  }
+  bool bEmpty = m_queue.empty();
+  LeaveCriticalSection(&m_critSection);
+
+  return bEmpty;
+}
+
+void CDVDVideoPictureQueue::SetFlipTime(double flipTime)
+{
+  EnterCriticalSection(&m_critSection);
+  m_flipTime = flipTime;
+  LeaveCriticalSection(&m_critSection);
+}
+
+double CDVDVideoPictureQueue::GetFlipTime()
+{
+  EnterCriticalSection(&m_critSection);
+  double flipTime = m_flipTime;
+  LeaveCriticalSection(&m_critSection);
+
+  return flipTime;
+}
+
+bool CDVDVideoPictureQueue::HasPicture(int iFlags)
+{
+  bool bFound = false;
+
+  EnterCriticalSection(&m_critSection);
+  for (unsigned int i = 0; i < m_queue.size() && !bFound; i++)
+    bFound = (m_queue[i].pPicture->iFlags & iFlags) != 0;
+  LeaveCriticalSection(&m_critSection);
+
+  return bFound;
+}
+
+int CDVDVideoPictureQueue::GetSize()
+{
+  EnterCriticalSection(&m_critSection);
+  int size = (int)m_queue.size();
+  LeaveCriticalSection(&m_critSection);
+  return size;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "DVDMessageQueue.h"
+#include "DVDCodecs/Video/DVDVideoCodec.h"
+#include <deque>
+#include <vector>
+
+// bounded fifo of decoded pictures waiting to be presented. pictures in
+// direct rendering buffers are queued by reference, anything else is
+// copied as the decoder will overwrite it on the next call to Decode.
+class CDVDVideoPictureQueue
+{
+public:
+  CDVDVideoPictureQueue();
+  virtual ~CDVDVideoPictureQueue();
+
+  void Init(int iMaxSize);
+  void Flush();
+  void Abort();
+  void End();
+
+  /**
+   * queues pPicture to be shown at pts, waits while the queue is full
+   */
+  MsgQueueReturnCode Put(DVDVideoPicture* pPicture, double pts, unsigned int iTimeoutInMilliSeconds);
+
+  /**
+   * Put() in two steps. Reference() takes the copy, after which the source
+   * may be reused. PutReference() queues it, waiting while the queue is full,
+   * and takes it over whatever the outcome.
+   */
+  DVDVideoPicture* Reference(DVDVideoPicture* pSource);
+  MsgQueueReturnCode PutReference(DVDVideoPicture* pPicture, double pts, unsigned int iTimeoutInMilliSeconds);
+
+  /**
+   * takes the oldest picture from the queue, the caller must hand it
+   * back with Release() once done with it
+   */
+  MsgQueueReturnCode Get(DVDVideoPicture** pPicture, double* pts, unsigned int iTimeoutInMilliSeconds);
+  void Release(DVDVideoPicture* pPicture);
+
+  // true if any picture still queued has one of iFlags set
+  bool HasPicture(int iFlags);
+
+  // waits untill all queued pictures have been taken, or the timeout expired
+  bool WaitUntilEmpty(unsigned int iTimeoutInMilliSeconds);
+
+  int GetSize();
+  int GetMaxSize() const                { return m_iMaxSize; }
+  bool IsInited() const                 { return m_bInitialized; }
+
+  // changes with every flush, lets a consumer holding a picture notice it became stale
+  unsigned int GetFlushCount() const    { return m_iFlushCount; }
+
+  /**
+   * when the consumer means to flip the picture after the one it presented
+   * last, on the absolute clock. the producer reads it to place the clock on
+   * a resync, the lock keeps the double whole between the two threads
+   */
+  void SetFlipTime(double flipTime);
+  double GetFlipTime();
+
+protected:
+  void FreePicture(DVDVideoPicture* pPicture);
+
+  struct SQueuedPicture
+  {
+    DVDVideoPicture* pPicture;
+    double pts;
+  };
+
+  std::deque<SQueuedPicture> m_queue;
+  std::vector<DVDVideoPicture*> m_unused; // copies kept for reuse
+
+  int m_iMaxSize;
+  volatile unsigned int m_iFlushCount;
+  double m_flipTime;
+  bool m_bAbortRequest;
+  bool m_bInitialized;
+
+  HANDLE m_hPutEvent; // set when a picture was queued
+  HANDLE m_hGetEvent; // set when a picture was taken
+  CRITICAL_SECTION m_critSection;
+};
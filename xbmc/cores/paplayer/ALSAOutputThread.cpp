@@ -0,0 +1,478 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#ifdef HAS_ALSA
+#include "ALSAOutputThread.h"
+#include <sched.h>
+#include <pthread.h>
+
+#define CHECK_ALSA(l,s,e) if ((e)<0) CLog::Log(l,"%s - %s, alsa error: %s",__FUNCTION__,s,snd_strerror(e));
+#define CHECK_ALSA_RETURN(l,s,e) CHECK_ALSA((l),(s),(e)); if ((e)<0) return false;
+
+#define ALSA_PERIODS   4    // periods in the device buffer
+#define ALSA_FIFO_TIME 200  // ms of audio the player may queue ahead of the device
+
+CALSAOutputThread::CALSAOutputThread()
+{
+  m_pcm = NULL;
+  m_bMMap = false;
+  m_bCanPause = false;
+  m_iFrameBytes = 0;
+  m_iBytesPerSecond = 0;
+  m_periodFrames = 0;
+  m_bufferFrames = 0;
+  m_pPeriod = NULL;
+
+  m_fifo = NULL;
+  m_fifoSize = 0;
+  m_fifoRead = 0;
+  m_fifoWrite = 0;
+
+  m_bPause = false;
+  m_bFlush = false;
+  m_bDraining = false;
+
+  m_delayFrames = 0;
+  m_iUnderruns = 0;
+  m_iXRuns = 0;
+}
+
+CALSAOutputThread::~CALSAOutputThread()
+{
+  Deinitialize(false);
+}
+
+bool CALSAOutputThread::Initialize(const CStdString& strDevice, int iChannels, unsigned int& uiSampleRate, unsigned int uiPeriodFrames)
+{
+  Deinitialize(false);
+
+  if (!OpenDevice(strDevice, iChannels, uiSampleRate, uiPeriodFrames))
+  {
+    if (m_pcm)
+      snd_pcm_close(m_pcm);
+    m_pcm = NULL;
+    return false;
+  }
+
+  m_iFrameBytes = iChannels * 2;
+  m_iBytesPerSecond = m_iFrameBytes * uiSampleRate;
+
+  // rounded up to a power of two so the positions can simply wrap
+  DWORD fifoBytes = std::max((DWORD)(m_iBytesPerSecond * ALSA_FIFO_TIME / 1000), (DWORD)(m_periodFrames * m_iFrameBytes * 2));
+  m_fifoSize = 1;
+  while (m_fifoSize < fifoBytes)
+    m_fifoSize <<= 1;
+
+  m_fifo = (BYTE*)malloc(m_fifoSize);
+  if (!m_bMMap)
+    m_pPeriod = (BYTE*)malloc(m_periodFrames * m_iFrameBytes);
+
+  m_fifoRead = m_fifoWrite = 0;
+  m_bPause = m_bFlush = m_bDraining = false;
+  m_delayFrames = 0;
+  m_iUnderruns = m_iXRuns = 0;
+
+  Create();
+  return true;
+}
+
+bool CALSAOutputThread::OpenDevice(const CStdString& strDevice, int iChannels, unsigned int& uiSampleRate, unsigned int uiPeriodFrames)
+{
+  snd_pcm_hw_params_t *hw_params=NULL;
+  snd_pcm_sw_params_t *sw_params=NULL;
+
+  int nErr = snd_pcm_open(&m_pcm, strDevice.c_str(), SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK);
+  CHECK_ALSA_RETURN(LOGERROR,"pcm_open",nErr);
+
+  snd_pcm_hw_params_alloca(&hw_params);
+  snd_pcm_sw_params_alloca(&sw_params);
+
+  nErr = snd_pcm_hw_params_any(m_pcm, hw_params);
+  CHECK_ALSA_RETURN(LOGERROR,"hw_params_any",nErr);
+
+  // prefer writing straight into the device buffer
+  m_bMMap = snd_pcm_hw_params_set_access(m_pcm, hw_params, SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0;
+  if (!m_bMMap)
+  {
+    nErr = snd_pcm_hw_params_set_access(m_pcm, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED);
+    CHECK_ALSA_RETURN(LOGERROR,"hw_params_set_access",nErr);
+  }
+
+  nErr = snd_pcm_hw_params_set_format(m_pcm, hw_params, SND_PCM_FORMAT_S16_LE);
+  CHECK_ALSA_RETURN(LOGERROR,"hw_params_set_format",nErr);
+
+  nErr = snd_pcm_hw_params_set_rate_near(m_pcm, hw_params, &uiSampleRate, NULL);
+  CHECK_ALSA_RETURN(LOGERROR,"hw_params_set_rate",nErr);
+
+  nErr = snd_pcm_hw_params_set_channels(m_pcm, hw_params, iChannels);
+  CHECK_ALSA_RETURN(LOGERROR,"hw_params_set_channels",nErr);
+
+  m_periodFrames = uiPeriodFrames;
+  nErr = snd_pcm_hw_params_set_period_size_near(m_pcm, hw_params, &m_periodFrames, 0);
+  CHECK_ALSA_RETURN(LOGERROR,"hw_params_set_period_size",nErr);
+
+  // the fifo absorbs decoding hickups, so the device buffer can stay small
+  m_bufferFrames = m_periodFrames * ALSA_PERIODS;
+  nErr = snd_pcm_hw_params_set_buffer_size_near(m_pcm, hw_params, &m_bufferFrames);
+  CHECK_ALSA_RETURN(LOGERROR,"hw_params_set_buffer_size",nErr);
+
+  nErr = snd_pcm_hw_params(m_pcm, hw_params);
+  CHECK_ALSA_RETURN(LOGERROR,"snd_pcm_hw_params",nErr);
+
+  m_bCanPause = !!snd_pcm_hw_params_can_pause(hw_params);
+
+  nErr = snd_pcm_sw_params_current(m_pcm, sw_params);
+  CHECK_ALSA_RETURN(LOGERROR,"sw_params_current",nErr);
+
+  nErr = snd_pcm_sw_params_set_start_threshold(m_pcm, sw_params, std::min(m_periodFrames * 2, m_bufferFrames));
+  CHECK_ALSA_RETURN(LOGERROR,"sw_params_set_start_threshold",nErr);
+
+  nErr = snd_pcm_sw_params_set_avail_min(m_pcm, sw_params, m_periodFrames);
+  CHECK_ALSA_RETURN(LOGERROR,"sw_params_set_avail_min",nErr);
+
+  // play silence rather than stale samples when we do run dry
+  snd_pcm_uframes_t boundary;
+  nErr = snd_pcm_sw_params_get_boundary(sw_params, &boundary);
+  CHECK_ALSA_RETURN(LOGERROR,"sw_params_get_boundary",nErr);
+
+  nErr = snd_pcm_sw_params_set_silence_threshold(m_pcm, sw_params, 0);
+  CHECK_ALSA_RETURN(LOGERROR,"sw_params_set_silence_threshold",nErr);
+
+  nErr = snd_pcm_sw_params_set_silence_size(m_pcm, sw_params, boundary);
+  CHECK_ALSA_RETURN(LOGERROR,"sw_params_set_silence_size",nErr);
+
+  nErr = snd_pcm_sw_params(m_pcm, sw_params);
+  CHECK_ALSA_RETURN(LOGERROR,"snd_pcm_sw_params",nErr);
+
+  nErr = snd_pcm_prepare(m_pcm);
+  CHECK_ALSA_RETURN(LOGERROR,"snd_pcm_prepare",nErr);
+
+  CLog::Log(LOGDEBUG, "%s - opened %s, sample rate: %u, channels: %d, period size: %d, buffer size: %d, %s transfers",
+            __FUNCTION__, strDevice.c_str(), uiSampleRate, iChannels, (int)m_periodFrames, (int)m_bufferFrames,
+            m_bMMap ? "mmap" : "rw");
+  return true;
+}
+
+void CALSAOutputThread::Deinitialize(bool bDrain)
+{
+  // a paused device never plays out, draining it would block for good
+  if (m_bPause)
+    bDrain = false;
+
+  if (bDrain)
+    WaitCompletion();
+
+  StopThread();
+
+  if (m_pcm)
+  {
+    if (bDrain)
+    {
+      snd_pcm_nonblock(m_pcm, 0);
+      snd_pcm_drain(m_pcm);
+    }
+    else
+      snd_pcm_drop(m_pcm);
+    snd_pcm_close(m_pcm);
+    m_pcm = NULL;
+
+    CLog::Log(LOGDEBUG, "%s - closed, underruns: %u, xruns: %u", __FUNCTION__, m_iUnderruns, m_iXRuns);
+  }
+
+  if (m_fifo)
+    free(m_fifo);
+  m_fifo = NULL;
+  m_fifoSize = 0;
+
+  if (m_pPeriod)
+    free(m_pPeriod);
+  m_pPeriod = NULL;
+}
+
+DWORD CALSAOutputThread::GetSpace()
+{
+  if (!m_pcm)
+    return 0;
+  return m_fifoSize - GetFifoLevel();
+}
+
+DWORD CALSAOutputThread::AddPackets(const BYTE* data, DWORD len)
+{
+  if (!m_pcm)
+    return 0;
+
+  len = std::min(len, GetSpace());
+  len -= len % m_iFrameBytes;
+  if (!len)
+    return 0;
+
+  DWORD pos = m_fifoWrite & (m_fifoSize - 1);
+  DWORD first = std::min(len, m_fifoSize - pos);
+  memcpy(m_fifo + pos, data, first);
+  memcpy(m_fifo, data + first, len - first);
+
+  // the samples must be visible before the output thread sees the new position
+  __sync_synchronize();
+  m_fifoWrite += len;
+
+  m_bDraining = false;
+  m_eventData.Set();
+  return len;
+}
+
+void CALSAOutputThread::PeekFifo(BYTE* dest, DWORD len)
+{
+  DWORD pos = m_fifoRead & (m_fifoSize - 1);
+  DWORD first = std::min(len, m_fifoSize - pos);
+  memcpy(dest, m_fifo + pos, first);
+  memcpy(dest + first, m_fifo, len - first);
+}
+
+void CALSAOutputThread::ConsumeFifo(DWORD len)
+{
+  // done reading before the player may overwrite it
+  __sync_synchronize();
+  m_fifoRead += len;
+}
+
+void CALSAOutputThread::Pause()
+{
+  if (!m_pcm || m_bPause)
+    return;
+
+  m_eventDone.Reset();
+  m_bPause = true;
+  m_eventData.Set();
+  m_eventDone.WaitMSec(500);
+}
+
+void CALSAOutputThread::Resume()
+{
+  if (!m_pcm || !m_bPause)
+    return;
+
+  m_eventDone.Reset();
+  m_bPause = false;
+  m_eventData.Set();
+  m_eventDone.WaitMSec(500);
+}
+
+void CALSAOutputThread::Flush()
+{
+  if (!m_pcm)
+    return;
+
+  m_eventDone.Reset();
+  m_bFlush = true;
+  m_eventData.Set();
+  if (!m_eventDone.WaitMSec(500))
+    CLog::Log(LOGWARNING, "%s - output thread didn't respond", __FUNCTION__);
+}
+
+void CALSAOutputThread::WaitCompletion()
+{
+  if (!m_pcm)
+    return;
+
+  m_bDraining = true;
+
+  DWORD timeout = GetTickCount() + ALSA_FIFO_TIME * 2;
+  while (GetFifoLevel() > 0 && !m_bPause && ThreadHandle() && (int)(timeout - GetTickCount()) > 0)
+    Sleep(10);
+}
+
+float CALSAOutputThread::GetDelay()
+{
+  if (!m_pcm || !m_iBytesPerSecond)
+    return 0.0f;
+
+  return (float)(m_delayFrames * m_iFrameBytes + GetFifoLevel()) / m_iBytesPerSecond;
+}
+
+void CALSAOutputThread::Recover(int err)
+{
+  if (err == -EPIPE)
+  {
+    m_iXRuns++;
+    CLog::Log(LOGDEBUG, "%s - device underrun", __FUNCTION__);
+  }
+
+  err = snd_pcm_recover(m_pcm, err, 1);
+  CHECK_ALSA(LOGERROR,"snd_pcm_recover",err);
+  if (err < 0)
+    Sleep(10); // don't spin on a device that is gone
+}
+
+int CALSAOutputThread::WriteMMap(snd_pcm_uframes_t frames)
+{
+  while (frames > 0)
+  {
+    const snd_pcm_channel_area_t* areas;
+    snd_pcm_uframes_t offset;
+    snd_pcm_uframes_t size = frames;
+
+    int err = snd_pcm_mmap_begin(m_pcm, &areas, &offset, &size);
+    if (err < 0)
+      return err;
+
+    // interleaved, so all channels live in the first area
+    BYTE* dest = (BYTE*)areas[0].addr + (areas[0].first + offset * areas[0].step) / 8;
+    PeekFifo(dest, size * m_iFrameBytes);
+
+    snd_pcm_sframes_t committed = snd_pcm_mmap_commit(m_pcm, offset, size);
+    if (committed < 0)
+      return committed;
+
+    ConsumeFifo(committed * m_iFrameBytes);
+    if ((snd_pcm_uframes_t)committed != size)
+      return -EPIPE;
+
+    frames -= size;
+  }
+  return 0;
+}
+
+int CALSAOutputThread::WriteRW(snd_pcm_uframes_t frames)
+{
+  while (frames > 0)
+  {
+    snd_pcm_uframes_t size = std::min(frames, m_periodFrames);
+    PeekFifo(m_pPeriod, size * m_iFrameBytes);
+
+    snd_pcm_sframes_t written = snd_pcm_writei(m_pcm, m_pPeriod, size);
+    if (written == -EAGAIN)
+      return 0;
+    if (written < 0)
+      return written;
+
+    ConsumeFifo(written * m_iFrameBytes);
+    frames -= written;
+  }
+  return 0;
+}
+
+void CALSAOutputThread::Process()
+{
+  // only the lowest realtime priority, but that already beats every normal thread
+  struct sched_param param;
+  param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+  if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+    CLog::Log(LOGDEBUG, "%s - unable to get realtime priority", __FUNCTION__);
+
+  DWORD periodMs = std::max((DWORD)1, (DWORD)(m_periodFrames * m_iFrameBytes * 1000 / m_iBytesPerSecond));
+  bool bPaused = false;
+  bool bStarved = false;
+
+  while (!m_bStop)
+  {
+    if (m_bFlush)
+    {
+      snd_pcm_drop(m_pcm);
+      m_fifoRead = m_fifoWrite;
+      int err = snd_pcm_prepare(m_pcm);
+      CHECK_ALSA(LOGERROR,"flush-prepare",err);
+      m_delayFrames = 0;
+      bStarved = false;
+      m_bFlush = false;
+      m_eventDone.Set();
+      continue;
+    }
+
+    if (m_bPause != bPaused)
+    {
+      bPaused = m_bPause;
+      snd_pcm_state_t state = snd_pcm_state(m_pcm);
+      if (bPaused)
+      {
+        if (m_bCanPause && state == SND_PCM_STATE_RUNNING)
+          snd_pcm_pause(m_pcm, 1);
+        else if (!m_bCanPause)
+          snd_pcm_drop(m_pcm);
+      }
+      else
+      {
+        if (state == SND_PCM_STATE_PAUSED)
+          snd_pcm_pause(m_pcm, 0);
+        else if (state != SND_PCM_STATE_PREPARED && state != SND_PCM_STATE_RUNNING)
+          snd_pcm_prepare(m_pcm);
+      }
+      m_eventDone.Set();
+    }
+
+    if (bPaused)
+    {
+      m_eventData.WaitMSec(100);
+      continue;
+    }
+
+    snd_pcm_sframes_t avail = snd_pcm_avail_update(m_pcm);
+    if (avail < 0)
+    {
+      Recover(avail);
+      continue;
+    }
+
+    if ((snd_pcm_uframes_t)avail < m_periodFrames)
+    {
+      int err = snd_pcm_wait(m_pcm, periodMs * 2);
+      if (err < 0)
+        Recover(err);
+      continue;
+    }
+
+    snd_pcm_uframes_t frames = GetFifoLevel() / m_iFrameBytes;
+    if (frames == 0)
+    {
+      // count it once per dry spell, and only if the device is about to notice
+      if (!bStarved && !m_bDraining
+       && snd_pcm_state(m_pcm) == SND_PCM_STATE_RUNNING
+       && m_bufferFrames - avail < m_periodFrames)
+      {
+        bStarved = true;
+        m_iUnderruns++;
+        CLog::Log(LOGDEBUG, "%s - fifo ran dry, %d frames left in the device", __FUNCTION__, (int)(m_bufferFrames - avail));
+      }
+      m_eventData.WaitMSec(periodMs);
+      continue;
+    }
+    bStarved = false;
+
+    if (frames > (snd_pcm_uframes_t)avail)
+      frames = avail;
+
+    int err = m_bMMap ? WriteMMap(frames) : WriteRW(frames);
+    if (err < 0)
+    {
+      Recover(err);
+      continue;
+    }
+
+    // a stream shorter than the start threshold would otherwise never start
+    if (m_bDraining && GetFifoLevel() == 0 && snd_pcm_state(m_pcm) == SND_PCM_STATE_PREPARED)
+      snd_pcm_start(m_pcm);
+
+    snd_pcm_sframes_t delay;
+    if (snd_pcm_delay(m_pcm, &delay) == 0)
+      m_delayFrames = delay;
+  }
+}
+#endif
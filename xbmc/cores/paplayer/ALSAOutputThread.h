@@ -0,0 +1,97 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/Thread.h"
+#include "utils/Event.h"
+
+#define ALSA_PCM_NEW_HW_PARAMS_API
+#include <alsa/asoundlib.h>
+
+// feeds an alsa playback device from its own realtime thread. the player
+// fills a single producer / single consumer fifo with AddPackets(), the
+// output thread moves it into the device buffer, using mmap transfers when
+// the device supports them. this keeps decoding hickups away from the device.
+class CALSAOutputThread : public CThread
+{
+public:
+  CALSAOutputThread();
+  virtual ~CALSAOutputThread();
+
+  bool Initialize(const CStdString& strDevice, int iChannels, unsigned int& uiSampleRate, unsigned int uiPeriodFrames);
+  void Deinitialize(bool bDrain);
+  bool IsInitialized() const { return m_pcm != NULL; }
+
+  DWORD GetSpace();
+  DWORD AddPackets(const BYTE* data, DWORD len);
+
+  void Pause();
+  void Resume();
+  void Flush();
+
+  // waits until the fifo has been handed to the device
+  void WaitCompletion();
+
+  // seconds of audio between AddPackets() and the speakers
+  float GetDelay();
+
+  // times the fifo ran dry while the device was about to, and times alsa
+  // reported an xrun
+  unsigned int GetUnderruns() const { return m_iUnderruns; }
+  unsigned int GetXRuns() const     { return m_iXRuns; }
+
+protected:
+  virtual void Process();
+
+  bool OpenDevice(const CStdString& strDevice, int iChannels, unsigned int& uiSampleRate, unsigned int uiPeriodFrames);
+  int  WriteMMap(snd_pcm_uframes_t frames);
+  int  WriteRW(snd_pcm_uframes_t frames);
+  void Recover(int err);
+
+  DWORD GetFifoLevel() const { return m_fifoWrite - m_fifoRead; }
+  void  PeekFifo(BYTE* dest, DWORD len);
+  void  ConsumeFifo(DWORD len);
+
+  snd_pcm_t*        m_pcm;
+  bool              m_bMMap;
+  bool              m_bCanPause;
+  unsigned int      m_iFrameBytes;
+  unsigned int      m_iBytesPerSecond;
+  snd_pcm_uframes_t m_periodFrames;
+  snd_pcm_uframes_t m_bufferFrames;
+  BYTE*             m_pPeriod;      // staging buffer when mmap isn't available
+
+  BYTE*             m_fifo;
+  DWORD             m_fifoSize;     // power of two
+  volatile DWORD    m_fifoRead;     // only moved by the output thread
+  volatile DWORD    m_fifoWrite;    // only moved by the player
+
+  volatile bool     m_bPause;       // requested by the player, handled by the output thread
+  volatile bool     m_bFlush;
+  volatile bool     m_bDraining;    // an empty fifo is expected, don't count it
+  CEvent            m_eventData;
+  CEvent            m_eventDone;
+
+  volatile long         m_delayFrames;  // device delay after the last transfer
+  volatile unsigned int m_iUnderruns;
+  volatile unsigned int m_iXRuns;
+};
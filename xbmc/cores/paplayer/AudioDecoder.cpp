@@ -24,6 +24,7 @@
 #include "CodecFactory.h"
 #include "GUISettings.h"
 #include "FileItem.h"
+#include "utils/AudioDSP.h"
 
 #define INTERNAL_BUFFER_LENGTH  sizeof(float)*2*44100       // float samples, 2 channels, 44100 samples per sec = 1 second
 
@@ -258,13 +259,7 @@ void CAudioDecoder::ProcessAudio(float *data, int numsamples)
   if (g_guiSettings.m_replayGain.iType != REPLAY_GAIN_NONE)
   {
     float gainFactor = GetReplayGain();
-    for (int i = 0; i < numsamples; i++)
-    {
-      data[i] *= gainFactor;
-      // check the range (is this needed here?)
-      if (data[i] > 1.0f) data[i] = 1.0f;
-      if (data[i] < -1.0f) data[i] = -1.0f;
-    }
+    CAudioDSP::Gain(data, numsamples, gainFactor, true);
   }
 }
 
@@ -320,22 +315,22 @@ int CAudioDecoder::ReadPCMSamples(float *buffer, int numsamples, int *actualsamp
   int result = m_codec->ReadPCM(m_pcmInputBuffer, numsamples, actualsamples);
 
   // convert to floats (-1 ... 1) range
-  int i;
   switch (m_codec->m_BitsPerSample)
   {
   case 8:
-    for (i = 0; i < *actualsamples; i++)
-      m_inputBuffer[i] = 1.0f / 0x7f * (m_pcmInputBuffer[i] - 128);
+    CAudioDSP::Int8ToFloat(buffer, m_pcmInputBuffer, *actualsamples);
     break;
   case 16:
     *actualsamples /= 2;
-    for (i = 0; i < *actualsamples; i++)
-      m_inputBuffer[i] = 1.0f / 0x7fff * ((short *)m_pcmInputBuffer)[i];
+    CAudioDSP::Int16ToFloat(buffer, (short *)m_pcmInputBuffer, *actualsamples);
     break;
   case 24:
     *actualsamples /= 3;
-    for (i = 0; i < *actualsamples; i++)
-      m_inputBuffer[i] = 1.0f / 0x7fffff * (((int)m_pcmInputBuffer[3*i] << 0) | ((int)m_pcmInputBuffer[3*i+1] << 8) | (((int)((char *)m_pcmInputBuffer)[3*i+2]) << 16));
+    CAudioDSP::Int24ToFloat(buffer, m_pcmInputBuffer, *actualsamples);
+    break;
+  case 32:
+    *actualsamples /= 4;
+    CAudioDSP::Int32ToFloat(buffer, (int *)m_pcmInputBuffer, *actualsamples);
     break;
   }
   return result;
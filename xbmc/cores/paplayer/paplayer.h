@@ -31,8 +31,7 @@
 #ifdef __APPLE__
 #include "CoreAudioAUHAL.h"
 #elif defined(HAS_ALSA)
-#define ALSA_PCM_NEW_HW_PARAMS_API
-#include <alsa/asoundlib.h>
+#include "ALSAOutputThread.h"
 #endif
 
 class CFileItem;
@@ -125,7 +124,11 @@ public:
   virtual float GetPercentage();
   virtual void SetVolume(long nVolume);
   virtual void SetDynamicRangeCompression(long drc);
+#ifdef HAS_ALSA
+  virtual void GetAudioInfo( CStdString& strAudioInfo);
+#else
   virtual void GetAudioInfo( CStdString& strAudioInfo) {}
+#endif
   virtual void GetVideoInfo( CStdString& strVideoInfo) {}
   virtual void GetGeneralInfo( CStdString& strVideoInfo) {}
   virtual void Update(bool bPauseDrawing = false) {}
@@ -222,7 +225,9 @@ private:
   //int               m_sampleRate[2];
   //int               m_bitsPerSample[2];
 #elif defined(HAS_ALSA)
-  snd_pcm_t*  		m_pStream[2];
+  CALSAOutputThread* m_pStream[2];
+  IAudioResampler*  m_resampler[2];
+  bool              m_resampleAudio;
   snd_pcm_uframes_t	m_periods[2];
   CPCMAmplifier 	m_amp[2];
   int               m_channelCount[2];
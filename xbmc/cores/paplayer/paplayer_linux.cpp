@@ -40,9 +40,6 @@
 #define XBMC_SAMPLE_RATE 48000
 #endif
 
-#define CHECK_ALSA(l,s,e) if ((e)<0) CLog::Log(l,"%s - %s, alsa error: %s",__FUNCTION__,s,snd_strerror(e));
-#define CHECK_ALSA_RETURN(l,s,e) CHECK_ALSA((l),(s),(e)); if ((e)<0) return false;
-
 #define VOLUME_FFWD_MUTE 900 // 9dB
 
 #define FADE_TIME 2 * 2048.0f / XBMC_SAMPLE_RATE.0f      // 2 packets
@@ -70,13 +67,14 @@ PAPlayer::PAPlayer(IPlayerCallback& callback) : IPlayer(callback)
   m_SeekTime=-1;
   m_IsFFwdRewding = false;
 
-  m_pStream[0] = NULL;
-  m_pStream[1] = NULL;
+  m_pStream[0] = new CALSAOutputThread;
+  m_pStream[1] = new CALSAOutputThread;
+
+  m_resampler[0] = CAudioResamplerFactory::Create(g_advancedSettings.m_audioResampleQuality);
+  m_resampler[1] = CAudioResamplerFactory::Create(g_advancedSettings.m_audioResampleQuality);
 
-  // periods will contain the amount of data that can be played with each call to alsa.
+  // periods will contain the amount of data that the output thread hands to alsa at a time.
   // the unit is "Frames". for 2 channels 16 bit its 4.
-  // we initialize with packet_size which is probably too big. later the alsa calls will set these
-  // values correctly.
   m_periods[0] = PACKET_SIZE / 4;
   m_periods[1] = PACKET_SIZE / 4;
 
@@ -107,6 +105,10 @@ PAPlayer::PAPlayer(IPlayerCallback& callback) : IPlayer(callback)
 PAPlayer::~PAPlayer()
 {
   CloseFileInternal(true);
+  delete m_pStream[0];
+  delete m_pStream[1];
+  delete m_resampler[0];
+  delete m_resampler[1];
   delete m_currentFile;
   delete m_nextFile;
 }
@@ -185,12 +187,6 @@ bool PAPlayer::OpenFile(const CFileItem& file, const CPlayerOptions &options)
 
   m_decoder[m_currentDecoder].Start();  // start playback
 
-  if (m_pStream[m_currentStream])
-     snd_pcm_reset(m_pStream[m_currentStream]);
-
-  if (m_pStream[m_currentStream])
-     snd_pcm_pause(m_pStream[m_currentStream], 0);
-
   m_clock.SetSpeed(m_iSpeed);
   return true;
 }
@@ -287,6 +283,10 @@ bool PAPlayer::QueueNextFile(const CFileItem &file, bool checkCrossFading)
 
 bool PAPlayer::CloseFileInternal(bool bAudioDevice /*= true*/)
 {
+  // only let the device play out what it has if playback came to its end,
+  // a stop or a paused stream is cut off right away
+  bool bDrain = !m_bIsPlaying && !IsPaused();
+
   if (IsPaused())
     Pause();
 
@@ -300,6 +300,8 @@ bool PAPlayer::CloseFileInternal(bool bAudioDevice /*= true*/)
   for (int i = 0; i < 2; i++)
   {
     m_decoder[i].Destroy();
+    if (!bDrain)
+      m_pStream[i]->Deinitialize(false);
     FreeStream(i);
   }
 
@@ -314,12 +316,7 @@ bool PAPlayer::CloseFileInternal(bool bAudioDevice /*= true*/)
 
 void PAPlayer::FreeStream(int stream)
 {
-  if (m_pStream[stream])
-  {
-    snd_pcm_drain(m_pStream[stream]);
-    snd_pcm_close(m_pStream[stream]);
-  }
-  m_pStream[stream] = NULL;
+  m_pStream[stream]->Deinitialize(true);
 
   if (m_packet[stream][0].packet)
     free(m_packet[stream][0].packet);
@@ -329,13 +326,11 @@ void PAPlayer::FreeStream(int stream)
     m_packet[stream][i].packet = NULL;
   }
 
-  m_resampler[stream].DeInitialize();
+  m_resampler[stream]->DeInitialize();
 }
 
 bool PAPlayer::CreateStream(int num, int channels, int samplerate, int bitspersample, CStdString codec)
 {
-  snd_pcm_hw_params_t *hw_params=NULL;
-
   FreeStream(num);
 
   m_packet[num][0].packet = (BYTE*)malloc(PACKET_SIZE * PACKET_COUNT);
@@ -345,63 +340,14 @@ bool PAPlayer::CreateStream(int num, int channels, int samplerate, int bitspersa
   m_SampleRateOutput = channels>2?samplerate:XBMC_SAMPLE_RATE;
   m_BitsPerSampleOutput = 16;
 
-  m_BytesPerSecond = (m_BitsPerSampleOutput / 8)*m_SampleRateOutput*channels;
-
-  /* Open the device */
-  int nErr = snd_pcm_open(&m_pStream[num], g_guiSettings.GetString("audiooutput.audiodevice"), SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK);
-    CHECK_ALSA_RETURN(LOGERROR,"pcm_open",nErr);
-
-  /* Allocate Hardware Parameters structures and fills it with config space for PCM */
-  snd_pcm_hw_params_alloca(&hw_params);
-
-  nErr = snd_pcm_hw_params_any(m_pStream[num], hw_params);
-    CHECK_ALSA_RETURN(LOGERROR,"hw_params_any",nErr);
-
-  nErr = snd_pcm_hw_params_set_access(m_pStream[num], hw_params, SND_PCM_ACCESS_RW_INTERLEAVED);
-    CHECK_ALSA_RETURN(LOGERROR,"hw_params_set_access",nErr);
-
-  // always use 16 bit samples
-  nErr = snd_pcm_hw_params_set_format(m_pStream[num], hw_params, SND_PCM_FORMAT_S16_LE);
-    CHECK_ALSA_RETURN(LOGERROR,"hw_params_set_format",nErr);
-
-  nErr = snd_pcm_hw_params_set_rate_near(m_pStream[num], hw_params, &m_SampleRateOutput, NULL);
-    CHECK_ALSA_RETURN(LOGERROR,"hw_params_set_rate",nErr);
-
-  nErr = snd_pcm_hw_params_set_channels(m_pStream[num], hw_params, channels);
-    CHECK_ALSA_RETURN(LOGERROR,"hw_params_set_channels",nErr);
-
-    m_periods[num] = PACKET_SIZE / 4;
-    nErr = snd_pcm_hw_params_set_period_size_near(m_pStream[num], hw_params, &m_periods[num], 0);
-    CHECK_ALSA_RETURN(LOGERROR,"hw_params_set_period_size",nErr);
-
-  snd_pcm_uframes_t buffer_size = PACKET_SIZE*20; // big enough buffer
-    nErr = snd_pcm_hw_params_set_buffer_size_near(m_pStream[num], hw_params, &buffer_size);
-    CHECK_ALSA_RETURN(LOGERROR,"hw_params_set_buffer_size",nErr);
-
-  unsigned int periodDuration = 0;
-  nErr = snd_pcm_hw_params_get_period_time(hw_params,&periodDuration, 0);
-    CHECK_ALSA(LOGERROR,"hw_params_get_period_time",nErr);
-
-    CLog::Log(LOGDEBUG,"PAPlayer::CreateStream - initialized. "
-         "sample rate: %d, channels: %d, period size: %d, buffer size: %d "
-         "period duration: %d",
-               m_SampleRateOutput,
-         channels,
-         (int) m_periods[num],
-         (int) buffer_size,
-         periodDuration);
-
-
-    /* Assign them to the playback handle and free the parameters structure */
-  nErr = snd_pcm_hw_params(m_pStream[num], hw_params);
-    CHECK_ALSA_RETURN(LOGERROR,"snd_pcm_hw_params",nErr);
+  m_periods[num] = PACKET_SIZE / 4;
+  if (!m_pStream[num]->Initialize(g_guiSettings.GetString("audiooutput.audiodevice"), channels, m_SampleRateOutput, m_periods[num]))
+    return false;
 
-  /* disable underrun reporting and play silence */
-  nErr = snd_pcm_prepare (m_pStream[num]);
-    CHECK_ALSA(LOGERROR,"snd_pcm_prepare",nErr);
+  m_BytesPerSecond = (m_BitsPerSampleOutput / 8)*m_SampleRateOutput*channels;
 
     // create our resampler  // upsample to XBMC_SAMPLE_RATE, only do this for sources with 1 or 2 channels
-    m_resampler[num].InitConverter(samplerate, bitspersample, channels, m_SampleRateOutput, m_BitsPerSampleOutput, PACKET_SIZE);
+    m_resampler[num]->InitConverter(samplerate, bitspersample, channels, m_SampleRateOutput, m_BitsPerSampleOutput, PACKET_SIZE);
 
     // set initial volume
     SetStreamVolume(num, g_stSettings.m_nVolumeLevel);
@@ -419,7 +365,7 @@ bool PAPlayer::CreateStream(int num, int channels, int samplerate, int bitspersa
 void PAPlayer::Pause()
 {
   CLog::Log(LOGDEBUG,"PAPlayer: pause m_bplaying: %d", m_bIsPlaying);
-  if (!m_bIsPlaying || !m_pStream)
+  if (!m_bIsPlaying)
   return ;
 
   m_bPaused = !m_bPaused;
@@ -427,24 +373,20 @@ void PAPlayer::Pause()
   if (m_bPaused)
   {
     m_clock.SetSpeed(0);
-    if (m_pAudioDecoder[m_currentStream])
-      m_pAudioDecoder[m_currentStream]->Pause();
+    m_pStream[m_currentStream]->Pause();
 
-    if (m_currentlyCrossFading && m_pAudioDecoder[1 - m_currentStream])
-      m_pAudioDecoder[1 - m_currentStream]->Pause();
+    if (m_currentlyCrossFading)
+      m_pStream[1 - m_currentStream]->Pause();
 
     CLog::Log(LOGDEBUG, "PAPlayer: Playback paused");
   }
   else
   {
     m_clock.SetSpeed(m_iSpeed);
-    if (m_pAudioDecoder[m_currentStream])
-      m_pAudioDecoder[m_currentStream]->Resume();
-
-    if (m_currentlyCrossFading && m_pAudioDecoder[1 - m_currentStream])
-      m_pAudioDecoder[1 - m_currentStream]->Resume();
+    m_pStream[m_currentStream]->Resume();
 
-  FlushStreams();
+    if (m_currentlyCrossFading)
+      m_pStream[1 - m_currentStream]->Resume();
 
     CLog::Log(LOGDEBUG, "PAP Player: Playback resumed");
   }
@@ -565,7 +507,7 @@ bool PAPlayer::ProcessPAP()
     {
       if (((GetTotalTime64() - GetTime() < m_crossFading * 1000L) || (m_forceFadeToNext)) && !m_currentlyCrossFading)
       { // request the next file from our application
-        if (m_decoder[1 - m_currentDecoder].GetStatus() == STATUS_QUEUED && m_pStream[1 - m_currentStream])
+        if (m_decoder[1 - m_currentDecoder].GetStatus() == STATUS_QUEUED && m_pStream[1 - m_currentStream]->IsInitialized())
         {
           m_currentlyCrossFading = true;
           if (m_forceFadeToNext)
@@ -582,7 +524,7 @@ bool PAPlayer::ProcessPAP()
           m_currentStream = 1 - m_currentStream;
           CLog::Log(LOGDEBUG, "Starting Crossfade - resuming stream %i", m_currentStream);
 
-          snd_pcm_pause(m_pStream[m_currentStream], 0);
+          m_pStream[m_currentStream]->Resume();
 
           m_callback.OnPlayBackStarted();
           m_clock.SetClock(m_nextFile->m_lStartOffset * 1000 / 75);
@@ -625,13 +567,12 @@ bool PAPlayer::ProcessPAP()
                 CLog::Log(LOGERROR, "PAPlayer: Error creating stream!");
                 return false;
               }
-              snd_pcm_pause(m_pStream[m_currentStream], 0);
             }
             else if (samplerate != samplerate2 || bitspersample != bitspersample2)
             {
               CLog::Log(LOGINFO, "PAPlayer: Restarting resampler due to a change in data format");
-              m_resampler[m_currentStream].DeInitialize();
-              if (!m_resampler[m_currentStream].InitConverter(samplerate2, bitspersample2, channels2, XBMC_SAMPLE_RATE, 16, PACKET_SIZE))
+              m_resampler[m_currentStream]->DeInitialize();
+              if (!m_resampler[m_currentStream]->InitConverter(samplerate2, bitspersample2, channels2, XBMC_SAMPLE_RATE, 16, PACKET_SIZE))
               {
                 CLog::Log(LOGERROR, "PAPlayer: Error initializing resampler!");
                 return false;
@@ -907,15 +848,7 @@ void PAPlayer::FlushStreams()
   m_bytesSentOut = 0;
   for (int stream = 0; stream < 2; stream++)
   {
-    if (m_pStream[stream] && m_packet[stream])
-    {
-      int nErr = snd_pcm_drain(m_pStream[stream]);
-      CHECK_ALSA(LOGERROR,"flush-drain",nErr);
-      nErr = snd_pcm_prepare(m_pStream[stream]);
-      CHECK_ALSA(LOGERROR,"flush-prepare",nErr);
-      nErr = snd_pcm_start(m_pStream[stream]);
-      CHECK_ALSA(LOGERROR,"flush-start",nErr);
-    }
+    m_pStream[stream]->Flush();
   }
 }
 
@@ -974,65 +907,39 @@ void PAPlayer::SetStreamVolume(int stream, long nVolume)
 bool PAPlayer::AddPacketsToStream(int stream, CAudioDecoder &dec)
 {
 
-  if (!m_pStream[stream] || dec.GetStatus() == STATUS_NO_FILE)
+  if (!m_pStream[stream]->IsInitialized() || dec.GetStatus() == STATUS_NO_FILE)
     return false;
 
     bool ret = false;
 
-    int nAvail = snd_pcm_frames_to_bytes(m_pStream[stream], snd_pcm_avail_update(m_pStream[stream]));
-    if (nAvail < PACKET_SIZE) {
+    // the output thread takes it from here, we only have to keep its fifo filled
+    if (m_pStream[stream]->GetSpace() < PACKET_SIZE) {
         return false;
     }
 
-    if (m_resampler[stream].GetData(m_packet[stream][0].packet))
+    if (m_resampler[stream]->GetData(m_packet[stream][0].packet))
     {
         // got some data from our resampler - construct audio packet
         m_packet[stream][0].length = PACKET_SIZE;
         m_packet[stream][0].stream = stream;
 
-  unsigned char *pcmPtr = m_packet[stream][0].packet;
-
   // handle volume de-amp
-  m_amp[stream].DeAmplify((short *)pcmPtr, m_packet[stream][0].length / 2);
+  m_amp[stream].DeAmplifyInt16((int16_t *)m_packet[stream][0].packet, m_packet[stream][0].length / 2, false, true);
 
     StreamCallback(&m_packet[stream][0]);
 
-  while ( pcmPtr < m_packet[stream][0].packet + m_packet[stream][0].length) {
-    int nPeriodSize = snd_pcm_frames_to_bytes(m_pStream[stream],m_periods[stream]);
-    if ( pcmPtr + nPeriodSize >  m_packet[stream][0].packet + m_packet[stream][0].length) {
-      nPeriodSize = m_packet[stream][0].packet + m_packet[stream][0].length - pcmPtr;
-    }
-
-    int framesToWrite = snd_pcm_bytes_to_frames(m_pStream[stream],nPeriodSize);
-    int writeResult = snd_pcm_writei(m_pStream[stream], pcmPtr, framesToWrite);
-    if (  writeResult == -EPIPE  ) {
-      CLog::Log(LOGDEBUG, "PAPlayer::AddPacketsToStream - buffer underun (tried to write %d frames)",
-      framesToWrite);
-      int err = snd_pcm_prepare(m_pStream[stream]);
-        CHECK_ALSA(LOGERROR,"prepare after EPIPE", err);
-    }
-    else if (writeResult != framesToWrite) {
-      CLog::Log(LOGERROR, "PAPlayer::AddPacketsToStream - failed to write %d frames. "
-      "bad write (err: %d) - %s",
-        framesToWrite, writeResult, snd_strerror(writeResult));
-      break;
-    }
-    //else
-        //    m_bytesSentOut += nPeriodSize;
-
-    pcmPtr += nPeriodSize;
-  }
+  m_pStream[stream]->AddPackets(m_packet[stream][0].packet, m_packet[stream][0].length);
 
       // something done
       ret = true;
     }
     else
     { // resampler wants more data - let's feed it
-      int amount = m_resampler[stream].GetInputSamples();
+      int amount = m_resampler[stream]->GetInputSamples();
       if (amount > 0 && amount <= (int)dec.GetDataSize())
       {
         // needs some data - let's feed it
-        m_resampler[stream].PutFloatData((float *)dec.GetData(amount), amount);
+        m_resampler[stream]->PutFloatData((float *)dec.GetData(amount), amount);
         ret = true;
       }
     }
@@ -1144,9 +1051,13 @@ void PAPlayer::WaitForStream()
 {
   // should we wait for our other stream as well?
   // currently we don't.
-  if (!m_pStream[m_currentStream])
-  {
-    snd_pcm_wait(m_pStream[m_currentStream], -1);
-  }
+  m_pStream[m_currentStream]->WaitCompletion();
+}
+
+void PAPlayer::GetAudioInfo(CStdString& strAudioInfo)
+{
+  CALSAOutputThread* pStream = m_pStream[m_currentStream];
+  strAudioInfo.Format("PAP Player: delay:%ims, underruns:%u, xruns:%u",
+                      (int)(pStream->GetDelay() * 1000), pStream->GetUnderruns(), pStream->GetXRuns());
 }
 #endif
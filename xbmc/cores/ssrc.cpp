@@ -4035,7 +4035,7 @@ bool Cssrc::GetData(unsigned char *pOutData)
     // Now move any extra data in our resample buffer to the front
     m_iResampleBufferPos -= m_iOutputBufferSize;
     if (m_iResampleBufferPos)
-      memmove(m_pResampleBuffer, m_pResampleBuffer + m_iOutputBufferSize, m_iResampleBufferPos);
+      memmove(m_pResampleBuffer, (unsigned char *)m_pResampleBuffer + m_iOutputBufferSize, m_iResampleBufferPos);
     return true;
   }
   return false;
@@ -4102,7 +4102,7 @@ int Cssrc::PutFloatData(float *pInData, int numSamples)
     // save data into our output buffer
     if (iNewSamples)
     {
-      memcpy(m_pResampleBuffer + m_iResampleBufferPos, pOutData, iNewSamples);
+      memcpy((unsigned char *)m_pResampleBuffer + m_iResampleBufferPos, pOutData, iNewSamples);
       m_iResampleBufferPos += iNewSamples;
     }
     return iAmountToRead;
@@ -4127,7 +4127,7 @@ int Cssrc::PutFloatData(float *pInData, int numSamples)
     // save data into our output buffer
     if (iNewSamples)
     {
-      memcpy(m_pResampleBuffer + m_iResampleBufferPos, pOutData, iNewSamples);
+      memcpy((unsigned char *)m_pResampleBuffer + m_iResampleBufferPos, pOutData, iNewSamples);
       m_iResampleBufferPos += iNewSamples;
     }
     return iAmountToRead;
@@ -4205,7 +4205,7 @@ int Cssrc::PutData(unsigned char *pInData, int iSize)
     // save data into our output buffer
     if (iNewSamples)
     {
-      memcpy(m_pResampleBuffer + m_iResampleBufferPos, pOutData, iNewSamples);
+      memcpy((unsigned char *)m_pResampleBuffer + m_iResampleBufferPos, pOutData, iNewSamples);
       m_iResampleBufferPos += iNewSamples;
     }
     return iAmountToRead;
@@ -4230,7 +4230,7 @@ int Cssrc::PutData(unsigned char *pInData, int iSize)
     // save data into our output buffer
     if (iNewSamples)
     {
-      memcpy(m_pResampleBuffer + m_iResampleBufferPos, pOutData, iNewSamples);
+      memcpy((unsigned char *)m_pResampleBuffer + m_iResampleBufferPos, pOutData, iNewSamples);
       m_iResampleBufferPos += iNewSamples;
     }
     return iAmountToRead;
@@ -25,6 +25,8 @@
 #ifndef CssrcH
 #define CssrcH
 
+#include "IAudioResampler.h"
+
 //#include <mmsystem.h>
 
 //#include "clsDataStream.h"
@@ -104,7 +106,7 @@ const double shapercoefs[8][21] =
     },  /* 44.1k, N=15, amp=9 */
   };
 
-class Cssrc
+class Cssrc : public IAudioResampler
 {
 public:
   Cssrc(void);
@@ -44,6 +44,8 @@
 #include "PictureInfoTag.h"
 #include "FileItem.h"
 #include "Settings.h"
+#include "utils/LockProfiler.h"
+#include "utils/Metrics.h"
 
 using namespace std;
 using namespace MUSIC_GRABBER;
@@ -2847,6 +2849,51 @@ int CXbmcHttp::xbmcSetLogLevel(int numParas, CStdString paras[])
   }
 }
 
+int CXbmcHttp::xbmcGetLockStats(int numParas, CStdString paras[])
+{
+  if (!CLockProfiler::IsEnabled())
+    return SetResponse(openTag+"Error:Lock profiling is off, see lockprofiling in advancedsettings.xml");
+  if (numParas>1)
+    return SetResponse(openTag+"Error:Too many parameters");
+
+  int count=20;
+  if (numParas==1)
+  {
+    if (paras[0].ToLower()=="reset")
+    {
+      CLockProfiler::Reset();
+      return SetResponse(openTag+"OK");
+    }
+    count=atoi(paras[0]);
+    if (count<=0)
+      return SetResponse(openTag+"Error:Count must be a positive number");
+  }
+
+  vector<CStdString> lines;
+  CLockProfiler::GetReport(lines, count);
+  if (lines.empty())
+    return SetResponse(openTag+"[Empty]");
+  CStdString output;
+  for (unsigned int i=0; i<lines.size(); i++)
+    output+=closeTag+openTag+lines[i];
+  return SetResponse(output);
+}
+
+int CXbmcHttp::xbmcGetMetrics(int numParas, CStdString paras[])
+{
+  if (numParas>0)
+    return g_application.getApplicationMessenger().SetResponse("Error:Too many parameters\n");
+
+  // plain text, one metric per line, whatever the response format is set to.
+  // the shim leaves out the web header and footer for it as well.
+  vector<CStdString> lines;
+  CMetrics::GetReport(lines);
+  CStdString output;
+  for (unsigned int i=0; i<lines.size(); i++)
+    output+=lines[i]+"\n";
+  return g_application.getApplicationMessenger().SetResponse(output);
+}
+
 int CXbmcHttp::xbmcWebServerStatus(int numParas, CStdString paras[])
 {
   if (numParas==0)
@@ -3039,6 +3086,8 @@ int CXbmcHttp::xbmcCommand(const CStdString &parameter)
 	  else if (command == "webserverstatus")          retVal = xbmcWebServerStatus(numParas, paras);
 	  else if (command == "setloglevel")              retVal = xbmcSetLogLevel(numParas, paras);
 	  else if (command == "getloglevel")              retVal = xbmcGetLogLevel();
+	  else if (command == "getlockstats")             retVal = xbmcGetLockStats(numParas, paras);
+	  else if (command == "getmetrics")               retVal = xbmcGetMetrics(numParas, paras);
 
 	  //only callable internally
 	  else if (command == "broadcastlevel")
@@ -3150,10 +3199,15 @@ CStdString CXbmcHttpShim::xbmcProcessCommand( int eid, webs_t wp, char_t *comman
   int cnt=0;
 
   checkForFunctionTypeParas(cmd, paras);
+  // answered in plain text, without the html or the user's header and footer
+  CStdString lowerCmd=cmd;
+  bool rawResponse=(lowerCmd.ToLower()=="getmetrics");
   if (wp!=NULL)
   {
     if (eid==NO_EID)
-	  if (m_pXbmcHttp)
+	  if (rawResponse)
+	    websWrite(wp, T("HTTP/1.0 200 OK\r\nPragma: no-cache\r\nCache-Control: no-cache\r\nContent-Type: text/plain\r\n\r\n"));
+	  else if (m_pXbmcHttp)
 	  {
 	    if (m_pXbmcHttp->incWebHeader)
           websHeader(wp);
@@ -3190,6 +3244,8 @@ CStdString CXbmcHttpShim::xbmcProcessCommand( int eid, webs_t wp, char_t *comman
 	}
   }
   //flushresult
+  if (rawResponse)
+    return flushResult(eid, wp, response);
   retVal=flushResult(eid, wp, m_pXbmcHttp->userHeader+response+m_pXbmcHttp->userFooter);
   if (m_pXbmcHttp) //this should always be true unless something is very wrong
     if ((wp!=NULL) && (m_pXbmcHttp->incWebFooter) && eid==NO_EID)
@@ -126,6 +126,8 @@ public:
   int xbmcWebServerStatus(int numParas, CStdString paras[]);
   int xbmcGetLogLevel();
   int xbmcSetLogLevel(int numParas, CStdString paras[]);
+  int xbmcGetLockStats(int numParas, CStdString paras[]);
+  int xbmcGetMetrics(int numParas, CStdString paras[]);
   CKey GetKey();
   void ResetKey();
   CStdString GetOpenTag();
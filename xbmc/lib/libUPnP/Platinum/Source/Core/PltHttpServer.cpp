@@ -223,6 +223,9 @@ PLT_FileServer::ServeFile(NPT_HttpResponse& response,
                 // set the end_offset in order to generate a bad response
                 if (end != (NPT_Position)-1 && end < start) {
                     end_offset = (NPT_Position)-1;
+                } else if (end != (NPT_Position)-1 && end < end_offset) {
+                    // the content length limits how much of the stream is sent
+                    end_offset = end;
                 }
             }
 
@@ -261,10 +261,25 @@ PLT_HttpServerSocketTask::Write(NPT_HttpResponse* response,
 
     // send response body if any
     if (!headers_only && entity) {
+        // a local file is sent by the kernel if the platform allows, otherwise
+        // or if that failed before anything went out, copy the stream
+        NPT_String    file_path;
+        NPT_Position  file_offset;
+        NPT_Result    result = NPT_FAILURE;
+        if (entity->GetContentLength() && 
+            NPT_SUCCEEDED(entity->GetFile(file_path, file_offset))) {
+            NPT_LargeSize bytes_sent = 0;
+            result = m_Socket->SendFile(file_path, 
+                                        file_offset, 
+                                        entity->GetContentLength(), 
+                                        &bytes_sent);
+            if (NPT_FAILED(result) && bytes_sent) return result;
+        }
+
         NPT_InputStreamReference body_stream;
         entity->GetInputStream(body_stream);
 
-        if (!body_stream.IsNull()) {
+        if (NPT_FAILED(result) && !body_stream.IsNull()) {
             NPT_CHECK_SEVERE(NPT_StreamToStreamCopy(
                 *body_stream.AsPointer(), 
                 *output_stream.AsPointer(),
@@ -289,7 +289,8 @@ NPT_HttpHeaders::GetHeaderValue(const char* name) const
 |   NPT_HttpEntity::NPT_HttpEntity
 +---------------------------------------------------------------------*/
 NPT_HttpEntity::NPT_HttpEntity() :
-    m_ContentLength(0)
+    m_ContentLength(0),
+    m_FileOffset(0)
 {
 }
 
@@ -297,7 +298,8 @@ NPT_HttpEntity::NPT_HttpEntity() :
 |   NPT_HttpEntity::NPT_HttpEntity
 +---------------------------------------------------------------------*/
 NPT_HttpEntity::NPT_HttpEntity(const NPT_HttpHeaders& headers) :
-    m_ContentLength(0)
+    m_ContentLength(0),
+    m_FileOffset(0)
 {
     NPT_HttpHeader* header;
     
@@ -356,6 +358,7 @@ NPT_HttpEntity::SetInputStream(const NPT_InputStreamReference& stream,
                                bool update_content_length /* = false */)
 {
     m_InputStream = stream;
+    m_FilePath    = "";
 
     // get the content length from the stream
     if (update_content_length) {
@@ -406,6 +409,29 @@ NPT_HttpEntity::SetInputStream(const NPT_String& string)
     return SetInputStream(body, true);
 }
 
+/*----------------------------------------------------------------------
+|   NPT_HttpEntity::SetFile
++---------------------------------------------------------------------*/
+NPT_Result 
+NPT_HttpEntity::SetFile(const char* path, NPT_Position offset)
+{
+    m_FilePath   = path;
+    m_FileOffset = offset;
+    return NPT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   NPT_HttpEntity::GetFile
++---------------------------------------------------------------------*/
+NPT_Result 
+NPT_HttpEntity::GetFile(NPT_String& path, NPT_Position& offset)
+{
+    if (m_FilePath.IsEmpty()) return NPT_ERROR_NO_SUCH_ITEM;
+    path   = m_FilePath;
+    offset = m_FileOffset;
+    return NPT_SUCCESS;
+}
+
 /*----------------------------------------------------------------------
 |   NPT_HttpEntity::Load
 +---------------------------------------------------------------------*/
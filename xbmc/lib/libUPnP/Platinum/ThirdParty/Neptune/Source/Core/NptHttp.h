@@ -182,6 +182,12 @@ public:
     NPT_Result Load(NPT_DataBuffer& buffer);
     NPT_Result SetHeaders(const NPT_HttpHeaders& headers);
 
+    // the body is also available as a byte range of a local file, starting
+    // at offset. a server able to send files from the kernel may use it
+    // instead of copying the input stream. cleared by SetInputStream.
+    NPT_Result SetFile(const char* path, NPT_Position offset);
+    NPT_Result GetFile(NPT_String& path, NPT_Position& offset);
+
     // field access
     NPT_Result        SetContentType(const char* type);
     NPT_Result        SetContentEncoding(const char* encoding);
@@ -198,6 +204,8 @@ private:
     NPT_String               m_ContentType;
     NPT_String               m_ContentEncoding;
     NPT_String               m_TransferEncoding;
+    NPT_String               m_FilePath;
+    NPT_Position             m_FileOffset;
 };
 
 /*----------------------------------------------------------------------
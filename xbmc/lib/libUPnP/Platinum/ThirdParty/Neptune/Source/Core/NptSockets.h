@@ -131,6 +131,20 @@ class NPT_SocketInterface
     virtual NPT_Result SetBlockingMode(bool blocking) = 0;
     virtual NPT_Result SetReadTimeout(NPT_Timeout timeout) = 0;
     virtual NPT_Result SetWriteTimeout(NPT_Timeout timeout) = 0;
+
+    // sends size bytes of a local file from offset, without going through
+    // an output stream. bytes_sent tells a caller wanting to fall back on
+    // a stream whether anything was written already.
+    virtual NPT_Result SendFile(const char*    path, 
+                                NPT_Position   offset, 
+                                NPT_LargeSize  size, 
+                                NPT_LargeSize* bytes_sent) {
+        NPT_COMPILER_UNUSED(path);
+        NPT_COMPILER_UNUSED(offset);
+        NPT_COMPILER_UNUSED(size);
+        if (bytes_sent) *bytes_sent = 0;
+        return NPT_ERROR_NOT_SUPPORTED;
+    }
 };
 
 /*----------------------------------------------------------------------
@@ -222,6 +236,12 @@ public:
     NPT_Result SetWriteTimeout(NPT_Timeout timeout) {                      
         return m_SocketDelegate->SetWriteTimeout(timeout);                            
     }                                                          
+    NPT_Result SendFile(const char*    path, 
+                        NPT_Position   offset, 
+                        NPT_LargeSize  size, 
+                        NPT_LargeSize* bytes_sent) {
+        return m_SocketDelegate->SendFile(path, offset, size, bytes_sent);
+    }
 
 protected:
     // constructor
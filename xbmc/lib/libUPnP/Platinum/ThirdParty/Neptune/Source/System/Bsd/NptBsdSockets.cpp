@@ -92,6 +92,13 @@
 #include <stdio.h>
 #include <errno.h>
 #include <signal.h>
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#define NPT_BSD_SOCKET_HAVE_SENDFILE
+#elif defined(__APPLE__)
+#include <sys/uio.h>
+#define NPT_BSD_SOCKET_HAVE_SENDFILE
+#endif
 
 #endif 
 
@@ -108,6 +115,7 @@
 |   constants
 +---------------------------------------------------------------------*/
 const int NPT_TCP_SERVER_SOCKET_DEFAULT_LISTEN_COUNT = 20;
+const NPT_Size NPT_BSD_SOCKET_SENDFILE_CHUNK = 1024*1024;
 
 /*----------------------------------------------------------------------
 |   WinSock adaptation layer
@@ -954,6 +962,10 @@ class NPT_BsdSocket : public NPT_SocketInterface
     NPT_Result SetBlockingMode(bool blocking);
     NPT_Result SetReadTimeout(NPT_Timeout timeout);
     NPT_Result SetWriteTimeout(NPT_Timeout timeout);
+    NPT_Result SendFile(const char*    path, 
+                        NPT_Position   offset, 
+                        NPT_LargeSize  size, 
+                        NPT_LargeSize* bytes_sent);
 
  protected:
     // members
@@ -1188,6 +1200,100 @@ NPT_BsdSocket::SetWriteTimeout(NPT_Timeout timeout)
     return NPT_SUCCESS;
 }
 
+#if defined(NPT_BSD_SOCKET_HAVE_SENDFILE)
+/*----------------------------------------------------------------------
+|   ReadAhead
++---------------------------------------------------------------------*/
+static void
+ReadAhead(int fd, off_t offset, off_t size, bool sequential)
+{
+#if defined(__APPLE__)
+    if (sequential) fcntl(fd, F_RDAHEAD, 1);
+    struct radvisory advice;
+    advice.ra_offset = offset;
+    advice.ra_count  = (int)(size > NPT_BSD_SOCKET_SENDFILE_CHUNK ? NPT_BSD_SOCKET_SENDFILE_CHUNK : size);
+    fcntl(fd, F_RDADVISE, &advice);
+#else
+    if (sequential) posix_fadvise(fd, offset, size, POSIX_FADV_SEQUENTIAL);
+    posix_fadvise(fd, offset, size > NPT_BSD_SOCKET_SENDFILE_CHUNK ? NPT_BSD_SOCKET_SENDFILE_CHUNK : size, POSIX_FADV_WILLNEED);
+#endif
+}
+#endif
+
+/*----------------------------------------------------------------------
+|   NPT_BsdSocket::SendFile
++---------------------------------------------------------------------*/
+NPT_Result
+NPT_BsdSocket::SendFile(const char*    path, 
+                        NPT_Position   offset, 
+                        NPT_LargeSize  size, 
+                        NPT_LargeSize* bytes_sent)
+{
+    if (bytes_sent) *bytes_sent = 0;
+
+#if defined(NPT_BSD_SOCKET_HAVE_SENDFILE)
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NPT_FAILURE;
+
+    // the range is read once and in order, let the kernel read ahead
+    // aggressively and start on the first chunk right away
+    off_t position = (off_t)offset;
+    ReadAhead(fd, position, (off_t)size, true);
+
+    NPT_Result result = NPT_SUCCESS;
+    while (size) {
+        // same as a stream write, honor the write timeout
+        if (m_SocketFdReference->m_Blocking && 
+            m_SocketFdReference->m_WriteTimeout != NPT_TIMEOUT_INFINITE) {
+            result = m_SocketFdReference->WaitUntilWriteable();
+            if (result != NPT_SUCCESS) break;
+        }
+
+        size_t chunk = size > NPT_BSD_SOCKET_SENDFILE_CHUNK ? NPT_BSD_SOCKET_SENDFILE_CHUNK : (size_t)size;
+#if defined(__APPLE__)
+        // darwin returns what was sent in len, even when it fails with
+        // EAGAIN or EINTR, and doesn't move the offset for us
+        off_t len = (off_t)chunk;
+        ssize_t nb_sent = sendfile(fd, m_SocketFdReference->m_SocketFd, position, &len, NULL, 0);
+        if (len > 0) {
+            nb_sent = (ssize_t)len;
+            position += len;
+        }
+#else
+        ssize_t nb_sent = sendfile(m_SocketFdReference->m_SocketFd, fd, &position, chunk);
+#endif
+        if (nb_sent > 0) {
+            size -= nb_sent;
+            if (bytes_sent) *bytes_sent += nb_sent;
+            m_SocketFdReference->m_Position += nb_sent;
+
+            // have the next chunk come off the disk while this one drains
+            ReadAhead(fd, position, NPT_BSD_SOCKET_SENDFILE_CHUNK, false);
+        } else if (nb_sent == 0) {
+            // the file got shorter than what we promised
+            result = NPT_ERROR_EOS;
+            break;
+        } else if (GetSocketError() == EAGAIN) {
+            // the socket buffer is full, wait for room rather than spinning,
+            // for ever if there's no write timeout (a disconnect still wakes us)
+            result = m_SocketFdReference->WaitUntilWriteable();
+            if (result != NPT_SUCCESS) break;
+        } else if (GetSocketError() != EINTR) {
+            result = MapErrorCode(GetSocketError());
+            break;
+        }
+    }
+
+    close(fd);
+    return result;
+#else
+    NPT_COMPILER_UNUSED(path);
+    NPT_COMPILER_UNUSED(offset);
+    NPT_COMPILER_UNUSED(size);
+    return NPT_ERROR_NOT_SUPPORTED;
+#endif
+}
+
 /*----------------------------------------------------------------------
 |   NPT_Socket::~NPT_Socket
 +---------------------------------------------------------------------*/
@@ -32,6 +32,7 @@
 #include <string>
 
 #include "sqlitedataset.h"
+#include "utils/Metrics.h"
 #ifndef _LINUX
 #include "sqlite3.h"
 #else
@@ -403,6 +404,7 @@ void SqliteDataset::fill_fields() {
 
 int SqliteDataset::exec(const string &sql) {
   if (!handle()) throw DbErrors("No Database Connection");
+  CMetricTimer timer("db_query_ms{kind=\"exec\"}");
   int res;
   exec_res.clear();
   if((res = db->setErr(sqlite3_exec(handle(),sql.c_str(),&callback,&exec_res,&errmsg),sql.c_str())) == SQLITE_OK)
@@ -432,6 +434,7 @@ bool SqliteDataset::query(const char *query) {
 
   close();
 
+  CMetricTimer timer("db_query_ms{kind=\"select\"}");
   sqlite3_stmt *stmt = NULL;
 #ifdef __APPLE__
   if (db->setErr(sqlite3_prepare(handle(),query,-1,&stmt, NULL),query) != SQLITE_OK)
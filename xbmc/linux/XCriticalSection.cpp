@@ -119,6 +119,24 @@ void XCriticalSection::Enter()
 	pthread_mutex_unlock(&m_countMutex);
 }
 
+//////////////////////////////////////////////////////////////////////
+BOOL XCriticalSection::TryEnter()
+{
+	// Enter() reports these.
+	if (m_isDestroyed || !m_isInitialized)
+		return FALSE;
+
+	if (pthread_mutex_trylock(&m_mutex) != 0)
+		return FALSE;
+
+	pthread_mutex_lock(&m_countMutex);
+	m_count++;
+	m_ownerThread = GetCurrentThreadId();
+	pthread_mutex_unlock(&m_countMutex);
+
+	return TRUE;
+}
+
 //////////////////////////////////////////////////////////////////////
 void XCriticalSection::Leave()
 {
@@ -44,6 +44,9 @@ class XCriticalSection
   // Enter a critical section.
   void Enter();
 
+  // Enters a critical section if no other thread holds it.
+  BOOL TryEnter();
+
   // Leave a critical section.
   void Leave();
 
@@ -36,6 +36,43 @@ CArchive::CArchive(CFile* pFile, int mode)
   memset(m_pBuffer, 0, sizeof(m_pBuffer));
 
   m_BufferPos = 0;
+
+  m_pOutput = NULL;
+  m_pInput = NULL;
+  m_inputSize = 0;
+  m_inputPos = 0;
+  m_pStrings = NULL;
+}
+
+CArchive::CArchive(std::vector<BYTE>& buffer, CArchiveStringPool* pStrings)
+{
+  m_pFile = NULL;
+  m_iMode = store;
+
+  m_pBuffer = new BYTE[BUFFER_MAX];
+  m_BufferPos = 0;
+
+  m_pOutput = &buffer;
+  m_pInput = NULL;
+  m_inputSize = 0;
+  m_inputPos = 0;
+  m_pStrings = pStrings;
+}
+
+CArchive::CArchive(const BYTE* pData, unsigned int size, CArchiveStringPool* pStrings)
+{
+  m_pFile = NULL;
+  m_iMode = load;
+
+  // nothing is buffered when loading, these are made per record so skip it
+  m_pBuffer = NULL;
+  m_BufferPos = 0;
+
+  m_pOutput = NULL;
+  m_pInput = pData;
+  m_inputSize = size;
+  m_inputPos = 0;
+  m_pStrings = pStrings;
 }
 
 CArchive::~CArchive()
@@ -160,6 +197,9 @@ CArchive& CArchive::operator<<(char c)
 
 CArchive& CArchive::operator<<(const CStdString& str)
 {
+  if (m_pStrings)
+    return *this << m_pStrings->Add(str);
+
   *this << str.GetLength();
 
   int size = str.GetLength();
@@ -227,66 +267,76 @@ CArchive& CArchive::operator<<(ISerializable& obj)
 
 CArchive& CArchive::operator>>(float& f)
 {
-  m_pFile->Read((void*)&f, sizeof(float));
+  Read((void*)&f, sizeof(float));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(double& d)
 {
-  m_pFile->Read((void*)&d, sizeof(double));
+  Read((void*)&d, sizeof(double));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(int& i)
 {
-  m_pFile->Read((void*)&i, sizeof(int));
+  Read((void*)&i, sizeof(int));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(unsigned int& i)
 {
-  m_pFile->Read((void*)&i, sizeof(unsigned int));
+  Read((void*)&i, sizeof(unsigned int));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(__int64& i64)
 {
-  m_pFile->Read((void*)&i64, sizeof(__int64));
+  Read((void*)&i64, sizeof(__int64));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(long& l)
 {
-  m_pFile->Read((void*)&l, sizeof(long));
+  Read((void*)&l, sizeof(long));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(bool& b)
 {
-  m_pFile->Read((void*)&b, sizeof(bool));
+  Read((void*)&b, sizeof(bool));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(char& c)
 {
-  m_pFile->Read((void*)&c, sizeof(char));
+  Read((void*)&c, sizeof(char));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(CStdString& str)
 {
+  if (m_pStrings)
+  {
+    int index = -1;
+    *this >> index;
+    str = m_pStrings->Get(index);
+    return *this;
+  }
+
   int iLength = 0;
   *this >> iLength;
+  if (m_pInput && (iLength < 0 || (unsigned int)iLength > m_inputSize - m_inputPos))
+    iLength = 0;
 
-  m_pFile->Read((void*)str.GetBufferSetLength(iLength), iLength);
+  Read((void*)str.GetBufferSetLength(iLength), iLength);
   str.ReleaseBuffer();
 
 
@@ -297,8 +347,10 @@ CArchive& CArchive::operator>>(CStdStringW& str)
 {
   int iLength = 0;
   *this >> iLength;
+  if (m_pInput && (iLength < 0 || (unsigned int)iLength > m_inputSize - m_inputPos))
+    iLength = 0;
 
-  m_pFile->Read((void*)str.GetBufferSetLength(iLength), iLength);
+  Read((void*)str.GetBufferSetLength(iLength), iLength);
   str.ReleaseBuffer();
 
 
@@ -307,7 +359,7 @@ CArchive& CArchive::operator>>(CStdStringW& str)
 
 CArchive& CArchive::operator>>(SYSTEMTIME& time)
 {
-  m_pFile->Read((void*)&time, sizeof(SYSTEMTIME));
+  Read((void*)&time, sizeof(SYSTEMTIME));
 
   return *this;
 }
@@ -323,7 +375,48 @@ void CArchive::FlushBuffer()
 {
   if (m_BufferPos > 0)
   {
-    m_pFile->Write(m_pBuffer, m_BufferPos);
+    if (m_pOutput)
+      m_pOutput->insert(m_pOutput->end(), m_pBuffer, m_pBuffer + m_BufferPos);
+    else
+      m_pFile->Write(m_pBuffer, m_BufferPos);
     m_BufferPos = 0;
   }
 }
+
+void CArchive::Read(void* lpBuf, unsigned int size)
+{
+  if (!m_pInput)
+  {
+    m_pFile->Read(lpBuf, size);
+    return;
+  }
+
+  unsigned int available = m_inputSize - m_inputPos;
+  if (size > available)
+  {
+    memset((BYTE*)lpBuf + available, 0, size - available);
+    size = available;
+  }
+  memcpy(lpBuf, m_pInput + m_inputPos, size);
+  m_inputPos += size;
+}
+
+int CArchiveStringPool::Add(const CStdString& str)
+{
+  std::map<CStdString, int>::const_iterator it = m_lookup.find(str);
+  if (it != m_lookup.end())
+    return it->second;
+
+  int index = (int)m_strings.size();
+  m_strings.push_back(str);
+  m_lookup.insert(std::make_pair(str, index));
+  return index;
+}
+
+const CStdString& CArchiveStringPool::Get(int index) const
+{
+  static const CStdString empty;
+  if (index < 0 || index >= (int)m_strings.size())
+    return empty;
+  return m_strings[index];
+}
@@ -23,6 +23,9 @@
 
 #include "StdString.h"
 
+#include <map>
+#include <vector>
+
 namespace XFILE
 {
   class CFile;
@@ -37,10 +40,27 @@ public:
   virtual ~ISerializable() {}
 };
 
+// strings written while an archive has a pool are stored once in the pool and
+// referenced by their index, the owner of the archive saves the pool itself.
+class CArchiveStringPool
+{
+public:
+  int Add(const CStdString& str);
+  const CStdString& Get(int index) const; // empty for a bad index
+
+  std::vector<CStdString> m_strings;
+private:
+  std::map<CStdString, int> m_lookup;
+};
+
 class CArchive
 {
 public:
   CArchive(XFILE::CFile* pFile, int mode);
+  // storing to the end of buffer, or loading from size bytes at pData.
+  // reads past the end of the data give zeroes.
+  CArchive(std::vector<BYTE>& buffer, CArchiveStringPool* pStrings = NULL);
+  CArchive(const BYTE* pData, unsigned int size, CArchiveStringPool* pStrings = NULL);
   ~CArchive();
   // storing
   CArchive& operator<<(float f);
@@ -79,9 +99,16 @@ public:
 
 protected:
   void FlushBuffer();
+  void Read(void* lpBuf, unsigned int size);
   XFILE::CFile* m_pFile;
   int m_iMode;
   LPBYTE m_pBuffer;
   int m_BufferPos;
+
+  std::vector<BYTE>* m_pOutput;
+  const BYTE* m_pInput;
+  unsigned int m_inputSize;
+  unsigned int m_inputPos;
+  CArchiveStringPool* m_pStrings;
 };
 
@@ -0,0 +1,200 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "AudioDSP.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define SCALE_INT8  (1.0f / 0x7f)
+#define SCALE_INT16 (1.0f / 0x7fff)
+#define SCALE_INT24 (1.0f / 0x7fffff)
+#define SCALE_INT32 (1.0f / 0x7fffffff)
+#define SCALE_DITHER (1.0f / (1 << 24))
+
+CAudioDSP::DitherState::DitherState()
+{
+  // any non zero seeds will do, they just have to differ per lane
+  seed[0] = 0x12345678;
+  seed[1] = 0x9abcdef1;
+  seed[2] = 0x2468ace1;
+  seed[3] = 0x13579bdf;
+}
+
+static inline unsigned int NextRandom(unsigned int &x)
+{
+  // xorshift, cheap and good enough for dither
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return x;
+}
+
+static inline float ToInt24(const unsigned char *src)
+{
+  // place the 3 bytes at the top of an int so the shift back sign extends
+  return (float)((int)(((unsigned int)src[0] << 8) | ((unsigned int)src[1] << 16) | ((unsigned int)src[2] << 24)) >> 8);
+}
+
+void CAudioDSP::Int8ToFloat(float *dest, const unsigned char *src, int nSamples)
+{
+  // 8 bit is rare enough not to bother
+  for (int i = 0; i < nSamples; i++)
+    dest[i] = SCALE_INT8 * (src[i] - 128);
+}
+
+void CAudioDSP::Int16ToFloat(float *dest, const short *src, int nSamples)
+{
+  int i = 0;
+#ifdef __SSE2__
+  const __m128 scale = _mm_set1_ps(SCALE_INT16);
+  for (; i + 8 <= nSamples; i += 8)
+  {
+    __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+    // duplicate each sample into both halves, the arithmetic shift sign extends it
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16);
+    _mm_storeu_ps(dest + i,     _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+    _mm_storeu_ps(dest + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+  }
+#endif
+  for (; i < nSamples; i++)
+    dest[i] = SCALE_INT16 * src[i];
+}
+
+void CAudioDSP::Int24ToFloat(float *dest, const unsigned char *src, int nSamples)
+{
+  int i = 0;
+#ifdef __SSE2__
+  const __m128 scale = _mm_set1_ps(SCALE_INT24);
+  for (; i + 4 <= nSamples; i += 4, src += 12)
+  {
+    __m128 in = _mm_set_ps(ToInt24(src + 9), ToInt24(src + 6), ToInt24(src + 3), ToInt24(src));
+    _mm_storeu_ps(dest + i, _mm_mul_ps(in, scale));
+  }
+#endif
+  for (; i < nSamples; i++, src += 3)
+    dest[i] = SCALE_INT24 * ToInt24(src);
+}
+
+void CAudioDSP::Int32ToFloat(float *dest, const int *src, int nSamples)
+{
+  int i = 0;
+#ifdef __SSE2__
+  const __m128 scale = _mm_set1_ps(SCALE_INT32);
+  for (; i + 4 <= nSamples; i += 4)
+  {
+    __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+    _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(in), scale));
+  }
+#endif
+  for (; i < nSamples; i++)
+    dest[i] = SCALE_INT32 * src[i];
+}
+
+void CAudioDSP::Gain(float *data, int nSamples, float fGain, bool bClip)
+{
+  int i = 0;
+#ifdef __SSE2__
+  const __m128 gain = _mm_set1_ps(fGain);
+  const __m128 max  = _mm_set1_ps(1.0f);
+  const __m128 min  = _mm_set1_ps(-1.0f);
+  if (bClip)
+  {
+    for (; i + 4 <= nSamples; i += 4)
+    {
+      __m128 v = _mm_mul_ps(_mm_loadu_ps(data + i), gain);
+      _mm_storeu_ps(data + i, _mm_max_ps(_mm_min_ps(v, max), min));
+    }
+  }
+  else
+  {
+    for (; i + 4 <= nSamples; i += 4)
+      _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), gain));
+  }
+#endif
+  for (; i < nSamples; i++)
+  {
+    float v = data[i] * fGain;
+    if (bClip)
+    {
+      if (v > 1.0f) v = 1.0f;
+      if (v < -1.0f) v = -1.0f;
+    }
+    data[i] = v;
+  }
+}
+
+void CAudioDSP::FloatToInt16(short *dest, const float *src, int nSamples, DitherState *pDither)
+{
+  int i = 0;
+#ifdef __SSE2__
+  const __m128 scale = _mm_set1_ps(0x7fff);
+  const __m128 max   = _mm_set1_ps(0x7fff);
+  const __m128 min   = _mm_set1_ps(-0x8000);
+  const __m128 unit  = _mm_set1_ps(SCALE_DITHER);
+  __m128i seed = pDither ? _mm_loadu_si128((const __m128i *)pDither->seed) : _mm_setzero_si128();
+
+  for (; i + 8 <= nSamples; i += 8)
+  {
+    __m128 v[2];
+    v[0] = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+    v[1] = _mm_mul_ps(_mm_loadu_ps(src + i + 4), scale);
+    for (int j = 0; pDither && j < 2; j++)
+    {
+      // triangular dither of +-1 lsb, the difference of two uniform values
+      __m128 r[2];
+      for (int k = 0; k < 2; k++)
+      {
+        seed = _mm_xor_si128(seed, _mm_slli_epi32(seed, 13));
+        seed = _mm_xor_si128(seed, _mm_srli_epi32(seed, 17));
+        seed = _mm_xor_si128(seed, _mm_slli_epi32(seed, 5));
+        r[k] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(seed, 8)), unit);
+      }
+      v[j] = _mm_add_ps(v[j], _mm_sub_ps(r[0], r[1]));
+    }
+    // clamp first, cvtps doesn't saturate
+    __m128i lo = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(v[0], max), min));
+    __m128i hi = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(v[1], max), min));
+    _mm_storeu_si128((__m128i *)(dest + i), _mm_packs_epi32(lo, hi));
+  }
+
+  if (pDither)
+    _mm_storeu_si128((__m128i *)pDither->seed, seed);
+#endif
+  for (; i < nSamples; i++)
+  {
+    float v = src[i] * 0x7fff;
+    if (pDither)
+    {
+      unsigned int &seed = pDither->seed[i & 3];
+      float r0 = (NextRandom(seed) >> 8) * SCALE_DITHER;
+      float r1 = (NextRandom(seed) >> 8) * SCALE_DITHER;
+      v += r0 - r1;
+    }
+    v = floorf(v + 0.5f);
+    if (v > 0x7fff) v = 0x7fff;
+    if (v < -0x8000) v = -0x8000;
+    dest[i] = (short)v;
+  }
+}
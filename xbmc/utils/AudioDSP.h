@@ -0,0 +1,51 @@
+#ifndef __AUDIO_DSP__H__
+#define __AUDIO_DSP__H__
+
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+// sample conversion and scaling kernels for the audio chain. floats are in
+// the -1 ... 1 range. the sse2 versions are picked at compile time, there is
+// a plain C version of every kernel for other targets. buffers need no
+// particular alignment.
+class CAudioDSP
+{
+public:
+  // state for the triangular dither used when going back to integers
+  struct DitherState
+  {
+    DitherState();
+    unsigned int seed[4];
+  };
+
+  static void Int8ToFloat(float *dest, const unsigned char *src, int nSamples);
+  static void Int16ToFloat(float *dest, const short *src, int nSamples);
+  static void Int24ToFloat(float *dest, const unsigned char *src, int nSamples); // packed, little endian
+  static void Int32ToFloat(float *dest, const int *src, int nSamples);
+
+  // multiplies by fGain, optionally clipping to -1 ... 1
+  static void Gain(float *data, int nSamples, float fGain, bool bClip);
+
+  // converts with saturation, adding dither when a state is given
+  static void FloatToInt16(short *dest, const float *src, int nSamples, DitherState *pDither);
+};
+
+#endif
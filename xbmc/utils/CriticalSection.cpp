@@ -20,9 +20,17 @@
 
 #include "stdafx.h"
 #include "CriticalSection.h"
+#include "LockProfiler.h"
+
+#ifdef __GNUC__
+#define CREATION_SITE __builtin_return_address(0)
+#else
+#define CREATION_SITE NULL
+#endif
 
 //////////////////////////////////////////////////////////////////////
 CCriticalSection::CCriticalSection()
+  : m_name(NULL), m_site(CREATION_SITE), m_stats(NULL)
 {
   m_criticalSection.Initialize();
 }
@@ -30,11 +38,14 @@ CCriticalSection::CCriticalSection()
 //////////////////////////////////////////////////////////////////////
 CCriticalSection::~CCriticalSection()
 {
+  if (m_stats)
+    CLockProfiler::Retire(*this);
   m_criticalSection.Destroy();
 }
 
 //////////////////////////////////////////////////////////////////////
 CCriticalSection::CCriticalSection(const CCriticalSection& section)
+  : m_name(section.m_name), m_site(CREATION_SITE), m_stats(NULL)
 {
   *this = section;
 }
@@ -51,14 +62,42 @@ CCriticalSection& CCriticalSection::operator=(const CCriticalSection& section)
 void  InitializeCriticalSection(CCriticalSection* section)             { section->getCriticalSection().Initialize(); } 
 void  DeleteCriticalSection(CCriticalSection* section)                 { section->getCriticalSection().Destroy(); }
 BOOL  OwningCriticalSection(CCriticalSection* section)                 { return section->getCriticalSection().Owning(); }
-DWORD ExitCriticalSection(CCriticalSection* section)                   { return section->getCriticalSection().Exit(); } 
-void  RestoreCriticalSection(CCriticalSection* section, DWORD count)   { return section->getCriticalSection().Restore(count); }
-void  EnterCriticalSection(CCriticalSection* section)                  { section->getCriticalSection().Enter(); }
-void  LeaveCriticalSection(CCriticalSection* section)                  { section->getCriticalSection().Leave(); }
+DWORD ExitCriticalSection(CCriticalSection* section)                   { return ExitCriticalSection(*section); } 
+void  RestoreCriticalSection(CCriticalSection* section, DWORD count)   { RestoreCriticalSection(*section, count); }
+void  EnterCriticalSection(CCriticalSection* section)                  { EnterCriticalSection(*section); }
+void  LeaveCriticalSection(CCriticalSection* section)                  { LeaveCriticalSection(*section); }
 
-void EnterCriticalSection(CCriticalSection& section)                   { section.getCriticalSection().Enter(); }
-void LeaveCriticalSection(CCriticalSection& section)                   { section.getCriticalSection().Leave(); }
 BOOL OwningCriticalSection(CCriticalSection& section)                  { return section.getCriticalSection().Owning(); }
-DWORD ExitCriticalSection(CCriticalSection& section)                   { return section.getCriticalSection().Exit(); }
-void RestoreCriticalSection(CCriticalSection& section, DWORD count)    { return section.getCriticalSection().Restore(count); }
 
+// the profiler is only ever switched on, so a section it saw entered is
+// also seen leaving
+void EnterCriticalSection(CCriticalSection& section)
+{
+  if (CLockProfiler::IsEnabled())
+    CLockProfiler::Enter(section, 1);
+  else
+    section.getCriticalSection().Enter();
+}
+
+void LeaveCriticalSection(CCriticalSection& section)
+{
+  if (CLockProfiler::IsEnabled())
+    CLockProfiler::Leave(section);
+  else
+    section.getCriticalSection().Leave();
+}
+
+DWORD ExitCriticalSection(CCriticalSection& section)
+{
+  if (CLockProfiler::IsEnabled())
+    return CLockProfiler::Exit(section);
+  return section.getCriticalSection().Exit();
+}
+
+void RestoreCriticalSection(CCriticalSection& section, DWORD count)
+{
+  if (CLockProfiler::IsEnabled() && count > 0)
+    CLockProfiler::Enter(section, count);
+  else
+    section.getCriticalSection().Restore(count);
+}
@@ -38,6 +38,8 @@
  *
  */
 
+struct SLockStats;
+
 class CCriticalSection
 {
 public:
@@ -50,8 +52,17 @@ public:
 
   XCriticalSection& getCriticalSection() { return m_criticalSection; }
 
+  // name the lock profiler reports this section under, must be a literal.
+  // unnamed sections are reported by where they were created.
+  void SetName(const char* name) { m_name = name; }
+
 private:
+  friend class CLockProfiler;
+
   XCriticalSection m_criticalSection;
+  const char* m_name;
+  void* m_site;
+  SLockStats* m_stats; // only once profiled
 };
 
 // The CCritical section overloads.
@@ -21,191 +21,300 @@
 
 #include "stdafx.h"
 #include "DownloadQueue.h"
-#include "HTTP.h"
+#include "FileSystem/File.h"
+#include "URL.h"
 #include "Util.h"
+#include "Settings.h"
+#include "SingleLock.h"
 
 using namespace std;
+using namespace XFILE;
 
 WORD CDownloadQueue::m_wNextQueueId = 0;
 
-CDownloadQueue::CDownloadQueue(void) : CThread()
+CDownloadQueue::CDownloadQueue(void)
 {
-  InitializeCriticalSection(&m_critical);
   m_bStop = false;
   m_wQueueId = m_wNextQueueId++;
   m_dwNextItemId = 0;
-  CThread::Create(false);
+
+  for (int i = 0; i < g_advancedSettings.m_iDownloadThreads; i++)
+  {
+    CThread *worker = new CThread(this);
+    worker->Create();
+    worker->SetName("DownloadQueue");
+    worker->SetPriority(THREAD_PRIORITY_LOWEST);
+    m_workers.push_back(worker);
+  }
+  CLog::Log(LOGNOTICE, "DownloadQueue ready, %i threads.", (int)m_workers.size());
 }
 
-void CDownloadQueue::OnStartup()
+CDownloadQueue::~CDownloadQueue(void)
 {
-  SetPriority( THREAD_PRIORITY_LOWEST );
+  m_bStop = true;
+  for (unsigned int i = 0; i < m_workers.size(); i++)
+  {
+    m_queueEvent.Set();
+    m_workers[i]->StopThread();
+    delete m_workers[i];
+  }
+  m_workers.clear();
+  CLog::Log(LOGNOTICE, "DownloadQueue terminated.");
 }
 
-CDownloadQueue::~CDownloadQueue(void)
+TICKET CDownloadQueue::RequestContent(CStdString& aUrl, IDownloadQueueObserver* aObserver, int iPriority)
 {
-  DeleteCriticalSection(&m_critical);
+  return Request(aUrl, "", aObserver, iPriority);
 }
 
+TICKET CDownloadQueue::RequestFile(CStdString& aUrl, CStdString& aFilePath, IDownloadQueueObserver* aObserver, int iPriority)
+{
+  return Request(aUrl, aFilePath, aObserver, iPriority);
+}
 
-TICKET CDownloadQueue::RequestContent(CStdString& aUrl, IDownloadQueueObserver* aObserver)
+TICKET CDownloadQueue::RequestFile(CStdString& aUrl, IDownloadQueueObserver* aObserver, int iPriority)
 {
-  EnterCriticalSection(&m_critical);
+  CSingleLock lock(m_critical);
 
-  TICKET ticket(m_wQueueId, m_dwNextItemId++);
+  CLog::Log(LOGDEBUG, "RequestFile from observer at %p", aObserver);
+  // create a temporary destination
+  CStdString strExtension;
+  CUtil::GetExtension(aUrl, strExtension);
 
-  Command request = {ticket, aUrl, "", aObserver};
-  m_queue.push(request);
+  CStdString strFilePath;
+  strFilePath.Format("Z:\\q%d-item%u%s", m_wQueueId, m_dwNextItemId, strExtension.c_str());
 
-  LeaveCriticalSection(&m_critical);
-  return request.ticket;
+  return Request(aUrl, strFilePath, aObserver, iPriority);
 }
 
-TICKET CDownloadQueue::RequestFile(CStdString& aUrl, CStdString& aFilePath, IDownloadQueueObserver* aObserver)
+TICKET CDownloadQueue::Request(const CStdString& aUrl, const CStdString& aFilePath, IDownloadQueueObserver* aObserver, int iPriority)
 {
-  EnterCriticalSection(&m_critical);
+  CSingleLock lock(m_critical);
 
   TICKET ticket(m_wQueueId, m_dwNextItemId++);
+  Waiter waiter = { ticket, aFilePath, aObserver };
+  bool bFile = !aFilePath.IsEmpty();
+
+  // already downloading it?
+  for (COMMANDQUEUE::iterator it = m_active.begin(); it != m_active.end(); ++it)
+  {
+    if (it->bFile == bFile && it->location == aUrl)
+    {
+      it->waiters.push_back(waiter);
+      return ticket;
+    }
+  }
+
+  // or waiting to?
+  for (COMMANDQUEUE::iterator it = m_queue.begin(); it != m_queue.end(); ++it)
+  {
+    if (it->bFile == bFile && it->location == aUrl)
+    {
+      it->waiters.push_back(waiter);
+      if (iPriority > it->priority)
+      { // move it up
+        Command request = *it;
+        request.priority = iPriority;
+        m_queue.erase(it);
+        Insert(request);
+      }
+      return ticket;
+    }
+  }
 
-  Command request = {ticket, aUrl, aFilePath, aObserver};
-  m_queue.push(request);
+  Command request;
+  request.location = aUrl;
+  request.host = CURL(aUrl).GetHostName();
+  request.bFile = bFile;
+  request.priority = iPriority;
+  request.waiters.push_back(waiter);
+  Insert(request);
+  m_queueEvent.Set();
 
-  LeaveCriticalSection(&m_critical);
-  return request.ticket;
+  return ticket;
+}
+
+void CDownloadQueue::Insert(Command& request)
+{
+  // after everything of the same or a higher priority
+  COMMANDQUEUE::iterator it = m_queue.begin();
+  while (it != m_queue.end() && it->priority >= request.priority)
+    ++it;
+  m_queue.insert(it, request);
 }
 
 void CDownloadQueue::CancelRequests(IDownloadQueueObserver *aObserver)
 {
-  EnterCriticalSection(&m_critical);
+  CSingleLock lock(m_critical);
 
   CLog::Log(LOGDEBUG, "CancelRequests from observer at %p", aObserver);
-  // run through our queue, and create a new queue with the requests
-  // from aObserver NULL'd out.
-  queue<Command> newQueue;
-  while (m_queue.size())
+  // NULL out the observer of the requests from aObserver, downloads already
+  // running are left to finish. the observers are called with the lock held,
+  // so none of them is called once we return.
+  COMMANDQUEUE* queues[] = { &m_queue, &m_active };
+  for (unsigned int i = 0; i < sizeof(queues) / sizeof(queues[0]); i++)
   {
-    Command request = m_queue.front();
-    m_queue.pop();
-    if (request.observer == aObserver)
-      request.observer = NULL;
-    newQueue.push(request);
+    for (COMMANDQUEUE::iterator it = queues[i]->begin(); it != queues[i]->end(); ++it)
+    {
+      for (unsigned int j = 0; j < it->waiters.size(); j++)
+      {
+        if (it->waiters[j].observer == aObserver)
+          it->waiters[j].observer = NULL;
+      }
+    }
   }
-  m_queue = newQueue;
-  LeaveCriticalSection(&m_critical);
 }
 
-TICKET CDownloadQueue::RequestFile(CStdString& aUrl, IDownloadQueueObserver* aObserver)
+VOID CDownloadQueue::Flush()
 {
-  EnterCriticalSection(&m_critical);
+  CSingleLock lock(m_critical);
 
-  CLog::Log(LOGDEBUG, "RequestFile from observer at %p", aObserver);
-  // create a temporary destination
-  CStdString strExtension;
-  CUtil::GetExtension(aUrl, strExtension);
+  // nothing was downloaded for these, but their observers still wait to hear
+  COMMANDQUEUE flushed;
+  flushed.swap(m_queue);
+  for (COMMANDQUEUE::iterator it = flushed.begin(); it != flushed.end(); ++it)
+  {
+    for (unsigned int i = 0; i < it->waiters.size(); i++)
+      Notify(it->waiters[i], "", 0, false);
+  }
+}
 
-  TICKET ticket(m_wQueueId, m_dwNextItemId++);
+void CDownloadQueue::Run()
+{
+  while (!m_bStop)
+  {
+    // take the first request from a host we aren't already busy enough with
+    COMMANDQUEUE::iterator request;
+    CStdString strUrl, strFilePath;
+    bool bFound = false;
+    {
+      CSingleLock lock(m_critical);
+      for (request = m_queue.begin(); request != m_queue.end(); ++request)
+      {
+        map<CStdString, int>::const_iterator host = m_hostDownloads.find(request->host);
+        if (host == m_hostDownloads.end() || host->second < g_advancedSettings.m_iDownloadsPerHost)
+        {
+          bFound = true;
+          break;
+        }
+      }
+      if (bFound)
+      {
+        m_active.splice(m_active.end(), m_queue, request);
+        m_hostDownloads[request->host]++;
+        strUrl = request->location;
+        strFilePath = request->waiters[0].filePath;
+      }
+    }
+    if (!bFound)
+    { // the event only wakes one of us, so don't sleep long
+      m_queueEvent.WaitMSec(500);
+      continue;
+    }
 
-  CStdString strFilePath;
-  strFilePath.Format("Z:\\q%d-item%u%s", ticket.wQueueId, ticket.dwItemId, strExtension.c_str());
+    CStdString strContent;
+    DWORD dwSize = 0;
+    bool bSuccess = Download(strUrl, strFilePath, strContent, dwSize);
+
+    // others asking for the same file get a copy of it. the copies are made
+    // without the lock, the request stays active meanwhile so more waiters
+    // can still join it and cancelling still reaches all of them.
+    vector<bool> results(1, bSuccess);
+    CSingleLock lock(m_critical);
+    while (results.size() < request->waiters.size())
+    {
+      vector<Waiter> pending(request->waiters.begin() + results.size(), request->waiters.end());
+      lock.Leave();
+      for (unsigned int i = 0; i < pending.size(); i++)
+      {
+        bool bWaiterSuccess = bSuccess;
+        if (bSuccess && !strFilePath.IsEmpty() && !pending[i].filePath.Equals(strFilePath))
+          bWaiterSuccess = CFile::Cache(strFilePath, pending[i].filePath);
+        results.push_back(bWaiterSuccess);
+      }
+      lock.Enter();
+    }
 
-  Command request = {ticket, aUrl, strFilePath, aObserver};
-  m_queue.push(request);
+    vector<Waiter> waiters = request->waiters;
+    map<CStdString, int>::iterator host = m_hostDownloads.find(request->host);
+    if (host != m_hostDownloads.end() && --host->second <= 0)
+      m_hostDownloads.erase(host);
+    m_active.erase(request);
 
-  LeaveCriticalSection(&m_critical);
-  return request.ticket;
+    for (unsigned int i = 0; i < waiters.size(); i++)
+      Notify(waiters[i], strContent, dwSize, results[i]);
+  }
 }
 
-VOID CDownloadQueue::Flush()
+// called with the lock held, see CancelRequests()
+void CDownloadQueue::Notify(Waiter& waiter, const CStdString& strContent, DWORD dwSize, bool bSuccess)
 {
-  EnterCriticalSection(&m_critical);
+  // if the request has been cancelled our observer will be NULL
+  if (NULL == waiter.observer)
+    return;
 
-  m_queue.empty();
+  try
+  {
+    if (!waiter.filePath.IsEmpty())
+    {
+      waiter.observer->OnFileComplete(waiter.ticket, waiter.filePath, dwSize,
+                                      bSuccess ? IDownloadQueueObserver::Succeeded : IDownloadQueueObserver::Failed );
+    }
+    else
+    {
+      CStdString content = strContent;
+      waiter.observer->OnContentComplete(waiter.ticket, content,
+                                         bSuccess ? IDownloadQueueObserver::Succeeded : IDownloadQueueObserver::Failed );
+    }
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "exception while updating download observer.");
 
-  LeaveCriticalSection(&m_critical);
+    if (!waiter.filePath.IsEmpty())
+    {
+      ::DeleteFile(waiter.filePath.c_str());
+    }
+  }
 }
 
-void CDownloadQueue::Process()
+bool CDownloadQueue::Download(const CStdString& strUrl, const CStdString& strFilePath, CStdString& strContent, DWORD& dwSize)
 {
-  CLog::Log(LOGNOTICE, "DownloadQueue ready.");
+  CFile file;
+  if (!file.Open(strUrl))
+    return false;
 
-  CHTTP http;
-  bool bSuccess;
+  CFile output;
+  if (!strFilePath.IsEmpty())
+  {
+    ::DeleteFile(strFilePath.c_str());
+    if (!output.OpenForWrite(strFilePath, true, true))
+      return false;
+  }
 
-  while ( !m_bStop )
+  char buffer[16384];
+  unsigned int iRead;
+  while (!m_bStop && (iRead = file.Read(buffer, sizeof(buffer))) > 0)
   {
-    while ( CDownloadQueue::Size() > 0 )
+    if (!strFilePath.IsEmpty())
     {
-      EnterCriticalSection(&m_critical);
-
-      // get the first item, but don't pop it from our queue
-      // so that the download can be interrupted
-      Command request = m_queue.front();
-
-      LeaveCriticalSection(&m_critical);
-
-      bool bFileRequest = request.content.length() > 0;
-      DWORD dwSize = 0;
-
-      if (bFileRequest)
-      {
-        ::DeleteFile(request.content.c_str());
-        bSuccess = http.Download(request.location, request.content, &dwSize);
-      }
-      else
-      {
-        bSuccess = http.Get(request.location, request.content);
-      }
-
-      // now re-grab the item as we may have cancelled our download
-      // while we were working
-      EnterCriticalSection(&m_critical);
-
-      request = m_queue.front();
-      m_queue.pop();
-
-      // if the request has been cancelled our observer will be NULL
-      if (NULL != request.observer)
+      if (output.Write(buffer, iRead) != (int)iRead)
       {
-        try
-        {
-          if (bFileRequest)
-          {
-            request.observer->OnFileComplete(request.ticket, request.content, dwSize,
-                                            bSuccess ? IDownloadQueueObserver::Succeeded : IDownloadQueueObserver::Failed );
-          }
-          else
-          {
-            request.observer->OnContentComplete(request.ticket, request.content,
-                                                bSuccess ? IDownloadQueueObserver::Succeeded : IDownloadQueueObserver::Failed );
-          }
-        }
-        catch (...)
-        {
-          CLog::Log(LOGERROR, "exception while updating download observer.");
-
-          if (bFileRequest)
-          {
-            ::DeleteFile(request.content.c_str());
-          }
-        }
+        output.Close();
+        ::DeleteFile(strFilePath.c_str());
+        return false;
       }
-      LeaveCriticalSection(&m_critical);
     }
-
-    Sleep(500);
+    else
+      strContent.append(buffer, iRead);
+    dwSize += iRead;
   }
-
-  CLog::Log(LOGNOTICE, "DownloadQueue terminated.");
+  return !m_bStop;
 }
 
 INT CDownloadQueue::Size()
 {
-  EnterCriticalSection(&m_critical);
+  CSingleLock lock(m_critical);
 
-  int sizeOfQueue = m_queue.size();
-
-  LeaveCriticalSection(&m_critical);
-
-  return sizeOfQueue;
+  return m_queue.size() + m_active.size();
 }
-
@@ -21,7 +21,13 @@
  *
  */
 
-#include <queue>
+#include "Thread.h"
+#include "CriticalSection.h"
+#include "Event.h"
+
+#include <list>
+#include <map>
+#include <vector>
 
 struct TICKET
 {
@@ -44,36 +50,58 @@ public:
 };
 
 
-class CDownloadQueue: CThread
+// downloads on a few threads of its own, at most a couple at a time from any
+// one host. downloads go through CFile, so the curl sessions kept per host
+// reuse their connections between requests. higher priority requests are
+// served first, and a request for something already queued or downloading
+// waits for that download instead of fetching it again.
+class CDownloadQueue : public IRunnable
 {
 public:
   CDownloadQueue();
   virtual ~CDownloadQueue(void);
 
-  TICKET RequestContent(CStdString& aUrl, IDownloadQueueObserver* aObserver);
-  TICKET RequestFile(CStdString& aUrl, IDownloadQueueObserver* aObserver);
-  TICKET RequestFile(CStdString& aUrl, CStdString& aFilePath, IDownloadQueueObserver* aObserver);
+  TICKET RequestContent(CStdString& aUrl, IDownloadQueueObserver* aObserver, int iPriority = 0);
+  TICKET RequestFile(CStdString& aUrl, IDownloadQueueObserver* aObserver, int iPriority = 0);
+  TICKET RequestFile(CStdString& aUrl, CStdString& aFilePath, IDownloadQueueObserver* aObserver, int iPriority = 0);
   void CancelRequests(IDownloadQueueObserver* aObserver);
 
   VOID Flush();
   INT Size();
 
 protected:
+  virtual void Run();
 
-  void OnStartup();
-  void Process();
+  struct Waiter
+  {
+    TICKET ticket;
+    CStdString filePath;    // empty for content requests
+    IDownloadQueueObserver* observer;
+  };
 
   struct Command
   {
-    TICKET ticket;
     CStdString location;
-    CStdString content;
-    IDownloadQueueObserver* observer;
+    CStdString host;
+    bool bFile;
+    int priority;
+    std::vector<Waiter> waiters;  // the first one asked for the download
   };
 
-  typedef std::queue<Command> COMMANDQUEUE;
-  COMMANDQUEUE m_queue;
-  CRITICAL_SECTION m_critical;
+  typedef std::list<Command> COMMANDQUEUE;
+
+  TICKET Request(const CStdString& aUrl, const CStdString& aFilePath, IDownloadQueueObserver* aObserver, int iPriority);
+  void Insert(Command& request);
+  void Notify(Waiter& waiter, const CStdString& strContent, DWORD dwSize, bool bSuccess);
+  bool Download(const CStdString& strUrl, const CStdString& strFilePath, CStdString& strContent, DWORD& dwSize);
+
+  COMMANDQUEUE m_queue;   // highest priority first
+  COMMANDQUEUE m_active;  // being downloaded
+  std::map<CStdString, int> m_hostDownloads;
+  CCriticalSection m_critical;
+  CEvent m_queueEvent;
+  std::vector<CThread*> m_workers;
+  volatile bool m_bStop;
 
   WORD m_wQueueId;
   DWORD m_dwNextItemId;
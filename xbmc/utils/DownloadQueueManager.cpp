@@ -42,26 +42,26 @@ VOID CDownloadQueueManager::Initialize()
 }
 
 
-TICKET CDownloadQueueManager::RequestContent(CStdString& aUrl, IDownloadQueueObserver* aObserver)
+TICKET CDownloadQueueManager::RequestContent(CStdString& aUrl, IDownloadQueueObserver* aObserver, int iPriority)
 {
   EnterCriticalSection(&m_critical);
-  TICKET ticket = GetNextDownloadQueue()->RequestContent(aUrl, aObserver);
+  TICKET ticket = GetNextDownloadQueue()->RequestContent(aUrl, aObserver, iPriority);
   LeaveCriticalSection(&m_critical);
   return ticket;
 }
 
-TICKET CDownloadQueueManager::RequestFile(CStdString& aUrl, CStdString& aFilePath, IDownloadQueueObserver* aObserver)
+TICKET CDownloadQueueManager::RequestFile(CStdString& aUrl, CStdString& aFilePath, IDownloadQueueObserver* aObserver, int iPriority)
 {
   EnterCriticalSection(&m_critical);
-  TICKET ticket = GetNextDownloadQueue()->RequestFile(aUrl, aFilePath, aObserver);
+  TICKET ticket = GetNextDownloadQueue()->RequestFile(aUrl, aFilePath, aObserver, iPriority);
   LeaveCriticalSection(&m_critical);
   return ticket;
 }
 
-TICKET CDownloadQueueManager::RequestFile(CStdString& aUrl, IDownloadQueueObserver* aObserver)
+TICKET CDownloadQueueManager::RequestFile(CStdString& aUrl, IDownloadQueueObserver* aObserver, int iPriority)
 {
   EnterCriticalSection(&m_critical);
-  TICKET ticket = GetNextDownloadQueue()->RequestFile(aUrl, aObserver);
+  TICKET ticket = GetNextDownloadQueue()->RequestFile(aUrl, aObserver, iPriority);
   LeaveCriticalSection(&m_critical);
   return ticket;
 }
@@ -80,42 +80,14 @@ void CDownloadQueueManager::CancelRequests(IDownloadQueueObserver *aObserver)
 
 CDownloadQueue* CDownloadQueueManager::GetNextDownloadQueue()
 {
-  CDownloadQueue* pQueueAvailable = NULL;
-
-  // if we haven't added any queues to the pool, add one.
+  // a single queue, it downloads several at a time itself and needs to see
+  // all requests to keep to the per host limit and merge duplicates
   if (m_queues.size() < 1)
   {
     m_queues.push_back( new CDownloadQueue() );
   }
 
-  // return the queue with the least number of items pending
-  for (QUEUEPOOL::iterator it = m_queues.begin(); it != m_queues.end(); ++it)
-  {
-    // always choose the first queue if we haven't selected one yet
-    if (!pQueueAvailable)
-    {
-      pQueueAvailable = *it;
-    }
-    else
-    {
-      // pick this queue if it has less items pending than our previous selection
-      if ( pQueueAvailable->Size() > (*it)->Size() )
-      {
-        pQueueAvailable = *it;
-      }
-    }
-  }
+  assert(m_queues[0] != NULL);
 
-  // if we picked a queue with pending items and we haven't reached out max pool limit
-  if (pQueueAvailable->Size() > 0 && m_queues.size() < MAX_DOWNLOAD_QUEUES)
-  {
-    // spawn a new queue
-    pQueueAvailable = new CDownloadQueue();
-    m_queues.push_back(pQueueAvailable);
-  }
-
-  assert(pQueueAvailable != NULL);
-
-  return pQueueAvailable;
+  return m_queues[0];
 }
-
@@ -23,8 +23,6 @@
 
 #include "DownloadQueue.h"
 
-#define MAX_DOWNLOAD_QUEUES  3
-
 class CDownloadQueueManager
 {
 public:
@@ -32,9 +30,9 @@ public:
   virtual ~CDownloadQueueManager(void);
 
   VOID Initialize();
-  TICKET RequestContent(CStdString& aUrl, IDownloadQueueObserver* aObserver);
-  TICKET RequestFile(CStdString& aUrl, IDownloadQueueObserver* aObserver);
-  TICKET RequestFile(CStdString& aUrl, CStdString& aFilePath, IDownloadQueueObserver* aObserver);
+  TICKET RequestContent(CStdString& aUrl, IDownloadQueueObserver* aObserver, int iPriority = 0);
+  TICKET RequestFile(CStdString& aUrl, IDownloadQueueObserver* aObserver, int iPriority = 0);
+  TICKET RequestFile(CStdString& aUrl, CStdString& aFilePath, IDownloadQueueObserver* aObserver, int iPriority = 0);
   void CancelRequests(IDownloadQueueObserver *aObserver);
 
 protected:
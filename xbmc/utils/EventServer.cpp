@@ -41,6 +41,13 @@ using namespace EVENTCLIENT;
 using namespace SOCKETS;
 using namespace std;
 
+// datagrams taken off the socket per wakeup, a gyro remote or a few clients
+// at once easily send more than one between two frames
+#define ES_READ_BATCH 32
+
+// clients time out after a minute, no need to check on every packet
+#define ES_REFRESH_INTERVAL 1000
+
 /************************************************************************/
 /* CEventServer                                                         */
 /************************************************************************/
@@ -161,7 +168,9 @@ void CEventServer::Run()
 {
   CAddress any_addr;
   CSocketListener listener;
-  int packetSize = 0;
+  CAddress addrs[ES_READ_BATCH];
+  int sizes[ES_READ_BATCH];
+  DWORD lastRefresh = timeGetTime();
 
 #ifndef _XBOX
   if (!g_guiSettings.GetBool("remoteevents.allinterfaces"))
@@ -179,7 +188,7 @@ void CEventServer::Run()
     CLog::Log(LOGERROR, "ES: Could not create socket, aborting!");
     return;
   }
-  m_pPacketBuffer = (unsigned char *)malloc(PACKET_SIZE);
+  m_pPacketBuffer = (unsigned char *)malloc(PACKET_SIZE * ES_READ_BATCH);
 
   if (!m_pPacketBuffer)
   {
@@ -207,21 +216,29 @@ void CEventServer::Run()
 
   while (!m_bStop)
   {
-    // start listening until we timeout
+    // start listening until we timeout, then take everything that is waiting
+    int packets = 0;
     if (listener.Listen(m_iListenTimeout))
     {
-      CAddress addr;
-      if ((packetSize = m_pSocket->Read(addr, PACKET_SIZE, (void *)m_pPacketBuffer)) > -1)
-      {
-        ProcessPacket(addr, packetSize);
-      }
+      packets = m_pSocket->ReadMany(addrs, sizes, ES_READ_BATCH, PACKET_SIZE, m_pPacketBuffer);
+
+      CSingleLock lock(m_critSection);
+      for (int i = 0 ; i < packets ; i++)
+        ProcessPacket(addrs[i], sizes[i], m_pPacketBuffer + i * PACKET_SIZE);
     }
 
-    // process events and queue the necessary actions and button codes
-    ProcessEvents();
+    // process events and queue the necessary actions and button codes. the
+    // whole burst goes in before the GUI thread asks, so successive mouse
+    // and axis updates leave only their latest state
+    if (packets > 0)
+      ProcessEvents();
 
     // refresh client list
-    RefreshClients();
+    if (m_bRefreshSettings || timeGetTime() - lastRefresh >= ES_REFRESH_INTERVAL)
+    {
+      RefreshClients();
+      lastRefresh = timeGetTime();
+    }
 
     // broadcast
     // BroadcastBeacon();
@@ -232,10 +249,10 @@ void CEventServer::Run()
   Cleanup();
 }
 
-void CEventServer::ProcessPacket(CAddress& addr, int pSize)
+void CEventServer::ProcessPacket(CAddress& addr, int pSize, unsigned char* pBuffer)
 {
   // check packet validity
-  CEventPacket* packet = new CEventPacket(pSize, m_pPacketBuffer);
+  CEventPacket* packet = new CEventPacket(pSize, pBuffer);
   if(packet == NULL)
   {
     CLog::Log(LOGERROR, "ES: Out of memory, cannot accept packet");
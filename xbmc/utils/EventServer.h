@@ -70,7 +70,7 @@ namespace EVENTSERVER
   protected:
     CEventServer();
     void Cleanup();
-    void ProcessPacket(SOCKETS::CAddress& addr, int packetSize);
+    void ProcessPacket(SOCKETS::CAddress& addr, int packetSize, unsigned char* packetBuffer);
     void ProcessEvents();
     void RefreshClients();
 
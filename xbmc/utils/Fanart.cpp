@@ -170,7 +170,7 @@ bool CFanart::DownloadImage(const CStdString &strDestination) const
   return DownloadImage(GetImageURL(), strDestination);
 }
 
-unsigned int CFanart::GetNumFanarts()
+unsigned int CFanart::GetNumFanarts() const
 {
   return m_fanart.size();
 }
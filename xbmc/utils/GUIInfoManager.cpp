@@ -1264,9 +1264,9 @@ CStdString CGUIInfoManager::GetLabel(int info, DWORD contextWindow)
         int duration=0;
         for (int i=0;i<items.Size();++i)
         {
-          CFileItemPtr item=items.Get(i);
-          if (item->HasMusicInfoTag())
-            duration += item->GetMusicInfoTag()->GetDuration();
+          const CFileItem &item = *items.Get(i);
+          if (item.HasMusicInfoTag())
+            duration += item.GetMusicInfoTag()->GetDuration();
         }
         if (duration > 0)
         {
@@ -2325,11 +2325,11 @@ bool CGUIInfoManager::GetMultiInfoBool(const GUIInfo &info, DWORD dwContextWindo
         CStdString strContent="movies";
         if (!m_currentFile->HasVideoInfoTag())
           strContent = "files";
-        if (m_currentFile->HasVideoInfoTag() && m_currentFile->GetVideoInfoTag()->m_iSeason > -1) // episode
+        if (m_currentFile->HasVideoInfoTag() && GetCurrentMovieTag()->m_iSeason > -1) // episode
           strContent = "episodes";
-        if (m_currentFile->HasVideoInfoTag() && !m_currentFile->GetVideoInfoTag()->m_strArtist.IsEmpty())
+        if (m_currentFile->HasVideoInfoTag() && !GetCurrentMovieTag()->m_strArtist.IsEmpty())
           strContent = "musicvideos";
-        if (m_currentFile->HasVideoInfoTag() && m_currentFile->GetVideoInfoTag()->m_strStatus == "livetv")
+        if (m_currentFile->HasVideoInfoTag() && GetCurrentMovieTag()->m_strStatus == "livetv")
           strContent = "livetv";
         bReturn = m_stringParameters[info.GetData1()].Equals(strContent);
       }
@@ -2737,7 +2737,7 @@ CStdString CGUIInfoManager::GetDuration(TIME_FORMAT format) const
   CStdString strDuration;
   if (g_application.IsPlayingAudio() && m_currentFile->HasMusicInfoTag())
   {
-    const CMusicInfoTag& tag = *m_currentFile->GetMusicInfoTag();
+    const CMusicInfoTag& tag = *GetCurrentSongTag();
     if (tag.GetDuration() > 0)
       StringUtils::SecondsToTimeString(tag.GetDuration(), strDuration, format);
   }
@@ -3010,8 +3010,8 @@ CStdString CGUIInfoManager::GetVideoLabel(int item)
   
   if (item == VIDEOPLAYER_TITLE)
   {
-    if (m_currentFile->HasVideoInfoTag() && !m_currentFile->GetVideoInfoTag()->m_strTitle.IsEmpty())
-      return m_currentFile->GetVideoInfoTag()->m_strTitle;
+    if (m_currentFile->HasVideoInfoTag() && !GetCurrentMovieTag()->m_strTitle.IsEmpty())
+      return GetCurrentMovieTag()->m_strTitle;
     // don't have the title, so use label, or drop down to title from path
     if (!m_currentFile->GetLabel().IsEmpty())
       return m_currentFile->GetLabel();
@@ -3032,103 +3032,103 @@ CStdString CGUIInfoManager::GetVideoLabel(int item)
     switch (item)
     {
     case VIDEOPLAYER_ORIGINALTITLE:
-      return m_currentFile->GetVideoInfoTag()->m_strOriginalTitle;
+      return GetCurrentMovieTag()->m_strOriginalTitle;
       break;
     case VIDEOPLAYER_GENRE:
-      return m_currentFile->GetVideoInfoTag()->m_strGenre;
+      return GetCurrentMovieTag()->m_strGenre;
       break;
     case VIDEOPLAYER_DIRECTOR:
-      return m_currentFile->GetVideoInfoTag()->m_strDirector;
+      return GetCurrentMovieTag()->m_strDirector;
       break;
     case VIDEOPLAYER_RATING:
       {
         CStdString strRating;
-        if (m_currentFile->GetVideoInfoTag()->m_fRating > 0.f)
-          strRating.Format("%2.2f", m_currentFile->GetVideoInfoTag()->m_fRating);
+        if (GetCurrentMovieTag()->m_fRating > 0.f)
+          strRating.Format("%2.2f", GetCurrentMovieTag()->m_fRating);
         return strRating;
       }
       break;
     case VIDEOPLAYER_RATING_AND_VOTES:
       {
         CStdString strRatingAndVotes;
-        if (m_currentFile->GetVideoInfoTag()->m_fRating > 0.f)
-          strRatingAndVotes.Format("%2.2f (%s %s)", m_currentFile->GetVideoInfoTag()->m_fRating, m_currentFile->GetVideoInfoTag()->m_strVotes, g_localizeStrings.Get(20350));
+        if (GetCurrentMovieTag()->m_fRating > 0.f)
+          strRatingAndVotes.Format("%2.2f (%s %s)", GetCurrentMovieTag()->m_fRating, GetCurrentMovieTag()->m_strVotes, g_localizeStrings.Get(20350));
         return strRatingAndVotes;
       }
       break;
     case VIDEOPLAYER_YEAR:
       {
         CStdString strYear;
-        if (m_currentFile->GetVideoInfoTag()->m_iYear > 0)
-          strYear.Format("%i", m_currentFile->GetVideoInfoTag()->m_iYear);
+        if (GetCurrentMovieTag()->m_iYear > 0)
+          strYear.Format("%i", GetCurrentMovieTag()->m_iYear);
         return strYear;
       }
       break;
     case VIDEOPLAYER_PREMIERED:
       {
         CStdString strYear;
-        if (!m_currentFile->GetVideoInfoTag()->m_strPremiered.IsEmpty())
-          strYear = m_currentFile->GetVideoInfoTag()->m_strPremiered;
-        else if (!m_currentFile->GetVideoInfoTag()->m_strFirstAired.IsEmpty())
-          strYear = m_currentFile->GetVideoInfoTag()->m_strFirstAired;
+        if (!GetCurrentMovieTag()->m_strPremiered.IsEmpty())
+          strYear = GetCurrentMovieTag()->m_strPremiered;
+        else if (!GetCurrentMovieTag()->m_strFirstAired.IsEmpty())
+          strYear = GetCurrentMovieTag()->m_strFirstAired;
         return strYear;
       }
       break;
     case VIDEOPLAYER_PLOT:
-      return m_currentFile->GetVideoInfoTag()->m_strPlot;
+      return GetCurrentMovieTag()->m_strPlot;
     case VIDEOPLAYER_TRAILER:
-      return m_currentFile->GetVideoInfoTag()->m_strTrailer;
+      return GetCurrentMovieTag()->m_strTrailer;
     case VIDEOPLAYER_PLOT_OUTLINE:
-      return m_currentFile->GetVideoInfoTag()->m_strPlotOutline;
+      return GetCurrentMovieTag()->m_strPlotOutline;
     case VIDEOPLAYER_EPISODE:
-      if (m_currentFile->GetVideoInfoTag()->m_iEpisode > 0)
+      if (GetCurrentMovieTag()->m_iEpisode > 0)
       {
         CStdString strYear;
-        if (m_currentFile->GetVideoInfoTag()->m_iSpecialSortEpisode > 0)
-          strYear.Format("S%i", m_currentFile->GetVideoInfoTag()->m_iEpisode);
+        if (GetCurrentMovieTag()->m_iSpecialSortEpisode > 0)
+          strYear.Format("S%i", GetCurrentMovieTag()->m_iEpisode);
         else
-          strYear.Format("%i", m_currentFile->GetVideoInfoTag()->m_iEpisode);
+          strYear.Format("%i", GetCurrentMovieTag()->m_iEpisode);
         return strYear;
       }
       break;
     case VIDEOPLAYER_SEASON:
-      if (m_currentFile->GetVideoInfoTag()->m_iSeason > -1)
+      if (GetCurrentMovieTag()->m_iSeason > -1)
       {
         CStdString strYear;
-        if (m_currentFile->GetVideoInfoTag()->m_iSpecialSortSeason > 0)
-          strYear.Format("%i", m_currentFile->GetVideoInfoTag()->m_iSpecialSortSeason);
+        if (GetCurrentMovieTag()->m_iSpecialSortSeason > 0)
+          strYear.Format("%i", GetCurrentMovieTag()->m_iSpecialSortSeason);
         else
-          strYear.Format("%i", m_currentFile->GetVideoInfoTag()->m_iSeason);
+          strYear.Format("%i", GetCurrentMovieTag()->m_iSeason);
         return strYear;
       }
       break;
     case VIDEOPLAYER_TVSHOW:
-      return m_currentFile->GetVideoInfoTag()->m_strShowTitle;
+      return GetCurrentMovieTag()->m_strShowTitle;
 
     case VIDEOPLAYER_STUDIO:
-      return m_currentFile->GetVideoInfoTag()->m_strStudio;
+      return GetCurrentMovieTag()->m_strStudio;
     case VIDEOPLAYER_MPAA:
-      return m_currentFile->GetVideoInfoTag()->m_strMPAARating;
+      return GetCurrentMovieTag()->m_strMPAARating;
     case VIDEOPLAYER_TOP250:
       {
         CStdString strTop250;
-        if (m_currentFile->GetVideoInfoTag()->m_iTop250 > 0)
-          strTop250.Format("%i", m_currentFile->GetVideoInfoTag()->m_iTop250);
+        if (GetCurrentMovieTag()->m_iTop250 > 0)
+          strTop250.Format("%i", GetCurrentMovieTag()->m_iTop250);
         return strTop250;
       }
       break;
     case VIDEOPLAYER_CAST:
-      return m_currentFile->GetVideoInfoTag()->GetCast();
+      return GetCurrentMovieTag()->GetCast();
     case VIDEOPLAYER_CAST_AND_ROLE:
-      return m_currentFile->GetVideoInfoTag()->GetCast(true);
+      return GetCurrentMovieTag()->GetCast(true);
     case VIDEOPLAYER_ARTIST:
-      return m_currentFile->GetVideoInfoTag()->m_strArtist;
+      return GetCurrentMovieTag()->m_strArtist;
     case VIDEOPLAYER_ALBUM:
-      return m_currentFile->GetVideoInfoTag()->m_strAlbum;
+      return GetCurrentMovieTag()->m_strAlbum;
     case VIDEOPLAYER_WRITER:
-      return m_currentFile->GetVideoInfoTag()->m_strWritingCredits;
+      return GetCurrentMovieTag()->m_strWritingCredits;
     case VIDEOPLAYER_TAGLINE:
-      return m_currentFile->GetVideoInfoTag()->m_strTagLine;
+      return GetCurrentMovieTag()->m_strTagLine;
     }
   }
   return "";
@@ -4104,8 +4104,9 @@ CStdString CGUIInfoManager::GetPictureLabel(int info) const
       return index;
     }
   }
-  if (m_currentSlide->HasPictureInfoTag())
-    return m_currentSlide->GetPictureInfoTag()->GetInfo(info);
+  const CFileItem &slide = *m_currentSlide;
+  if (slide.HasPictureInfoTag())
+    return slide.GetPictureInfoTag()->GetInfo(info);
   return "";
 }
 
@@ -4184,17 +4185,15 @@ const CFileItem& CGUIInfoManager::GetCurrentSlide() const
 
 const MUSIC_INFO::CMusicInfoTag* CGUIInfoManager::GetCurrentSongTag() const
 {
-  if (m_currentFile->HasMusicInfoTag())
-    return m_currentFile->GetMusicInfoTag(); 
-
-  return NULL;
+  // the labels read this every frame. through the const item the tag stays
+  // shared with the playlist item it came from
+  const CFileItem &currentFile = *m_currentFile;
+  return currentFile.GetMusicInfoTag();
 };
 const CVideoInfoTag* CGUIInfoManager::GetCurrentMovieTag() const
 { 
-  if (m_currentFile->HasVideoInfoTag())
-    return m_currentFile->GetVideoInfoTag(); 
-
-  return NULL;
+  const CFileItem &currentFile = *m_currentFile;
+  return currentFile.GetVideoInfoTag();
 }
 
 void GUIInfo::SetInfoFlag(uint32_t flag)
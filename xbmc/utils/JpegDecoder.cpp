@@ -0,0 +1,275 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "JpegDecoder.h"
+
+#ifdef _LINUX
+#include <setjmp.h>
+extern "C" {
+#include <jpeglib.h>
+}
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+void SwizzleRow(BYTE *dst, const BYTE *src, unsigned int width, bool bSwapRB)
+{
+  unsigned int x = 0;
+#ifdef __SSE2__
+  const __m128i alpha = _mm_set1_epi32(0xff000000);
+  const __m128i green = _mm_set1_epi32(0xff00ff00);
+  // 4 pixels at a time, the load reads 4 bytes past them so keep off the last 2.
+  // each pixel is shifted down to the bottom of its own dword, the byte that
+  // comes along above it is covered by the alpha.
+  for (; x + 6 <= width; x += 4, src += 12, dst += 16)
+  {
+    __m128i in = _mm_loadu_si128((const __m128i *)src);
+    __m128i p01 = _mm_unpacklo_epi32(in, _mm_srli_si128(in, 3));
+    __m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(in, 6), _mm_srli_si128(in, 9));
+    __m128i out = _mm_or_si128(_mm_unpacklo_epi64(p01, p23), alpha);
+    if (bSwapRB)
+    {
+      __m128i r = _mm_srli_epi32(_mm_slli_epi32(out, 8), 24);
+      __m128i b = _mm_srli_epi32(_mm_slli_epi32(out, 24), 8);
+      out = _mm_or_si128(_mm_and_si128(out, green), _mm_or_si128(r, b));
+    }
+    _mm_storeu_si128((__m128i *)dst, out);
+  }
+#endif
+  const int r = bSwapRB ? 2 : 0;
+  for (; x < width; x++, src += 3, dst += 4)
+  {
+    dst[0] = src[r];
+    dst[1] = src[1];
+    dst[2] = src[2 - r];
+    dst[3] = 0xff;
+  }
+}
+
+#ifdef _LINUX
+struct JpegError
+{
+  struct jpeg_error_mgr pub;
+  jmp_buf jump;
+};
+
+static void JpegErrorExit(j_common_ptr cinfo)
+{
+  longjmp(((JpegError *)cinfo->err)->jump, 1);
+}
+
+static void JpegOutputMessage(j_common_ptr cinfo)
+{
+  // corrupt data warnings are common and harmless, don't spam the log
+}
+
+// memory source, libjpeg 6b has no jpeg_mem_src()
+static void JpegInitSource(j_decompress_ptr cinfo)
+{
+}
+
+static boolean JpegFillInput(j_decompress_ptr cinfo)
+{
+  // the whole file is already in the buffer, so this is a truncated image.
+  // hand out an EOI so libjpeg finishes with what it has
+  static const JOCTET eoi[2] = { 0xFF, JPEG_EOI };
+  cinfo->src->next_input_byte = eoi;
+  cinfo->src->bytes_in_buffer = 2;
+  return TRUE;
+}
+
+static void JpegSkipInput(j_decompress_ptr cinfo, long num_bytes)
+{
+  if (num_bytes <= 0)
+    return;
+  if ((size_t)num_bytes > cinfo->src->bytes_in_buffer)
+    JpegFillInput(cinfo);
+  else
+  {
+    cinfo->src->next_input_byte += num_bytes;
+    cinfo->src->bytes_in_buffer -= num_bytes;
+  }
+}
+
+static void JpegTermSource(j_decompress_ptr cinfo)
+{
+}
+
+static unsigned int ExifRead(const BYTE *p, int bytes, bool bIntel)
+{
+  unsigned int value = 0;
+  for (int i = 0; i < bytes; i++)
+    value |= (unsigned int)p[bIntel ? i : bytes - 1 - i] << (8 * i);
+  return value;
+}
+
+// the orientation tag from the first IFD of the exif block, 1 if there is none
+static int JpegOrientation(j_decompress_ptr cinfo)
+{
+  for (jpeg_saved_marker_ptr marker = cinfo->marker_list; marker; marker = marker->next)
+  {
+    if (marker->marker != JPEG_APP0 + 1 || marker->data_length < 14 || memcmp(marker->data, "Exif\0\0", 6))
+      continue;
+
+    const BYTE *tiff = marker->data + 6;
+    unsigned int length = marker->data_length - 6;
+    bool bIntel = tiff[0] == 'I';
+    unsigned int ifd = ExifRead(tiff + 4, 4, bIntel);
+    // compared so that a bogus offset can't wrap around
+    if (length < 2 || ifd > length - 2)
+      break;
+    unsigned int entries = std::min(ExifRead(tiff + ifd, 2, bIntel), (length - ifd - 2) / 12);
+    for (unsigned int i = 0; i < entries; i++)
+    {
+      const BYTE *entry = tiff + ifd + 2 + i * 12;
+      if (ExifRead(entry, 2, bIntel) == 0x0112)
+        return ExifRead(entry + 8, 2, bIntel);
+    }
+    break;
+  }
+  return 1;
+}
+
+// bilinear BGRA downscale, only used for the last factor of less than 2
+// that the DCT scaling can't do
+static BYTE *ScaleBGRA(const BYTE *src, unsigned int srcWidth, unsigned int srcHeight, unsigned int width, unsigned int height)
+{
+  BYTE *pixels = new BYTE[width * height * 4];
+  const unsigned int stepX = (srcWidth << 16) / width;
+  const unsigned int stepY = (srcHeight << 16) / height;
+  BYTE *dst = pixels;
+  for (unsigned int y = 0, sy = stepY / 2; y < height; y++, sy += stepY)
+  {
+    unsigned int y0 = sy >> 16;
+    unsigned int y1 = y0 + 1 < srcHeight ? y0 + 1 : y0;
+    unsigned int fy = (sy >> 8) & 0xff;
+    const BYTE *row0 = src + y0 * srcWidth * 4;
+    const BYTE *row1 = src + y1 * srcWidth * 4;
+    for (unsigned int x = 0, sx = stepX / 2; x < width; x++, sx += stepX)
+    {
+      unsigned int x0 = sx >> 16;
+      unsigned int x1 = x0 + 1 < srcWidth ? x0 + 1 : x0;
+      unsigned int fx = (sx >> 8) & 0xff;
+      for (int c = 0; c < 4; c++)
+      {
+        unsigned int top = row0[x0 * 4 + c] * (256 - fx) + row0[x1 * 4 + c] * fx;
+        unsigned int bottom = row1[x0 * 4 + c] * (256 - fx) + row1[x1 * 4 + c] * fx;
+        *dst++ = (BYTE)((top * (256 - fy) + bottom * fy) >> 16);
+      }
+    }
+  }
+  return pixels;
+}
+
+// no C++ objects live here as libjpeg errors longjmp back to the setjmp.
+BYTE *DecodeJpeg(const BYTE *data, unsigned int size, unsigned int iMaxWidth, unsigned int iMaxHeight, bool bRotate, ImageInfo &info)
+{
+  struct jpeg_decompress_struct cinfo;
+  struct jpeg_source_mgr src;
+  JpegError jerr;
+  BYTE * volatile pixels = NULL;
+  JSAMPLE * volatile row = NULL;
+
+  cinfo.err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = JpegErrorExit;
+  jerr.pub.output_message = JpegOutputMessage;
+  if (setjmp(jerr.jump))
+  {
+    jpeg_destroy_decompress(&cinfo);
+    delete[] pixels;
+    delete[] row;
+    return NULL;
+  }
+
+  jpeg_create_decompress(&cinfo);
+  src.init_source = JpegInitSource;
+  src.fill_input_buffer = JpegFillInput;
+  src.skip_input_data = JpegSkipInput;
+  src.resync_to_restart = jpeg_resync_to_restart;
+  src.term_source = JpegTermSource;
+  src.next_input_byte = data;
+  src.bytes_in_buffer = size;
+  cinfo.src = &src;
+  jpeg_save_markers(&cinfo, JPEG_APP0 + 1, 0xffff);
+  jpeg_read_header(&cinfo, TRUE);
+
+  int orientation = JpegOrientation(&cinfo);
+  if ((bRotate && orientation > 1) || cinfo.jpeg_color_space == JCS_CMYK || cinfo.jpeg_color_space == JCS_YCCK)
+  { // leave these to ImageLib
+    jpeg_destroy_decompress(&cinfo);
+    return NULL;
+  }
+
+  const unsigned int width = cinfo.image_width;
+  const unsigned int height = cinfo.image_height;
+  unsigned int destWidth = width;
+  unsigned int destHeight = height;
+  if (width > iMaxWidth || height > iMaxHeight)
+  {
+    float scale = std::min((float)iMaxWidth / width, (float)iMaxHeight / height);
+    destWidth = std::max(1, (int)(width * scale + 0.5f));
+    destHeight = std::max(1, (int)(height * scale + 0.5f));
+  }
+
+  unsigned int denom = 1;
+  while (denom < 8 && (width + denom * 2 - 1) / (denom * 2) >= destWidth && (height + denom * 2 - 1) / (denom * 2) >= destHeight)
+    denom *= 2;
+  cinfo.scale_num = 1;
+  cinfo.scale_denom = denom;
+  cinfo.out_color_space = JCS_RGB;
+  jpeg_start_decompress(&cinfo);
+
+  const unsigned int outWidth = cinfo.output_width;
+  const unsigned int outHeight = cinfo.output_height;
+  pixels = new BYTE[outWidth * outHeight * 4];
+  row = new JSAMPLE[outWidth * 3];
+  while (cinfo.output_scanline < outHeight)
+  {
+    BYTE *dst = pixels + cinfo.output_scanline * outWidth * 4;
+    JSAMPROW rows[1] = { row };
+    jpeg_read_scanlines(&cinfo, rows, 1);
+    SwizzleRow(dst, row, outWidth, true);
+  }
+  jpeg_finish_decompress(&cinfo);
+  jpeg_destroy_decompress(&cinfo);
+  delete[] row;
+
+  BYTE *result = pixels;
+  if (outWidth != destWidth || outHeight != destHeight)
+  {
+    result = ScaleBGRA(pixels, outWidth, outHeight, destWidth, destHeight);
+    delete[] pixels;
+  }
+
+  info.width = destWidth;
+  info.height = destHeight;
+  info.originalwidth = width;
+  info.originalheight = height;
+  info.exifInfo.Width = width;
+  info.exifInfo.Height = height;
+  info.exifInfo.Orientation = orientation;
+  CLog::Log(LOGDEBUG, "PICTURE: decoded jpeg %ux%u at 1/%u, scaled to %ux%u", width, height, denom, destWidth, destHeight);
+  return result;
+}
+#endif
@@ -0,0 +1,36 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+#include "DllImageLib.h"
+
+// expands packed 24 bit pixels to opaque 32 bit BGRA, swapping red and blue
+// if the source is RGB
+void SwizzleRow(BYTE *dst, const BYTE *src, unsigned int width, bool bSwapRB);
+
+#ifdef _LINUX
+// decodes a jpeg held in memory to a top down BGRA buffer of info.width *
+// info.height, at the smallest DCT scale (1/1 ... 1/8) still at least as large
+// as the image fitted into iMaxWidth x iMaxHeight, resampling the rest.
+// returns NULL if libjpeg can't read it, for CMYK, or when the image needs
+// rotating and bRotate is set, all of which are left to ImageLib.
+// the buffer is to be delete[]'d.
+BYTE *DecodeJpeg(const BYTE *data, unsigned int size, unsigned int iMaxWidth, unsigned int iMaxHeight, bool bRotate, ImageInfo &info);
+#endif
@@ -0,0 +1,311 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "LockProfiler.h"
+
+#include <algorithm>
+
+#ifdef _LINUX
+#include <dlfcn.h>
+#include <cxxabi.h>
+#endif
+
+using namespace std;
+
+bool CLockProfiler::m_enabled = false;
+__int64 CLockProfiler::m_ticksPerUs = 1;
+
+// guards the lists below, a plain XCriticalSection so it isn't profiled itself.
+// none of it is ever freed, sections may still be destroyed after static
+// destructors ran.
+static XCriticalSection* g_registryLock = NULL;
+static set<SLockStats*>* g_liveStats = NULL;
+static map<pair<string, void*>, SLockStats>* g_retiredStats = NULL;
+
+static inline __int64 Now()
+{
+  LARGE_INTEGER now;
+  QueryPerformanceCounter(&now);
+  return now.QuadPart;
+}
+
+static bool SortByWaitTime(const SLockStats& a, const SLockStats& b)
+{
+  return a.waitTotal > b.waitTotal;
+}
+
+void CLockProfiler::Enable()
+{
+  if (m_enabled)
+    return;
+
+  LARGE_INTEGER freq;
+  QueryPerformanceFrequency(&freq);
+  m_ticksPerUs = freq.QuadPart / 1000000;
+  if (m_ticksPerUs < 1)
+    m_ticksPerUs = 1;
+
+  g_registryLock = new XCriticalSection;
+  g_registryLock->Initialize();
+  g_liveStats = new set<SLockStats*>;
+  g_retiredStats = new map<pair<string, void*>, SLockStats>;
+  m_enabled = true;
+  CLog::Log(LOGNOTICE, "%s - lock profiling enabled", __FUNCTION__);
+}
+
+SLockStats* CLockProfiler::GetStats(CCriticalSection& section)
+{
+  // called holding the section, so no one else can be creating them
+  if (!section.m_stats)
+  {
+    SLockStats* stats = new SLockStats;
+    memset(stats, 0, sizeof(SLockStats));
+    stats->name = section.m_name;
+    stats->site = section.m_site;
+
+    g_registryLock->Enter();
+    g_liveStats->insert(stats);
+    g_registryLock->Leave();
+    section.m_stats = stats;
+  }
+  return section.m_stats;
+}
+
+void CLockProfiler::AddSample(unsigned int* histogram, __int64 us)
+{
+  int bucket = 0;
+  while (us > 1 && bucket < LOCK_HISTOGRAM_BUCKETS - 1)
+  {
+    us >>= 1;
+    bucket++;
+  }
+  histogram[bucket]++;
+}
+
+void CLockProfiler::Enter(CCriticalSection& section, DWORD count)
+{
+  XCriticalSection& cs = section.getCriticalSection();
+
+  __int64 start = 0;
+  bool contended = !cs.TryEnter();
+  if (contended)
+  {
+    start = Now();
+    cs.Enter();
+  }
+  if (count > 1)
+    cs.Restore(count - 1);
+
+  SLockStats* stats = GetStats(section);
+  if (stats->depth > 0)
+  { // a recursive enter, the hold time is that of the outermost one
+    stats->depth += count;
+    return;
+  }
+
+  stats->depth = count;
+  stats->enterTime = Now();
+  stats->acquires++;
+  if (contended)
+  {
+    __int64 wait = (stats->enterTime - start) / m_ticksPerUs;
+    stats->contended++;
+    stats->waitTotal += wait;
+    if (wait > stats->waitMax)
+      stats->waitMax = wait;
+    AddSample(stats->waitHistogram, wait);
+  }
+}
+
+void CLockProfiler::Leave(CCriticalSection& section)
+{
+  XCriticalSection& cs = section.getCriticalSection();
+  SLockStats* stats = section.m_stats;
+  if (stats && stats->depth > 0 && cs.Owning() && --stats->depth == 0)
+  {
+    __int64 hold = (Now() - stats->enterTime) / m_ticksPerUs;
+    stats->holdTotal += hold;
+    if (hold > stats->holdMax)
+      stats->holdMax = hold;
+    AddSample(stats->holdHistogram, hold);
+  }
+  cs.Leave();
+}
+
+DWORD CLockProfiler::Exit(CCriticalSection& section)
+{
+  XCriticalSection& cs = section.getCriticalSection();
+  SLockStats* stats = section.m_stats;
+  if (stats && stats->depth > 0 && cs.Owning())
+  {
+    stats->depth = 1;
+    Leave(section);
+    // Leave() gave one up already
+    return cs.Exit() + 1;
+  }
+  return cs.Exit();
+}
+
+void CLockProfiler::Retire(CCriticalSection& section)
+{
+  SLockStats* stats = section.m_stats;
+  section.m_stats = NULL;
+
+  g_registryLock->Enter();
+  g_liveStats->erase(stats);
+  Merge((*g_retiredStats)[make_pair(string(stats->name ? stats->name : ""), stats->site)], *stats);
+  g_registryLock->Leave();
+  delete stats;
+}
+
+void CLockProfiler::Merge(SLockStats& into, const SLockStats& from)
+{
+  into.name = from.name;
+  into.site = from.site;
+  into.acquires += from.acquires;
+  into.contended += from.contended;
+  into.waitTotal += from.waitTotal;
+  into.waitMax = max(into.waitMax, from.waitMax);
+  into.holdTotal += from.holdTotal;
+  into.holdMax = max(into.holdMax, from.holdMax);
+  for (int i = 0; i < LOCK_HISTOGRAM_BUCKETS; i++)
+  {
+    into.waitHistogram[i] += from.waitHistogram[i];
+    into.holdHistogram[i] += from.holdHistogram[i];
+  }
+}
+
+CStdString CLockProfiler::GetSiteName(const SLockStats& stats)
+{
+  CStdString site;
+  if (stats.name)
+    site = stats.name;
+#ifdef _LINUX
+  // the site is a return address in whatever constructed the section
+  Dl_info info;
+  if (site.IsEmpty() && stats.site && dladdr(stats.site, &info) && info.dli_sname)
+  {
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(info.dli_sname, NULL, NULL, &status);
+    site = status == 0 && demangled ? demangled : info.dli_sname;
+    free(demangled);
+  }
+#endif
+  if (site.IsEmpty())
+    site.Format("%p", stats.site);
+  return site;
+}
+
+void CLockProfiler::GetReport(vector<CStdString>& lines, unsigned int count)
+{
+  lines.clear();
+  if (!m_enabled)
+    return;
+
+  // live and retired sections of the same name and site are shown as one,
+  // the map's entries start out zeroed
+  map<pair<string, void*>, SLockStats> merged;
+  g_registryLock->Enter();
+  for (set<SLockStats*>::iterator it = g_liveStats->begin(); it != g_liveStats->end(); ++it)
+  {
+    const SLockStats& stats = **it;
+    SLockStats& into = merged[make_pair(string(stats.name ? stats.name : ""), stats.site)];
+    Merge(into, stats);
+  }
+  for (map<pair<string, void*>, SLockStats>::iterator it = g_retiredStats->begin(); it != g_retiredStats->end(); ++it)
+  {
+    SLockStats& into = merged[it->first];
+    Merge(into, it->second);
+  }
+  g_registryLock->Leave();
+
+  vector<SLockStats> sorted;
+  for (map<pair<string, void*>, SLockStats>::iterator it = merged.begin(); it != merged.end(); ++it)
+  {
+    if (it->second.acquires)
+      sorted.push_back(it->second);
+  }
+  sort(sorted.begin(), sorted.end(), SortByWaitTime);
+  if (sorted.size() > count)
+    sorted.resize(count);
+
+  for (unsigned int i = 0; i < sorted.size(); i++)
+  {
+    const SLockStats& stats = sorted[i];
+    CStdString line;
+    line.Format("%s: %u acquires, %u contended, wait %lld/%lld us (total/max), hold %lld/%lld us (total/max)",
+                GetSiteName(stats).c_str(), stats.acquires, stats.contended,
+                stats.waitTotal, stats.waitMax, stats.holdTotal, stats.holdMax);
+    lines.push_back(line);
+
+    for (int h = 0; h < 2; h++)
+    {
+      const unsigned int* histogram = h ? stats.holdHistogram : stats.waitHistogram;
+      CStdString buckets;
+      for (int b = 0; b < LOCK_HISTOGRAM_BUCKETS; b++)
+      {
+        if (!histogram[b])
+          continue;
+        CStdString bucket;
+        if (b < LOCK_HISTOGRAM_BUCKETS - 1)
+          bucket.Format(" <%u:%u", 2u << b, histogram[b]);
+        else
+          bucket.Format(" >=%u:%u", 1u << b, histogram[b]);
+        buckets += bucket;
+      }
+      if (!buckets.IsEmpty())
+        lines.push_back((h ? "  hold us:" : "  wait us:") + buckets);
+    }
+  }
+}
+
+void CLockProfiler::DumpToLog(unsigned int count)
+{
+  vector<CStdString> lines;
+  GetReport(lines, count);
+  if (lines.empty())
+    return;
+
+  CLog::Log(LOGNOTICE, "%s - most contended locks:", __FUNCTION__);
+  for (unsigned int i = 0; i < lines.size(); i++)
+    CLog::Log(LOGNOTICE, "%s", lines[i].c_str());
+}
+
+void CLockProfiler::Reset()
+{
+  if (!m_enabled)
+    return;
+
+  // counters of live sections are cleared under their owners' feet, an
+  // update or two may be lost
+  g_registryLock->Enter();
+  for (set<SLockStats*>::iterator it = g_liveStats->begin(); it != g_liveStats->end(); ++it)
+  {
+    SLockStats& stats = **it;
+    stats.acquires = stats.contended = 0;
+    stats.waitTotal = stats.waitMax = stats.holdTotal = stats.holdMax = 0;
+    memset(stats.waitHistogram, 0, sizeof(stats.waitHistogram));
+    memset(stats.holdHistogram, 0, sizeof(stats.holdHistogram));
+  }
+  g_retiredStats->clear();
+  g_registryLock->Leave();
+}
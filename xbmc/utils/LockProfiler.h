@@ -0,0 +1,81 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "CriticalSection.h"
+#include "StdString.h"
+
+#include <vector>
+
+#define LOCK_HISTOGRAM_BUCKETS 24 // powers of two in us, the last is >= 8s
+
+struct SLockStats
+{
+  const char* name;
+  void* site;
+  unsigned int acquires;       // outermost enters only
+  unsigned int contended;      // acquires that had to wait
+  __int64 waitTotal, waitMax;  // us
+  __int64 holdTotal, holdMax;  // us
+  unsigned int waitHistogram[LOCK_HISTOGRAM_BUCKETS];
+  unsigned int holdHistogram[LOCK_HISTOGRAM_BUCKETS];
+
+  // only touched by the thread holding the section
+  unsigned int depth;
+  __int64 enterTime;
+};
+
+// opt-in contention profiling of CCriticalSection, switched on with
+// <lockprofiling> in advancedsettings.xml. while it is off entering a section
+// costs one extra test. while it is on an uncontended enter adds a try-lock
+// and a clock read, only a thread that has to wait reads the clock twice.
+//
+// every section gets its stats the first time it's entered. they are
+// updated while holding the section itself, so no further locking is
+// needed. stats of destroyed sections are kept, merged by name and
+// creation site, so short lived sections show up as one.
+class CLockProfiler
+{
+public:
+  static void Enable();
+  static bool IsEnabled() { return m_enabled; }
+
+  static void Enter(CCriticalSection& section, DWORD count);
+  static void Leave(CCriticalSection& section);
+  static DWORD Exit(CCriticalSection& section);
+  static void Retire(CCriticalSection& section);
+
+  // one line per section, the sections threads waited longest on first.
+  // the wait and hold histograms follow each on their own line.
+  static void GetReport(std::vector<CStdString>& lines, unsigned int count);
+  static void DumpToLog(unsigned int count);
+  static void Reset();
+
+private:
+  static SLockStats* GetStats(CCriticalSection& section);
+  static void AddSample(unsigned int* histogram, __int64 us);
+  static void Merge(SLockStats& into, const SLockStats& from);
+  static CStdString GetSiteName(const SLockStats& stats);
+
+  static bool m_enabled;
+  static __int64 m_ticksPerUs;
+};
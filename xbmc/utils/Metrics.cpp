@@ -0,0 +1,229 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "Metrics.h"
+#include "Thread.h"
+
+using namespace std;
+
+// upper bounds of the histogram buckets in ms
+static const double g_bucketBounds[METRICS_HISTOGRAM_BUCKETS - 1] = { 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 5000 };
+
+CCriticalSection CMetrics::m_section;
+map<CStdString, __int64> CMetrics::m_counters;
+map<CStdString, double> CMetrics::m_gauges;
+map<CStdString, CMetrics::SHistogram> CMetrics::m_histograms;
+
+static inline __int64 Now()
+{
+  LARGE_INTEGER now;
+  QueryPerformanceCounter(&now);
+  return now.QuadPart;
+}
+
+void CMetrics::Increment(const CStdString& name, __int64 amount)
+{
+  CSingleLock lock(m_section);
+  m_counters[name] += amount;
+}
+
+void CMetrics::SetGauge(const CStdString& name, double value)
+{
+  CSingleLock lock(m_section);
+  m_gauges[name] = value;
+}
+
+void CMetrics::RemoveGauge(const CStdString& name)
+{
+  CSingleLock lock(m_section);
+  m_gauges.erase(name);
+}
+
+void CMetrics::Observe(const CStdString& name, double ms)
+{
+  int bucket = 0;
+  while (bucket < METRICS_HISTOGRAM_BUCKETS - 1 && ms > g_bucketBounds[bucket])
+    bucket++;
+
+  CSingleLock lock(m_section);
+  map<CStdString, SHistogram>::iterator it = m_histograms.find(name);
+  if (it == m_histograms.end())
+  {
+    SHistogram histogram;
+    memset(&histogram, 0, sizeof(histogram));
+    it = m_histograms.insert(make_pair(name, histogram)).first;
+  }
+  it->second.buckets[bucket]++;
+  it->second.count++;
+  it->second.sum += ms;
+}
+
+vector<CMetricCounter*>& CMetrics::GetCounters()
+{
+  // constructed on first use, the counters of other files may register
+  // before the statics of this one are
+  static vector<CMetricCounter*> counters;
+  return counters;
+}
+
+void CMetrics::SplitName(const CStdString& name, CStdString& family, CStdString& labels)
+{
+  int brace = name.Find('{');
+  if (brace < 0)
+  {
+    family = "xbmc_" + name;
+    labels.Empty();
+  }
+  else
+  {
+    family = "xbmc_" + name.Left(brace);
+    labels = name.Mid(brace + 1, name.size() - brace - 2);
+  }
+}
+
+CStdString CMetrics::Sample(const CStdString& family, const CStdString& suffix, const CStdString& labels, const CStdString& extraLabel)
+{
+  CStdString sample = family + suffix;
+  if (!labels.IsEmpty() || !extraLabel.IsEmpty())
+  {
+    sample += "{" + labels;
+    if (!labels.IsEmpty() && !extraLabel.IsEmpty())
+      sample += ",";
+    sample += extraLabel + "}";
+  }
+  return sample;
+}
+
+void CMetrics::GetReport(vector<CStdString>& lines)
+{
+  lines.clear();
+
+  // taken before our lock, the thread list has its own
+  vector<SThreadUsage> threads;
+  CThread::GetAllUsage(threads);
+
+  CSingleLock lock(m_section);
+  CStdString family, labels, lastFamily, line;
+
+  map<CStdString, __int64> counters(m_counters);
+  const vector<CMetricCounter*>& registered = GetCounters();
+  for (unsigned int i = 0; i < registered.size(); i++)
+    counters[registered[i]->m_name] += registered[i]->m_value;
+
+  for (map<CStdString, __int64>::const_iterator it = counters.begin(); it != counters.end(); ++it)
+  {
+    SplitName(it->first, family, labels);
+    if (family != lastFamily)
+      lines.push_back("# TYPE " + family + " counter");
+    lastFamily = family;
+    line.Format("%s %lld", Sample(family, "", labels).c_str(), it->second);
+    lines.push_back(line);
+  }
+
+  for (map<CStdString, double>::const_iterator it = m_gauges.begin(); it != m_gauges.end(); ++it)
+  {
+    SplitName(it->first, family, labels);
+    if (family != lastFamily)
+      lines.push_back("# TYPE " + family + " gauge");
+    lastFamily = family;
+    line.Format("%s %g", Sample(family, "", labels).c_str(), it->second);
+    lines.push_back(line);
+  }
+
+  for (map<CStdString, SHistogram>::const_iterator it = m_histograms.begin(); it != m_histograms.end(); ++it)
+  {
+    SplitName(it->first, family, labels);
+    if (family != lastFamily)
+      lines.push_back("# TYPE " + family + " histogram");
+    lastFamily = family;
+
+    const SHistogram& histogram = it->second;
+    unsigned int cumulative = 0;
+    for (int i = 0; i < METRICS_HISTOGRAM_BUCKETS; i++)
+    {
+      CStdString le;
+      if (i < METRICS_HISTOGRAM_BUCKETS - 1)
+        le.Format("le=\"%g\"", g_bucketBounds[i]);
+      else
+        le = "le=\"+Inf\"";
+      cumulative += histogram.buckets[i];
+      line.Format("%s %u", Sample(family, "_bucket", labels, le).c_str(), cumulative);
+      lines.push_back(line);
+    }
+    line.Format("%s %g", Sample(family, "_sum", labels).c_str(), histogram.sum);
+    lines.push_back(line);
+    line.Format("%s %u", Sample(family, "_count", labels).c_str(), histogram.count);
+    lines.push_back(line);
+  }
+
+  if (threads.size())
+    lines.push_back("# TYPE xbmc_thread_cpu_percent gauge");
+  for (unsigned int i = 0; i < threads.size(); i++)
+  {
+    line.Format("xbmc_thread_cpu_percent{thread=\"%s\",id=\"%u\"} %.1f",
+                threads[i].name.c_str(), threads[i].id, threads[i].usage * 100.0f);
+    lines.push_back(line);
+  }
+}
+
+CMetricAccumulator::CMetricAccumulator()
+{
+  m_count = 0;
+  m_ms = 0.0;
+}
+
+void CMetricAccumulator::Add(double ms)
+{
+  CSingleLock lock(m_section);
+  m_count++;
+  m_ms += ms;
+}
+
+void CMetricAccumulator::Take(unsigned int& count, double& ms)
+{
+  CSingleLock lock(m_section);
+  count = m_count;
+  ms = m_ms;
+  m_count = 0;
+  m_ms = 0.0;
+}
+
+CMetricCounter::CMetricCounter(const char* name)
+{
+  m_name = name;
+  m_value = 0;
+  // before main, no other thread is there to report yet
+  CMetrics::GetCounters().push_back(this);
+}
+
+CMetricTimer::CMetricTimer(const char* name)
+{
+  m_name = name;
+  m_start = Now();
+}
+
+CMetricTimer::~CMetricTimer()
+{
+  LARGE_INTEGER freq;
+  QueryPerformanceFrequency(&freq);
+  CMetrics::Observe(m_name, (double)(Now() - m_start) * 1000.0 / (double)freq.QuadPart);
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "CriticalSection.h"
+#include "StdString.h"
+
+#include <map>
+#include <vector>
+
+#define METRICS_HISTOGRAM_BUCKETS 12 // see the bounds in Metrics.cpp, the last is +Inf
+
+class CMetricCounter;
+
+// process wide counters, gauges and histograms for scraping through the HTTP
+// API (getmetrics). metric names may carry labels the way they are written
+// out, eg. "db_query_ms{kind=\"select\"}". everything is reported in the
+// prometheus text format, prefixed with "xbmc_".
+//
+// updating a metric takes a lock and a map lookup, so it's meant for things
+// happening a few hundred times a second at most - rate limit anything that
+// happens per packet or per frame, or count it with a CMetricCounter.
+class CMetrics
+{
+public:
+  static void Increment(const CStdString& name, __int64 amount = 1);
+  static void SetGauge(const CStdString& name, double value);
+  static void RemoveGauge(const CStdString& name);
+  static void Observe(const CStdString& name, double ms);
+
+  // one line per sample, per-thread cpu usage is taken at the time of the call
+  static void GetReport(std::vector<CStdString>& lines);
+
+private:
+  struct SHistogram
+  {
+    unsigned int buckets[METRICS_HISTOGRAM_BUCKETS];
+    unsigned int count;
+    double sum;
+  };
+
+  static void SplitName(const CStdString& name, CStdString& family, CStdString& labels);
+  static CStdString Sample(const CStdString& family, const CStdString& suffix, const CStdString& labels, const CStdString& extraLabel = "");
+
+  friend class CMetricCounter;
+  static std::vector<CMetricCounter*>& GetCounters();
+
+  static CCriticalSection m_section;
+  static std::map<CStdString, __int64> m_counters;
+  static std::map<CStdString, double> m_gauges;
+  static std::map<CStdString, SHistogram> m_histograms;
+};
+
+// adds up timings on a busy thread, for another one to publish now and then.
+// for things that happen too often to Observe() one by one.
+class CMetricAccumulator
+{
+public:
+  CMetricAccumulator();
+
+  void Add(double ms);
+  // the number and the total of the timings added since the last call
+  void Take(unsigned int& count, double& ms);
+
+private:
+  CCriticalSection m_section;
+  unsigned int m_count;
+  double m_ms;
+};
+
+// a counter for hot paths, bumping it is an atomic add without a lock or a
+// lookup. the report picks up what it counted when it's scraped. define them
+// at file scope, they register while the statics are constructed.
+class CMetricCounter
+{
+public:
+  CMetricCounter(const char* name);
+
+  void Increment()
+  {
+#ifdef __GNUC__
+    __sync_fetch_and_add(&m_value, 1);
+#else
+    InterlockedIncrement((LONG*)&m_value);
+#endif
+  }
+
+private:
+  friend class CMetrics;
+  const char* m_name;
+  volatile long m_value;
+};
+
+// observes the time from construction to destruction, in ms
+class CMetricTimer
+{
+public:
+  CMetricTimer(const char* name);
+  ~CMetricTimer();
+
+private:
+  const char* m_name;
+  __int64 m_start;
+};
@@ -22,6 +22,8 @@
 #include "stdafx.h"
 #include "PCMAmplifier.h"
 
+#define DEAMP_CHUNK 1024 // samples converted per pass of the 16 bit de-amplifier
+
 CPCMAmplifier::CPCMAmplifier() : m_nVolume(VOLUME_MAXIMUM), m_dFactor(0)
 {
 	m_intMax = 0;
@@ -61,7 +63,7 @@ void CPCMAmplifier::DeAmplifyInt16(int16_t *pcm, int nSamples, bool normalise, b
 	
 	if (normalise)
 	{
-		for (int16_t nSample=0; nSample<nSamples; nSample++)
+		for (int nSample=0; nSample<nSamples; nSample++)
 		{
 			// scan buffer and store maximum level encountered
 			m_intMax = MAX(m_intMax, pcm[nSample]);
@@ -78,10 +80,14 @@ void CPCMAmplifier::DeAmplifyInt16(int16_t *pcm, int nSamples, bool normalise, b
 	// apply the (possibly new) power factor to the buffer
 	double scale = volFactor * m_PowerFactor;
 	
-	for (int16_t nSample=0; nSample<nSamples; nSample++)
+	// scale as float and dither back, truncating to 16 bit adds audible distortion at low volume
+	float buffer[DEAMP_CHUNK];
+	for (int nSample=0; nSample<nSamples; nSample+=DEAMP_CHUNK)
 	{
-		int16_t nSampleValue = pcm[nSample];
-		pcm[nSample] = nSampleValue * scale;
+		int nChunk = std::min(DEAMP_CHUNK, nSamples - nSample);
+		CAudioDSP::Int16ToFloat(buffer, pcm + nSample, nChunk);
+		CAudioDSP::Gain(buffer, nChunk, (float)scale, true);
+		CAudioDSP::FloatToInt16(pcm + nSample, buffer, nChunk, &m_dither);
 	}
 	
 }
@@ -96,11 +102,5 @@ void CPCMAmplifier::DeAmplifyFloat32(float *pcm, int nSamples)
     return;
   }
 
-  for (int nSample=0; nSample<nSamples; nSample++)
-  {
-    float nSampleValue = pcm[nSample];
-    nSampleValue *= m_dFactor;
-
-    pcm[nSample] = nSampleValue;
-  }
+  CAudioDSP::Gain(pcm, nSamples, (float)m_dFactor, false);
 }
@@ -23,6 +23,7 @@
  */
 
 #include "../Settings.h"
+#include "AudioDSP.h"
 
 class CPCMAmplifier {
 public:
@@ -42,6 +43,7 @@ protected:
   double m_PowerFactor;
 	float m_floatMax;
   int16_t m_intMax;
+  CAudioDSP::DitherState m_dither;
 	
 
 };
@@ -30,12 +30,106 @@
 #include "FileSystem/FileZip.h"
 #include "Picture.h"
 #include "Util.h"
+#include "SingleLock.h"
+#include "Event.h"
 
 #include <cstring>
 #include <sstream>
+#include <deque>
 
 using namespace std;
 
+#define SCRAPER_HOST_CONNECTIONS 2                 // requests in flight per host
+#define SCRAPER_RESPONSE_CACHE   (8 * 1024 * 1024) // bytes of responses kept in memory
+
+// responses fetched during a scan, keyed by url. episode guides and search
+// pages get asked for again and again by the scanner, and the fetch workers
+// would otherwise hit the same pages in parallel. outside of a scan nothing
+// is kept, a refresh from the info dialog has to see the site as it is now.
+static CCriticalSection g_responseSection;
+static bool g_bCaching = false;
+static map<CStdString, string> g_responses;
+static deque<CStdString> g_responseOrder;
+static unsigned int g_responseBytes = 0;
+
+// request slots of a host, one per host for the life of the process
+struct SHostSlots
+{
+  SHostSlots() : active(0), waiting(0) {}
+  int active;
+  int waiting;
+  CEvent freed;
+};
+static map<CStdString, SHostSlots*> g_hostSlots;
+
+// holds one of the SCRAPER_HOST_CONNECTIONS request slots of a host
+class CHostSlot
+{
+public:
+  CHostSlot(const CStdString& strUrl)
+  {
+    CStdString strHost = CURL(strUrl).GetHostName();
+    CSingleLock lock(g_responseSection);
+    SHostSlots *&slots = g_hostSlots[strHost];
+    if (!slots)
+      slots = new SHostSlots;
+    m_slots = slots;
+    while (m_slots->active >= SCRAPER_HOST_CONNECTIONS)
+    {
+      m_slots->waiting++;
+      lock.Leave();
+      m_slots->freed.Wait();
+      lock.Enter();
+      m_slots->waiting--;
+    }
+    m_slots->active++;
+    // the event only keeps one wakeup, pass on any others that were meant
+    if (m_slots->waiting && m_slots->active < SCRAPER_HOST_CONNECTIONS)
+      m_slots->freed.Set();
+  }
+  ~CHostSlot()
+  {
+    CSingleLock lock(g_responseSection);
+    m_slots->active--;
+    if (m_slots->waiting)
+      m_slots->freed.Set();
+  }
+private:
+  SHostSlots *m_slots;
+};
+
+static bool GetCachedResponse(const CStdString& strKey, string& strHTML)
+{
+  CSingleLock lock(g_responseSection);
+  if (!g_bCaching)
+    return false;
+  map<CStdString, string>::const_iterator it = g_responses.find(strKey);
+  if (it == g_responses.end())
+    return false;
+  strHTML.append(it->second);
+  return true;
+}
+
+static void CacheResponse(const CStdString& strKey, const string& strHTML)
+{
+  if (strHTML.size() > SCRAPER_RESPONSE_CACHE / 8)
+    return;
+
+  CSingleLock lock(g_responseSection);
+  if (!g_bCaching || g_responses.find(strKey) != g_responses.end())
+    return;
+  while (g_responseBytes + strHTML.size() > SCRAPER_RESPONSE_CACHE && !g_responseOrder.empty())
+  { // drop the oldest
+    map<CStdString, string>::iterator it = g_responses.find(g_responseOrder.front());
+    g_responseBytes -= it->second.size();
+    g_responses.erase(it);
+    g_responseOrder.pop_front();
+  }
+  g_responses[strKey] = strHTML;
+  g_responseOrder.push_back(strKey);
+  g_responseBytes += strHTML.size();
+}
+
 CScraperUrl::CScraperUrl(const CStdString& strUrl)
 {
   ParseString(strUrl);
@@ -205,6 +299,11 @@ bool CScraperUrl::Get(const SUrlEntry& scrURL, string& strHTML, CHTTP& http)
     }
   }
 
+  CStdString strKey = (scrURL.m_post ? "POST " : "GET ") + scrURL.m_url;
+  if (GetCachedResponse(strKey, strHTML))
+    return true;
+
+  CHostSlot slot(scrURL.m_url);
   if (scrURL.m_post)
   {
     CStdString strOptions = url.GetOptions();
@@ -241,9 +340,26 @@ bool CScraperUrl::Get(const SUrlEntry& scrURL, string& strHTML, CHTTP& http)
       file.Write(strHTML.data(),strHTML.size());
     file.Close();
   }
+  else
+    CacheResponse(strKey, strHTML);
   return true;
 }
 
+void CScraperUrl::SetCaching(bool bEnable)
+{
+  CSingleLock lock(g_responseSection);
+  g_bCaching = bEnable;
+  ClearCache();
+}
+
+void CScraperUrl::ClearCache()
+{
+  CSingleLock lock(g_responseSection);
+  g_responses.clear();
+  g_responseOrder.clear();
+  g_responseBytes = 0;
+}
+
 bool CScraperUrl::DownloadThumbnail(const CStdString &thumb, const CScraperUrl::SUrlEntry& entry)
 {
   if (entry.m_url.IsEmpty())
@@ -267,7 +383,12 @@ bool CScraperUrl::DownloadThumbnail(const CStdString &thumb, const CScraperUrl::
   CHTTP http;
   http.SetReferer(entry.m_spoof);
   string thumbData;
-  if (http.Get(entry.m_url, thumbData))
+  bool bGot;
+  {
+    CHostSlot slot(entry.m_url);
+    bGot = http.Get(entry.m_url, thumbData);
+  }
+  if (bGot)
   {
     try
     {
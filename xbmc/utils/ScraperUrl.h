@@ -63,6 +63,10 @@ public:
   void Clear();
   static bool Get(const SUrlEntry&, std::string&, CHTTP& http);
   static bool DownloadThumbnail(const CStdString &thumb, const SUrlEntry& entry);
+  // Get() keeps responses in memory only while caching is on. the scanner turns
+  // it on for the length of a scan, both calls drop whatever was kept.
+  static void SetCaching(bool bEnable);
+  // drops the responses Get() kept in memory
   static void ClearCache();
 
   CStdString m_xml;
@@ -22,64 +22,247 @@
 #include "stdafx.h"
 #include "SharedSection.h"
 
-#define MAXSHAREDACCESSES 5000
+#if defined(_LINUX) && !defined(__APPLE__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <limits.h>
+#endif
+#ifdef __APPLE__
+#include <pthread.h>
+#endif
+
+// set in m_state by a writer that is waiting for the readers to go away. new
+// readers hold back while it is set, the low bits still count the readers.
+#define WRITER_WAITING 0x40000000
+#define READER_MASK    (WRITER_WAITING - 1)
+
+// how many shared locks the calling thread holds, on any section. a thread
+// that already holds one may always take another, otherwise a nested shared
+// lock would wait for a writer that is itself waiting for the outer one.
+#if defined(_MSC_VER)
+static __declspec(thread) int g_sharedHeld = 0;
+static inline int GetSharedHeld()         { return g_sharedHeld; }
+static inline void AddSharedHeld(int add) { g_sharedHeld += add; }
+#elif defined(__APPLE__)
+static pthread_key_t  g_sharedHeldKey;
+static pthread_once_t g_sharedHeldOnce = PTHREAD_ONCE_INIT;
+static void CreateSharedHeldKey()         { pthread_key_create(&g_sharedHeldKey, NULL); }
+static inline int GetSharedHeld()
+{
+  pthread_once(&g_sharedHeldOnce, CreateSharedHeldKey);
+  return (int)(intptr_t)pthread_getspecific(g_sharedHeldKey);
+}
+static inline void AddSharedHeld(int add)
+{
+  pthread_setspecific(g_sharedHeldKey, (void*)(intptr_t)(GetSharedHeld() + add));
+}
+#else
+static __thread int g_sharedHeld = 0;
+static inline int GetSharedHeld()         { return g_sharedHeld; }
+static inline void AddSharedHeld(int add) { g_sharedHeld += add; }
+#endif
+
+// both return what *p held before
+static inline int AtomicCompareExchange(volatile int* p, int oldValue, int newValue)
+{
+#ifdef __GNUC__
+  return __sync_val_compare_and_swap(p, oldValue, newValue);
+#else
+  return InterlockedCompareExchange((LONG*)p, newValue, oldValue);
+#endif
+}
+
+static inline int AtomicAdd(volatile int* p, int value)
+{
+#ifdef __GNUC__
+  return __sync_fetch_and_add(p, value);
+#else
+  int old;
+  do
+  {
+    old = *p;
+  } while (AtomicCompareExchange(p, old, old + value) != old);
+  return old;
+#endif
+}
 
 CSharedSection::CSharedSection()
 {
-  m_sharedLock = 0;
-  m_exclusive = false;
-  InitializeCriticalSection(&m_critSection);
-  InitializeCriticalSection(&m_helperLock);
-  m_eventFree = CreateEvent(NULL, TRUE, FALSE, NULL);
+  m_state = 0;
+  m_waiters = 0;
+  m_owner = 0;
+  m_recursion = 0;
+#if !defined(_LINUX) || defined(__APPLE__)
+  m_eventChanged = CreateEvent(NULL, TRUE, FALSE, NULL);
+#endif
+  ResetContention();
+}
+
+CSharedSection::CSharedSection(const CSharedSection& src)
+{
+  // a lock isn't copied, the copy starts out free
+  m_state = 0;
+  m_waiters = 0;
+  m_owner = 0;
+  m_recursion = 0;
+#if !defined(_LINUX) || defined(__APPLE__)
+  m_eventChanged = CreateEvent(NULL, TRUE, FALSE, NULL);
+#endif
+  ResetContention();
+}
+
+CSharedSection& CSharedSection::operator=(const CSharedSection& src)
+{
+  return *this;
 }
 
 CSharedSection::~CSharedSection()
 {
-  DeleteCriticalSection(&m_critSection);
-  DeleteCriticalSection(&m_helperLock);
-  CloseHandle(m_eventFree);
+#if !defined(_LINUX) || defined(__APPLE__)
+  CloseHandle(m_eventChanged);
+#endif
+}
+
+bool CSharedSection::IsExclusiveOwner() const
+{
+  // only the owner itself can see its own id here, so no barrier is needed
+  return m_state == -1 && m_owner == GetCurrentThreadId();
+}
+
+void CSharedSection::Wait(int state)
+{
+  AtomicAdd(&m_waiters, 1);
+#if defined(_LINUX) && !defined(__APPLE__)
+  // returns at once if m_state has moved on since we looked at it
+  syscall(SYS_futex, &m_state, FUTEX_WAIT_PRIVATE, state, NULL, NULL, 0);
+#else
+  ResetEvent(m_eventChanged);
+  if (m_state == state)
+  { // a wakeup meant for someone else may be reset by us, so don't sleep for long
+    WaitForSingleObject(m_eventChanged, 10);
+  }
+#endif
+  AtomicAdd(&m_waiters, -1);
+}
+
+void CSharedSection::Wake()
+{
+  if (m_waiters == 0)
+    return;
+#if defined(_LINUX) && !defined(__APPLE__)
+  syscall(SYS_futex, &m_state, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+  SetEvent(m_eventChanged);
+#endif
 }
 
 void CSharedSection::EnterShared()
 {
-  EnterCriticalSection(&m_critSection);
-  if( !m_exclusive )
-  { //exclusve will be set if this thread already owns this object
-    ResetEvent(m_eventFree);
-    EnterCriticalSection(&m_helperLock);
-    m_sharedLock++;
-    LeaveCriticalSection(&m_helperLock);
+  if (IsExclusiveOwner())
+  {
+    m_recursion++;
+    return;
+  }
+
+  // a waiting writer goes first, unless we'd be waiting on ourselves
+  int mask = GetSharedHeld() > 0 ? ~WRITER_WAITING : ~0;
+
+  int state = m_state;
+  if (state >= 0 && (state & mask & WRITER_WAITING) == 0
+   && AtomicCompareExchange(&m_state, state, state + 1) == state)
+  {
+    AddSharedHeld(1);
+    return;
+  }
+
+  DWORD start = GetTickCount();
+  while (true)
+  {
+    state = m_state;
+    if (state >= 0 && (state & mask & WRITER_WAITING) == 0)
+    {
+      if (AtomicCompareExchange(&m_state, state, state + 1) == state)
+        break;
+    }
+    else
+      Wait(state);
   }
-  LeaveCriticalSection(&m_critSection);
+  AddSharedHeld(1);
+  AtomicAdd(&m_sharedWaits, 1);
+  AtomicAdd(&m_waitTime, GetTickCount() - start);
 }
 
 void CSharedSection::LeaveShared()
 {
-  // NO! We always need to do this to keep the count right and set the event.
-  //if( !m_exclusive )
+  if (IsExclusiveOwner())
   {
-    EnterCriticalSection(&m_helperLock);
-    m_sharedLock--;
-    if (m_sharedLock == 0)
-      SetEvent(m_eventFree);
-    
-    LeaveCriticalSection(&m_helperLock);
+    m_recursion--;
+    return;
   }
+
+  AddSharedHeld(-1);
+  // the last reader out lets in the writers, and any readers that held back
+  if ((AtomicAdd(&m_state, -1) & READER_MASK) == 1)
+    Wake();
 }
 
 void CSharedSection::EnterExclusive()
 {
-  EnterCriticalSection(&m_critSection);
-  if( m_sharedLock != 0 )
-    WaitForSingleObject(m_eventFree, INFINITE);
+  if (IsExclusiveOwner())
+  {
+    m_recursion++;
+    return;
+  }
 
-  m_exclusive = true;
+  if (AtomicCompareExchange(&m_state, 0, -1) != 0)
+  {
+    DWORD start = GetTickCount();
+    while (true)
+    {
+      int state = m_state;
+      if (state == 0 || state == WRITER_WAITING)
+      { // taking it clears the flag, writers still waiting will set it again
+        if (AtomicCompareExchange(&m_state, state, -1) == state)
+          break;
+        continue;
+      }
+      if (state > 0 && !(state & WRITER_WAITING))
+      { // hold back new readers while the current ones finish
+        if (AtomicCompareExchange(&m_state, state, state | WRITER_WAITING) != state)
+          continue;
+        state |= WRITER_WAITING;
+      }
+      Wait(state);
+    }
+    AtomicAdd(&m_exclusiveWaits, 1);
+    AtomicAdd(&m_waitTime, GetTickCount() - start);
+  }
+  m_owner = GetCurrentThreadId();
+  m_recursion = 1;
 }
 
 void CSharedSection::LeaveExclusive()
 {
-  m_exclusive = false;
-  LeaveCriticalSection(&m_critSection);
+  if (--m_recursion > 0)
+    return;
+
+  m_owner = 0;
+  AtomicCompareExchange(&m_state, -1, 0);
+  Wake();
+}
+
+void CSharedSection::GetContention(unsigned int& sharedWaits, unsigned int& exclusiveWaits, unsigned int& waitTime) const
+{
+  sharedWaits = (unsigned int)m_sharedWaits;
+  exclusiveWaits = (unsigned int)m_exclusiveWaits;
+  waitTime = (unsigned int)m_waitTime;
+}
+
+void CSharedSection::ResetContention()
+{
+  m_sharedWaits = 0;
+  m_exclusiveWaits = 0;
+  m_waitTime = 0;
 }
 
 //////////////////////////////////////////////////////////////////////
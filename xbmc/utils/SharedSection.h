@@ -21,6 +21,18 @@
  *
  */
 
+// reader/writer lock. any number of threads may hold it shared, one thread
+// may hold it exclusive. the thread holding it exclusive may enter it again,
+// shared or exclusive. once a writer is waiting new readers hold back until it
+// got its turn, so a steady stream of readers can't starve it. a thread that
+// already holds a shared lock is let through regardless, so shared locks nest
+// freely - but a thread holding it shared must not ask for it exclusive, that
+// will never be granted.
+//
+// taking and releasing an uncontended lock is a single atomic operation, only
+// a thread that has to wait sleeps (on a futex under linux, an event
+// elsewhere). how often and how long threads waited is counted, see
+// GetContention().
 class CSharedSection
 {
 
@@ -30,21 +42,34 @@ public:
   CSharedSection& operator=(const CSharedSection& src);
   virtual ~CSharedSection();
 
-  inline void EnterExclusive();
-  inline void LeaveExclusive();
+  void EnterExclusive();
+  void LeaveExclusive();
 
-  inline void EnterShared();
-  inline void LeaveShared();
-  
-private:
+  void EnterShared();
+  void LeaveShared();
 
-  CRITICAL_SECTION m_critSection;
-  
-  CRITICAL_SECTION m_helperLock;
+  // number of times a thread had to wait for the lock, and the total time in ms
+  // spent waiting, since creation or the last reset
+  void GetContention(unsigned int& sharedWaits, unsigned int& exclusiveWaits, unsigned int& waitTime) const;
+  void ResetContention();
 
-  HANDLE m_eventFree;
-  bool m_exclusive;
-  long m_sharedLock;
+private:
+  bool IsExclusiveOwner() const;
+  void Wait(int state);
+  void Wake();
+
+  volatile int m_state;      // number of readers (+ WRITER_WAITING), -1 while held exclusive
+  volatile int m_waiters;
+  volatile DWORD m_owner;     // thread holding it exclusive
+  int m_recursion;            // enters by m_owner, shared or exclusive
+
+#if !defined(_LINUX) || defined(__APPLE__)
+  HANDLE m_eventChanged;
+#endif
+
+  volatile int m_sharedWaits;
+  volatile int m_exclusiveWaits;
+  volatile int m_waitTime;
 };
 
 class CSharedLock
@@ -55,8 +80,8 @@ public:
   virtual ~CSharedLock();
 
   bool IsOwner() const;
-  inline bool Enter();
-  inline void Leave();
+  bool Enter();
+  void Leave();
 
 protected:
   CSharedLock(const CSharedLock& src);
@@ -115,6 +115,57 @@ int CPosixUDPSocket::Read(CAddress& addr, const int buffersize, void *buffer)
                        (struct sockaddr*)&addr.saddr, &addr.size);  
 }
 
+int CPosixUDPSocket::ReadMany(CAddress* addrs, int* sizes, const int count,
+                              const int buffersize, unsigned char* buffers)
+{
+#if defined(_LINUX) && defined(MSG_WAITFORONE)
+  // a whole burst in a single call
+  vector<struct mmsghdr> msgs(count);
+  vector<struct iovec>   iovs(count);
+  memset(&msgs[0], 0, count * sizeof(struct mmsghdr));
+  for (int i = 0 ; i < count ; i++)
+  {
+    iovs[i].iov_base = buffers + i * buffersize;
+    iovs[i].iov_len  = buffersize;
+    msgs[i].msg_hdr.msg_iov     = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen  = 1;
+    msgs[i].msg_hdr.msg_name    = &addrs[i].saddr;
+    msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i].saddr);
+  }
+
+  int read = recvmmsg(m_iSock, &msgs[0], count, MSG_DONTWAIT, NULL);
+  if (read < 0)
+    return 0;
+
+  for (int i = 0 ; i < read ; i++)
+  {
+    sizes[i] = (int)msgs[i].msg_len;
+    addrs[i].size = msgs[i].msg_hdr.msg_namelen;
+  }
+  return read;
+#else
+  // the first read won't block, after it only take what is already there
+  int read = 0;
+  while (read < count)
+  {
+    if (read > 0)
+    {
+      fd_set set;
+      FD_ZERO(&set);
+      FD_SET(m_iSock, &set);
+      struct timeval tv = { 0, 0 };
+      if (select(m_iSock+1, &set, NULL, NULL, &tv) <= 0)
+        break;
+    }
+    int size = Read(addrs[read], buffersize, buffers + read * buffersize);
+    if (size < 0)
+      break;
+    sizes[read++] = size;
+  }
+  return read;
+#endif
+}
+
 int CPosixUDPSocket::SendTo(const CAddress& addr, const int buffersize, 
                           const void *buffer)
 {
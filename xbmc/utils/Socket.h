@@ -134,6 +134,13 @@ typedef int socklen_t;
 
     // read datagrams, return no. of bytes read or -1 or error
     virtual int  Read(CAddress& addr, const int buffersize, void *buffer) = 0;
+
+    // read up to count datagrams into consecutive buffers of buffersize
+    // bytes, the first one must be waiting already and no more than are
+    // waiting are read. returns no. of datagrams read, their sizes and
+    // senders are in sizes and addrs.
+    virtual int  ReadMany(CAddress* addrs, int* sizes, const int count,
+                          const int buffersize, unsigned char* buffers) = 0;
     virtual bool Broadcast(const CAddress& addr, const int datasize, 
                            const void* data) = 0;
   };
@@ -156,6 +163,8 @@ typedef int socklen_t;
     bool Listen(int timeout);
     int  SendTo(const CAddress& addr, const int datasize, const void* data);
     int  Read(CAddress& addr, const int buffersize, void *buffer);
+    int  ReadMany(CAddress* addrs, int* sizes, const int count,
+                  const int buffersize, unsigned char* buffers);
     bool Broadcast(const CAddress& addr, const int datasize, const void* data)
     {
       // TODO
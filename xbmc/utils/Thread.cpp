@@ -34,6 +34,7 @@ typedef int (*PBEGINTHREADEX_THREADFUNC)(LPVOID lpThreadParameter);
 
 #include "log.h"
 #include "GraphicContext.h"
+#include "SingleLock.h"
 
 #ifdef __APPLE__
 //
@@ -57,6 +58,11 @@ static void MakeTlsKeys()
 //////////////////////////////////////////////////////////////////////
 
 
+// threads GetAllUsage() reports on, from Create() until they finish. never
+// freed, some threads live in globals that may be destroyed after it.
+static CCriticalSection g_threadListSection;
+static std::set<CThread*>* g_threadList = NULL;
+
 #define MS_VC_EXCEPTION 0x406d1388
 typedef struct tagTHREADNAME_INFO 
 { 
@@ -81,6 +87,7 @@ CThread::CThread()
   m_iLastTime = 0;
   m_iLastUsage = 0;
   m_fLastUsage = 0.0f;
+  m_bRegistered = false;
   m_StopEvent = CreateEvent(NULL, TRUE, TRUE, NULL);
 
   m_pRunnable=NULL;
@@ -96,6 +103,7 @@ CThread::CThread(IRunnable* pRunnable)
   m_iLastTime = 0;
   m_iLastUsage = 0;
   m_fLastUsage = 0.0f;
+  m_bRegistered = false;
   m_StopEvent = CreateEvent(NULL, TRUE, TRUE, NULL);
 
   m_pRunnable=pRunnable;
@@ -103,6 +111,8 @@ CThread::CThread(IRunnable* pRunnable)
 
 CThread::~CThread()
 {
+  Unregister();
+
   if (m_ThreadHandle != NULL)
   {
     CloseHandle(m_ThreadHandle);
@@ -239,6 +249,8 @@ DWORD WINAPI CThread::staticThread(LPVOID* data)
     CLog::Log(LOGERROR, "%s - Unhandled exception caught in thread exit", __FUNCTION__); 
   }
 
+  pThread->Unregister();
+
   if ( pThread->IsAutoDelete() )
   {
     CLog::Log(LOGDEBUG,"%s, deleting thread object", __FUNCTION__);
@@ -269,7 +281,9 @@ void CThread::Create(bool bAutoDelete, unsigned stacksize)
   m_bAutoDelete = bAutoDelete;
   m_bStop = false;
   ::ResetEvent(m_StopEvent);
- 
+
+  // before the thread starts, it unregisters itself when done
+  Register();
   m_ThreadHandle = (HANDLE)_beginthreadex(NULL, stacksize, (PBEGINTHREADEX_THREADFUNC)staticThread, (void*)this, 0, &m_ThreadId);
 
 }
@@ -327,6 +341,11 @@ bool CThread::SetPriority(const int iPriority)
 
 void CThread::SetName( LPCTSTR szThreadName )
 {
+  {
+    CSingleLock lock(g_threadListSection);
+    m_strName = szThreadName ? szThreadName : "";
+  }
+
   THREADNAME_INFO info; 
   info.dwType = 0x1000; 
   info.szName = szThreadName; 
@@ -404,6 +423,42 @@ float CThread::GetRelativeUsage()
   return 0.0f; 
 }
 
+void CThread::Register()
+{
+  CSingleLock lock(g_threadListSection);
+  if (!g_threadList)
+    g_threadList = new std::set<CThread*>;
+  g_threadList->insert(this);
+  m_bRegistered = true;
+}
+
+void CThread::Unregister()
+{
+  if (!m_bRegistered)
+    return;
+
+  CSingleLock lock(g_threadListSection);
+  g_threadList->erase(this);
+  m_bRegistered = false;
+}
+
+void CThread::GetAllUsage(std::vector<SThreadUsage>& usage)
+{
+  usage.clear();
+  CSingleLock lock(g_threadListSection);
+  if (!g_threadList)
+    return;
+  for (std::set<CThread*>::iterator it = g_threadList->begin(); it != g_threadList->end(); ++it)
+  {
+    CThread* thread = *it;
+    SThreadUsage entry;
+    entry.name = thread->m_strName.empty() ? "unnamed" : thread->m_strName;
+    entry.id = thread->ThreadId();
+    entry.usage = thread->GetRelativeUsage();
+    usage.push_back(entry);
+  }
+}
+
 DWORD CThread::WaitForSingleObject(HANDLE hHandle, DWORD dwMilliseconds)
 {
   if(dwMilliseconds > 10 && GetCurrentThreadId() == m_ThreadId)
@@ -39,6 +39,9 @@
 #include <mach/mach.h>
 #endif
 
+#include <string>
+#include <vector>
+
 class IRunnable
 {
 public:
@@ -50,6 +53,13 @@ public:
 #undef CTHREAD
 #endif
 
+struct SThreadUsage
+{
+  std::string name;
+  DWORD id;
+  float usage;
+};
+
 // minimum as mandated by XTL
 #define THREAD_MINSTACKSIZE 0x10000
 
@@ -75,6 +85,9 @@ public:
 
   // returns the relative cpu usage of this thread since last call
   float GetRelativeUsage();
+
+  // GetRelativeUsage() of every thread created and not yet finished
+  static void GetAllUsage(std::vector<SThreadUsage>& usage);
   
 protected:
   virtual void OnStartup(){};
@@ -99,6 +112,11 @@ private:
   unsigned __int64 m_iLastTime;
   float m_fLastUsage;
 
+  std::string m_strName;
+  bool m_bRegistered;
+  void Register();
+  void Unregister();
+
 private:
 #ifndef _WIN32
   static int staticThread(void* data);
@@ -21,14 +21,15 @@
  * TODO
  * Remove compiling in of FFT_BUFFER_SIZE?  (Might slow things down, but would
  * be nice to be able to change size at runtime.)
- * Finish making / checking thread-safety.
- * More optimisations.
  */
 
 #include "fft.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #ifndef PI
 #ifdef M_PI
 #define PI M_PI
@@ -46,29 +47,26 @@ struct _struct_fft_state
   /* Temporary data stores to perform FFT in. */
   float real[FFT_BUFFER_SIZE];
   float imag[FFT_BUFFER_SIZE];
+
+  /* Hann window, scaled to an average of 1 so that a sine keeps its level */
+  float window[FFT_BUFFER_SIZE];
+
+  /* Twiddle factors, one run per pass.  The pass combining groups of
+   * half h finds its h factors at offset h - 1. */
+  float twiddleReal[FFT_BUFFER_SIZE];
+  float twiddleImag[FFT_BUFFER_SIZE];
+
+  /* Table to speed up bit reverse copy */
+  unsigned int bitReverse[FFT_BUFFER_SIZE];
 };
 
 /* ############################# */
 /* # Local function prototypes # */
 /* ############################# */
 
-static void fft_prepare(const sound_sample *input, float * re, float * im);
-static void fft_calculate(float * re, float * im);
-static void fft_output(const float *re, const float *im, float *output);
+static void fft_calculate(fft_state *state);
 static int reverseBits(unsigned int initial);
 
-/* #################### */
-/* # Global variables # */
-/* #################### */
-
-/* Table to speed up bit reverse copy */
-static unsigned int bitReverse[FFT_BUFFER_SIZE];
-
-/* The next two tables could be made to use less space in memory, since they
- * overlap hugely, but hey. */
-static float sintable[FFT_BUFFER_SIZE / 2];
-static float costable[FFT_BUFFER_SIZE / 2];
-
 /* ############################## */
 /* # Externally called routines # */
 /* ############################## */
@@ -86,7 +84,7 @@ static float costable[FFT_BUFFER_SIZE / 2];
 fft_state *fft_init(void)
 {
   fft_state *state;
-  unsigned int i;
+  unsigned int i, half;
 
   state = (fft_state *) malloc(sizeof(fft_state));
   if (!state)
@@ -94,13 +92,16 @@ fft_state *fft_init(void)
 
   for (i = 0; i < FFT_BUFFER_SIZE; i++)
   {
-    bitReverse[i] = reverseBits(i);
+    state->bitReverse[i] = reverseBits(i);
+    state->window[i] = 1.0f - cos(2 * PI * i / FFT_BUFFER_SIZE);
   }
-  for (i = 0; i < FFT_BUFFER_SIZE / 2; i++)
+  for (half = 1; half < FFT_BUFFER_SIZE; half <<= 1)
   {
-    float j = 2 * PI * i / FFT_BUFFER_SIZE;
-    costable[i] = cos(j);
-    sintable[i] = sin(j);
+    for (i = 0; i < half; i++)
+    {
+      state->twiddleReal[half - 1 + i] = cos(PI * i / half);
+      state->twiddleImag[half - 1 + i] = -sin(PI * i / half);
+    }
   }
 
   return state;
@@ -111,12 +112,8 @@ fft_state *fft_init(void)
  * sound.h) and returning the intensities of each frequency as floats in the
  * range 0 to ((FFT_BUFFER_SIZE / 2) * 32768) ^ 2
  *
- * FIXME - the above range assumes no frequencies present have an amplitude
- * larger than that of the sample variation.  But this is false: we could have
- * a wave such that its maximums are always between samples, and it's just
- * inside the representable range at the places samples get taken.
- * Question: what _is_ the maximum value possible.  Twice that value?  Root
- * two times that value?  Hmmm.  Think it depends on the frequency, too.
+ * The input is windowed first, so a frequency between two bins doesn't
+ * smear over the whole spectrum.
  *
  * The input array is assumed to have FFT_BUFFER_SIZE elements,
  * and the output array is assumed to have (FFT_BUFFER_SIZE / 2 + 1) elements.
@@ -124,50 +121,105 @@ fft_state *fft_init(void)
  */
 void fft_perform(const sound_sample *input, float *output, fft_state *state)
 {
-  /* Convert data from sound format to be ready for FFT */
-  fft_prepare(input, state->real, state->imag);
+  unsigned int i;
+
+  /* Get input, in reverse bit order */
+  for (i = 0; i < FFT_BUFFER_SIZE; i++)
+  {
+    unsigned int n = state->bitReverse[i];
+    state->real[i] = input[n] * state->window[n];
+    state->imag[i] = 0;
+  }
 
-  /* Do the actual FFT */
-  fft_calculate(state->real, state->imag);
+  fft_calculate(state);
 
   /* Convert the FFT output into intensities */
-  fft_output(state->real, state->imag, output);
+  for (i = 0; i <= FFT_BUFFER_SIZE / 2; i++)
+    output[i] = state->real[i] * state->real[i] + state->imag[i] * state->imag[i];
+
+  /* Do divisions to keep the constant and highest frequency terms in scale
+   * with the other terms. */
+  output[0] /= 4;
+  output[FFT_BUFFER_SIZE / 2] /= 4;
 }
 
 #define FFT_MIN(a,b) (a<b) ? a : b
 #define SCALE_FACTOR 14000.0
 
+/*
+ * Both channels go through a single complex FFT, left as the real part and
+ * right as the imaginary part.  The spectrum of a real signal is conjugate
+ * symmetric, which is what lets the two be told apart again afterwards:
+ *   L[k] = (Z[k] + conj(Z[N-k])) / 2
+ *   R[k] = (Z[k] - conj(Z[N-k])) / 2i
+ *
+ * The input is FFT_BUFFER_SIZE interleaved stereo samples, the output
+ * FFT_BUFFER_SIZE interleaved magnitudes, FFT_BUFFER_SIZE / 2 per channel.
+ */
 void fft_perform_stereo(const sound_sample* input, float* output, fft_state *state)
 {
-  // Demux data.
-  sound_sample channel[FFT_BUFFER_SIZE];
-  float        outChannel[FFT_BUFFER_SIZE/2+1];
-  
-  // Preprocess.
-  int n=0;
-  for (int i=0; i<FFT_BUFFER_SIZE*2; i+=2, n++)
-    channel[n] = input[i];
-  
-  // Perform.
-  fft_perform(channel, outChannel, state);
-  
-  // Postprocess.
-  n = 0;
-  for(int j=0; j<FFT_BUFFER_SIZE; j+=2, n++)
-    output[j] = FFT_MIN(255.0, ::sqrt(outChannel[n])/SCALE_FACTOR);//*(((float)j/(float)(FFT_BUFFER_SIZE/2))+0.1));
-  
-  // Preprocess.
-  n = 0;
-  for (int i=1; i<FFT_BUFFER_SIZE*2; i+=2, n++)
-    channel[n] = input[i];
-  
-  // Perform.
-  fft_perform(channel, outChannel, state);
-  
-  // Postprocess.
-  n = 0;
-  for(int j=1; j<FFT_BUFFER_SIZE; j+=2, n++)
-    output[j] = FFT_MIN(255.0, ::sqrt(outChannel[n])/SCALE_FACTOR);//*(((float)j/(float)(FFT_BUFFER_SIZE/2))+0.1));
+  const float *re = state->real;
+  const float *im = state->imag;
+  const float scale = (float)(0.5 / SCALE_FACTOR);
+  unsigned int i, k = 0;
+
+  for (i = 0; i < FFT_BUFFER_SIZE; i++)
+  {
+    unsigned int n = state->bitReverse[i];
+    state->real[i] = input[2*n] * state->window[n];
+    state->imag[i] = input[2*n+1] * state->window[n];
+  }
+
+  fft_calculate(state);
+
+#ifdef __SSE2__
+  /* k = 0 pairs with itself, so start with the first full block after it */
+  const __m128 vscale = _mm_set1_ps(scale);
+  const __m128 vmax = _mm_set1_ps(255.0f);
+  for (k = 4; k < FFT_BUFFER_SIZE / 2; k += 4)
+  {
+    __m128 a = _mm_loadu_ps(re + k);
+    __m128 b = _mm_loadu_ps(im + k);
+    __m128 c = _mm_loadu_ps(re + FFT_BUFFER_SIZE - k - 3);
+    __m128 d = _mm_loadu_ps(im + FFT_BUFFER_SIZE - k - 3);
+    c = _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 1, 2, 3));
+    d = _mm_shuffle_ps(d, d, _MM_SHUFFLE(0, 1, 2, 3));
+
+    __m128 lr = _mm_add_ps(a, c);
+    __m128 li = _mm_sub_ps(b, d);
+    __m128 rr = _mm_add_ps(b, d);
+    __m128 ri = _mm_sub_ps(a, c);
+    __m128 left = _mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(lr, lr), _mm_mul_ps(li, li))), vscale);
+    __m128 right = _mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(rr, rr), _mm_mul_ps(ri, ri))), vscale);
+    left = _mm_min_ps(left, vmax);
+    right = _mm_min_ps(right, vmax);
+
+    _mm_storeu_ps(output + 2*k, _mm_unpacklo_ps(left, right));
+    _mm_storeu_ps(output + 2*k + 4, _mm_unpackhi_ps(left, right));
+  }
+  /* and the first block, below */
+  unsigned int end = 4;
+  k = 0;
+#else
+  unsigned int end = FFT_BUFFER_SIZE / 2;
+#endif
+  for (; k < end; k++)
+  {
+    unsigned int n = (FFT_BUFFER_SIZE - k) & (FFT_BUFFER_SIZE - 1);
+    float lr = re[k] + re[n];
+    float li = im[k] - im[n];
+    float rr = im[k] + im[n];
+    float ri = re[k] - re[n];
+    float left = sqrt(lr * lr + li * li) * scale;
+    float right = sqrt(rr * rr + ri * ri) * scale;
+    if (k == 0)
+    { /* the constant term */
+      left /= 2;
+      right /= 2;
+    }
+    output[2*k] = FFT_MIN(255.0f, left);
+    output[2*k+1] = FFT_MIN(255.0f, right);
+  }
 }
 
 
@@ -185,140 +237,67 @@ void fft_close(fft_state *state)
 /* ########################### */
 
 /*
- * Prepare data to perform an FFT on
+ * Actually perform the FFT, in place on input that is in bit reversed order
  */
-static void fft_prepare(const sound_sample *input, float * re, float * im)
+static void fft_calculate(fft_state *state)
 {
-  unsigned int i;
-  float *realptr = re;
-  float *imagptr = im;
+  float *re = state->real;
+  float *im = state->imag;
+  unsigned int i, j, group, half;
 
-  /* Get input, in reverse bit order */
-  for (i = 0; i < FFT_BUFFER_SIZE; i++)
+  /* The first two passes together - their factors are 1 and -i */
+  for (i = 0; i < FFT_BUFFER_SIZE; i += 4)
   {
-    *realptr++ = input[bitReverse[i]];
-    *imagptr++ = 0;
+    float r0 = re[i] + re[i+1], i0 = im[i] + im[i+1];
+    float r1 = re[i] - re[i+1], i1 = im[i] - im[i+1];
+    float r2 = re[i+2] + re[i+3], i2 = im[i+2] + im[i+3];
+    float r3 = re[i+2] - re[i+3], i3 = im[i+2] - im[i+3];
+    re[i]   = r0 + r2; im[i]   = i0 + i2;
+    re[i+2] = r0 - r2; im[i+2] = i0 - i2;
+    re[i+1] = r1 + i3; im[i+1] = i1 - r3;
+    re[i+3] = r1 - i3; im[i+3] = i1 + r3;
   }
-}
-
-/*
- * Take result of an FFT and calculate the intensities of each frequency
- * Note: only produces half as many data points as the input had.
- * This is roughly a consequence of the Nyquist sampling theorm thingy.
- * (FIXME - make this comment better, and helpful.)
- * 
- * The two divisions by 4 are also a consequence of this: the contributions
- * returned for each frequency are split into two parts, one at i in the
- * table, and the other at FFT_BUFFER_SIZE - i, except for i = 0 and
- * FFT_BUFFER_SIZE which would otherwise get float (and then 4* when squared)
- * the contributions.
- */
-static void fft_output(const float * re, const float * im, float *output)
-{
-  float *outputptr = output;
-  const float *realptr = re;
-  const float *imagptr = im;
-  float *endptr = output + FFT_BUFFER_SIZE / 2;
-
-#ifdef DEBUG
-  unsigned int i, j;
-#endif
 
-  while (outputptr <= endptr)
+  /* The rest, combining groups of half values into groups of 2 * half
+   *   val[k]        := val[k] + factor * val[k + half]
+   *   val[k + half] := val[k] - factor * val[k + half]
+   */
+  for (half = 4; half < FFT_BUFFER_SIZE; half <<= 1)
   {
-    *outputptr = (*realptr * *realptr) + (*imagptr * *imagptr);
-    outputptr++;
-    realptr++;
-    imagptr++;
-  }
-  
-  /* Do divisions to keep the constant and highest frequency terms in scale
-   * with the other terms. */
-  *output /= 4;
-  *endptr /= 4;
-
-#ifdef DEBUG
-  printf("Recalculated input:\n");
-  for(i = 0; i < FFT_BUFFER_SIZE; i++)
-  {
-    float val_real = 0;
-    float val_imag = 0;
-    for(j = 0; j < FFT_BUFFER_SIZE; j++)
+    const float *factReal = state->twiddleReal + half - 1;
+    const float *factImag = state->twiddleImag + half - 1;
+    for (group = 0; group < FFT_BUFFER_SIZE; group += half << 1)
     {
-      float fact_real = cos(- 2 * j * i * PI / FFT_BUFFER_SIZE);
-      float fact_imag = sin(- 2 * j * i * PI / FFT_BUFFER_SIZE);
-      val_real += fact_real * re[j] - fact_imag * im[j];
-      val_imag += fact_real * im[j] + fact_imag * re[j];
-    }
-    printf("%5d = %8f + i * %8f\n", i,
-        val_real / FFT_BUFFER_SIZE,
-        val_imag / FFT_BUFFER_SIZE);
-  }
-  printf("\n");
-#endif
-}
-
-/*
- * Actually perform the FFT
- */
-static void fft_calculate(float * re, float * im)
-{
-  unsigned int i, j, k;
-  unsigned int exchanges;
-  float fact_real, fact_imag;
-  float tmp_real, tmp_imag;
-  unsigned int factfact;
-
-  /* Set up some variables to reduce calculation in the loops */
-  exchanges = 1;
-  factfact = FFT_BUFFER_SIZE / 2;
-
-  /* Loop through the divide and conquer steps */
-  for (i = FFT_BUFFER_SIZE_LOG; i != 0; i--)
-  {
-    /* In this step, we have 2 ^ (i - 1) exchange groups, each with
-     * 2 ^ (FFT_BUFFER_SIZE_LOG - i) exchanges
-     */
-    /* Loop through the exchanges in a group */
-    for (j = 0; j != exchanges; j++)
-    {
-      /* Work out factor for this exchange
-       * factor ^ (exchanges) = -1
-       * So, real = cos(j * PI / exchanges),
-       *     imag = sin(j * PI / exchanges)
-       */
-      fact_real = costable[j * factfact];
-      fact_imag = sintable[j * factfact];
-
-      /* Loop through all the exchange groups */
-      for (k = j; k < FFT_BUFFER_SIZE; k += exchanges << 1)
+      float *aReal = re + group, *aImag = im + group;
+      float *bReal = aReal + half, *bImag = aImag + half;
+      j = 0;
+#ifdef __SSE2__
+      for (; j < half; j += 4)
       {
-        int k1 = k + exchanges;
-        /* newval[k]  := val[k] + factor * val[k1]
-         * newval[k1] := val[k] - factor * val[k1]
-         **/
-#ifdef DEBUG
-        printf("%d %d %d\n", i,j,k);
-        printf("Exchange %d with %d\n", k, k1);
-        printf("Factor %9f + i * %8f\n", fact_real, fact_imag);
-#endif
-        /* FIXME - potential scope for more optimization here? */
-        tmp_real = fact_real * re[k1] - fact_imag * im[k1];
-        tmp_imag = fact_real * im[k1] + fact_imag * re[k1];
-        re[k1] = re[k] - tmp_real;
-        im[k1] = im[k] - tmp_imag;
-        re[k] += tmp_real;
-        im[k] += tmp_imag;
-#ifdef DEBUG
-        for(k1 = 0; k1 < FFT_BUFFER_SIZE; k1++)
-        {
-          printf("%5d = %8f + i * %8f\n", k1, real[k1], imag[k1]);
-        }
+        __m128 fr = _mm_loadu_ps(factReal + j);
+        __m128 fi = _mm_loadu_ps(factImag + j);
+        __m128 xr = _mm_loadu_ps(bReal + j);
+        __m128 xi = _mm_loadu_ps(bImag + j);
+        __m128 tr = _mm_sub_ps(_mm_mul_ps(fr, xr), _mm_mul_ps(fi, xi));
+        __m128 ti = _mm_add_ps(_mm_mul_ps(fr, xi), _mm_mul_ps(fi, xr));
+        __m128 yr = _mm_loadu_ps(aReal + j);
+        __m128 yi = _mm_loadu_ps(aImag + j);
+        _mm_storeu_ps(bReal + j, _mm_sub_ps(yr, tr));
+        _mm_storeu_ps(bImag + j, _mm_sub_ps(yi, ti));
+        _mm_storeu_ps(aReal + j, _mm_add_ps(yr, tr));
+        _mm_storeu_ps(aImag + j, _mm_add_ps(yi, ti));
+      }
 #endif
+      for (; j < half; j++)
+      {
+        float tr = factReal[j] * bReal[j] - factImag[j] * bImag[j];
+        float ti = factReal[j] * bImag[j] + factImag[j] * bReal[j];
+        bReal[j] = aReal[j] - tr;
+        bImag[j] = aImag[j] - ti;
+        aReal[j] += tr;
+        aImag[j] += ti;
       }
     }
-    exchanges <<= 1;
-    factfact >>= 1;
   }
 }
 
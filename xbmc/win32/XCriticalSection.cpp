@@ -89,6 +89,15 @@ void XCriticalSection::Enter()
 	EnterCriticalSection(&m_criticalSection);
 }
 
+//////////////////////////////////////////////////////////////////////
+BOOL XCriticalSection::TryEnter()
+{
+	if (m_isDestroyed || m_isInitialized == false)
+		return FALSE;
+	
+	return TryEnterCriticalSection(&m_criticalSection);
+}
+
 //////////////////////////////////////////////////////////////////////
 void XCriticalSection::Leave()
 {